@@ -0,0 +1,113 @@
+/// benchmarks of the astrodynamics solvers, transforms and ephemerides, reported in evaluations per
+/// second.
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <lao/lao.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t batch = 1024;
+
+/// @brief returns batch values evenly spaced over [low, high).
+std::vector<double> spaced(double low, double high)
+{
+    std::vector<double> values(batch);
+    for (size_t k = 0; k < batch; ++k)
+        values[k] = low + (high - low) * static_cast<double>(k) / static_cast<double>(batch);
+    return values;
+}
+
+void BM_MeanAnomalyToEccentricAnomaly(benchmark::State& state)
+{
+    const std::vector<double> M = spaced(-3.0, 3.0);
+    const std::vector<double> e = spaced(0.0, 0.95);
+    for (auto _ : state) {
+        for (size_t k = 0; k < batch; ++k)
+            benchmark::DoNotOptimize(lao::astro::meanAnomalyToEccentricAnomaly(M[k], e[k]));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_MeanAnomalyToEccentricAnomaly);
+
+void BM_EccentricAnomalyBatch(benchmark::State& state)
+{
+    const std::vector<double> M = spaced(-3.0, 3.0);
+    const std::vector<double> e = spaced(0.0, 0.95);
+    std::vector<double> E(batch);
+    for (auto _ : state) {
+        lao::astro::eccentricAnomalyBatch(M, e, E);
+        benchmark::DoNotOptimize(E.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_EccentricAnomalyBatch);
+
+void BM_RotationFromEuler(benchmark::State& state)
+{
+    const std::vector<double> angles = spaced(-3.0, 3.0);
+    for (auto _ : state) {
+        for (size_t k = 0; k + 2 < batch; ++k) {
+            const lao::linalg::RowVector<double, 3> phi_theta_psi { { angles[k], angles[k + 1], angles[k + 2] } };
+            benchmark::DoNotOptimize(lao::astro::rotationFromEuler(std::string("ZXZ"), phi_theta_psi));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * (batch - 2)));
+}
+BENCHMARK(BM_RotationFromEuler);
+
+void BM_RotationFromEulerSequence(benchmark::State& state)
+{
+    const std::vector<double> angles = spaced(-3.0, 3.0);
+    for (auto _ : state) {
+        for (size_t k = 0; k + 2 < batch; ++k)
+            benchmark::DoNotOptimize(lao::astro::rotationFromEuler<lao::astro::EulerSequence::ZXZ>(angles[k], angles[k + 1], angles[k + 2]));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * (batch - 2)));
+}
+BENCHMARK(BM_RotationFromEulerSequence);
+
+void BM_JPLLP_eph(benchmark::State& state)
+{
+    const lao::astro::JPLLP body("Mars");
+    const std::vector<double> mjd2000 = spaced(0.0, 10000.0);
+    for (auto _ : state) {
+        for (size_t k = 0; k < batch; ++k)
+            benchmark::DoNotOptimize(body.eph(lao::astro::Epoch(mjd2000[k])));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_JPLLP_eph);
+
+void BM_JPLLP_ephBatch(benchmark::State& state)
+{
+    const lao::astro::JPLLP body("Mars");
+    const std::vector<double> mjd2000 = spaced(0.0, 10000.0);
+    lao::astro::StateBatch states;
+    for (auto _ : state) {
+        body.ephBatch(mjd2000, states);
+        benchmark::DoNotOptimize(states.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_JPLLP_ephBatch);
+
+void BM_JPLLP_ephBatchFloat(benchmark::State& state)
+{
+    const lao::astro::JPLLP body("Mars");
+    const std::vector<double> mjd2000 = spaced(0.0, 10000.0);
+    std::vector<float> states(6 * mjd2000.size());
+    for (auto _ : state) {
+        body.ephBatch(mjd2000, states.data(), mjd2000.size());
+        benchmark::DoNotOptimize(states.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_JPLLP_ephBatchFloat);
+
+}; // namespace
@@ -0,0 +1,200 @@
+/// benchmarks of the dense matrices, expressions and solvers over square sizes, reported in GFLOP/s.
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <lao/lao.hpp>
+#include <random>
+
+namespace {
+
+using DenseMatrix = lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic>;
+using DenseVector = lao::linalg::Matrix<double, lao::linalg::Dynamic, 1>;
+
+/// @brief returns an n x n matrix of uniform values in [0, 1], the same on every run.
+DenseMatrix randomMatrix(size_t n, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+    DenseMatrix A(n, n);
+    A.fillf([&]() { return dis(gen); });
+    return A;
+}
+
+/// @brief returns a random n x n matrix with n added to its diagonal, so it is strictly
+/// diagonally dominant, and LU without pivoting and jacobi are well defined.
+DenseMatrix dominantMatrix(size_t n, unsigned seed)
+{
+    DenseMatrix A = randomMatrix(n, seed);
+    for (size_t i = 1; i <= n; ++i)
+        A(i, i) += static_cast<double>(n);
+    return A;
+}
+
+/// @brief reports flops per iteration as a rate, shown as GFLOP/s.
+benchmark::Counter gflops(double flops)
+{
+    return benchmark::Counter(flops * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BM_DenseExpressionAssign(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const DenseMatrix A = randomMatrix(n, 1);
+    const DenseMatrix B = randomMatrix(n, 2);
+    const DenseMatrix C = randomMatrix(n, 3);
+    DenseMatrix D(n, n);
+    for (auto _ : state) {
+        D = A + 2.0 * B - C;
+        benchmark::DoNotOptimize(D.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["GFLOP"] = gflops(3.0 * static_cast<double>(n * n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 4 * n * n * sizeof(double)));
+}
+BENCHMARK(BM_DenseExpressionAssign)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_Dot(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const DenseMatrix A = randomMatrix(n, 1);
+    const DenseMatrix B = randomMatrix(n, 2);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(lao::linalg::dot(A, B));
+    state.counters["GFLOP"] = gflops(2.0 * static_cast<double>(n * n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 2 * n * n * sizeof(double)));
+}
+BENCHMARK(BM_Dot)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_SumCompensated(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const DenseMatrix A = randomMatrix(n, 1);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(lao::linalg::sum(A, lao::linalg::Summation::compensated));
+    state.counters["GFLOP"] = gflops(4.0 * static_cast<double>(n * n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * n * sizeof(double)));
+}
+BENCHMARK(BM_SumCompensated)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_MatrixMultiplication(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const DenseMatrix A = randomMatrix(n, 1);
+    const DenseMatrix B = randomMatrix(n, 2);
+    DenseMatrix C(n, n);
+    for (auto _ : state) {
+        C = A * B;
+        benchmark::DoNotOptimize(C.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["GFLOP"] = gflops(2.0 * static_cast<double>(n * n * n));
+}
+BENCHMARK(BM_MatrixMultiplication)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_MatrixMultiplicationFixed6(benchmark::State& state)
+{
+    lao::linalg::Matrix<double, 6, 6> A(lao::linalg::filltype::rand);
+    lao::linalg::Matrix<double, 6, 6> B(lao::linalg::filltype::rand);
+    lao::linalg::Matrix<double, 6, 6> C;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A.data());
+        benchmark::DoNotOptimize(B.data());
+        C = A * B;
+        benchmark::DoNotOptimize(C.data());
+    }
+    state.counters["GFLOP"] = gflops(2.0 * 6 * 6 * 6);
+}
+BENCHMARK(BM_MatrixMultiplicationFixed6);
+
+// LU_doolittle loops over the compile-time extents, so it is measured on fixed sizes.
+template <size_t N>
+void BM_LU_doolittle(benchmark::State& state)
+{
+    lao::linalg::Matrix<double, N, N> A(lao::linalg::filltype::rand);
+    for (size_t i = 1; i <= N; ++i)
+        A(i, i) += static_cast<double>(N);
+    lao::linalg::Matrix<double, N, N> L;
+    lao::linalg::Matrix<double, N, N> U;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A.data());
+        lao::linalg::LU_doolittle(A, L, U);
+        benchmark::DoNotOptimize(L.data());
+        benchmark::DoNotOptimize(U.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["GFLOP"] = gflops(2.0 / 3.0 * static_cast<double>(N * N * N));
+}
+BENCHMARK(BM_LU_doolittle<16>);
+BENCHMARK(BM_LU_doolittle<64>);
+
+void BM_LUFactorization(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const DenseMatrix A = randomMatrix(n, 1);
+    lao::linalg::LUFactorization<double, lao::linalg::Dynamic> lu;
+    for (auto _ : state) {
+        lu.compute(A);
+        benchmark::DoNotOptimize(&lu);
+        benchmark::ClobberMemory();
+    }
+    state.counters["GFLOP"] = gflops(2.0 / 3.0 * static_cast<double>(n * n * n));
+}
+BENCHMARK(BM_LUFactorization)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_LUSolve(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const DenseMatrix A = dominantMatrix(n, 1);
+    DenseVector b(n, 1);
+    b.fill(1.0);
+    for (auto _ : state) {
+        const DenseVector x = lao::linalg::LUFactorization(A).solve(b);
+        benchmark::DoNotOptimize(x.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LUSolve)->RangeMultiplier(4)->Range(64, 1024);
+
+void BM_MixedPrecisionSolve(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const DenseMatrix A = dominantMatrix(n, 1);
+    DenseVector b(n, 1);
+    b.fill(1.0);
+    DenseVector x(n, 1);
+    size_t iterations = 0;
+    for (auto _ : state) {
+        x.zeros();
+        const auto result = lao::linalg::mixed_precision_solve(A, x, b);
+        iterations = result.iterations;
+        benchmark::DoNotOptimize(x.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["iterations"] = static_cast<double>(iterations);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MixedPrecisionSolve)->RangeMultiplier(4)->Range(64, 1024);
+
+void BM_SolveJacobiElement(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const DenseMatrix A = dominantMatrix(n, 1);
+    DenseVector b(n, 1);
+    b.fill(1.0);
+    DenseVector x(n, 1);
+    size_t iterations = 0;
+    for (auto _ : state) {
+        const auto result = lao::linalg::solve_jacobi_element(x, A, b, 1000, 1e-10);
+        iterations = result.iterations;
+        benchmark::DoNotOptimize(x.data());
+        benchmark::ClobberMemory();
+    }
+    // a matrix-vector product and an update of x per iteration.
+    state.counters["GFLOP"] = gflops(static_cast<double>(iterations) * (2.0 * static_cast<double>(n * n) + 2.0 * static_cast<double>(n)));
+    state.counters["iterations"] = static_cast<double>(iterations);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SolveJacobiElement)->RangeMultiplier(4)->Range(16, 1024);
+
+}; // namespace
@@ -0,0 +1,143 @@
+/// benchmarks of the sparse matrices over square sizes and densities of non-zeros, given in parts per
+/// thousand, reported in non-zeros or lookups per second.
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <lao/lao.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Entry {
+    size_t row;
+    size_t col;
+    double value;
+};
+
+/// @brief returns about n * n * permille / 1000 random entries of an n x n matrix, the same on
+/// every run, with any duplicates left in.
+std::vector<Entry> randomEntries(size_t n, size_t permille, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> index(0, n - 1);
+    std::uniform_real_distribution<double> value(0.5, 1.5);
+    std::vector<Entry> entries(n * n * permille / 1000 + 1);
+    for (Entry& entry : entries)
+        entry = { index(gen), index(gen), value(gen) };
+    return entries;
+}
+
+template <size_t N>
+void BM_SparseConstructTriplets(benchmark::State& state)
+{
+    const std::vector<Entry> entries = randomEntries(N, static_cast<size_t>(state.range(0)), 1);
+    for (auto _ : state) {
+        lao::linalg::TripletBuilder<double, N, N> builder(entries.size());
+        for (const Entry& entry : entries)
+            builder.add(entry.row, entry.col, entry.value);
+        lao::linalg::SparseMatrix<double, N, N> A(builder);
+        benchmark::DoNotOptimize(A.values());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * entries.size()));
+}
+BENCHMARK_TEMPLATE(BM_SparseConstructTriplets, 256)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_SparseConstructTriplets, 1024)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_SparseConstructTriplets, 4096)->Arg(1)->Arg(10);
+
+template <size_t N>
+void BM_SparseConstructSet(benchmark::State& state)
+{
+    const std::vector<Entry> entries = randomEntries(N, static_cast<size_t>(state.range(0)), 1);
+    for (auto _ : state) {
+        lao::linalg::SparseMatrix<double, N, N> A;
+        for (const Entry& entry : entries)
+            A.set(entry.row, entry.col, entry.value);
+        benchmark::DoNotOptimize(A.values());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * entries.size()));
+}
+BENCHMARK_TEMPLATE(BM_SparseConstructSet, 256)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_SparseConstructSet, 1024)->Arg(1)->Arg(10);
+
+template <size_t N>
+void BM_SparseAccess(benchmark::State& state)
+{
+    const std::vector<Entry> entries = randomEntries(N, static_cast<size_t>(state.range(0)), 1);
+    lao::linalg::TripletBuilder<double, N, N> builder(entries.size());
+    for (const Entry& entry : entries)
+        builder.add(entry.row, entry.col, entry.value);
+    const lao::linalg::SparseMatrix<double, N, N> A(builder);
+    // lookups of random elements, most of them zeros at low densities.
+    const std::vector<Entry> lookups = randomEntries(N, 10, 2);
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (const Entry& lookup : lookups)
+            sum += A(lookup.row, lookup.col);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * lookups.size()));
+}
+BENCHMARK_TEMPLATE(BM_SparseAccess, 256)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_SparseAccess, 1024)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_SparseAccess, 4096)->Arg(1)->Arg(10);
+
+template <size_t N>
+void BM_SparseMatrixVector(benchmark::State& state)
+{
+    const std::vector<Entry> entries = randomEntries(N, static_cast<size_t>(state.range(0)), 1);
+    lao::linalg::TripletBuilder<double, N, N> builder(entries.size());
+    for (const Entry& entry : entries)
+        builder.add(entry.row, entry.col, entry.value);
+    const lao::linalg::SparseMatrix<double, N, N> A(builder);
+    lao::linalg::Matrix<double, N, 1> x(lao::linalg::filltype::ones);
+    lao::linalg::Matrix<double, N, 1> y;
+    for (auto _ : state) {
+        y = A * x;
+        benchmark::DoNotOptimize(y.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["GFLOP"] = benchmark::Counter(2.0 * static_cast<double>(A.nnz()) * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK_TEMPLATE(BM_SparseMatrixVector, 1024)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_SparseMatrixVector, 4096)->Arg(1)->Arg(10);
+
+template <size_t N>
+void BM_SparseUpdate(benchmark::State& state)
+{
+    const std::vector<Entry> entries = randomEntries(N, static_cast<size_t>(state.range(0)), 1);
+    lao::linalg::TripletBuilder<double, N, N> builder(entries.size());
+    for (const Entry& entry : entries)
+        builder.add(entry.row, entry.col, entry.value);
+    const lao::linalg::SparseMatrix<double, N, N> K(builder);
+    lao::linalg::SparseMatrix<double, N, N> A = K;
+    // an update with an unchanged pattern, which only writes the values of A.
+    for (auto _ : state) {
+        A = A + K * 1e-3;
+        benchmark::DoNotOptimize(A.values());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * A.nnz()));
+}
+BENCHMARK_TEMPLATE(BM_SparseUpdate, 1024)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_SparseUpdate, 16384)->Arg(1);
+
+template <size_t N>
+void BM_SparseToDense(benchmark::State& state)
+{
+    const std::vector<Entry> entries = randomEntries(N, static_cast<size_t>(state.range(0)), 1);
+    lao::linalg::TripletBuilder<double, N, N> builder(entries.size());
+    for (const Entry& entry : entries)
+        builder.add(entry.row, entry.col, entry.value);
+    const lao::linalg::SparseMatrix<double, N, N> A(builder);
+    lao::linalg::Matrix<double, N, N> dense;
+    for (auto _ : state) {
+        dense = A;
+        lao::linalg::SparseMatrix<double, N, N> B(dense);
+        benchmark::DoNotOptimize(B.values());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * N * N));
+}
+BENCHMARK_TEMPLATE(BM_SparseToDense, 1024)->Arg(1)->Arg(10);
+
+}; // namespace
@@ -2,13 +2,21 @@
 #define LAO_ASTRO_ASTRO_H_
 
 #include <lao/astro/body/base.hpp>
+#include <lao/astro/body/ephemeris_cache.hpp>
+#include <lao/astro/body/ephemeris_engine.hpp>
 #include <lao/astro/body/jpl_low_precision.hpp>
 #include <lao/astro/core/constants.hpp>
 #include <lao/astro/core/conversions.hpp>
 #include <lao/astro/core/equations.hpp>
+#include <lao/astro/core/lambert.hpp>
+#include <lao/astro/core/porkchop.hpp>
+#include <lao/astro/core/propagation.hpp>
+#include <lao/astro/core/screening.hpp>
 #include <lao/astro/date/epoch.hpp>
 #include <lao/astro/date/gregorian.hpp>
+#include <lao/astro/math/kepler.hpp>
 #include <lao/astro/math/newton_raphson.hpp>
+#include <lao/astro/math/sincos.hpp>
 #include <lao/astro/math/transforms.hpp>
 
 #endif // LAO_ASTRO_ASTRO_H_
\ No newline at end of file
@@ -21,17 +21,26 @@
 #ifndef LAO_ASTRO_BODY_BASE_H_
 #define LAO_ASTRO_BODY_BASE_H_
 
+#include <algorithm>
+#include <cstddef>
 #include <lao/astro/core/constants.hpp>
 #include <lao/astro/date/epoch.hpp>
 #include <lao/linalg/core/forward.hpp>
 #include <lao/linalg/dense/matrix.hpp>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace lao {
 namespace astro {
 
+    /// @brief states of a body at many epochs, one row per epoch.
+    /// @details the columns are x, y, z [m] and vx, vy, vz [m/s]. the matrix is column-major, so each
+    /// column is contiguous (structure of arrays).
+    using StateBatch = linalg::ColMajorMatrix<double, linalg::Dynamic, 6>;
+
     /// @brief parent class that represents a body.
     /// @details designed to be inherited such that the child implements the eph method
     /// which returns the state vector of the body using a child-specific method.
@@ -63,12 +72,104 @@ namespace astro {
 
         virtual ~Base() {};
 
+        /// @brief returns the standard gravitational parameter of the body [m^3/s^2].
+        double mu() const
+        {
+            return m_mu_body;
+        }
+
+        /// @brief returns the standard gravitational parameter of the attracting/parent body [m^3/s^2].
+        double muCentralBody() const
+        {
+            return m_mu_central_body;
+        }
+
+        /// @brief returns the radius of the body [m].
+        double radius() const
+        {
+            return m_radius;
+        }
+
+        /// @brief returns the name of the body.
+        const std::string& name() const
+        {
+            return m_name;
+        }
+
         /// @brief returns the cartesian coordinate form of position and velocity vectors given epoch.
         /// @details this is a pure virtual method which is implemented in inheriting classes.
         /// @param epoch_date the epoch from which to find the position and velocity of the body.
         /// @returns a 6D array representing the position and velocity vectors.
         virtual linalg::RowVector<double, 6> eph(const Epoch& epoch_date) const = 0;
 
+        /// @brief writes the cartesian coordinate form of position and velocity vectors given epoch
+        /// into state, through ephBatch, so that no state is built and copied.
+        /// @param epoch_date the epoch from which to find the position and velocity of the body.
+        /// @param state the position and velocity vectors, every element of which is written.
+        void eph(const Epoch& epoch_date, linalg::RowVector<double, 6>& state) const
+        {
+            const double mjd2000 = epoch_date.MJD2000();
+            ephBatch(std::span<const double>(&mjd2000, 1), state.data(), 1);
+        }
+
+        /// @brief returns the cartesian position and velocity vectors at many epochs in one call.
+        /// @details the state at mjd2000[k] is written to states[k], states[stride + k], ...,
+        /// states[5 * stride + k], in the order x, y, z, vx, vy, vz, so stride is the length of each
+        /// column. the default calls eph once per epoch, inheriting classes override it with a loop
+        /// that does the per-body work once per batch.
+        /// @param mjd2000 the epochs as MJD2000.
+        /// @param states the six output columns, each of at least stride elements.
+        /// @param stride the distance between the columns.
+        virtual void ephBatch(std::span<const double> mjd2000, double* states, size_t stride) const
+        {
+            for (size_t k = 0; k < mjd2000.size(); ++k) {
+                const linalg::RowVector<double, 6> state = eph(Epoch(mjd2000[k]));
+                for (size_t j = 0; j < 6; ++j)
+                    states[j * stride + k] = state.coeff(1, j + 1);
+            }
+        }
+
+        /// @brief returns the cartesian position and velocity vectors at many epochs in one call, in
+        /// single precision, for screening passes whose candidates are then evaluated in double.
+        /// @details the layout is that of the double ephBatch. the default evaluates the states in
+        /// double in chunks and rounds them, inheriting classes with a cheaper evaluation in float
+        /// override it.
+        /// @param mjd2000 the epochs as MJD2000.
+        /// @param states the six output columns, each of at least stride elements.
+        /// @param stride the distance between the columns.
+        virtual void ephBatch(std::span<const double> mjd2000, float* states, size_t stride) const
+        {
+            constexpr size_t chunk = 64;
+            double out[6 * chunk];
+            for (size_t first = 0; first < mjd2000.size(); first += chunk) {
+                const size_t n = std::min(chunk, mjd2000.size() - first);
+                ephBatch(mjd2000.subspan(first, n), out, chunk);
+                for (size_t j = 0; j < 6; ++j)
+                    for (size_t k = 0; k < n; ++k)
+                        states[j * stride + first + k] = static_cast<float>(out[j * chunk + k]);
+            }
+        }
+
+        /// @brief returns the cartesian position and velocity vectors at many epochs in one call.
+        /// @param mjd2000 the epochs as MJD2000.
+        /// @param states resized to one row per epoch, see StateBatch.
+        void ephBatch(std::span<const double> mjd2000, StateBatch& states) const
+        {
+            states.resize(mjd2000.size(), 6);
+            ephBatch(mjd2000, states.data(), mjd2000.size());
+        }
+
+        /// @brief returns the cartesian position and velocity vectors at many epochs in one call.
+        /// @param epochs the epochs.
+        /// @param states resized to one row per epoch, see StateBatch.
+        void ephBatch(std::span<const Epoch> epochs, StateBatch& states) const
+        {
+            std::vector<double> mjd2000(epochs.size());
+            for (size_t k = 0; k < epochs.size(); ++k)
+                mjd2000[k] = epochs[k].MJD2000();
+            ephBatch(mjd2000, states);
+        }
+
         virtual std::string ostreamExtra() const
         {
             return std::string();
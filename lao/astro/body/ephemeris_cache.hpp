@@ -0,0 +1,347 @@
+/// the ephemeris cache replaces the ephemerides of any body over a fixed span of epochs with piecewise
+/// chebyshev polynomials fitted to them, in the manner of the type 3 segments of a SPICE SPK file:
+/// https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/req/spk.html#Type%203:%20Chebyshev%20(position%20and%20velocity)
+///
+/// the span is split into segments of equal length and each of the six coordinates of the state is
+/// fitted on each segment by interpolation at the chebyshev nodes. the velocity is fitted rather than
+/// taken as the derivative of the position, as the two need not agree for a source like JPLLP, whose
+/// velocity is that of the osculating orbit. a lookup is then one clenshaw recurrence over the
+/// coefficients of its segment, which sums all six series in the same pass, however costly the
+/// ephemerides of the source are.
+///
+/// a cache can be saved to a binary file and loaded without the source, behind a fixed header:
+///
+///     uint64 magic, version, degree, segments, name length, reserved[3]
+///     double mu, mu central body, radius, begin, end, position error, velocity error, reserved
+///     char   name[name length], zero padded to a multiple of 8 bytes
+///     double coefficients[segments][6][degree + 1]
+///
+/// the format uses the byte order of the machine which wrote it, and is rejected on one with the other
+/// order.
+
+#ifndef LAO_ASTRO_BODY_EPHEMERIS_CACHE_H_
+#define LAO_ASTRO_BODY_EPHEMERIS_CACHE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <lao/astro/body/base.hpp>
+#include <lao/astro/core/constants.hpp>
+#include <lao/astro/date/epoch.hpp>
+#include <lao/linalg/dense/matrix.hpp>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lao {
+namespace astro {
+
+    /// @brief largest differences between an ephemeris cache and its source.
+    struct EphemerisCacheError {
+        // norm of the position difference [m]
+        double position;
+        // norm of the velocity difference [m/s]
+        double velocity;
+    };
+
+    /// @brief a body whose ephemerides are chebyshev fits to those of another body.
+    /// @details the cache copies the physical parameters and name of its source, and does not keep a
+    /// reference to it.
+    class EphemerisCache : public Base {
+    private:
+        static constexpr std::uint64_t m_magic = 0x4850454f414cull; // "LAOEPH" in little endian
+        static constexpr std::uint64_t m_version = 1;
+
+        // first and last epoch covered, (MJD2000, MJD2000)
+        double m_begin;
+        double m_end;
+        // length of each segment [days]
+        double m_segment_length;
+        size_t m_degree;
+        size_t m_segments;
+        // coefficients of x, y, z [m] and vx, vy, vz [m/s] of each segment in turn, degree + 1 each,
+        // the first halved
+        std::vector<double> m_coefficients;
+        EphemerisCacheError m_fit_error;
+
+        EphemerisCache(double mu_body, double mu_central_body, double radius, const std::string& name)
+            : Base(mu_body, mu_central_body, radius, name)
+        {
+        }
+
+        /// @brief evaluates the cache at one epoch, see Base::ephBatch for the layout of states.
+        void evaluate(double mjd2000, double* states, size_t stride) const
+        {
+            if (!(mjd2000 >= m_begin && mjd2000 <= m_end))
+                throw std::invalid_argument("epoch date must be in the range of the ephemeris cache");
+            // the segment and the epoch on it mapped to [-1, 1]
+            const double u = (mjd2000 - m_begin) / m_segment_length;
+            const size_t segment = std::min(static_cast<size_t>(u), m_segments - 1);
+            const double x = 2.0 * (u - static_cast<double>(segment)) - 1.0;
+            const double* c = m_coefficients.data() + segment * 6 * (m_degree + 1);
+
+            // clenshaw's recurrence for f(x) = sum c_k T_k(x), b_k = c_k + 2 x b_k+1 - b_k+2 and
+            // f(x) = c_0 + x b_1 - b_2, for the six coordinates at once.
+            double b1[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+            double b2[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+            for (size_t k = m_degree; k >= 1; --k) {
+                for (size_t j = 0; j < 6; ++j) {
+                    const double b = c[j * (m_degree + 1) + k] + 2.0 * x * b1[j] - b2[j];
+                    b2[j] = b1[j];
+                    b1[j] = b;
+                }
+            }
+            for (size_t j = 0; j < 6; ++j)
+                states[j * stride] = c[j * (m_degree + 1)] + x * b1[j] - b2[j];
+        }
+
+    public:
+        /// @brief fits a cache to the ephemerides of a body.
+        /// @details the span is split into the fewest segments of equal length no longer than
+        /// granularity, and the source is evaluated with one call to ephBatch at degree + 1 nodes on
+        /// each. the error of the fit is then measured with measureError, see fitError.
+        /// @param source the body whose ephemerides are fitted.
+        /// @param mjd2000_begin first epoch covered (MJD2000).
+        /// @param mjd2000_end last epoch covered (MJD2000).
+        /// @param granularity longest length of a segment [days].
+        /// @param degree degree of the polynomial fitted to each coordinate on each segment.
+        EphemerisCache(const Base& source, double mjd2000_begin, double mjd2000_end, double granularity, size_t degree = 12)
+            : EphemerisCache(source.mu(), source.muCentralBody(), source.radius(), source.name())
+        {
+            if (!(mjd2000_end > mjd2000_begin))
+                throw std::invalid_argument("End of the ephemeris cache must be after its beginning");
+            if (!(granularity > 0))
+                throw std::invalid_argument("Granularity must be greater than zero");
+            if (degree < 1)
+                throw std::invalid_argument("Degree must be at least one");
+
+            m_begin = mjd2000_begin;
+            m_end = mjd2000_end;
+            m_degree = degree;
+            m_segments = static_cast<size_t>(std::ceil((mjd2000_end - mjd2000_begin) / granularity));
+            m_segment_length = (mjd2000_end - mjd2000_begin) / static_cast<double>(m_segments);
+
+            // the chebyshev nodes x_j = cos(pi (j + 1/2) / n) and T_k(x_j) = cos(pi k (j + 1/2) / n)
+            const size_t n = degree + 1;
+            std::vector<double> nodes(n);
+            std::vector<double> basis(n * n);
+            for (size_t j = 0; j < n; ++j) {
+                nodes[j] = std::cos(PI<double> * (static_cast<double>(j) + 0.5) / static_cast<double>(n));
+                for (size_t k = 0; k < n; ++k)
+                    basis[k * n + j] = std::cos(PI<double> * static_cast<double>(k) * (static_cast<double>(j) + 0.5) / static_cast<double>(n));
+            }
+
+            std::vector<double> epochs(m_segments * n);
+            for (size_t s = 0; s < m_segments; ++s)
+                for (size_t j = 0; j < n; ++j)
+                    epochs[s * n + j] = m_begin + (static_cast<double>(s) + 0.5 * (nodes[j] + 1.0)) * m_segment_length;
+            StateBatch states;
+            source.ephBatch(epochs, states);
+
+            // c_k = 2/n sum_j f(x_j) T_k(x_j), with c_0 halved so f(x) = sum c_k T_k(x)
+            m_coefficients.assign(m_segments * 6 * n, 0.0);
+            for (size_t s = 0; s < m_segments; ++s) {
+                for (size_t j = 0; j < 6; ++j) {
+                    const double* f = states.data() + j * epochs.size() + s * n;
+                    double* c = m_coefficients.data() + (s * 6 + j) * n;
+                    for (size_t k = 0; k < n; ++k) {
+                        double sum = 0.0;
+                        for (size_t i = 0; i < n; ++i)
+                            sum += f[i] * basis[k * n + i];
+                        c[k] = 2.0 * sum / static_cast<double>(n);
+                    }
+                    c[0] *= 0.5;
+                }
+            }
+
+            m_fit_error = measureError(source);
+        }
+
+        /// @brief loads a cache saved with save.
+        /// @details throws std::runtime_error if the file cannot be read, is not an ephemeris cache, or
+        /// if the sizes in its header do not match its length, i.e. it is truncated or corrupt.
+        /// @param filename the file to load.
+        static EphemerisCache load(const std::string& filename)
+        {
+            std::ifstream file(filename, std::ios::binary);
+            if (!file.is_open())
+                throw std::runtime_error("Failed to open file");
+
+            file.seekg(0, std::ios::end);
+            const std::streamoff length = file.tellg();
+            file.seekg(0, std::ios::beg);
+
+            std::uint64_t header[8];
+            double parameters[8];
+            if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != m_magic)
+                throw std::runtime_error("Not an ephemeris cache file");
+            if (header[1] != m_version)
+                throw std::runtime_error("Unsupported ephemeris cache version");
+            if (!file.read(reinterpret_cast<char*>(parameters), sizeof(parameters)))
+                throw std::runtime_error("Truncated ephemeris cache file");
+
+            // every size is checked against the bytes left in the file before anything is allocated,
+            // each bound divided down so that none of the products can overflow.
+            const std::uint64_t degree = header[2];
+            const std::uint64_t segments = header[3];
+            const std::uint64_t name_length = header[4];
+            if (degree < 1 || segments < 1 || !(parameters[4] > parameters[3]))
+                throw std::runtime_error("Malformed ephemeris cache file");
+            std::uint64_t remaining = static_cast<std::uint64_t>(length) - sizeof(header) - sizeof(parameters);
+            if (name_length > remaining || (name_length + 7) / 8 * 8 > remaining)
+                throw std::runtime_error("Truncated ephemeris cache file");
+            remaining -= (name_length + 7) / 8 * 8;
+            const std::uint64_t words = remaining / sizeof(double);
+            if (degree >= words || segments > words / 6 / (degree + 1))
+                throw std::runtime_error("Truncated ephemeris cache file");
+            if (segments * 6 * (degree + 1) * sizeof(double) != remaining)
+                throw std::runtime_error("Corrupt ephemeris cache file");
+
+            std::string name((name_length + 7) / 8 * 8, '\0');
+            if (!file.read(name.data(), static_cast<std::streamsize>(name.size())))
+                throw std::runtime_error("Truncated ephemeris cache file");
+            name.resize(name_length);
+
+            EphemerisCache cache(parameters[0], parameters[1], parameters[2], name);
+            cache.m_begin = parameters[3];
+            cache.m_end = parameters[4];
+            cache.m_fit_error = { parameters[5], parameters[6] };
+            cache.m_degree = degree;
+            cache.m_segments = segments;
+            cache.m_segment_length = (cache.m_end - cache.m_begin) / static_cast<double>(segments);
+            cache.m_coefficients.resize(segments * 6 * (degree + 1));
+            if (!file.read(reinterpret_cast<char*>(cache.m_coefficients.data()), static_cast<std::streamsize>(cache.m_coefficients.size() * sizeof(double))))
+                throw std::runtime_error("Truncated ephemeris cache file");
+            return cache;
+        }
+
+        /// @brief saves the cache to a binary file, see load.
+        /// @param filename the file to write.
+        void save(const std::string& filename) const
+        {
+            std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                throw std::runtime_error("Failed to open file");
+
+            const std::uint64_t header[8] = { m_magic, m_version, m_degree, m_segments, m_name.size(), 0, 0, 0 };
+            const double parameters[8] = {
+                m_mu_body, m_mu_central_body, m_radius, m_begin, m_end, m_fit_error.position, m_fit_error.velocity, 0.0
+            };
+            std::string name = m_name;
+            name.resize((name.size() + 7) / 8 * 8, '\0');
+            file.write(reinterpret_cast<const char*>(header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(parameters), sizeof(parameters));
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+            file.write(reinterpret_cast<const char*>(m_coefficients.data()), static_cast<std::streamsize>(m_coefficients.size() * sizeof(double)));
+            if (!file)
+                throw std::runtime_error("Failed to write file");
+        }
+
+        /// @brief returns the largest differences between the cache and a body over the whole span.
+        /// @details both are evaluated at samples epochs spread evenly over each segment, away from
+        /// the nodes the fit interpolates.
+        /// @param source the body to compare against, usually the one the cache was fitted to.
+        /// @param samples number of epochs compared on each segment.
+        EphemerisCacheError measureError(const Base& source, size_t samples = 16) const
+        {
+            std::vector<double> epochs(m_segments * samples);
+            for (size_t s = 0; s < m_segments; ++s)
+                for (size_t j = 0; j < samples; ++j)
+                    epochs[s * samples + j] = m_begin + (static_cast<double>(s) + (static_cast<double>(j) + 0.5) / static_cast<double>(samples)) * m_segment_length;
+            StateBatch expected;
+            StateBatch cached;
+            source.ephBatch(epochs, expected);
+            ephBatch(epochs, cached);
+
+            EphemerisCacheError error = { 0.0, 0.0 };
+            for (size_t k = 1; k <= epochs.size(); ++k) {
+                double dr = 0.0;
+                double dv = 0.0;
+                for (size_t axis = 1; axis <= 3; ++axis) {
+                    dr += std::pow(cached(k, axis) - expected(k, axis), 2);
+                    dv += std::pow(cached(k, axis + 3) - expected(k, axis + 3), 2);
+                }
+                error.position = std::max(error.position, std::sqrt(dr));
+                error.velocity = std::max(error.velocity, std::sqrt(dv));
+            }
+            return error;
+        }
+
+        /// @brief returns the error of the fit against its source, measured when it was made.
+        const EphemerisCacheError& fitError() const
+        {
+            return m_fit_error;
+        }
+
+        /// @brief returns the first epoch covered (MJD2000).
+        double begin() const
+        {
+            return m_begin;
+        }
+
+        /// @brief returns the last epoch covered (MJD2000).
+        double end() const
+        {
+            return m_end;
+        }
+
+        /// @brief returns the number of segments.
+        size_t segments() const
+        {
+            return m_segments;
+        }
+
+        /// @brief returns the degree of the polynomials.
+        size_t degree() const
+        {
+            return m_degree;
+        }
+
+        /// @brief returns the cartesian coordinate form of position and velocity vectors given epoch.
+        /// @details throws std::invalid_argument for an epoch outside of the span of the cache.
+        /// @param epoch_date the epoch from which to find the position and velocity of the body.
+        /// @returns a 6D array representing the position and velocity vectors.
+        linalg::RowVector<double, 6> eph(const Epoch& epoch_date) const
+        {
+            linalg::RowVector<double, 6> state;
+            evaluate(epoch_date.MJD2000(), state.data(), 1);
+            return state;
+        }
+
+        using Base::eph;
+        using Base::ephBatch;
+
+        /// @brief returns the cartesian position and velocity vectors at many epochs in one call.
+        /// @param mjd2000 the epochs as MJD2000.
+        /// @param states the six output columns x, y, z, vx, vy, vz, each of at least stride elements.
+        /// @param stride the distance between the columns.
+        void ephBatch(std::span<const double> mjd2000, double* states, size_t stride) const override
+        {
+            for (size_t k = 0; k < mjd2000.size(); ++k)
+                evaluate(mjd2000[k], states + k, stride);
+        }
+
+        std::string ostreamExtra() const
+        {
+            std::ostringstream s;
+            s << "\"ephemeris_cache\": {\n";
+            s << "  \"begin_mjd2000\": " << m_begin << ",\n";
+            s << "  \"end_mjd2000\": " << m_end << ",\n";
+            s << "  \"segment_length_days\": " << m_segment_length << ",\n";
+            s << "  \"segments\": " << m_segments << ",\n";
+            s << "  \"degree\": " << m_degree << ",\n";
+            s << "  \"position_error_m\": " << m_fit_error.position << ",\n";
+            s << "  \"velocity_error_m_per_s\": " << m_fit_error.velocity << "\n";
+            s << "  }\n";
+            return s.str();
+        }
+    };
+
+}; // namespace astro
+}; // namespace lao
+
+#endif // LAO_ASTRO_BODY_EPHEMERIS_CACHE_H_
@@ -0,0 +1,190 @@
+/// the ephemeris engine evaluates the ephemerides of several bodies over a grid of epochs in parallel.
+///
+/// the work is split into tasks of one body over one chunk of consecutive epochs, each a single call
+/// to the ephBatch of that body, which run on the library ThreadPool, so threads which finish their
+/// tasks early steal those of the others, e.g. where one body is far costlier than the rest. every
+/// task writes straight into its own part of one preallocated EphemerisTensor.
+///
+/// for grids too large to hold at once, stream evaluates a window of chunks at a time, one per
+/// thread, and hands the chunks of each window to a callback in the order of their epochs, so the
+/// memory used is bounded by the window whatever the length of the grid.
+
+#ifndef LAO_ASTRO_BODY_EPHEMERIS_ENGINE_H_
+#define LAO_ASTRO_BODY_EPHEMERIS_ENGINE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <lao/astro/body/base.hpp>
+#include <lao/config.hpp>
+#include <lao/instrumentation.hpp>
+#include <lao/linalg/dense/matrix.hpp>
+#include <lao/parallel.hpp>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace lao {
+namespace astro {
+
+    /// @brief states of many bodies at many epochs, one row per epoch.
+    /// @details six columns per body, in the order the bodies were given to the EphemerisEngine, of x,
+    /// y, z [m] and vx, vy, vz [m/s] as in StateBatch. the matrix is column-major, so each column is
+    /// contiguous (structure of arrays), and the state of body b at row k is (k, 6 b + 1) to
+    /// (k, 6 b + 6).
+    using EphemerisTensor = linalg::ColMajorMatrix<double, linalg::Dynamic, linalg::Dynamic>;
+
+    /// @brief epochs evenly spaced in time, begin, begin + step, ..., begin + (count - 1) step.
+    struct EpochGrid {
+        // first epoch (MJD2000)
+        double begin;
+        // time between epochs [days]
+        double step;
+        size_t count;
+
+        /// @brief returns epoch k (MJD2000).
+        double operator[](size_t k) const noexcept
+        {
+            return begin + static_cast<double>(k) * step;
+        }
+    };
+
+    /// @brief evaluates the ephemerides of several bodies over many epochs in parallel.
+    /// @details the bodies are not owned, and must outlive the engine.
+    class EphemerisEngine {
+    private:
+        std::vector<const Base*> m_bodies;
+        size_t m_chunk;
+        ThreadPool* m_pool;
+
+        /// @brief evaluates every body at the count epochs mjd2000, with one task per body and chunk.
+        /// @details out(c) returns the destination of chunk c as a pointer to its first row and the
+        /// distance between its columns, and body b is written from its column 6 b onwards.
+        template <typename Out>
+        void run(const double* mjd2000, size_t count, const Out& out) const
+        {
+            instrumentation::ScopedTimer timer(instrumentation::Kernel::ephemeris);
+            const size_t chunks = (count + m_chunk - 1) / m_chunk;
+            m_pool->parallel_for(0, m_bodies.size() * chunks, 1, [&](size_t task_begin, size_t task_end) {
+                for (size_t task = task_begin; task < task_end; ++task) {
+                    const size_t body = task / chunks;
+                    const size_t c = task % chunks;
+                    const size_t first = c * m_chunk;
+                    const auto [data, stride] = out(c);
+                    m_bodies[body]->ephBatch(std::span<const double>(mjd2000 + first, std::min(m_chunk, count - first)),
+                        data + 6 * body * stride, stride);
+                }
+            });
+        }
+
+        /// @brief streams count epochs, where epochs(first, n) returns a pointer to epochs [first,
+        /// first + n).
+        template <typename Epochs, typename F>
+        void streamImpl(size_t count, const Epochs& epochs, F& on_chunk) const
+        {
+            // one chunk per thread in flight at a time, each in its own tensor handed to on_chunk as is.
+            const size_t window = m_pool->size();
+            std::vector<EphemerisTensor> chunks(window);
+            for (size_t first = 0; first < count; first += window * m_chunk) {
+                const size_t n = std::min(window * m_chunk, count - first);
+                const double* mjd2000 = epochs(first, n);
+                const size_t used = (n + m_chunk - 1) / m_chunk;
+                for (size_t c = 0; c < used; ++c) {
+                    const size_t rows = std::min(m_chunk, n - c * m_chunk);
+                    if (chunks[c].rows() != rows || chunks[c].cols() != 6 * m_bodies.size())
+                        chunks[c].resize(rows, 6 * m_bodies.size());
+                }
+                run(mjd2000, n, [&](size_t c) { return std::pair<double*, size_t>(chunks[c].data(), chunks[c].rows()); });
+                for (size_t c = 0; c < used; ++c)
+                    on_chunk(first + c * m_chunk, std::span<const double>(mjd2000 + c * m_chunk, chunks[c].rows()), std::as_const(chunks[c]));
+            }
+        }
+
+    public:
+        /// @brief ephemeris engine constructor.
+        /// @param bodies the bodies to evaluate, in the order of their columns in an EphemerisTensor.
+        /// @param chunk number of consecutive epochs evaluated by each task.
+        /// @param pool the pool the tasks run on.
+        EphemerisEngine(std::vector<const Base*> bodies, size_t chunk = LAO_EPHEMERIS_CHUNK_SIZE, ThreadPool& pool = ThreadPool::instance())
+            : m_bodies(std::move(bodies))
+            , m_chunk(chunk)
+            , m_pool(&pool)
+        {
+            if (m_bodies.empty())
+                throw std::invalid_argument("Ephemeris engine needs at least one body");
+            for (const Base* body : m_bodies)
+                if (body == nullptr)
+                    throw std::invalid_argument("Body must not be null");
+            if (chunk == 0)
+                throw std::invalid_argument("Chunk size must be greater than zero");
+        }
+
+        /// @brief returns the bodies, in the order of their columns.
+        const std::vector<const Base*>& bodies() const noexcept
+        {
+            return m_bodies;
+        }
+
+        /// @brief returns the number of epochs evaluated by each task.
+        size_t chunkSize() const noexcept
+        {
+            return m_chunk;
+        }
+
+        /// @brief evaluates every body at every epoch.
+        /// @details exceptions thrown by a body, e.g. for an epoch outside of its ephemerides, are
+        /// rethrown here once the other tasks are done.
+        /// @param mjd2000 the epochs as MJD2000.
+        /// @param states resized to one row per epoch and six columns per body, see EphemerisTensor.
+        void evaluate(std::span<const double> mjd2000, EphemerisTensor& states) const
+        {
+            states.resize(mjd2000.size(), 6 * m_bodies.size());
+            run(mjd2000.data(), mjd2000.size(), [&](size_t c) { return std::pair<double*, size_t>(states.data() + c * m_chunk, states.rows()); });
+        }
+
+        /// @brief evaluates every body at every epoch of a grid.
+        /// @param grid the epochs.
+        /// @param states resized to one row per epoch and six columns per body, see EphemerisTensor.
+        void evaluate(const EpochGrid& grid, EphemerisTensor& states) const
+        {
+            std::vector<double> mjd2000(grid.count);
+            for (size_t k = 0; k < grid.count; ++k)
+                mjd2000[k] = grid[k];
+            evaluate(mjd2000, states);
+        }
+
+        /// @brief evaluates every body at every epoch, handing the states to on_chunk a chunk at a
+        /// time in the order of the epochs.
+        /// @details on_chunk(first, mjd2000, states) is called on the calling thread with the index
+        /// of the first epoch of the chunk, its epochs and an EphemerisTensor of their states, which
+        /// is only valid during the call. at most one chunk per thread of the pool is held at once.
+        /// @param mjd2000 the epochs as MJD2000.
+        /// @param on_chunk the callback.
+        template <typename F>
+        void stream(std::span<const double> mjd2000, F&& on_chunk) const
+        {
+            streamImpl(mjd2000.size(), [&](size_t first, size_t) { return mjd2000.data() + first; }, on_chunk);
+        }
+
+        /// @brief evaluates every body at every epoch of a grid, handing the states to on_chunk a
+        /// chunk at a time in the order of the epochs, see stream. the epochs are generated a window
+        /// at a time, so neither they nor the states are ever held for the whole grid.
+        /// @param grid the epochs.
+        /// @param on_chunk the callback.
+        template <typename F>
+        void stream(const EpochGrid& grid, F&& on_chunk) const
+        {
+            std::vector<double> mjd2000;
+            streamImpl(grid.count, [&](size_t first, size_t n) {
+                mjd2000.resize(n);
+                for (size_t k = 0; k < n; ++k)
+                    mjd2000[k] = grid[first + k];
+                return mjd2000.data();
+            }, on_chunk);
+        }
+    };
+
+}; // namespace astro
+}; // namespace lao
+
+#endif // LAO_ASTRO_BODY_EPHEMERIS_ENGINE_H_
@@ -6,19 +6,52 @@
 #include <lao/astro/body/base.hpp>
 #include <lao/astro/core/constants.hpp>
 #include <lao/astro/core/conversions.hpp>
+#include <lao/astro/math/kepler.hpp>
+#include <lao/astro/math/sincos.hpp>
 #include <lao/linalg/dense/matrix.hpp>
 #include <lao/astro/date/epoch.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
 
 namespace lao {
 namespace astro {
 
+    /// @brief identifies the bodies with JPL low precision ephemerides.
+    enum class BodyId : size_t {
+        Mercury,
+        Venus,
+        EMBary,
+        Mars,
+        Jupiter,
+        Saturn,
+        Uranus,
+        Neptune
+    };
+
+    /// @brief the tables of JPL low precision elements, named by the time-interval they are fitted to.
+    /// @details the 1800 AD - 2050 AD table is the more accurate within that interval.
+    enum class JPLLPTable {
+        Years1800To2050,
+        Years3000BCTo3000AD
+    };
+
+    /// @brief bound on the error of the single precision ephBatch of JPLLP relative to the double one,
+    /// of the position relative to the distance of the body and of the velocity relative to its speed.
+    /// @details the largest error over every body and epoch of both tables is 5.2e-7, about 8 ulp of
+    /// float. at 1 AU the bound is 150 km.
+    inline constexpr double JPLLP_FLOAT_ERROR = 1e-6;
+
     /// @brief JPL low precision class
     /// @details inherits the Base class representing an abstract body. this class implements
-    /// the JPL low precision ephemerides. it uses a lookup hashtable and given a name of the body
-    /// in the constructor to find the parameters and orbital parameters to calculate the ephemerides.
+    /// the JPL low precision ephemerides. the parameters and orbital elements of each body are held in
+    /// static constexpr tables indexed by BodyId, so constructing a body does not allocate.
     class JPLLP : public Base {
     private:
         // table of bodies and some basic parameters, taken from numerous sources.
@@ -63,16 +96,57 @@ namespace astro {
         // | neptune    | 0.00026291   | 0.00005105    | 0.00035372    | 218.45945325    | -0.32241464           | -0.00508664           |
         // +------------+--------------+---------------+---------------+-----------------+-----------------------+-----------------------+
         //
-        // although we're currently only using solar system large bodies and linear ordering means we could just use
-        // array indexing, this is expandable for any number of bodies and a hashmap will allow for fast lookup
+        // taken from https://ssd.jpl.nasa.gov/planets/approx_pos.html
+        // keplerian elements and their rates, with respect to the mean ecliptic and equinox of J2000,
+        // valid for the time-interval 3000 BC - 3000 AD.
+        //
+        // +------------+-------------+------------+-------------+--------------+-----------------+-----------------+
+        // |            |    a [au]   |   e [rad]  |   I [deg]   |    L [deg]   | long peri [deg] | long node [deg] |
+        // | mercury    | 0.38709843  | 0.20563661 | 7.00559432  | 252.25166724 | 77.45771895     | 48.33961819     |
+        // | venus      | 0.72332102  | 0.00676399 | 3.39777545  | 181.97970850 | 131.76755713    | 76.67261496     |
+        // | E-M bary   | 1.00000018  | 0.01673163 | -0.00054346 | 100.46691572 | 102.93005885    | -5.11260389     |
+        // | mars       | 1.52371243  | 0.09336511 | 1.85181869  | -4.56813164  | -23.91744784    | 49.71320984     |
+        // | jupiter    | 5.20248019  | 0.04853590 | 1.29861416  | 34.33479152  | 14.27495244     | 100.29282654    |
+        // | saturn     | 9.54149883  | 0.05550825 | 2.49424102  | 50.07571329  | 92.86136063     | 113.63998702    |
+        // | uranus     | 19.18797948 | 0.04685740 | 0.77298127  | 314.20276625 | 172.43404441    | 73.96250215     |
+        // | neptune    | 30.06952752 | 0.00895439 | 1.77005520  | 304.22289287 | 46.68158724     | 131.78635853    |
+        // +------------+-------------+------------+-------------+--------------+-----------------+-----------------+
+        //
+        // +------------+--------------+---------------+---------------+-----------------+-----------------------+-----------------------+
+        // |            | adot [au/Cy] | edot [rad/Cy] | Idot [deg/Cy] | Ldot [deg/Cy]   | long peridot [deg/Cy] | long nodedot [deg/Cy] |
+        // | mercury    | 0.00000000   | 0.00002123    | -0.00590158   | 149472.67486623 | 0.15940013            | -0.12214182           |
+        // | venus      | -0.00000026  | -0.00005107   | 0.00043494    | 58517.81560260  | 0.05679648            | -0.27274174           |
+        // | E-M bary   | -0.00000003  | -0.00003661   | -0.01337178   | 35999.37306329  | 0.31795260            | -0.24123856           |
+        // | mars       | 0.00000097   | 0.00009149    | -0.00724757   | 19140.29934243  | 0.45223625            | -0.26852431           |
+        // | jupiter    | -0.00002864  | 0.00018026    | -0.00322699   | 3034.90371757   | 0.18199196            | 0.13024619            |
+        // | saturn     | -0.00003065  | -0.00032044   | 0.00451969    | 1222.11494724   | 0.54179478            | -0.25015002           |
+        // | uranus     | -0.00020455  | -0.00001550   | -0.00180155   | 428.49512595    | 0.09266985            | 0.05739699            |
+        // | neptune    | 0.00006447   | 0.00000818    | 0.00022400    | 218.46515314    | 0.01009938            | -0.00606302           |
+        // +------------+--------------+---------------+---------------+-----------------+-----------------------+-----------------------+
+        //
+        // for the outer planets the mean anomaly of this table has additional terms,
+        // M = L - long peri + b T^2 + c cos(f T) + s sin(f T).
         //
-        // the table is ordered as such: [body parameters x3], [keplerian elements x6], [keplerian element rates x6]
-        // the table below contains the bodies and some basic parameters, and then their keplerian elements.
+        // +------------+-------------+-------------+-------------+-------------+
+        // |            |   b [deg]   |   c [deg]   |   s [deg]   |   f [deg]   |
+        // | jupiter    | -0.00012452 | 0.06064060  | -0.35635438 | 38.35125000 |
+        // | saturn     | 0.00025899  | -0.13434469 | 0.87320147  | 38.35125000 |
+        // | uranus     | 0.00058331  | -0.97731848 | 0.17689245  | 7.67025000  |
+        // | neptune    | -0.00041348 | 0.68346318  | -0.10162547 | 7.67025000  |
+        // +------------+-------------+-------------+-------------+-------------+
+        //
+        // the tables are arrays indexed by BodyId. with this few bodies a linear search over the names is
+        // at least as fast as a hashmap, and needs no allocation.
 
         struct Body {
+            std::string_view name;
             double mu;
             double mu_central;
             double radius;
+        };
+
+        // keplerian elements and their rates per century, followed by the extra mean anomaly terms.
+        struct Elements {
             double a;
             double e;
             double I;
@@ -85,130 +159,249 @@ namespace astro {
             double Ldot;
             double long_peridot;
             double long_nodedot;
+            double b;
+            double c;
+            double s;
+            double f;
         };
 
-        // TODO: perf this against a sorted vector since with a smaller number of elements it may be better
-        // TODO: use the 3000 BC - 3000 AD table rather than this one
-        std::unordered_map<std::string, Body> m_body_lookup_1800_2050 = {
-            { "Mercury", { MU_MERCURY<double>, MU_SUN<double>, 2439500, 0.38709927, 0.20563593, 7.00497902, 252.25032350, 77.45779628, 48.33076593, 0.00000037, 0.00001906, -0.00594749, 149472.67411175, 0.16047689, -0.12534081 } },
-            { "Venus", { MU_VENUS<double>, MU_SUN<double>, 6052000, 0.72333566, 0.00677672, 3.39467605, 181.97909950, 131.60246718, 76.67984255, 0.00000390, -0.00004107, -0.00078890, 58517.81538729, 0.00268329, -0.27769418 } },
-            { "EM bary", { MU_EARTH<double>, MU_SUN<double>, 6378100, 1.00000261, 0.01671123, -0.00001531, 100.46457166, 102.93768193, 0.0, 0.00000562, -0.00004392, -0.01294668, 35999.37244981, 0.32327364, 0.0 } },
-            { "Mars", { MU_MARS<double>, MU_SUN<double>, 3396000, 1.52371034, 0.09339410, 1.84969142, -4.55343205, -23.94362959, 49.55953891, 0.00001847, 0.00007882, -0.00813131, 19140.30268499, 0.44441088, -0.29257343 } },
-            { "Jupiter", { MU_JUPITER<double>, MU_SUN<double>, 71492000, 5.20288700, 0.04838624, 1.30439695, 34.39644051, 14.72847983, 100.47390909, -0.00011607, -0.00013253, -0.00183714, 3034.74612775, 0.21252668, 0.20469106 } },
-            { "Saturn", { MU_SATURN<double>, MU_SUN<double>, 60268000, 9.53667594, 0.05386179, 2.48599187, 49.95424423, 92.59887831, 113.66242448, -0.00125060, -0.00050991, 0.00193609, 1222.49362201, -0.41897216, -0.28867794 } },
-            { "Uranus", { MU_URANUS<double>, MU_SUN<double>, 25559000, 19.18916464, 0.04725744, 0.77263783, 313.23810451, 170.95427630, 74.01692503, -0.00196176, -0.00004397, -0.00242939, 428.48202785, 0.40805281, 0.04240589 } },
-            { "Neptune", { MU_NEPTUNE<double>, MU_SUN<double>, 24764000, 30.06992276, 0.00859048, 1.77004347, -55.12002969, 44.96476227, 131.78422574, 0.00026291, 0.00005105, 0.00035372, 218.45945325, -0.32241464, -0.00508664 } }
-        };
+        static constexpr std::array<Body, 8> m_bodies = { {
+            { "Mercury", MU_MERCURY<double>, MU_SUN<double>, 2439500 },
+            { "Venus", MU_VENUS<double>, MU_SUN<double>, 6052000 },
+            { "EM bary", MU_EARTH<double>, MU_SUN<double>, 6378100 },
+            { "Mars", MU_MARS<double>, MU_SUN<double>, 3396000 },
+            { "Jupiter", MU_JUPITER<double>, MU_SUN<double>, 71492000 },
+            { "Saturn", MU_SATURN<double>, MU_SUN<double>, 60268000 },
+            { "Uranus", MU_URANUS<double>, MU_SUN<double>, 25559000 },
+            { "Neptune", MU_NEPTUNE<double>, MU_SUN<double>, 24764000 },
+        } };
 
-        // JPL LP elements position [x,y,z]
-        linalg::RowVector<double, 6> m_jpl_elements;
-        // JPL LP elements velocity [xdot, ydot, zdot]
-        linalg::RowVector<double, 6> m_jpl_elements_dot;
+        static constexpr std::array<Elements, 8> m_elements_1800_2050 = { {
+            { 0.38709927, 0.20563593, 7.00497902, 252.25032350, 77.45779628, 48.33076593, 0.00000037, 0.00001906, -0.00594749, 149472.67411175, 0.16047689, -0.12534081, 0, 0, 0, 0 },
+            { 0.72333566, 0.00677672, 3.39467605, 181.97909950, 131.60246718, 76.67984255, 0.00000390, -0.00004107, -0.00078890, 58517.81538729, 0.00268329, -0.27769418, 0, 0, 0, 0 },
+            { 1.00000261, 0.01671123, -0.00001531, 100.46457166, 102.93768193, 0.0, 0.00000562, -0.00004392, -0.01294668, 35999.37244981, 0.32327364, 0.0, 0, 0, 0, 0 },
+            { 1.52371034, 0.09339410, 1.84969142, -4.55343205, -23.94362959, 49.55953891, 0.00001847, 0.00007882, -0.00813131, 19140.30268499, 0.44441088, -0.29257343, 0, 0, 0, 0 },
+            { 5.20288700, 0.04838624, 1.30439695, 34.39644051, 14.72847983, 100.47390909, -0.00011607, -0.00013253, -0.00183714, 3034.74612775, 0.21252668, 0.20469106, 0, 0, 0, 0 },
+            { 9.53667594, 0.05386179, 2.48599187, 49.95424423, 92.59887831, 113.66242448, -0.00125060, -0.00050991, 0.00193609, 1222.49362201, -0.41897216, -0.28867794, 0, 0, 0, 0 },
+            { 19.18916464, 0.04725744, 0.77263783, 313.23810451, 170.95427630, 74.01692503, -0.00196176, -0.00004397, -0.00242939, 428.48202785, 0.40805281, 0.04240589, 0, 0, 0, 0 },
+            { 30.06992276, 0.00859048, 1.77004347, -55.12002969, 44.96476227, 131.78422574, 0.00026291, 0.00005105, 0.00035372, 218.45945325, -0.32241464, -0.00508664, 0, 0, 0, 0 },
+        } };
 
-    public:
-        /// @brief JPL low precision constructor.
-        /// @param body_name name of the body
-        /// TODO: better initial arguments
-        JPLLP(const std::string& body_name)
-            : Base(1.0, 1.0, 1.0, body_name)
+        static constexpr std::array<Elements, 8> m_elements_3000bc_3000ad = { {
+            { 0.38709843, 0.20563661, 7.00559432, 252.25166724, 77.45771895, 48.33961819, 0.00000000, 0.00002123, -0.00590158, 149472.67486623, 0.15940013, -0.12214182, 0, 0, 0, 0 },
+            { 0.72332102, 0.00676399, 3.39777545, 181.97970850, 131.76755713, 76.67261496, -0.00000026, -0.00005107, 0.00043494, 58517.81560260, 0.05679648, -0.27274174, 0, 0, 0, 0 },
+            { 1.00000018, 0.01673163, -0.00054346, 100.46691572, 102.93005885, -5.11260389, -0.00000003, -0.00003661, -0.01337178, 35999.37306329, 0.31795260, -0.24123856, 0, 0, 0, 0 },
+            { 1.52371243, 0.09336511, 1.85181869, -4.56813164, -23.91744784, 49.71320984, 0.00000097, 0.00009149, -0.00724757, 19140.29934243, 0.45223625, -0.26852431, 0, 0, 0, 0 },
+            { 5.20248019, 0.04853590, 1.29861416, 34.33479152, 14.27495244, 100.29282654, -0.00002864, 0.00018026, -0.00322699, 3034.90371757, 0.18199196, 0.13024619, -0.00012452, 0.06064060, -0.35635438, 38.35125000 },
+            { 9.54149883, 0.05550825, 2.49424102, 50.07571329, 92.86136063, 113.63998702, -0.00003065, -0.00032044, 0.00451969, 1222.11494724, 0.54179478, -0.25015002, 0.00025899, -0.13434469, 0.87320147, 38.35125000 },
+            { 19.18797948, 0.04685740, 0.77298127, 314.20276625, 172.43404441, 73.96250215, -0.00020455, -0.00001550, -0.00180155, 428.49512595, 0.09266985, 0.05739699, 0.00058331, -0.97731848, 0.17689245, 7.67025000 },
+            { 30.06952752, 0.00895439, 1.77005520, 304.22289287, 46.68158724, 131.78635853, 0.00006447, 0.00000818, 0.00022400, 218.46515314, 0.01009938, -0.00606302, -0.00041348, 0.68346318, -0.10162547, 7.67025000 },
+        } };
+
+        static constexpr const Elements& elements(BodyId id, JPLLPTable table) noexcept
         {
-            // perform a lookup and set the corresponding values given the body name
-            if (auto it = m_body_lookup_1800_2050.find(body_name); it != m_body_lookup_1800_2050.end()) {
-                m_mu_body = it->second.mu;
-                m_mu_central_body = it->second.mu_central;
-                m_radius = it->second.radius;
-
-                m_jpl_elements(1,1) = it->second.a;
-                m_jpl_elements(1,2) = it->second.e;
-                m_jpl_elements(1,3) = it->second.I;
-                m_jpl_elements(1,4) = it->second.L;
-                m_jpl_elements(1,5) = it->second.long_peri;
-                m_jpl_elements(1,6) = it->second.long_node;
-
-                m_jpl_elements_dot(1,1) = it->second.adot;
-                m_jpl_elements_dot(1,2) = it->second.edot;
-                m_jpl_elements_dot(1,3) = it->second.Idot;
-                m_jpl_elements_dot(1,4) = it->second.Ldot;
-                m_jpl_elements_dot(1,5) = it->second.long_peridot;
-                m_jpl_elements_dot(1,6) = it->second.long_nodedot;
-
-                //                m_jpl_elements = { it->second.a, it->second.e, it->second.I, it->second.L, it->second.long_peri, it->second.long_node };
-                //                m_jpl_elements_dot = { it->second.adot, it->second.edot, it->second.Idot, it->second.Ldot, it->second.long_peridot, it->second.long_nodedot };
-            } else {
-                throw std::invalid_argument("Unknown body name");
-            }
-        };
+            const auto index = static_cast<size_t>(id);
+            return table == JPLLPTable::Years1800To2050 ? m_elements_1800_2050[index] : m_elements_3000bc_3000ad[index];
+        }
 
-        /// @brief returns the cartesian coordinate form of position and velocity vectors given epoch.
-        /// @details this uses the JPL low precision ephemerides.
-        /// @param epoch_date the epoch from which to find the position and velocity of the body.
-        /// @returns a 6D array representing the position and velocity vectors.
-        linalg::RowVector<double, 6> eph(const Epoch& epoch_date) const
+        // JPL LP elements and their rates, from the table the body was constructed with
+        Elements m_elements;
+        // valid interval of the table, (MJD2000, MJD2000)
+        double m_mjd2000_min;
+        double m_mjd2000_max;
+
+        /// @brief the states at many epochs, in double or float, see ephBatch.
+        template <typename Scalar>
+        void evaluateBatch(std::span<const double> mjd2000, Scalar* states, size_t stride) const
         {
             // converting from elements to pos and vel using https://ssd.jpl.nasa.gov/planets/approx_pos.html
-            /// TODO: se the 3000 BC - 3000 AD table rather than this one
-            if (epoch_date.MJD2000() <= -73048.0 || epoch_date.MJD2000() >= 18263.0)
-                throw std::invalid_argument("epoch date must be in range [1800, 2050]");
-
-            // using equation from https://ssd.jpl.nasa.gov/planets/approx_pos.html to obtain coordinates from ephemeris
             // 1. compute the value of each of that planet's six elements, a = a0 + adot * T where T is the number of centuries past J2000.0
             // 2. convert units to SI
             // 3. compute argument of periapsis and mean anomaly
             // 4. solve equation
             // 5. convert keplerian elements (a,e,i,W,w,E) to cartesian
 
-            // elements contains:
-            // * semi-major axis, a [m]
-            // * eccentricity, e
-            // * inclination, i [rad]
-            // * longitude of the ascending node, Omega [rad]
-            // * argument of periapsis, omega [rad]
-            // * mean anomaly, M
-            linalg::RowVector<double, 6> elements;
-
-            // 1.
-            // number of centuries past J2000.0
-            double dt = (epoch_date.MJD2000() - 2451545.0) / 36525.0;
-            // a = a0 + adot * T and converting to SI
-            // a [AU -> m]
-            // https://en.wikipedia.org/wiki/Semi-major_and_semi-minor_axes
-            elements(1,1) = (m_jpl_elements(1,1) + m_jpl_elements_dot(1,1) * dt) * AU2M<double>;
-            // e
-            // https://en.wikipedia.org/wiki/Orbital_eccentricity
-            elements(1,2) = (m_jpl_elements(1,2) + m_jpl_elements_dot(1,2) * dt);
-            // i [deg -> rad]
-            // https://en.wikipedia.org/wiki/Orbital_inclination
-            elements(1,3) = (m_jpl_elements(1,3) + m_jpl_elements_dot(1,3) * dt) * DEG2RAD<double>;
-            // Omega [deg -> rad]
-            // https://en.wikipedia.org/wiki/Longitude_of_the_ascending_node
-            elements(1,4) = (m_jpl_elements(1,4) + m_jpl_elements_dot(1,4) * dt) * DEG2RAD<double>;
-            // omega [deg -> rad]; omega = omegbar - Omega
-            // https://en.wikipedia.org/wiki/Argument_of_periapsis
-            elements(1,5) = (m_jpl_elements(1,5) + m_jpl_elements_dot(1,5) * dt) * DEG2RAD<double> - elements(1,4);
-            // 4.
-            // M
-            elements(1,6) = meanAnomalyToEccentricAnomaly<double>(elements(1,6), elements(1,2));
-            // 5.
-            return keplerianToCartesian<double>(elements, m_mu_central_body);
+            // 2. hoisted out of the loop, so per epoch each element is a single multiply-add.
+            // a [AU -> m], i, L, long peri, Omega [deg -> rad]
+            const double a0 = m_elements.a * AU2M<double>;
+            const double adot = m_elements.adot * AU2M<double>;
+            const double e0 = m_elements.e;
+            const double edot = m_elements.edot;
+            const double i0 = m_elements.I * DEG2RAD<double>;
+            const double idot = m_elements.Idot * DEG2RAD<double>;
+            const double L0 = m_elements.L * DEG2RAD<double>;
+            const double Ldot = m_elements.Ldot * DEG2RAD<double>;
+            const double peri0 = m_elements.long_peri * DEG2RAD<double>;
+            const double peridot = m_elements.long_peridot * DEG2RAD<double>;
+            const double node0 = m_elements.long_node * DEG2RAD<double>;
+            const double nodedot = m_elements.long_nodedot * DEG2RAD<double>;
+            // b T^2 + c cos(f T) + s sin(f T) [deg -> rad], zero for the 1800 AD - 2050 AD table
+            const double b = m_elements.b * DEG2RAD<double>;
+            const double c = m_elements.c * DEG2RAD<double>;
+            const double s = m_elements.s * DEG2RAD<double>;
+            const double f = m_elements.f * DEG2RAD<double>;
+            const Scalar mu = static_cast<Scalar>(m_mu_central_body);
+            constexpr double two_over_pi = 6.36619772367581382433e-01;
+
+            for (const double t : mjd2000)
+                if (t <= m_mjd2000_min || t >= m_mjd2000_max)
+                    throw std::invalid_argument("epoch date must be in the range of the JPL low precision table");
+
+            // the epochs are taken in chunks through local columns, which the compiler knows alias
+            // neither mjd2000 nor each other, and the periodic terms are switched at compile-time, so
+            // the loop over a chunk is vectorized.
+            constexpr size_t chunk = 64;
+            // a, e, i, Omega, omega and M, then x, y, z, vx, vy, vz, at each epoch of a chunk.
+            Scalar orbit[6][chunk];
+            Scalar out[6][chunk];
+            const auto evaluate = [&](auto periodic, const double* t, size_t n) {
+                for (size_t k = 0; k < n; ++k) {
+                    // 1.
+                    // number of centuries past J2000.0, which is MJD2000 0.5
+                    const double T = (t[k] - 0.5) / 36525.0;
+                    const double a = a0 + adot * T;
+                    const double e = e0 + edot * T;
+                    const double i = i0 + idot * T;
+                    // Omega
+                    const double Omega = node0 + nodedot * T;
+                    // 3.
+                    // omega = long peri - Omega, M = L - long peri (+ the extra terms)
+                    const double peri = peri0 + peridot * T;
+                    const double omega = peri - Omega;
+                    double M = L0 + Ldot * T - peri + b * T * T;
+                    if constexpr (decltype(periodic)::value) {
+                        double sin_fT, cos_fT;
+                        sinCos(f * T, sin_fT, cos_fT);
+                        M += c * cos_fT + s * sin_fT;
+                    }
+                    // eccentricAnomaly reduces M to [-pi, pi] itself, which in float is done in double
+                    // first.
+                    if constexpr (!std::is_same_v<Scalar, double>) {
+                        const double turns = (M * (0.25 * two_over_pi) + detail::ROUND_SHIFT) - detail::ROUND_SHIFT;
+                        M = detail::subtractPio2(M, 4.0 * turns);
+                    }
+                    orbit[0][k] = static_cast<Scalar>(a);
+                    orbit[1][k] = static_cast<Scalar>(e);
+                    orbit[2][k] = static_cast<Scalar>(i);
+                    orbit[3][k] = static_cast<Scalar>(Omega);
+                    orbit[4][k] = static_cast<Scalar>(omega);
+                    orbit[5][k] = static_cast<Scalar>(M);
+                }
+                // split from the loop above, so that in float this loop has no doubles, and is
+                // vectorized at the width of float.
+                for (size_t k = 0; k < n; ++k) {
+                    // 4.
+                    const Scalar E = eccentricAnomaly(orbit[5][k], orbit[1][k]);
+
+                    // 5.
+                    keplerianToCartesian(orbit[0][k], orbit[1][k], orbit[2][k], orbit[3][k], orbit[4][k], E, mu, &out[0][k], chunk);
+                }
+            };
+            for (size_t first = 0; first < mjd2000.size(); first += chunk) {
+                const size_t n = std::min(chunk, mjd2000.size() - first);
+                if (f != 0.0)
+                    evaluate(std::true_type {}, mjd2000.data() + first, n);
+                else
+                    evaluate(std::false_type {}, mjd2000.data() + first, n);
+                for (size_t j = 0; j < 6; ++j)
+                    std::copy(out[j], out[j] + n, states + j * stride + first);
+            }
+        }
+
+    public:
+        /// @brief returns the id of a body given its name.
+        /// @details a linear search over the table, which folds to a constant for a literal name.
+        /// @param body_name name of the body, e.g. "Mercury" or "EM bary".
+        static constexpr BodyId bodyId(std::string_view body_name)
+        {
+            for (size_t i = 0; i < m_bodies.size(); ++i)
+                if (m_bodies[i].name == body_name)
+                    return static_cast<BodyId>(i);
+            throw std::invalid_argument("Unknown body name");
+        }
+
+        /// @brief JPL low precision constructor.
+        /// @param id the body.
+        /// @param table the table of elements to use, which sets the time-interval of valid epochs.
+        JPLLP(BodyId id, JPLLPTable table = JPLLPTable::Years1800To2050)
+            : Base(m_bodies[static_cast<size_t>(id)].mu, m_bodies[static_cast<size_t>(id)].mu_central,
+                m_bodies[static_cast<size_t>(id)].radius, std::string(m_bodies[static_cast<size_t>(id)].name))
+            , m_elements(elements(id, table))
+            // 1800 AD - 2050 AD, and 50 centuries before to 10 centuries after J2000.
+            , m_mjd2000_min(table == JPLLPTable::Years1800To2050 ? -73048.0 : 0.5 - 50 * 36525.0)
+            , m_mjd2000_max(table == JPLLPTable::Years1800To2050 ? 18263.0 : 0.5 + 10 * 36525.0)
+        {
+        }
+
+        /// @brief JPL low precision constructor.
+        /// @param body_name name of the body, see bodyId.
+        /// @param table the table of elements to use, which sets the time-interval of valid epochs.
+        JPLLP(std::string_view body_name, JPLLPTable table = JPLLPTable::Years1800To2050)
+            : JPLLP(bodyId(body_name), table)
+        {
+        }
+
+        /// @brief returns the cartesian coordinate form of position and velocity vectors given epoch.
+        /// @details this uses the JPL low precision ephemerides, see ephBatch.
+        /// @param epoch_date the epoch from which to find the position and velocity of the body.
+        /// @returns a 6D array representing the position and velocity vectors.
+        linalg::RowVector<double, 6> eph(const Epoch& epoch_date) const
+        {
+            const double mjd2000 = epoch_date.MJD2000();
+            linalg::RowVector<double, 6> state;
+            ephBatch(std::span<const double>(&mjd2000, 1), state.data(), 1);
+            return state;
         };
 
+        using Base::eph;
+        using Base::ephBatch;
+
+        /// @brief returns the cartesian position and velocity vectors at many epochs in one call.
+        /// @details this uses the JPL low precision ephemerides. the elements and their rates are
+        /// converted to SI once per batch, and each epoch is then a handful of scalar operations and a
+        /// fixed-work solve of Kepler's equation, see eccentricAnomaly, with no matrices built and no
+        /// calls made per epoch, so the epochs are evaluated several at a time in SIMD registers.
+        /// @param mjd2000 the epochs as MJD2000.
+        /// @param states the six output columns x, y, z, vx, vy, vz, each of at least stride elements.
+        /// @param stride the distance between the columns.
+        void ephBatch(std::span<const double> mjd2000, double* states, size_t stride) const override
+        {
+            evaluateBatch(mjd2000, states, stride);
+        }
+
+        /// @brief returns the cartesian position and velocity vectors at many epochs in one call, in
+        /// single precision.
+        /// @details the elements at each epoch are computed in double, with the mean anomaly reduced to
+        /// [-pi, pi], and only then rounded to float, so the error of a float T in the centuries past
+        /// J2000 is not multiplied by the rate of the mean longitude. Kepler's equation and the
+        /// conversion to cartesian, the bulk of the work, run in float at twice the SIMD width of
+        /// double. the positions are within JPLLP_FLOAT_ERROR r of those in double, where r is the
+        /// distance of the body, and the velocities within JPLLP_FLOAT_ERROR v, where v is its speed.
+        /// @param mjd2000 the epochs as MJD2000.
+        /// @param states the six output columns x, y, z, vx, vy, vz, each of at least stride elements.
+        /// @param stride the distance between the columns.
+        void ephBatch(std::span<const double> mjd2000, float* states, size_t stride) const override
+        {
+            evaluateBatch(mjd2000, states, stride);
+        }
+
         // TODO: consistent accuracy
         std::string ostreamExtra() const
         {
             std::ostringstream s;
             s << "\"JPL_low_precision\": {\n";
-            s << "  \"semi_major_axis_au\": " << m_jpl_elements(1,1) << ",\n";
-            s << "  \"eccentricity\": " << m_jpl_elements(1,2) << ",\n";
-            s << "  \"inclination_deg\": " << m_jpl_elements(1,3) << ",\n";
-            s << "  \"mean_longitude_deg\": " << m_jpl_elements(1,4) << ",\n";
-            s << "  \"longitude_of_perihelion_deg\": " << m_jpl_elements(1,5) << ",\n";
-            s << "  \"longitude_of_ascending_node_deg\": " << m_jpl_elements(1,6) << ",\n";
-            s << "  \"semi_major_axis_rate_of_change_au_per_Cy\": " << m_jpl_elements_dot(1,1) << ",\n";
-            s << "  \"eccentricity_rate_of_change_rad_per_Cy\": " << m_jpl_elements_dot(1,2) << ",\n";
-            s << "  \"inclination_rate_of_change_deg_per_Cy\": " << m_jpl_elements_dot(1,3) << ",\n";
-            s << "  \"mean_longitude_rate_of_change_deg_per_Cy\": " << m_jpl_elements_dot(1,4) << ",\n";
-            s << "  \"longitude_of_perihelion_rate_of_change_deg_per_Cy\": " << m_jpl_elements_dot(1,5) << ",\n";
-            s << "  \"longitude_of_ascending_node_rate_of_change_deg_per_Cy\": " << m_jpl_elements_dot(1,6) << "\n";
+            s << "  \"semi_major_axis_au\": " << m_elements.a << ",\n";
+            s << "  \"eccentricity\": " << m_elements.e << ",\n";
+            s << "  \"inclination_deg\": " << m_elements.I << ",\n";
+            s << "  \"mean_longitude_deg\": " << m_elements.L << ",\n";
+            s << "  \"longitude_of_perihelion_deg\": " << m_elements.long_peri << ",\n";
+            s << "  \"longitude_of_ascending_node_deg\": " << m_elements.long_node << ",\n";
+            s << "  \"semi_major_axis_rate_of_change_au_per_Cy\": " << m_elements.adot << ",\n";
+            s << "  \"eccentricity_rate_of_change_rad_per_Cy\": " << m_elements.edot << ",\n";
+            s << "  \"inclination_rate_of_change_deg_per_Cy\": " << m_elements.Idot << ",\n";
+            s << "  \"mean_longitude_rate_of_change_deg_per_Cy\": " << m_elements.Ldot << ",\n";
+            s << "  \"longitude_of_perihelion_rate_of_change_deg_per_Cy\": " << m_elements.long_peridot << ",\n";
+            s << "  \"longitude_of_ascending_node_rate_of_change_deg_per_Cy\": " << m_elements.long_nodedot << "\n";
             s << "  }\n";
             return s.str();
         }
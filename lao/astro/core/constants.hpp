@@ -51,6 +51,10 @@ namespace astro {
 
     // solver tolerance
     MAKE_CONSTANT(SOLVER_TOLERANCE, 1e-16);
+    // in float a relative step of 1e-16 is never reached, and newton's method has converged to
+    // within rounding one step after a step of 1e-6.
+    template <>
+    constexpr float SOLVER_TOLERANCE<float> = 1e-6f;
 
 }; // namespace astro
 }; // namespace lao
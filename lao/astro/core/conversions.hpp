@@ -2,10 +2,12 @@
 #define LAO_ASTRO_CONVERSIONS_H_
 
 #include <cmath>
+#include <cstddef>
 #include <functional>
 #include <lao/astro/core/constants.hpp>
 #include <lao/astro/core/equations.hpp>
 #include <lao/astro/math/newton_raphson.hpp>
+#include <lao/astro/math/sincos.hpp>
 #include <lao/astro/math/transforms.hpp>
 #include <lao/linalg/dense/matrix.hpp>
 
@@ -21,65 +23,86 @@ namespace astro {
     template <typename T>
     inline T meanAnomalyToEccentricAnomaly(const T& M, const T& e)
     {
-        T E = M + e * sin(M);
+        T E = M + e * std::sin(M);
 
         auto F = [&](T E) { return meanAnomaly(E, e, M); };
         auto dF = [&](T E) { return meanAnomalyDerivative(E, e); };
 
-        return newtonRaphson(E, F, dF, 100, SOLVER_TOLERANCE<T>);
+        // newtonRaphson refines E in place and returns the iterations it had left.
+        newtonRaphson(E, F, dF, 100, SOLVER_TOLERANCE<T>);
+        return E;
     };
 
-    /// @brief converts keplerian elements to cartesian coordinate state vector.
-    /// @details see https://ssd.jpl.nasa.gov/planets/approx_pos.html.
-    /// @param elements keplerian elements as a 6D vector [a,e,i,Omega,omega,E].
+    /// @brief converts keplerian elements to the cartesian coordinate state vector, writing its six
+    /// components directly.
+    /// @details the position and velocity in the perifocal frame are rotated to the reference frame by
+    /// the first two columns of R = Rz(Omega) Rx(i) Rz(omega), with no matrices built. see
+    /// https://ssd.jpl.nasa.gov/planets/approx_pos.html.
+    /// @param a semi-major axis.
+    /// @param e eccentricity.
+    /// @param i inclination [rad].
+    /// @param Omega longitude of the ascending node [rad].
+    /// @param omega argument of periapsis [rad].
+    /// @param E eccentric anomaly [rad].
     /// @param mu_central_body the standard gravitational parameter of the attracting body.
-    /// @returns the cartesian state vector as a 6D vector.
+    /// @param state x, y, z, vx, vy, vz are written to state[0], state[stride], ..., state[5 * stride].
+    /// @param stride the distance between the components.
     template <typename T>
-    inline linalg::RowVector<double, 6> keplerianToCartesian(const linalg::RowVector<double, 6>& elements, const T& mu_central_body)
+    inline void keplerianToCartesian(T a, T e, T i, T Omega, T omega, T E, T mu_central_body, T* state, size_t stride = 1) noexcept
     {
-        T a = elements(1, 1);
-        T e = elements(1, 2);
-        T i = elements(1, 3);
-        T Omega = elements(1, 4);
-        T omega = elements(1, 5);
-        T E = elements(1, 6);
-
-        linalg::RowVector<double, 3> angles;
-
-        angles(1, 1) = -omega;
-        angles(1, 2) = -i;
-        angles(1, 3) = -Omega;
-
-        // computing the body's perifocal coordinates in its orbital plane
+        // position and velocity in the perifocal frame, the orbital plane with x towards periapsis
         // https://en.wikipedia.org/wiki/Perifocal_coordinate_system
-        // https://orbital-mechanics.space/classical-orbital-elements/orbital-elements-and-the-state-vector.html#step-1transform-to-perifocal-frame
-        linalg::Matrix<T, 3, 3> R = rotationFromEuler("ZXZ", angles);
-
-        // position and velocity vectors in the perifocal frame
-        T xprime = a * (std::cos(E) - e);
-        T yprime = a * (std::sqrt(1 - std::pow(e, 2))) * std::sin(E);
-        T zprime = 0;
-        T vxprime = -std::sqrt(mu_central_body / a) * std::sin(E);
-        T vyprime = std::sqrt(mu_central_body / a) * std::sqrt(1 - e * e) * std::cos(E);
-        T vzprime = 0;
-
-        linalg::Matrix<T, 1, 3> rprime;
-        linalg::Matrix<T, 1, 3> vprime;
-
-        rprime(1, 1) = xprime;
-        rprime(1, 2) = yprime;
-        rprime(1, 3) = zprime;
-        vprime(1, 1) = vxprime;
-        vprime(1, 2) = vyprime;
-        vprime(1, 3) = vzprime;
-
-        // 1x3 = 1x3 * 3x3
-        linalg::Matrix<T, 1, 3> rvec = rprime * R;
-        linalg::Matrix<T, 1, 3> vvec = vprime * R;
+        T sin_E, cos_E;
+        sinCos(E, sin_E, cos_E);
+        const T sqrt_1me2 = std::sqrt(T(1) - e * e);
+        const T xprime = a * (cos_E - e);
+        const T yprime = a * sqrt_1me2 * sin_E;
+        // (d/dt) E = n / (1 - e cos E), with the mean motion n = sqrt(mu / a^3)
+        const T Edot = std::sqrt(mu_central_body / a) / (a * (T(1) - e * cos_E));
+        const T vxprime = -a * sin_E * Edot;
+        const T vyprime = a * sqrt_1me2 * cos_E * Edot;
+
+        T sin_w, cos_w, sin_O, cos_O, sin_i, cos_i;
+        sinCos(omega, sin_w, cos_w);
+        sinCos(Omega, sin_O, cos_O);
+        sinCos(i, sin_i, cos_i);
+        const T r11 = cos_w * cos_O - sin_w * sin_O * cos_i;
+        const T r12 = -sin_w * cos_O - cos_w * sin_O * cos_i;
+        const T r21 = cos_w * sin_O + sin_w * cos_O * cos_i;
+        const T r22 = -sin_w * sin_O + cos_w * cos_O * cos_i;
+        const T r31 = sin_w * sin_i;
+        const T r32 = cos_w * sin_i;
+
+        state[0] = r11 * xprime + r12 * yprime;
+        state[stride] = r21 * xprime + r22 * yprime;
+        state[2 * stride] = r31 * xprime + r32 * yprime;
+        state[3 * stride] = r11 * vxprime + r12 * vyprime;
+        state[4 * stride] = r21 * vxprime + r22 * vyprime;
+        state[5 * stride] = r31 * vxprime + r32 * vyprime;
+    }
 
-        linalg::Matrix<T, 1, 6> result = concat(rvec, vvec);
+    /// @brief converts keplerian elements to cartesian coordinate state vector, into state.
+    /// @param elements keplerian elements as a 6D vector [a,e,i,Omega,omega,E].
+    /// @param mu_central_body the standard gravitational parameter of the attracting body.
+    /// @param state the cartesian state vector, every element of which is written.
+    template <typename T, typename U>
+    inline void keplerianToCartesian(const linalg::RowVector<T, 6>& elements, const U& mu_central_body, linalg::RowVector<T, 6>& state)
+    {
+        keplerianToCartesian<T>(elements(1, 1), elements(1, 2), elements(1, 3), elements(1, 4), elements(1, 5), elements(1, 6),
+            static_cast<T>(mu_central_body), state.data());
+    }
 
-        return result;
+    /// @brief converts keplerian elements to cartesian coordinate state vector.
+    /// @details see https://ssd.jpl.nasa.gov/planets/approx_pos.html.
+    /// @param elements keplerian elements as a 6D vector [a,e,i,Omega,omega,E].
+    /// @param mu_central_body the standard gravitational parameter of the attracting body.
+    /// @returns the cartesian state vector as a 6D vector.
+    template <typename T, typename U>
+    inline linalg::RowVector<T, 6> keplerianToCartesian(const linalg::RowVector<T, 6>& elements, const U& mu_central_body)
+    {
+        linalg::RowVector<T, 6> state(linalg::filltype::none);
+        keplerianToCartesian(elements, mu_central_body, state);
+        return state;
     }
 
 }; // namespace astro
@@ -12,7 +12,8 @@ namespace astro {
     /// @param e eccentricity
     /// @param M mean anomaly
     /// @returns
-    inline double meanAnomaly(double E, double e, double M)
+    template <typename T>
+    inline T meanAnomaly(T E, T e, T M)
     {
         return E - e * std::sin(E) - M;
     }
@@ -22,9 +23,10 @@ namespace astro {
     /// @param E eccentric anomaly
     /// @param e eccentricity
     /// @returns
-    inline double meanAnomalyDerivative(double E, double e)
+    template <typename T>
+    inline T meanAnomalyDerivative(T E, T e)
     {
-        return 1.0 - e * std::cos(E);
+        return T(1) - e * std::cos(E);
     }
 
 }; // namespace astro
@@ -0,0 +1,265 @@
+/// lambert.hpp implements Izzo's solver of lambert's problem, the orbits between two positions in a
+/// given time about one attracting body, with up to any number of complete revolutions.
+///
+/// the problem is reduced to the single parameter lambda of the geometry and a non-dimensional time
+/// of flight T, and solved for x, related to the semi-major axis, where T(x) is evaluated with
+/// lagrange's expression, battin's hypergeometric series close to x = 1 and lancaster's otherwise.
+/// from the initial guesses of Izzo every solution converges within a few of householder's steps.
+/// an orbit of N revolutions exists for T at least the minimum time of flight of N revolutions,
+/// found by halley's method, and then has two solutions, of the left and right branches of T(x).
+/// see D. Izzo, Revisiting Lambert's problem, Celestial Mechanics and Dynamical Astronomy 121 (2015).
+
+#ifndef LAO_ASTRO_CORE_LAMBERT_H_
+#define LAO_ASTRO_CORE_LAMBERT_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <lao/astro/body/base.hpp>
+#include <lao/astro/core/constants.hpp>
+#include <lao/astro/date/epoch.hpp>
+#include <lao/astro/math/newton_raphson.hpp>
+#include <lao/instrumentation.hpp>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace lao {
+namespace astro {
+
+    /// @brief a solution of lambert's problem.
+    struct LambertSolution {
+        // velocity at the first position [m/s]
+        std::array<double, 3> v1;
+        // velocity at the second position [m/s]
+        std::array<double, 3> v2;
+        // number of complete revolutions
+        size_t revolutions;
+    };
+
+    namespace detail {
+
+        inline std::array<double, 3> cross(const std::array<double, 3>& a, const std::array<double, 3>& b) noexcept
+        {
+            return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+        }
+
+        inline std::array<double, 3> normalized(const std::array<double, 3>& a) noexcept
+        {
+            const double n = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+            return { a[0] / n, a[1] / n, a[2] / n };
+        }
+
+        /// @brief returns the hypergeometric function 2F1(3, 1, 5/2, z) of battin's series.
+        inline double lambertHypergeometric(double z, double tolerance) noexcept
+        {
+            double S = 1.0;
+            double C = 1.0;
+            for (size_t j = 0; std::abs(C) > tolerance; ++j) {
+                const double n = static_cast<double>(j);
+                C *= (3.0 + n) * (1.0 + n) / (2.5 + n) * z / (n + 1.0);
+                S += C;
+            }
+            return S;
+        }
+
+        /// @brief returns the non-dimensional time of flight for x and N revolutions.
+        inline double lambertTimeOfFlight(double x, double lambda, size_t N) noexcept
+        {
+            const double revolutions = static_cast<double>(N) * PI<double>;
+            const double distance = std::abs(x - 1.0);
+            if (distance > 0.01 && distance < 0.2) {
+                // lagrange
+                const double a = 1.0 / (1.0 - x * x);
+                if (a > 0.0) {
+                    const double alfa = 2.0 * std::acos(x);
+                    const double beta = std::copysign(2.0 * std::asin(std::sqrt(lambda * lambda / a)), lambda);
+                    return a * std::sqrt(a) * ((alfa - std::sin(alfa)) - (beta - std::sin(beta)) + 2.0 * revolutions) / 2.0;
+                }
+                const double alfa = 2.0 * std::acosh(x);
+                const double beta = std::copysign(2.0 * std::asinh(std::sqrt(-lambda * lambda / a)), lambda);
+                return -a * std::sqrt(-a) * ((beta - std::sinh(beta)) - (alfa - std::sinh(alfa))) / 2.0;
+            }
+
+            const double E = x * x - 1.0;
+            const double rho = std::abs(E);
+            const double z = std::sqrt(1.0 + lambda * lambda * E);
+            if (distance <= 0.01) {
+                // battin
+                const double eta = z - lambda * x;
+                const double S1 = 0.5 * (1.0 - lambda - x * eta);
+                const double Q = 4.0 / 3.0 * lambertHypergeometric(S1, 1e-11);
+                return (eta * eta * eta * Q + 4.0 * lambda * eta) / 2.0 + revolutions / std::pow(rho, 1.5);
+            }
+            // lancaster
+            const double y = std::sqrt(rho);
+            const double g = x * z - lambda * E;
+            const double d = E < 0.0 ? revolutions + std::acos(g) : std::log(y * (z - lambda * x) + g);
+            return (x - lambda * z - d / y) / E;
+        }
+
+        /// @brief returns the first three derivatives of the time of flight T at x.
+        inline std::array<double, 3> lambertTimeOfFlightDerivatives(double x, double T, double lambda) noexcept
+        {
+            const double l2 = lambda * lambda;
+            const double l3 = l2 * lambda;
+            const double umx2 = 1.0 - x * x;
+            const double y = std::sqrt(1.0 - l2 * umx2);
+            const double y2 = y * y;
+            const double y3 = y2 * y;
+            const double dT = (3.0 * T * x - 2.0 + 2.0 * l3 * x / y) / umx2;
+            const double d2T = (3.0 * T + 5.0 * x * dT + 2.0 * (1.0 - l2) * l3 / y3) / umx2;
+            const double d3T = (7.0 * x * d2T + 8.0 * dT - 6.0 * (1.0 - l2) * l2 * l3 * x / y3 / y2) / umx2;
+            return { dT, d2T, d3T };
+        }
+
+        /// @brief solves T(x) = T for N revolutions by householder's method from x.
+        inline double lambertSolve(double T, double x, double lambda, size_t N, double accuracy) noexcept
+        {
+            householder(x, [&](double x) {
+                const double tof = lambertTimeOfFlight(x, lambda, N);
+                const std::array<double, 3> d = lambertTimeOfFlightDerivatives(x, tof, lambda);
+                return std::array<double, 4> { tof - T, d[0], d[1], d[2] };
+            }, 15, accuracy);
+            return x;
+        }
+
+    }; // namespace detail
+
+    /// @brief solves lambert's problem, writing every solution of at most (solutions.size() - 1) / 2
+    /// complete revolutions.
+    /// @details the orbit of no complete revolutions is written first, then those of 1, 2, ...
+    /// revolutions, each of the left and then the right branch, up to the most the time of flight
+    /// allows. nothing is allocated, so many problems may be solved in a loop.
+    /// @param r1 first position [m].
+    /// @param r2 second position [m].
+    /// @param tof time of flight [s].
+    /// @param mu standard gravitational parameter of the attracting body [m^3/s^2].
+    /// @param solutions where the solutions are written.
+    /// @param retrograde whether the orbits are clockwise about the z axis rather than counterclockwise.
+    /// @returns the number of solutions written.
+    inline size_t lambert(const std::array<double, 3>& r1, const std::array<double, 3>& r2, double tof, double mu,
+        std::span<LambertSolution> solutions, bool retrograde = false)
+    {
+        if (!(tof > 0.0))
+            throw std::invalid_argument("Time of flight must be positive");
+        if (!(mu > 0.0))
+            throw std::invalid_argument("Gravitational parameter must be positive");
+        if (solutions.empty())
+            throw std::invalid_argument("There must be room for at least one solution");
+        instrumentation::ScopedTimer timer(instrumentation::Kernel::lambert);
+
+        // 1 - the geometry, reduced to lambda and the non-dimensional time of flight T.
+        const std::array<double, 3> chord = { r2[0] - r1[0], r2[1] - r1[1], r2[2] - r1[2] };
+        const double c = std::sqrt(chord[0] * chord[0] + chord[1] * chord[1] + chord[2] * chord[2]);
+        const double R1 = std::sqrt(r1[0] * r1[0] + r1[1] * r1[1] + r1[2] * r1[2]);
+        const double R2 = std::sqrt(r2[0] * r2[0] + r2[1] * r2[1] + r2[2] * r2[2]);
+        const double s = (c + R1 + R2) / 2.0;
+        const std::array<double, 3> ir1 = { r1[0] / R1, r1[1] / R1, r1[2] / R1 };
+        const std::array<double, 3> ir2 = { r2[0] / R2, r2[1] / R2, r2[2] / R2 };
+        const std::array<double, 3> ih = detail::normalized(detail::cross(ir1, ir2));
+        if (!std::isfinite(ih[0] + ih[1] + ih[2]))
+            throw std::invalid_argument("Positions must not be collinear with the attracting body");
+
+        const double lambda2 = 1.0 - c / s;
+        double lambda = std::sqrt(lambda2);
+        std::array<double, 3> it1, it2;
+        if (ih[2] < 0.0) {
+            // transfer angle larger than pi
+            lambda = -lambda;
+            it1 = detail::normalized(detail::cross(ir1, ih));
+            it2 = detail::normalized(detail::cross(ir2, ih));
+        } else {
+            it1 = detail::normalized(detail::cross(ih, ir1));
+            it2 = detail::normalized(detail::cross(ih, ir2));
+        }
+        if (retrograde) {
+            lambda = -lambda;
+            for (size_t k = 0; k < 3; ++k) {
+                it1[k] = -it1[k];
+                it2[k] = -it2[k];
+            }
+        }
+        const double lambda3 = lambda * lambda2;
+        const double T = std::sqrt(2.0 * mu / (s * s * s)) * tof;
+
+        // 2 - the most revolutions the time of flight allows, from the minimum time of flight of each.
+        size_t revolutions = static_cast<size_t>(T / PI<double>);
+        const double T00 = std::acos(lambda) + lambda * std::sqrt(1.0 - lambda2);
+        const double T0 = T00 + static_cast<double>(revolutions) * PI<double>;
+        const double T1 = 2.0 / 3.0 * (1.0 - lambda3);
+        if (revolutions > 0 && T < T0) {
+            double x_min = 0.0;
+            double T_min = T0;
+            halley(x_min, [&](double x) {
+                T_min = detail::lambertTimeOfFlight(x, lambda, revolutions);
+                return detail::lambertTimeOfFlightDerivatives(x, T_min, lambda);
+            }, 12, 1e-13);
+            T_min = detail::lambertTimeOfFlight(x_min, lambda, revolutions);
+            if (T_min > T)
+                revolutions -= 1;
+        }
+        revolutions = std::min(revolutions, (solutions.size() - 1) / 2);
+
+        // 3 - x of every solution, from the initial guesses of Izzo.
+        double x0;
+        if (T >= T00)
+            x0 = -(T - T00) / (T - T00 + 4.0);
+        else if (T <= T1)
+            x0 = T1 * (T1 - T) / (2.0 / 5.0 * (1.0 - lambda2 * lambda3) * T) + 1.0;
+        else
+            x0 = std::pow(T / T00, 0.69314718055994529 / std::log(T1 / T00)) - 1.0;
+
+        // 4 - the velocities from x.
+        const double gamma = std::sqrt(mu * s / 2.0);
+        const double rho = (R1 - R2) / c;
+        const double sigma = std::sqrt(1.0 - rho * rho);
+        auto write = [&](LambertSolution& solution, double x, size_t N) {
+            const double y = std::sqrt(1.0 - lambda2 + lambda2 * x * x);
+            const double vr1 = gamma * ((lambda * y - x) - rho * (lambda * y + x)) / R1;
+            const double vr2 = -gamma * ((lambda * y - x) + rho * (lambda * y + x)) / R2;
+            const double vt = gamma * sigma * (y + lambda * x);
+            for (size_t k = 0; k < 3; ++k) {
+                solution.v1[k] = vr1 * ir1[k] + vt / R1 * it1[k];
+                solution.v2[k] = vr2 * ir2[k] + vt / R2 * it2[k];
+            }
+            solution.revolutions = N;
+        };
+
+        write(solutions[0], detail::lambertSolve(T, x0, lambda, 0, 1e-5), 0);
+        for (size_t N = 1; N <= revolutions; ++N) {
+            const double n = static_cast<double>(N);
+            const double left = std::pow((n * PI<double> + PI<double>) / (8.0 * T), 2.0 / 3.0);
+            write(solutions[2 * N - 1], detail::lambertSolve(T, (left - 1.0) / (left + 1.0), lambda, N, 1e-8), N);
+            const double right = std::pow(8.0 * T / (n * PI<double>), 2.0 / 3.0);
+            write(solutions[2 * N], detail::lambertSolve(T, (right - 1.0) / (right + 1.0), lambda, N, 1e-8), N);
+        }
+        return 2 * revolutions + 1;
+    }
+
+    /// @brief solves lambert's problem between two bodies, departing one at t1 and arriving at the
+    /// other at t2, about the attracting body of the first.
+    /// @param departure the body departed.
+    /// @param t1 the epoch of departure.
+    /// @param arrival the body arrived at.
+    /// @param t2 the epoch of arrival, after t1.
+    /// @param max_revolutions the most complete revolutions of the solutions.
+    /// @param retrograde whether the orbits are clockwise about the z axis rather than counterclockwise.
+    /// @returns every solution, see lambert.
+    inline std::vector<LambertSolution> lambert(const Base& departure, const Epoch& t1, const Base& arrival, const Epoch& t2,
+        size_t max_revolutions = 0, bool retrograde = false)
+    {
+        const linalg::RowVector<double, 6> s1 = departure.eph(t1);
+        const linalg::RowVector<double, 6> s2 = arrival.eph(t2);
+        std::vector<LambertSolution> solutions(2 * max_revolutions + 1);
+        const size_t count = lambert({ s1(1, 1), s1(1, 2), s1(1, 3) }, { s2(1, 1), s2(1, 2), s2(1, 3) },
+            (t2.MJD2000() - t1.MJD2000()) * DAY2SEC<double>, departure.muCentralBody(), solutions, retrograde);
+        solutions.resize(count);
+        return solutions;
+    }
+
+}; // namespace astro
+}; // namespace lao
+
+#endif // LAO_ASTRO_CORE_LAMBERT_H_
@@ -0,0 +1,142 @@
+/// porkchop.hpp implements the grids of lambert transfers between two bodies over their departure and
+/// arrival epochs, of the departure C3, the hyperbolic excess speeds and the delta-v of each cell.
+///
+/// the ephemerides are evaluated once per departure row and arrival column with ephBatch, not per
+/// cell, and the grid is split into square tiles, small enough to keep their rows and columns of
+/// states in cache, which run on the ThreadPool. each thread solves the cells of its tiles with lambert
+/// into solutions of its own, so no cell allocates.
+
+#ifndef LAO_ASTRO_CORE_PORKCHOP_H_
+#define LAO_ASTRO_CORE_PORKCHOP_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <lao/astro/body/base.hpp>
+#include <lao/astro/body/ephemeris_engine.hpp>
+#include <lao/astro/core/constants.hpp>
+#include <lao/astro/core/lambert.hpp>
+#include <lao/instrumentation.hpp>
+#include <lao/linalg/dense/matrix.hpp>
+#include <lao/parallel.hpp>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace lao {
+namespace astro {
+
+    /// @brief transfers between two bodies, one row per departure epoch and one column per arrival
+    /// epoch.
+    /// @details each cell is of the solution of lambert's problem of least delta_v, and is NaN where
+    /// the arrival is not after the departure, or the bodies are collinear with their attracting body.
+    struct Porkchop {
+        // departure C3, the square of the hyperbolic excess speed at departure [m^2/s^2]
+        linalg::Matrix<double, linalg::Dynamic, linalg::Dynamic> c3;
+        // hyperbolic excess speed at arrival [m/s]
+        linalg::Matrix<double, linalg::Dynamic, linalg::Dynamic> vinf_arrival;
+        // sum of the hyperbolic excess speeds at departure and arrival [m/s]
+        linalg::Matrix<double, linalg::Dynamic, linalg::Dynamic> delta_v;
+    };
+
+    namespace detail {
+
+        /// @brief number of rows and columns of the tiles of a porkchop grid.
+        inline constexpr size_t PORKCHOP_TILE = 32;
+
+    }; // namespace detail
+
+    /// @brief solves lambert's problem between two bodies for every pair of departure and arrival
+    /// epochs, over the attracting body of the departure.
+    /// @param departure the body departed.
+    /// @param arrival the body arrived at, with the same attracting body.
+    /// @param departures the departure epochs as MJD2000.
+    /// @param arrivals the arrival epochs as MJD2000.
+    /// @param max_revolutions the most complete revolutions of the transfers considered.
+    /// @param pool the pool the tiles run on.
+    /// @returns the grids, departures.size() x arrivals.size().
+    inline Porkchop porkchop(const Base& departure, const Base& arrival, std::span<const double> departures, std::span<const double> arrivals,
+        size_t max_revolutions = 0, ThreadPool& pool = ThreadPool::instance())
+    {
+        if (departure.muCentralBody() != arrival.muCentralBody())
+            throw std::invalid_argument("Bodies must have the same attracting body");
+        if (departures.empty() || arrivals.empty())
+            throw std::invalid_argument("There must be at least one departure and one arrival epoch");
+        instrumentation::ScopedTimer timer(instrumentation::Kernel::porkchop);
+
+        const size_t rows = departures.size();
+        const size_t cols = arrivals.size();
+        StateBatch from;
+        StateBatch to;
+        departure.ephBatch(departures, from);
+        arrival.ephBatch(arrivals, to);
+
+        Porkchop grid { linalg::Matrix<double, linalg::Dynamic, linalg::Dynamic>(rows, cols), linalg::Matrix<double, linalg::Dynamic, linalg::Dynamic>(rows, cols),
+            linalg::Matrix<double, linalg::Dynamic, linalg::Dynamic>(rows, cols) };
+        const double mu = departure.muCentralBody();
+        const size_t tile_rows = (rows + detail::PORKCHOP_TILE - 1) / detail::PORKCHOP_TILE;
+        const size_t tile_cols = (cols + detail::PORKCHOP_TILE - 1) / detail::PORKCHOP_TILE;
+        pool.parallel_for(0, tile_rows * tile_cols, 1, [&](size_t tile_begin, size_t tile_end) {
+            std::vector<LambertSolution> solutions(2 * max_revolutions + 1);
+            for (size_t tile = tile_begin; tile < tile_end; ++tile) {
+                const size_t row_begin = tile / tile_cols * detail::PORKCHOP_TILE;
+                const size_t col_begin = tile % tile_cols * detail::PORKCHOP_TILE;
+                for (size_t i = row_begin + 1; i <= std::min(rows, row_begin + detail::PORKCHOP_TILE); ++i) {
+                    const std::array<double, 3> r1 = { from(i, 1), from(i, 2), from(i, 3) };
+                    for (size_t j = col_begin + 1; j <= std::min(cols, col_begin + detail::PORKCHOP_TILE); ++j) {
+                        const double tof = (arrivals[j - 1] - departures[i - 1]) * DAY2SEC<double>;
+                        grid.c3(i, j) = grid.vinf_arrival(i, j) = grid.delta_v(i, j) = std::numeric_limits<double>::quiet_NaN();
+                        if (!(tof > 0.0))
+                            continue;
+                        size_t count;
+                        try {
+                            count = lambert(r1, { to(j, 1), to(j, 2), to(j, 3) }, tof, mu, solutions);
+                        } catch (const std::invalid_argument&) {
+                            // positions collinear with the attracting body, where the plane is undefined.
+                            continue;
+                        }
+                        double best = std::numeric_limits<double>::infinity();
+                        for (size_t k = 0; k < count; ++k) {
+                            const double vinf1 = std::hypot(solutions[k].v1[0] - from(i, 4), solutions[k].v1[1] - from(i, 5), solutions[k].v1[2] - from(i, 6));
+                            const double vinf2 = std::hypot(solutions[k].v2[0] - to(j, 4), solutions[k].v2[1] - to(j, 5), solutions[k].v2[2] - to(j, 6));
+                            if (vinf1 + vinf2 < best) {
+                                best = vinf1 + vinf2;
+                                grid.c3(i, j) = vinf1 * vinf1;
+                                grid.vinf_arrival(i, j) = vinf2;
+                                grid.delta_v(i, j) = best;
+                            }
+                        }
+                    }
+                }
+            }
+        });
+        return grid;
+    }
+
+    /// @brief solves lambert's problem between two bodies over grids of departure and arrival epochs,
+    /// see porkchop.
+    /// @param departure the body departed.
+    /// @param arrival the body arrived at, with the same attracting body.
+    /// @param departures the departure epochs.
+    /// @param arrivals the arrival epochs.
+    /// @param max_revolutions the most complete revolutions of the transfers considered.
+    /// @param pool the pool the tiles run on.
+    /// @returns the grids, departures.count x arrivals.count.
+    inline Porkchop porkchop(const Base& departure, const Base& arrival, const EpochGrid& departures, const EpochGrid& arrivals,
+        size_t max_revolutions = 0, ThreadPool& pool = ThreadPool::instance())
+    {
+        std::vector<double> from(departures.count);
+        std::vector<double> to(arrivals.count);
+        for (size_t k = 0; k < departures.count; ++k)
+            from[k] = departures[k];
+        for (size_t k = 0; k < arrivals.count; ++k)
+            to[k] = arrivals[k];
+        return porkchop(departure, arrival, from, to, max_revolutions, pool);
+    }
+
+}; // namespace astro
+}; // namespace lao
+
+#endif // LAO_ASTRO_CORE_PORKCHOP_H_
@@ -0,0 +1,464 @@
+/// propagation.hpp implements a two-body propagator over the universal variable chi, for elliptic,
+/// parabolic and hyperbolic orbits alike, written for catalogues of many objects propagated at once.
+///
+/// the states are read and written as columns of x, y, z, vx, vy, vz a stride apart, the layout of a
+/// StateBatch and of the output of ephBatch, so the states of a body may be propagated where its
+/// ephemerides were written. the objects are split into chunks which run in parallel, and within a
+/// chunk every object takes the same laguerre-conway step on the universal kepler equation in lockstep,
+/// over the stumpff functions c2 and c3 evaluated with no branches or library calls, so the loop over
+/// the objects of a chunk is vectorized by the compiler, given -fno-math-errno and a target with 64-bit
+/// lane compares, SSE4.2 and up. the chunk stops once all of its objects have converged, which
+/// laguerre-conway does within a few steps from any starting value. objects which still have not
+/// after 50 steps, or whose state overflows, are returned as NaN and counted.
+///
+/// the state transition matrix is derived in closed form from the partials of the universal functions,
+/// as in Goodyear's formulation, and chained onto the one given with the fixed-size 6x6 kernels, so
+/// successive propagations accumulate the transition matrix from the first epoch.
+/// see D. A. Vallado, Fundamentals of Astrodynamics and Applications, algorithm 8, and W. H.
+/// Goodyear, Completely general closed-form solution for coordinates and partial derivatives of the
+/// two-body problem, Astronomical Journal 70 (1965).
+
+#ifndef LAO_ASTRO_CORE_PROPAGATION_H_
+#define LAO_ASTRO_CORE_PROPAGATION_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <lao/astro/body/base.hpp>
+#include <lao/astro/math/sincos.hpp>
+#include <lao/instrumentation.hpp>
+#include <lao/linalg/dense/fixed.hpp>
+#include <lao/linalg/dense/matrix.hpp>
+#include <lao/parallel.hpp>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+namespace lao {
+namespace astro {
+
+    /// @brief state transition matrices of many objects, one row per object.
+    /// @details element (i, j) of the 6x6 matrix of each object, the partial of component i of its
+    /// state with respect to component j of its initial state, is column 6 i + j + 1. the matrix is
+    /// column-major, so each element is contiguous across the objects.
+    using StmBatch = linalg::ColMajorMatrix<double, linalg::Dynamic, 36>;
+
+    /// @brief returns count identity state transition matrices, the start of a chain of propagations.
+    inline StmBatch stmIdentity(size_t count)
+    {
+        StmBatch stm(count, 36);
+        for (size_t k = 1; k <= count; ++k)
+            for (size_t j = 1; j <= 36; ++j)
+                stm(k, j) = (j - 1) % 7 == 0 ? 1.0 : 0.0;
+        return stm;
+    }
+
+    namespace detail {
+
+        /// @brief returns c ? a : b through a bit mask.
+        /// @details unlike linalg::detail::select, the mask comes from a select of constants rather
+        /// than arithmetic on the bool, which compilers vectorize on every target with 64-bit lane
+        /// compares, SSE4.2 and up.
+        inline double blend(bool c, double a, double b) noexcept
+        {
+            const std::uint64_t mask = c ? ~std::uint64_t(0) : std::uint64_t(0);
+            const std::uint64_t ua = std::bit_cast<std::uint64_t>(a);
+            const std::uint64_t ub = std::bit_cast<std::uint64_t>(b);
+            return std::bit_cast<double>(ub ^ ((ua ^ ub) & mask));
+        }
+
+        /// @brief number of objects solved in lockstep, within one chunk.
+        inline constexpr size_t PROPAGATION_LANES = 256;
+
+        /// @brief returns the stumpff function c_N(psi) = sum (-psi)^k / (2 k + N)! from its series,
+        /// to within 1e-17 for |psi| <= 1.
+        template <int N>
+        inline double stumpffSeries(double psi) noexcept
+        {
+            constexpr double factorial = N == 2 ? 2.0 : N == 3 ? 6.0 : N == 4 ? 24.0 : 120.0;
+            double c = 1.0;
+            for (int k = 9; k >= 1; --k)
+                c = 1.0 - psi * c / static_cast<double>((2 * k + N - 1) * (2 * k + N));
+            return c / factorial;
+        }
+
+        /// @brief computes the stumpff functions c2 and c3 of psi, with no branches.
+        /// @details c2 = (1 - cos y) / psi and c3 = (y - sin y) / (y psi) with y = sqrt(psi) for psi > 0,
+        /// their hyperbolic forms for psi < 0, and the series for |psi| <= 1, where those cancel. all
+        /// three are computed and the right one selected by a bit mask, since the compiler would
+        /// otherwise sink each form into a branch of its own.
+        inline void stumpff(double psi, double& c2, double& c3) noexcept
+        {
+            const double y = std::sqrt(std::abs(psi));
+            double s, c, sh, ch;
+            sinCos(y, s, c);
+            coshSinh(y, ch, sh);
+            const double cosine = blend(psi > 0.0, c, ch);
+            const double sine = blend(psi > 0.0, s, sh);
+            const bool small = std::abs(psi) <= 1.0;
+            c2 = blend(small, stumpffSeries<2>(psi), (1.0 - cosine) / psi);
+            c3 = blend(small, stumpffSeries<3>(psi), (y - sine) / (y * psi));
+        }
+
+        /// @brief computes the stumpff functions c2 to c5 of psi, see stumpff.
+        inline void stumpff(double psi, double& c2, double& c3, double& c4, double& c5) noexcept
+        {
+            stumpff(psi, c2, c3);
+            const bool small = std::abs(psi) <= 1.0;
+            c4 = blend(small, stumpffSeries<4>(psi), (0.5 - c2) / psi);
+            c5 = blend(small, stumpffSeries<5>(psi), (1.0 / 6.0 - c3) / psi);
+        }
+
+        /// @brief a value and its gradient with respect to the six components of an initial state.
+        struct StateDual {
+            double v;
+            double d[6];
+        };
+
+        inline StateDual operator+(const StateDual& a, const StateDual& b) noexcept
+        {
+            StateDual r { a.v + b.v, {} };
+            for (int j = 0; j < 6; ++j)
+                r.d[j] = a.d[j] + b.d[j];
+            return r;
+        }
+
+        inline StateDual operator-(double a, const StateDual& b) noexcept
+        {
+            StateDual r { a - b.v, {} };
+            for (int j = 0; j < 6; ++j)
+                r.d[j] = -b.d[j];
+            return r;
+        }
+
+        inline StateDual operator*(const StateDual& a, const StateDual& b) noexcept
+        {
+            StateDual r { a.v * b.v, {} };
+            for (int j = 0; j < 6; ++j)
+                r.d[j] = a.d[j] * b.v + a.v * b.d[j];
+            return r;
+        }
+
+        inline StateDual operator*(double a, const StateDual& b) noexcept
+        {
+            StateDual r { a * b.v, {} };
+            for (int j = 0; j < 6; ++j)
+                r.d[j] = a * b.d[j];
+            return r;
+        }
+
+        inline StateDual operator/(const StateDual& a, const StateDual& b) noexcept
+        {
+            const double inv = 1.0 / b.v;
+            StateDual r { a.v * inv, {} };
+            for (int j = 0; j < 6; ++j)
+                r.d[j] = (a.d[j] - r.v * b.d[j]) * inv;
+            return r;
+        }
+
+        inline StateDual operator/(const StateDual& a, double b) noexcept
+        {
+            return (1.0 / b) * a;
+        }
+
+        /// @brief computes the state from the initial state and the universal functions U0, U1 and
+        /// U2 of the solution, through the lagrange coefficients f, g and their rates.
+        /// @details generic so the same code gives the state for T = double, and its gradient, a row
+        /// of the state transition matrix, for T = StateDual.
+        template <typename T>
+        inline void lagrangeState(const T (&r0)[3], const T (&v0)[3], const T& r0n, const T& sigma0, const T& U0, const T& U1,
+            const T& U2, double sqrt_mu, T (&state)[6]) noexcept
+        {
+            const T r = r0n * U0 + sigma0 * U1 + U2;
+            const T f = 1.0 - U2 / r0n;
+            const T g = (r0n * U1 + sigma0 * U2) / sqrt_mu;
+            const T df = (-sqrt_mu) * U1 / (r * r0n);
+            const T dg = 1.0 - U2 / r;
+            for (int i = 0; i < 3; ++i) {
+                state[i] = f * r0[i] + g * v0[i];
+                state[i + 3] = df * r0[i] + dg * v0[i];
+            }
+        }
+
+        /// @brief computes the state transition matrix phi, row-major, of one object from its
+        /// initial state x, mu and the converged solution chi.
+        /// @details the gradient of chi follows from the universal kepler equation held at the
+        /// solution, and those of U0, U1 and U2 from their partials in chi and alpha,
+        /// dU_n/dchi = U_(n-1) and dU_n/dalpha = -(chi U_(n+1) - n U_(n+2)) / 2.
+        inline void stateTransition(const double (&x)[6], double mu, double chi, double (&phi)[36]) noexcept
+        {
+            const double sqrt_mu = std::sqrt(mu);
+            const double r0n = std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+            const double sigma0 = (x[0] * x[3] + x[1] * x[4] + x[2] * x[5]) / sqrt_mu;
+            const double alpha = 2.0 / r0n - (x[3] * x[3] + x[4] * x[4] + x[5] * x[5]) / mu;
+
+            const double psi = alpha * chi * chi;
+            double c2, c3, c4, c5;
+            stumpff(psi, c2, c3, c4, c5);
+            const double chi2 = chi * chi;
+            const double U0 = 1.0 - psi * c2;
+            const double U1 = chi * (1.0 - psi * c3);
+            const double U2 = chi2 * c2;
+            const double U3 = chi2 * chi * c3;
+            const double U4 = chi2 * chi2 * c4;
+            const double U5 = chi2 * chi2 * chi * c5;
+            const double r = r0n * U0 + sigma0 * U1 + U2;
+
+            const double dU0_dalpha = -0.5 * chi * U1;
+            const double dU1_dalpha = -0.5 * (chi * U2 - U3);
+            const double dU2_dalpha = -0.5 * (chi * U3 - 2.0 * U4);
+            const double dU3_dalpha = -0.5 * (chi * U4 - 3.0 * U5);
+
+            StateDual r0[3], v0[3];
+            StateDual r0n_d { r0n, {} }, sigma0_d { sigma0, {} };
+            double grad_alpha[6], grad_chi[6];
+            for (int j = 0; j < 3; ++j) {
+                r0[j] = { x[j], {} };
+                v0[j] = { x[j + 3], {} };
+                r0[j].d[j] = 1.0;
+                v0[j].d[j + 3] = 1.0;
+                r0n_d.d[j] = x[j] / r0n;
+                sigma0_d.d[j] = x[j + 3] / sqrt_mu;
+                sigma0_d.d[j + 3] = x[j] / sqrt_mu;
+                grad_alpha[j] = -2.0 * x[j] / (r0n * r0n * r0n);
+                grad_alpha[j + 3] = -2.0 * x[j + 3] / mu;
+            }
+            // the kepler equation r0n U1 + sigma0 U2 + U3 = sqrt(mu) dt, whose partial in chi is r.
+            const double dkepler_dalpha = r0n * dU1_dalpha + sigma0 * dU2_dalpha + dU3_dalpha;
+            for (int j = 0; j < 6; ++j)
+                grad_chi[j] = -(U1 * r0n_d.d[j] + U2 * sigma0_d.d[j] + dkepler_dalpha * grad_alpha[j]) / r;
+
+            StateDual U0_d { U0, {} }, U1_d { U1, {} }, U2_d { U2, {} };
+            for (int j = 0; j < 6; ++j) {
+                U0_d.d[j] = -alpha * U1 * grad_chi[j] + dU0_dalpha * grad_alpha[j];
+                U1_d.d[j] = U0 * grad_chi[j] + dU1_dalpha * grad_alpha[j];
+                U2_d.d[j] = U1 * grad_chi[j] + dU2_dalpha * grad_alpha[j];
+            }
+
+            StateDual state[6];
+            lagrangeState(r0, v0, r0n_d, sigma0_d, U0_d, U1_d, U2_d, sqrt_mu, state);
+            for (int i = 0; i < 6; ++i)
+                for (int j = 0; j < 6; ++j)
+                    phi[6 * i + j] = state[i].d[j];
+        }
+
+        /// @brief propagates objects [first, first + n) of propagateKeplerBatch, n <= PROPAGATION_LANES.
+        /// @returns the number of objects which failed, see propagateKeplerBatch.
+        inline size_t propagateChunk(const double* states, size_t stride, const double* mu, size_t mu_stride, double dt, double* out,
+            size_t out_stride, double* stm, size_t stm_stride, size_t first, size_t n)
+        {
+            // relative change in chi below which an object has converged, after which the cubic
+            // convergence of laguerre-conway leaves it at round-off.
+            constexpr double tolerance = 1e-13;
+            constexpr size_t max_steps = 50;
+
+            double r0n[PROPAGATION_LANES], sigma0[PROPAGATION_LANES], alpha[PROPAGATION_LANES], sqrt_mu_dt[PROPAGATION_LANES];
+            double chi[PROPAGATION_LANES], change[PROPAGATION_LANES];
+            for (size_t k = 0; k < n; ++k) {
+                const double* x = states + first + k;
+                const double m = mu[(first + k) * mu_stride];
+                const double sqrt_mu = std::sqrt(m);
+                r0n[k] = std::sqrt(x[0] * x[0] + x[stride] * x[stride] + x[2 * stride] * x[2 * stride]);
+                const double rv = x[0] * x[3 * stride] + x[stride] * x[4 * stride] + x[2 * stride] * x[5 * stride];
+                const double v2 = x[3 * stride] * x[3 * stride] + x[4 * stride] * x[4 * stride] + x[5 * stride] * x[5 * stride];
+                sigma0[k] = rv / sqrt_mu;
+                alpha[k] = 2.0 / r0n[k] - v2 / m;
+                sqrt_mu_dt[k] = sqrt_mu * dt;
+
+                // starting values of vallado, algorithm 8, once per object so left scalar.
+                if (alpha[k] > 1e-12) {
+                    chi[k] = sqrt_mu * dt * alpha[k];
+                } else if (alpha[k] < -1e-12 && dt != 0.0) {
+                    const double a = 1.0 / alpha[k];
+                    const double sign = std::copysign(1.0, dt);
+                    chi[k] = sign * std::sqrt(-a) * std::log((-2.0 * m * alpha[k] * dt) / (rv + sign * std::sqrt(-m * a) * (1.0 - r0n[k] * alpha[k])));
+                } else {
+                    chi[k] = sqrt_mu * dt / r0n[k];
+                }
+            }
+
+            size_t steps = 0;
+            while (steps < max_steps) {
+                ++steps;
+                size_t unconverged = 0;
+                for (size_t k = 0; k < n; ++k) {
+                    const double x = chi[k];
+                    const double psi = alpha[k] * x * x;
+                    double c2, c3;
+                    stumpff(psi, c2, c3);
+                    const double U0 = 1.0 - psi * c2;
+                    const double U1 = x * (1.0 - psi * c3);
+                    const double U2 = x * x * c2;
+                    const double U3 = x * x * x * c3;
+                    // the universal kepler equation and its first two derivatives in chi.
+                    const double F = r0n[k] * U1 + sigma0[k] * U2 + U3 - sqrt_mu_dt[k];
+                    const double dF = r0n[k] * U0 + sigma0[k] * U1 + U2;
+                    const double d2F = sigma0[k] * U0 + (1.0 - alpha[k] * r0n[k]) * U1;
+                    // laguerre-conway with n = 5, where dF = r > 0.
+                    const double delta = 5.0 * F / (dF + std::sqrt(std::abs(16.0 * dF * dF - 20.0 * F * d2F)));
+                    chi[k] = x - delta;
+                    // written so that a NaN, e.g. from the overflow of cosh beyond |y| ~ 710, counts
+                    // as not converged.
+                    change[k] = std::abs(delta) / (std::abs(x) + 1.0);
+                    unconverged += !(change[k] <= tolerance);
+                }
+                if (unconverged == 0)
+                    break;
+            }
+
+            // objects which have not converged within max_steps, or whose state is not finite, are
+            // flagged by a NaN state and transition matrix rather than a wrong one.
+            bool failed[PROPAGATION_LANES];
+            size_t failures = 0;
+            for (size_t k = 0; k < n; ++k) {
+                failed[k] = !(change[k] <= tolerance) || !std::isfinite(chi[k]);
+                instrumentation::record_solve(instrumentation::Solver::propagation, steps, change[k], !failed[k]);
+            }
+
+            if (stm != nullptr) {
+                for (size_t k = 0; k < n; ++k) {
+                    double x[6], phi[36], chained[36];
+                    for (size_t i = 0; i < 6; ++i)
+                        x[i] = states[first + k + i * stride];
+                    stateTransition(x, mu[(first + k) * mu_stride], chi[k], phi);
+                    double* previous = stm + first + k;
+                    linalg::detail::fixed_gemm<6, 6, 6>(phi, 6, 1, previous, 6 * stm_stride, stm_stride, chained, 6, 1);
+                    for (size_t e = 0; e < 36; ++e)
+                        previous[e * stm_stride] = chained[e];
+                }
+            }
+
+            for (size_t k = 0; k < n; ++k) {
+                const double psi = alpha[k] * chi[k] * chi[k];
+                double c2, c3;
+                stumpff(psi, c2, c3);
+                const double U0 = 1.0 - psi * c2;
+                const double U1 = chi[k] * (1.0 - psi * c3);
+                const double U2 = chi[k] * chi[k] * c2;
+
+                const double* x = states + first + k;
+                const double r0[3] = { x[0], x[stride], x[2 * stride] };
+                const double v0[3] = { x[3 * stride], x[4 * stride], x[5 * stride] };
+                double state[6];
+                lagrangeState(r0, v0, r0n[k], sigma0[k], U0, U1, U2, std::sqrt(mu[(first + k) * mu_stride]), state);
+                bool finite = !failed[k];
+                for (size_t i = 0; i < 6; ++i)
+                    finite = finite && std::isfinite(state[i]);
+                for (size_t i = 0; i < 6; ++i)
+                    out[first + k + i * out_stride] = finite ? state[i] : std::numeric_limits<double>::quiet_NaN();
+                if (!finite && stm != nullptr)
+                    for (size_t e = 0; e < 36; ++e)
+                        stm[first + k + e * stm_stride] = std::numeric_limits<double>::quiet_NaN();
+                failures += !finite;
+            }
+            return failures;
+        }
+
+    }; // namespace detail
+
+    /// @brief propagates the states of many objects by dt on their two-body orbits, in parallel.
+    /// @details object k reads x, y, z, vx, vy, vz [m, m/s] from states[k], states[k + stride], ...,
+    /// states[k + 5 * stride] and writes them to out in the same way, which may be states itself with
+    /// the same stride, so e.g. the data and rows of a StateBatch, or a body of an EphemerisTensor,
+    /// are propagated in place.
+    /// @param states initial states of count objects.
+    /// @param stride the distance between the components of states.
+    /// @param count number of objects.
+    /// @param mu standard gravitational parameter [m^3/s^2] of the attracting body of object k at mu[k *
+    /// mu_stride], so a mu_stride of 0 gives every object the same.
+    /// @param mu_stride the distance between the mu of consecutive objects.
+    /// @param dt time to propagate by [s], negative to propagate backwards.
+    /// @param out propagated states.
+    /// @param out_stride the distance between the components of out.
+    /// @param stm if not null, the 36 elements of the state transition matrix of object k, laid out as
+    /// in StmBatch a stm_stride apart, are multiplied on the left by the transition matrix over dt.
+    /// @param stm_stride the distance between the elements of stm.
+    /// @returns the number of objects which failed: those whose solution did not converge within 50
+    /// steps, or whose propagated state is not finite, e.g. a strongly hyperbolic orbit over a long
+    /// dt. their state, and transition matrix if given, are set to NaN, and each object is recorded
+    /// through instrumentation::record_solve as solved or not.
+    inline size_t propagateKeplerBatch(const double* states, size_t stride, size_t count, const double* mu, size_t mu_stride, double dt,
+        double* out, size_t out_stride, double* stm = nullptr, size_t stm_stride = 0)
+    {
+        instrumentation::ScopedTimer timer(instrumentation::Kernel::propagation);
+        std::atomic<size_t> failures { 0 };
+        lao::parallel_for(0, count, detail::PROPAGATION_LANES, [&](size_t begin, size_t end) {
+            size_t failed = 0;
+            for (size_t first = begin; first < end; first += detail::PROPAGATION_LANES)
+                failed += detail::propagateChunk(states, stride, mu, mu_stride, dt, out, out_stride, stm, stm_stride, first,
+                    std::min(detail::PROPAGATION_LANES, end - first));
+            failures.fetch_add(failed, std::memory_order_relaxed);
+        });
+        return failures.load(std::memory_order_relaxed);
+    }
+
+    /// @brief propagates the states of many objects by dt on their two-body orbits, see
+    /// propagateKeplerBatch.
+    /// @param states initial states, one row per object.
+    /// @param mu standard gravitational parameters [m^3/s^2], one per object, or one for all.
+    /// @param dt time to propagate by [s].
+    /// @param out resized to the propagated states. may be states itself.
+    /// @returns the number of objects which failed, see propagateKeplerBatch.
+    inline size_t propagateKepler(const StateBatch& states, std::span<const double> mu, double dt, StateBatch& out)
+    {
+        if (mu.size() != states.rows() && mu.size() != 1)
+            throw std::invalid_argument("mu must have one value per state or a single value");
+        if (&out != &states)
+            out.resize(states.rows(), 6);
+        return propagateKeplerBatch(states.data(), states.rows(), states.rows(), mu.data(), mu.size() == 1 ? 0 : 1, dt, out.data(), out.rows());
+    }
+
+    /// @brief propagates the states of many objects about one attracting body by dt, see
+    /// propagateKeplerBatch.
+    /// @param states initial states, one row per object.
+    /// @param mu standard gravitational parameter [m^3/s^2].
+    /// @param dt time to propagate by [s].
+    /// @param out resized to the propagated states. may be states itself.
+    /// @returns the number of objects which failed, see propagateKeplerBatch.
+    inline size_t propagateKepler(const StateBatch& states, double mu, double dt, StateBatch& out)
+    {
+        return propagateKepler(states, std::span<const double>(&mu, 1), dt, out);
+    }
+
+    /// @brief propagates the states of many objects by dt and chains their state transition
+    /// matrices, see propagateKeplerBatch.
+    /// @param states initial states, one row per object.
+    /// @param mu standard gravitational parameters [m^3/s^2], one per object, or one for all.
+    /// @param dt time to propagate by [s].
+    /// @param out resized to the propagated states. may be states itself.
+    /// @param stm one row per object, the transition matrices up to states on entry, e.g. from
+    /// stmIdentity, and up to out on return.
+    /// @returns the number of objects which failed, see propagateKeplerBatch.
+    inline size_t propagateKepler(const StateBatch& states, std::span<const double> mu, double dt, StateBatch& out, StmBatch& stm)
+    {
+        if (mu.size() != states.rows() && mu.size() != 1)
+            throw std::invalid_argument("mu must have one value per state or a single value");
+        if (stm.rows() != states.rows())
+            throw std::invalid_argument("state transition matrices must have one row per state");
+        if (&out != &states)
+            out.resize(states.rows(), 6);
+        return propagateKeplerBatch(states.data(), states.rows(), states.rows(), mu.data(), mu.size() == 1 ? 0 : 1, dt, out.data(), out.rows(),
+            stm.data(), stm.rows());
+    }
+
+    /// @brief propagates the states of many objects about one attracting body by dt and chains their
+    /// state transition matrices, see propagateKeplerBatch.
+    /// @param states initial states, one row per object.
+    /// @param mu standard gravitational parameter [m^3/s^2].
+    /// @param dt time to propagate by [s].
+    /// @param out resized to the propagated states. may be states itself.
+    /// @param stm one row per object, the transition matrices up to states on entry and up to out on
+    /// return.
+    /// @returns the number of objects which failed, see propagateKeplerBatch.
+    inline size_t propagateKepler(const StateBatch& states, double mu, double dt, StateBatch& out, StmBatch& stm)
+    {
+        return propagateKepler(states, std::span<const double>(&mu, 1), dt, out, stm);
+    }
+
+}; // namespace astro
+}; // namespace lao
+
+#endif // LAO_ASTRO_CORE_PROPAGATION_H_
@@ -0,0 +1,120 @@
+/// screening.hpp implements the search for the epochs at which two bodies come within a distance of
+/// each other, over many epochs, in two passes of mixed precision.
+///
+/// every epoch is first screened with the single precision ephBatch of both bodies, which runs at
+/// twice the SIMD width of double, against the threshold widened by the error bound of float, so
+/// no epoch within the threshold is missed. only the candidates that pass are evaluated again in
+/// double, and those within the threshold kept with their distance in double, so the result is
+/// exactly that of a pass in double at a fraction of its cost wherever few epochs are close. the
+/// epochs are split into chunks which run on the ThreadPool.
+
+#ifndef LAO_ASTRO_CORE_SCREENING_H_
+#define LAO_ASTRO_CORE_SCREENING_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <lao/astro/body/base.hpp>
+#include <lao/astro/body/jpl_low_precision.hpp>
+#include <lao/parallel.hpp>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace lao {
+namespace astro {
+
+    /// @brief an epoch at which two bodies are within the threshold of closeApproaches.
+    struct CloseApproach {
+        // the epoch (MJD2000)
+        double mjd2000;
+        // distance between the bodies at the epoch, from their ephemerides in double [m]
+        double distance;
+    };
+
+    namespace detail {
+
+        /// @brief number of epochs of each task of closeApproaches.
+        inline constexpr size_t SCREENING_CHUNK = 1024;
+
+    }; // namespace detail
+
+    /// @brief finds the epochs at which two bodies are within a distance of each other.
+    /// @details the epochs are screened in float, see screening.hpp. an epoch is a candidate where
+    /// the distance in float is within threshold + (float_error + 2^-22) (r1 + r2), with r1 and r2
+    /// the distances of the bodies from their attracting body, the second term bounding the error
+    /// of the float states and of the rounding of their difference. float_error must bound the
+    /// error of the float ephBatch of both bodies relative to their double one, as the default
+    /// JPLLP_FLOAT_ERROR does for JPLLP, while 2^-24 is enough for bodies which round their states
+    /// from double, as the default of Base::ephBatch does.
+    /// @param first a body.
+    /// @param second another body, with the same attracting body.
+    /// @param mjd2000 the epochs as MJD2000.
+    /// @param threshold the distance within which the bodies are close [m].
+    /// @param float_error bound on the relative error of the float states of the bodies.
+    /// @param pool the pool the chunks run on.
+    /// @returns the epochs within threshold, in the order given.
+    inline std::vector<CloseApproach> closeApproaches(const Base& first, const Base& second, std::span<const double> mjd2000, double threshold,
+        double float_error = JPLLP_FLOAT_ERROR, ThreadPool& pool = ThreadPool::instance())
+    {
+        if (first.muCentralBody() != second.muCentralBody())
+            throw std::invalid_argument("Bodies must have the same attracting body");
+        if (!(threshold >= 0.0))
+            throw std::invalid_argument("Threshold must be non-negative");
+
+        const size_t chunks = (mjd2000.size() + detail::SCREENING_CHUNK - 1) / detail::SCREENING_CHUNK;
+        std::vector<std::vector<CloseApproach>> found(chunks);
+        const float limit = static_cast<float>(threshold);
+        const float margin = static_cast<float>(float_error + std::ldexp(1.0, -22));
+        pool.parallel_for(0, chunks, 1, [&](size_t chunk_begin, size_t chunk_end) {
+            std::vector<float> from(6 * detail::SCREENING_CHUNK);
+            std::vector<float> to(6 * detail::SCREENING_CHUNK);
+            std::vector<float> slack(detail::SCREENING_CHUNK);
+            std::vector<double> candidates;
+            StateBatch exact_from;
+            StateBatch exact_to;
+            for (size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+                const size_t offset = chunk * detail::SCREENING_CHUNK;
+                const size_t n = std::min(detail::SCREENING_CHUNK, mjd2000.size() - offset);
+                const std::span<const double> epochs = mjd2000.subspan(offset, n);
+                first.ephBatch(epochs, from.data(), n);
+                second.ephBatch(epochs, to.data(), n);
+
+                // the screening pass, in float, as a loop with no branches which is vectorized, and
+                // then a scan for the candidates.
+                for (size_t k = 0; k < n; ++k) {
+                    const float x1 = from[k], y1 = from[n + k], z1 = from[2 * n + k];
+                    const float x2 = to[k], y2 = to[n + k], z2 = to[2 * n + k];
+                    const float dx = x1 - x2, dy = y1 - y2, dz = z1 - z2;
+                    const float r = std::sqrt(x1 * x1 + y1 * y1 + z1 * z1) + std::sqrt(x2 * x2 + y2 * y2 + z2 * z2);
+                    const float widened = limit + margin * r;
+                    slack[k] = widened * widened - (dx * dx + dy * dy + dz * dz);
+                }
+                candidates.clear();
+                for (size_t k = 0; k < n; ++k)
+                    if (slack[k] >= 0.0f)
+                        candidates.push_back(epochs[k]);
+                if (candidates.empty())
+                    continue;
+
+                // the candidates again, in double.
+                first.ephBatch(candidates, exact_from);
+                second.ephBatch(candidates, exact_to);
+                for (size_t k = 1; k < candidates.size() + 1; ++k) {
+                    const double distance = std::hypot(exact_from(k, 1) - exact_to(k, 1), exact_from(k, 2) - exact_to(k, 2), exact_from(k, 3) - exact_to(k, 3));
+                    if (distance <= threshold)
+                        found[chunk].push_back({ candidates[k - 1], distance });
+                }
+            }
+        });
+
+        std::vector<CloseApproach> approaches;
+        for (const auto& chunk : found)
+            approaches.insert(approaches.end(), chunk.begin(), chunk.end());
+        return approaches;
+    }
+
+}; // namespace astro
+}; // namespace lao
+
+#endif // LAO_ASTRO_CORE_SCREENING_H_
@@ -1,11 +1,20 @@
 /// solving the newton-raphson method, or newton's method for finding approximations for roots
 /// https://en.wikipedia.org/wiki/Newton%27s_method
+///
+/// and its higher order members, halley's and householder's methods, which converge cubically and
+/// quartically where the second and third derivatives come at little extra cost, e.g. for lambert's
+/// problem. https://en.wikipedia.org/wiki/Householder%27s_method
+///
+/// each solve records its iterations and its last relative step as the residual, see
+/// lao/instrumentation.hpp.
 
 #ifndef LAO_ASTRO_MATH_NEWTON_RAPHSON_H_
 #define LAO_ASTRO_MATH_NEWTON_RAPHSON_H_
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <lao/instrumentation.hpp>
 
 namespace lao {
 namespace astro {
@@ -21,10 +30,62 @@ namespace astro {
     inline double newtonRaphson(start& x, func F, deriv dF, double max_iterations, const double& accuracy)
     {
         start term;
+        double step;
+        size_t iterations = 0;
         do {
             term = F(x) / dF(x);
             x -= term;
-        } while ((std::fabs(term / std::max(std::fabs(x), 1.0)) > accuracy) && (--max_iterations));
+            ++iterations;
+            step = std::fabs(term / std::max<start>(std::fabs(x), start(1)));
+        } while ((step > accuracy) && (--max_iterations));
+        instrumentation::record_solve(instrumentation::Solver::newton, iterations, step, step <= accuracy);
+        return max_iterations;
+    };
+
+    /// @brief generically solving halley's method for finding approximations for roots.
+    /// @param x starting point.
+    /// @param F function returning the value and its first two derivatives at x, as F(x)[0] to F(x)[2].
+    /// @param max_iterations maximum number of loop iterations.
+    /// @param accuracy accuracy.
+    /// @returns the iterations left.
+    template <class start, class func>
+    inline double halley(start& x, func F, double max_iterations, const double& accuracy)
+    {
+        start term;
+        double step;
+        size_t iterations = 0;
+        do {
+            const auto f = F(x);
+            term = f[0] * f[1] / (f[1] * f[1] - f[0] * f[2] / 2);
+            x -= term;
+            ++iterations;
+            step = std::fabs(term / std::max<start>(std::fabs(x), start(1)));
+        } while ((step > accuracy) && (--max_iterations));
+        instrumentation::record_solve(instrumentation::Solver::halley, iterations, step, step <= accuracy);
+        return max_iterations;
+    };
+
+    /// @brief generically solving householder's method of order 3 for finding approximations for roots.
+    /// @param x starting point.
+    /// @param F function returning the value and its first three derivatives at x, as F(x)[0] to F(x)[3].
+    /// @param max_iterations maximum number of loop iterations.
+    /// @param accuracy accuracy.
+    /// @returns the iterations left.
+    template <class start, class func>
+    inline double householder(start& x, func F, double max_iterations, const double& accuracy)
+    {
+        start term;
+        double step;
+        size_t iterations = 0;
+        do {
+            const auto f = F(x);
+            const start df2 = f[1] * f[1];
+            term = f[0] * (df2 - f[0] * f[2] / 2) / (f[1] * (df2 - f[0] * f[2]) + f[3] * f[0] * f[0] / 6);
+            x -= term;
+            ++iterations;
+            step = std::fabs(term / std::max<start>(std::fabs(x), start(1)));
+        } while ((step > accuracy) && (--max_iterations));
+        instrumentation::record_solve(instrumentation::Solver::householder, iterations, step, step <= accuracy);
         return max_iterations;
     };
 
@@ -0,0 +1,205 @@
+/// sincos.hpp implements the sine and cosine of an angle computed together, with no branches or
+/// library calls, so a loop over arrays of angles is vectorized by the compiler where calls to
+/// std::sin and std::cos keep it scalar.
+///
+/// The angle is reduced by the nearest multiple of pi/2 to [-pi/4, pi/4], where the fdlibm kernel
+/// polynomials are evaluated, and the quadrant then swaps and negates the two through bit masks.
+/// pi/2 is split in two so the reduction is exact for |x| < 2^20 pi/2, beyond which the results
+/// lose accuracy gradually. Within it they agree with std::sin and std::cos to about 1 ulp.
+///
+/// The float kernel is the same in single precision, with the shorter cephes polynomials and pi/2
+/// split in three, and is accurate to about 1 ulp of float for |x| < 8192. A vector register holds
+/// twice as many floats as doubles, so a loop over it evaluates twice the angles per instruction.
+///
+/// coshSinh is the hyperbolic counterpart, built the same way on an exponential reduced by the
+/// nearest multiple of ln 2 to [-ln 2 / 2, ln 2 / 2], with the power of two set in the exponent bits.
+
+#ifndef LAO_ASTRO_MATH_SINCOS_H_
+#define LAO_ASTRO_MATH_SINCOS_H_
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace lao {
+namespace astro {
+
+    namespace detail {
+
+        /// @brief 1.5 * 2^52, adding and subtracting it rounds a double with |x| < 2^51 to the
+        /// nearest integer, and leaves that integer in the low bits of the sum.
+        inline constexpr double ROUND_SHIFT = 6755399441055744.0;
+
+        /// @brief pi/2 split into its leading 33 bits and the rest, so k * PIO2_HI is exact for
+        /// |k| < 2^20. from fdlibm.
+        inline constexpr double PIO2_HI = 1.57079632673412561417e+00;
+        inline constexpr double PIO2_LO = 6.07710050650619224932e-11;
+
+        /// @brief 1.5 * 2^23, adding and subtracting it rounds a float with |x| < 2^22 to the nearest
+        /// integer, and leaves that integer in the low bits of the sum.
+        inline constexpr float ROUND_SHIFT_F = 12582912.0f;
+
+        /// @brief pi/2 split into three floats, the first two short enough that k * PIO2_F_HI and
+        /// k * PIO2_F_MID are exact for |k| < 2^13. from cephes.
+        inline constexpr float PIO2_F_HI = 1.5703125f;
+        inline constexpr float PIO2_F_MID = 4.837512969970703125e-4f;
+        inline constexpr float PIO2_F_LO = 7.54978995489188216e-8f;
+
+        /// @brief returns x - k pi/2 for an integral k, with the products of the split pi/2 exact.
+        inline double subtractPio2(double x, double k) noexcept
+        {
+            return (x - k * PIO2_HI) - k * PIO2_LO;
+        }
+
+        inline float subtractPio2(float x, float k) noexcept
+        {
+            return ((x - k * PIO2_F_HI) - k * PIO2_F_MID) - k * PIO2_F_LO;
+        }
+
+        /// @brief returns k pi/2 for an integral k, rounded once from the split pi/2.
+        inline double multiplePio2(double k) noexcept
+        {
+            return k * PIO2_HI + k * PIO2_LO;
+        }
+
+        inline float multiplePio2(float k) noexcept
+        {
+            return k * PIO2_F_HI + (k * PIO2_F_MID + k * PIO2_F_LO);
+        }
+
+        /// @brief ln 2 split into its leading 32 bits and the rest, so k * LN2_HI is exact for
+        /// |k| < 2^20. from fdlibm.
+        inline constexpr double LN2_HI = 6.93147180369123816490e-01;
+        inline constexpr double LN2_LO = 1.90821492927058770002e-10;
+
+        /// @brief returns e^x for |x| <= 709, with no branches or library calls, to about 1 ulp.
+        inline double expKernel(double x) noexcept
+        {
+            constexpr double inv_ln2 = 1.44269504088896338700e+00;
+            // x = k ln 2 + r, with k left in the low bits of the shifted sum.
+            const double shifted = x * inv_ln2 + ROUND_SHIFT;
+            const double k = shifted - ROUND_SHIFT;
+            const double r = (x - k * LN2_HI) - k * LN2_LO;
+            // taylor series of e^r to r^13, whose remainder is below 1e-17 for |r| <= ln 2 / 2.
+            double p = 1.0;
+            for (int n = 13; n >= 1; --n)
+                p = 1.0 + r * p / static_cast<double>(n);
+            const std::int64_t ki = std::bit_cast<std::int64_t>(shifted) - std::bit_cast<std::int64_t>(ROUND_SHIFT);
+            return p * std::bit_cast<double>(static_cast<std::uint64_t>(ki + 1023) << 52);
+        }
+
+    }; // namespace detail
+
+    /// @brief computes the sine and cosine of x.
+    /// @param x angle [rad].
+    /// @param s sine of x.
+    /// @param c cosine of x.
+    inline void sinCos(double x, double& s, double& c) noexcept
+    {
+        constexpr double two_over_pi = 6.36619772367581382433e-01;
+        // fdlibm __kernel_sin and __kernel_cos, minimax on [-pi/4, pi/4].
+        constexpr double S1 = -1.66666666666666324348e-01;
+        constexpr double S2 = 8.33333333332248946124e-03;
+        constexpr double S3 = -1.98412698298579493134e-04;
+        constexpr double S4 = 2.75573137070700676789e-06;
+        constexpr double S5 = -2.50507602534068634195e-08;
+        constexpr double S6 = 1.58969099521155010221e-10;
+        constexpr double C1 = 4.16666666666666019037e-02;
+        constexpr double C2 = -1.38888888888741095749e-03;
+        constexpr double C3 = 2.48015872894767294178e-05;
+        constexpr double C4 = -2.75573143513906633035e-07;
+        constexpr double C5 = 2.08757232129817482790e-09;
+        constexpr double C6 = -1.13596475577881948265e-11;
+
+        // x = k pi/2 + r, where the low two bits of the shifted sum are the quadrant k mod 4.
+        const double shifted = x * two_over_pi + detail::ROUND_SHIFT;
+        const double k = shifted - detail::ROUND_SHIFT;
+        const std::uint64_t quadrant = std::bit_cast<std::uint64_t>(shifted);
+        const double r = (x - k * detail::PIO2_HI) - k * detail::PIO2_LO;
+
+        const double z = r * r;
+        const double sin_r = r + z * r * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+        // 1 - z/2 rounded in two parts, as in fdlibm, to keep the cosine accurate near pi/4.
+        const double hz = 0.5 * z;
+        const double w = 1.0 - hz;
+        const double cos_r = w + (((1.0 - w) - hz) + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6))))));
+
+        // quadrants 1 and 3 swap sine and cosine, the sine is negative in 2 and 3, the cosine in 1 and 2.
+        const std::uint64_t swap = std::uint64_t(0) - (quadrant & 1);
+        const std::uint64_t sin_sign = (quadrant & 2) << 62;
+        const std::uint64_t cos_sign = ((quadrant + 1) & 2) << 62;
+        const std::uint64_t us = std::bit_cast<std::uint64_t>(sin_r);
+        const std::uint64_t uc = std::bit_cast<std::uint64_t>(cos_r);
+        s = std::bit_cast<double>((us ^ ((us ^ uc) & swap)) ^ sin_sign);
+        c = std::bit_cast<double>((uc ^ ((us ^ uc) & swap)) ^ cos_sign);
+    }
+
+    /// @brief computes the sine and cosine of x in single precision.
+    /// @param x angle [rad], |x| < 8192.
+    /// @param s sine of x.
+    /// @param c cosine of x.
+    inline void sinCos(float x, float& s, float& c) noexcept
+    {
+        constexpr float two_over_pi = 6.36619772e-01f;
+        // cephes sinf and cosf, minimax on [-pi/4, pi/4].
+        constexpr float S1 = -1.6666654611e-01f;
+        constexpr float S2 = 8.3321608736e-03f;
+        constexpr float S3 = -1.9515295891e-04f;
+        constexpr float C1 = 4.166664568298827e-02f;
+        constexpr float C2 = -1.388731625493765e-03f;
+        constexpr float C3 = 2.443315711809948e-05f;
+
+        // x = k pi/2 + r, where the low two bits of the shifted sum are the quadrant k mod 4.
+        const float shifted = x * two_over_pi + detail::ROUND_SHIFT_F;
+        const float k = shifted - detail::ROUND_SHIFT_F;
+        const std::uint32_t quadrant = std::bit_cast<std::uint32_t>(shifted);
+        const float r = detail::subtractPio2(x, k);
+
+        const float z = r * r;
+        const float sin_r = r + z * r * (S1 + z * (S2 + z * S3));
+        const float cos_r = (1.0f - 0.5f * z) + z * z * (C1 + z * (C2 + z * C3));
+
+        // quadrants 1 and 3 swap sine and cosine, the sine is negative in 2 and 3, the cosine in 1 and 2.
+        const std::uint32_t swap = std::uint32_t(0) - (quadrant & 1);
+        const std::uint32_t sin_sign = (quadrant & 2) << 30;
+        const std::uint32_t cos_sign = ((quadrant + 1) & 2) << 30;
+        const std::uint32_t us = std::bit_cast<std::uint32_t>(sin_r);
+        const std::uint32_t uc = std::bit_cast<std::uint32_t>(cos_r);
+        s = std::bit_cast<float>((us ^ ((us ^ uc) & swap)) ^ sin_sign);
+        c = std::bit_cast<float>((uc ^ ((us ^ uc) & swap)) ^ cos_sign);
+    }
+
+    /// @brief computes the sine and cosine of x for the other floating point types, with std::sin and
+    /// std::cos, so generic code can call sinCos for any T.
+    /// @param x angle [rad].
+    /// @param s sine of x.
+    /// @param c cosine of x.
+    template <typename T>
+        requires std::is_floating_point_v<T>
+    inline void sinCos(T x, T& s, T& c) noexcept
+    {
+        s = std::sin(x);
+        c = std::cos(x);
+    }
+
+    /// @brief computes the hyperbolic cosine and sine of x.
+    /// @details as (e^x + e^-x) / 2 and (e^x - e^-x) / 2, so the sine loses relative accuracy for
+    /// |x| much below 1, where callers use series instead. |x| must be at most 709, beyond which
+    /// both overflow, and the results are meaningless rather than infinite, so the exponent takes no
+    /// branch or select which would keep loops over coshSinh from being vectorized.
+    /// @param x argument.
+    /// @param ch hyperbolic cosine of x.
+    /// @param sh hyperbolic sine of x.
+    inline void coshSinh(double x, double& ch, double& sh) noexcept
+    {
+        const double e = detail::expKernel(x);
+        const double inv_e = 1.0 / e;
+        ch = 0.5 * (e + inv_e);
+        sh = 0.5 * (e - inv_e);
+    }
+
+}; // namespace astro
+}; // namespace lao
+
+#endif // LAO_ASTRO_MATH_SINCOS_H_
@@ -1,100 +1,272 @@
+/// transforms.hpp implements the rotations between the reference frames of the astro code.
+///
+/// the axes of a sequence of euler angles are a template parameter, so the matrix of a sequence is
+/// a fixed set of products of the sines and cosines of the three angles, with no dispatch at run-time.
+
 #ifndef LAO_ASTRO_MATH_LINEAR_TRANSFORMS_H_
 #define LAO_ASTRO_MATH_LINEAR_TRANSFORMS_H_
 
 #include <cmath>
+#include <iterator>
+#include <lao/astro/math/sincos.hpp>
 #include <lao/linalg/dense/matrix.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 namespace lao {
 namespace astro {
 
+    /// @brief the axes of the three rotations of a sequence of euler angles, the six proper euler
+    /// sequences followed by the six tait-bryan sequences.
+    enum class EulerSequence {
+        XZX,
+        XYX,
+        YXY,
+        YZY,
+        ZXZ,
+        ZYZ,
+        XYZ,
+        XZY,
+        YXZ,
+        YZX,
+        ZXY,
+        ZYX
+    };
+
+    /// @brief returns the sequence of euler angles given its axes, e.g. "ZXZ".
+    /// @details throws std::invalid_argument for anything else.
+    constexpr EulerSequence eulerSequence(std::string_view axis)
+    {
+        constexpr std::string_view names[] = { "XZX", "XYX", "YXY", "YZY", "ZXZ", "ZYZ", "XYZ", "XZY", "YXZ", "YZX", "ZXY", "ZYX" };
+        for (size_t i = 0; i < std::size(names); ++i)
+            if (names[i] == axis)
+                return static_cast<EulerSequence>(i);
+        throw std::invalid_argument("Unknown axis");
+    }
+
     /// @brief builds a rotation matrix using euler angles.
-    /// @details see https://en.wikipedia.org/wiki/Euler_angles#Definition_by_intrinsic_rotations.
-    /// @param axis axis from which the 3D rotation is around
-    /// @param angles euler angles [rad,rad,rad]
-    template <typename T>
-    linalg::Matrix<T, 3, 3> rotationFromEuler(const std::string& axis, const linalg::RowVector<T, 3>& angles)
+    /// @details intrinsic rotations, R = R1(phi) R2(theta) R3(psi) for the axes 1, 2 and 3 of the
+    /// sequence, see https://en.wikipedia.org/wiki/Euler_angles#Rotation_matrix. the sine and cosine
+    /// of each angle are computed together, once, in T.
+    /// @tparam Sequence the axes of the rotations.
+    /// @param phi first angle [rad].
+    /// @param theta second angle [rad].
+    /// @param psi third angle [rad].
+    /// @param R the rotation matrix, every element of which is written.
+    template <EulerSequence Sequence, typename T>
+    void rotationFromEuler(T phi, T theta, T psi, linalg::Matrix<T, 3, 3>& R)
     {
-        T phi = angles(1, 1);
-        T theta = angles(1, 2);
-        T psi = angles(1, 3);
+        T s1, c1, s2, c2, s3, c3;
+        sinCos(phi, s1, c1);
+        sinCos(theta, s2, c2);
+        sinCos(psi, s3, c3);
 
-        linalg::Matrix<T, 3, 3> elements;
+        if constexpr (Sequence == EulerSequence::XZX) {
+            R(1, 1) = c2;
+            R(1, 2) = -c3 * s2;
+            R(1, 3) = s2 * s3;
+            R(2, 1) = c1 * s2;
+            R(2, 2) = c1 * c2 * c3 - s1 * s3;
+            R(2, 3) = -c3 * s1 - c1 * c2 * s3;
+            R(3, 1) = s1 * s2;
+            R(3, 2) = c1 * s3 + c2 * c3 * s1;
+            R(3, 3) = c1 * c3 - c2 * s1 * s3;
+        } else if constexpr (Sequence == EulerSequence::XYX) {
+            R(1, 1) = c2;
+            R(1, 2) = s2 * s3;
+            R(1, 3) = c3 * s2;
+            R(2, 1) = s1 * s2;
+            R(2, 2) = c1 * c3 - c2 * s1 * s3;
+            R(2, 3) = -c1 * s3 - c2 * c3 * s1;
+            R(3, 1) = -c1 * s2;
+            R(3, 2) = c3 * s1 + c1 * c2 * s3;
+            R(3, 3) = c1 * c2 * c3 - s1 * s3;
+        } else if constexpr (Sequence == EulerSequence::YXY) {
+            R(1, 1) = c1 * c3 - c2 * s1 * s3;
+            R(1, 2) = s1 * s2;
+            R(1, 3) = c1 * s3 + c2 * c3 * s1;
+            R(2, 1) = s2 * s3;
+            R(2, 2) = c2;
+            R(2, 3) = -c3 * s2;
+            R(3, 1) = -c3 * s1 - c1 * c2 * s3;
+            R(3, 2) = c1 * s2;
+            R(3, 3) = c1 * c2 * c3 - s1 * s3;
+        } else if constexpr (Sequence == EulerSequence::YZY) {
+            R(1, 1) = c1 * c2 * c3 - s1 * s3;
+            R(1, 2) = -c1 * s2;
+            R(1, 3) = c3 * s1 + c1 * c2 * s3;
+            R(2, 1) = c3 * s2;
+            R(2, 2) = c2;
+            R(2, 3) = s2 * s3;
+            R(3, 1) = -c1 * s3 - c2 * c3 * s1;
+            R(3, 2) = s1 * s2;
+            R(3, 3) = c1 * c3 - c2 * s1 * s3;
+        } else if constexpr (Sequence == EulerSequence::ZXZ) {
+            R(1, 1) = c1 * c3 - c2 * s1 * s3;
+            R(1, 2) = -c1 * s3 - c2 * c3 * s1;
+            R(1, 3) = s1 * s2;
+            R(2, 1) = c3 * s1 + c1 * c2 * s3;
+            R(2, 2) = c1 * c2 * c3 - s1 * s3;
+            R(2, 3) = -c1 * s2;
+            R(3, 1) = s2 * s3;
+            R(3, 2) = c3 * s2;
+            R(3, 3) = c2;
+        } else if constexpr (Sequence == EulerSequence::ZYZ) {
+            R(1, 1) = c1 * c2 * c3 - s1 * s3;
+            R(1, 2) = -c3 * s1 - c1 * c2 * s3;
+            R(1, 3) = c1 * s2;
+            R(2, 1) = c1 * s3 + c2 * c3 * s1;
+            R(2, 2) = c1 * c3 - c2 * s1 * s3;
+            R(2, 3) = s1 * s2;
+            R(3, 1) = -c3 * s2;
+            R(3, 2) = s2 * s3;
+            R(3, 3) = c2;
+        } else if constexpr (Sequence == EulerSequence::XYZ) {
+            R(1, 1) = c2 * c3;
+            R(1, 2) = -c2 * s3;
+            R(1, 3) = s2;
+            R(2, 1) = c1 * s3 + c3 * s1 * s2;
+            R(2, 2) = c1 * c3 - s1 * s2 * s3;
+            R(2, 3) = -c2 * s1;
+            R(3, 1) = s1 * s3 - c1 * c3 * s2;
+            R(3, 2) = c3 * s1 + c1 * s2 * s3;
+            R(3, 3) = c1 * c2;
+        } else if constexpr (Sequence == EulerSequence::XZY) {
+            R(1, 1) = c2 * c3;
+            R(1, 2) = -s2;
+            R(1, 3) = c2 * s3;
+            R(2, 1) = s1 * s3 + c1 * c3 * s2;
+            R(2, 2) = c1 * c2;
+            R(2, 3) = c1 * s2 * s3 - c3 * s1;
+            R(3, 1) = c3 * s1 * s2 - c1 * s3;
+            R(3, 2) = c2 * s1;
+            R(3, 3) = c1 * c3 + s1 * s2 * s3;
+        } else if constexpr (Sequence == EulerSequence::YXZ) {
+            R(1, 1) = c1 * c3 + s1 * s2 * s3;
+            R(1, 2) = c3 * s1 * s2 - c1 * s3;
+            R(1, 3) = c2 * s1;
+            R(2, 1) = c2 * s3;
+            R(2, 2) = c2 * c3;
+            R(2, 3) = -s2;
+            R(3, 1) = c1 * s2 * s3 - c3 * s1;
+            R(3, 2) = s1 * s3 + c1 * c3 * s2;
+            R(3, 3) = c1 * c2;
+        } else if constexpr (Sequence == EulerSequence::YZX) {
+            R(1, 1) = c1 * c2;
+            R(1, 2) = s1 * s3 - c1 * c3 * s2;
+            R(1, 3) = c3 * s1 + c1 * s2 * s3;
+            R(2, 1) = s2;
+            R(2, 2) = c2 * c3;
+            R(2, 3) = -c2 * s3;
+            R(3, 1) = -c2 * s1;
+            R(3, 2) = c1 * s3 + c3 * s1 * s2;
+            R(3, 3) = c1 * c3 - s1 * s2 * s3;
+        } else if constexpr (Sequence == EulerSequence::ZXY) {
+            R(1, 1) = c1 * c3 - s1 * s2 * s3;
+            R(1, 2) = -c2 * s1;
+            R(1, 3) = c1 * s3 + c3 * s1 * s2;
+            R(2, 1) = c3 * s1 + c1 * s2 * s3;
+            R(2, 2) = c1 * c2;
+            R(2, 3) = s1 * s3 - c1 * c3 * s2;
+            R(3, 1) = -c2 * s3;
+            R(3, 2) = s2;
+            R(3, 3) = c2 * c3;
+        } else if constexpr (Sequence == EulerSequence::ZYX) {
+            R(1, 1) = c1 * c2;
+            R(1, 2) = c1 * s2 * s3 - c3 * s1;
+            R(1, 3) = s1 * s3 + c1 * c3 * s2;
+            R(2, 1) = c2 * s1;
+            R(2, 2) = c1 * c3 + s1 * s2 * s3;
+            R(2, 3) = c3 * s1 * s2 - c1 * s3;
+            R(3, 1) = -s2;
+            R(3, 2) = c2 * s3;
+            R(3, 3) = c2 * c3;
+        }
+    }
+
+    /// @brief builds a rotation matrix using euler angles.
+    /// @tparam Sequence the axes of the rotations.
+    /// @param phi first angle [rad].
+    /// @param theta second angle [rad].
+    /// @param psi third angle [rad].
+    template <EulerSequence Sequence, typename T>
+    linalg::Matrix<T, 3, 3> rotationFromEuler(T phi, T theta, T psi)
+    {
+        linalg::Matrix<T, 3, 3> R(linalg::filltype::none);
+        rotationFromEuler<Sequence>(phi, theta, psi, R);
+        return R;
+    }
+
+    /// @brief builds a rotation matrix using euler angles.
+    /// @tparam Sequence the axes of the rotations.
+    /// @param angles euler angles [rad,rad,rad]
+    /// @param R the rotation matrix, every element of which is written.
+    template <EulerSequence Sequence, typename T>
+    void rotationFromEuler(const linalg::RowVector<T, 3>& angles, linalg::Matrix<T, 3, 3>& R)
+    {
+        rotationFromEuler<Sequence>(angles(1, 1), angles(1, 2), angles(1, 3), R);
+    }
 
-        float c1 = std::cos(phi);
-        float c2 = std::cos(theta);
-        float c3 = std::cos(psi);
-        float s1 = std::sin(phi);
-        float s2 = std::sin(theta);
-        float s3 = std::sin(psi);
+    /// @brief builds a rotation matrix using euler angles.
+    /// @tparam Sequence the axes of the rotations.
+    /// @param angles euler angles [rad,rad,rad]
+    template <EulerSequence Sequence, typename T>
+    linalg::Matrix<T, 3, 3> rotationFromEuler(const linalg::RowVector<T, 3>& angles)
+    {
+        return rotationFromEuler<Sequence>(angles(1, 1), angles(1, 2), angles(1, 3));
+    }
 
-        if (axis == "ZXZ") {
-            elements(1, 1) = c2;
-            elements(1, 2) = -c3 * s2;
-            elements(1, 3) = s2 * s3;
-            elements(2, 1) = c1 * s2;
-            elements(2, 2) = c1 * c2 * c3 - s1 * s3;
-            elements(2, 3) = -c3 * s1 - c1 * c2 * s3;
-            elements(3, 1) = s1 * s2;
-            elements(3, 2) = c1 * s3 + c2 * c3 * s1;
-            elements(3, 3) = c1 * c3 - c2 * s1 * s3;
-        } else if (axis == "XYX") {
-            elements(1, 1) = c2;
-            elements(1, 2) = s2 * s3;
-            elements(1, 3) = c3 * s2;
-            elements(2, 1) = s1 * s2;
-            elements(2, 2) = c1 * c3 - c2 * s1 * s3;
-            elements(2, 3) = -c1 * s3 - c2 * c3 * s1;
-            elements(3, 1) = -c1 * s2;
-            elements(3, 2) = c3 * s1 + c1 * c2 * s3;
-            elements(3, 3) = c1 * c2 * c3 - s1 * s3;
-        } else if (axis == "YXY") {
-            elements(1, 1) = c1 * c3 - c2 * s1 * s3;
-            elements(1, 2) = s1 * s2;
-            elements(1, 3) = c1 * s3 + c2 * c3 * s1;
-            elements(2, 1) = c2 * s3;
-            elements(2, 2) = c2;
-            elements(2, 3) = -c3 * s2;
-            elements(3, 1) = -c3 * s1 - c1 * c2 * s3;
-            elements(3, 2) = c1 * s2;
-            elements(3, 3) = c1 * c2 * c3 - s1 * s3;
-        } else if (axis == "YZY") {
-            elements(1, 1) = c1 * c2 * c3 - s1 * s3;
-            elements(1, 2) = -c1 * s2;
-            elements(1, 3) = c3 * s1 + c1 * c2 * s3;
-            elements(2, 1) = c3 * s2;
-            elements(2, 2) = c2;
-            elements(2, 3) = s2 * s3;
-            elements(3, 1) = -c1 * s3 - c2 * c3 * s1;
-            elements(3, 2) = s1 * s2;
-            elements(3, 3) = c1 * c3 - c2 * s1 * s3;
-        } else if (axis == "ZYZ") {
-            elements(1, 1) = c1 * c2 * c3 - s1 * s3;
-            elements(1, 2) = -c3 * s1 - c1 * c2 * s3;
-            elements(1, 3) = c1 * s2;
-            elements(2, 1) = c1 * s3 + c2 * c3 * s1;
-            elements(2, 2) = c1 * c3 - c2 * s1 * s3;
-            elements(2, 3) = s1 * s2;
-            elements(3, 1) = -c3 * s2;
-            elements(3, 2) = s2 * s3;
-            elements(3, 3) = c2;
-        } else if (axis == "ZXZ") {
-            elements(1, 1) = c1 * c3 - c2 * s1 * s3;
-            elements(1, 1) = -c1 * s3 - c2 * c3 * s1;
-            elements(1, 3) = s1 * s2;
-            elements(2, 1) = c3 * s1 + c1 * c2 * s3;
-            elements(2, 2) = c1 * c2 * c3 - s1 * s3;
-            elements(2, 3) = -c1 * s2;
-            elements(3, 1) = s2 * s3;
-            elements(3, 2) = c3 * s2;
-            elements(3, 3) = c2;
-        } else {
-            throw std::invalid_argument("Unknown axis");
+    /// @brief builds a rotation matrix using euler angles.
+    /// @details see https://en.wikipedia.org/wiki/Euler_angles#Definition_by_intrinsic_rotations.
+    /// prefer the overloads taking the sequence as a template parameter where the axes are known.
+    /// @param axis axis from which the 3D rotation is around, see eulerSequence.
+    /// @param angles euler angles [rad,rad,rad]
+    /// @param R the rotation matrix, every element of which is written.
+    template <typename T>
+    void rotationFromEuler(const std::string& axis, const linalg::RowVector<T, 3>& angles, linalg::Matrix<T, 3, 3>& R)
+    {
+        switch (eulerSequence(axis)) {
+        case EulerSequence::XZX:
+            return rotationFromEuler<EulerSequence::XZX>(angles, R);
+        case EulerSequence::XYX:
+            return rotationFromEuler<EulerSequence::XYX>(angles, R);
+        case EulerSequence::YXY:
+            return rotationFromEuler<EulerSequence::YXY>(angles, R);
+        case EulerSequence::YZY:
+            return rotationFromEuler<EulerSequence::YZY>(angles, R);
+        case EulerSequence::ZXZ:
+            return rotationFromEuler<EulerSequence::ZXZ>(angles, R);
+        case EulerSequence::ZYZ:
+            return rotationFromEuler<EulerSequence::ZYZ>(angles, R);
+        case EulerSequence::XYZ:
+            return rotationFromEuler<EulerSequence::XYZ>(angles, R);
+        case EulerSequence::XZY:
+            return rotationFromEuler<EulerSequence::XZY>(angles, R);
+        case EulerSequence::YXZ:
+            return rotationFromEuler<EulerSequence::YXZ>(angles, R);
+        case EulerSequence::YZX:
+            return rotationFromEuler<EulerSequence::YZX>(angles, R);
+        case EulerSequence::ZXY:
+            return rotationFromEuler<EulerSequence::ZXY>(angles, R);
+        case EulerSequence::ZYX:
+            return rotationFromEuler<EulerSequence::ZYX>(angles, R);
         }
+        throw std::invalid_argument("Unknown axis");
+    }
 
-        return linalg::Matrix<T, 3, 3>(elements);
+    /// @brief builds a rotation matrix using euler angles, see the overload writing into R.
+    /// @param axis axis from which the 3D rotation is around, see eulerSequence.
+    /// @param angles euler angles [rad,rad,rad]
+    template <typename T>
+    linalg::Matrix<T, 3, 3> rotationFromEuler(const std::string& axis, const linalg::RowVector<T, 3>& angles)
+    {
+        linalg::Matrix<T, 3, 3> R(linalg::filltype::none);
+        rotationFromEuler(axis, angles, R);
+        return R;
     }
 
-}; // namespace astro 
-}; // namespace lao 
+}; // namespace astro
+}; // namespace lao
 
-#endif // LAO_ASTRO_MATH_TRANSFORMS_H_
\ No newline at end of file
+#endif // LAO_ASTRO_MATH_LINEAR_TRANSFORMS_H_
@@ -1,7 +1,93 @@
 #ifndef LAO_CONFIG_H_
 #define LAO_CONFIG_H_
 
-#define LAO_USE_SIMD        (false)
+// use SIMD kernels for the instruction sets enabled by the compiler target, e.g. -mavx2.
+#ifndef LAO_USE_SIMD
+#define LAO_USE_SIMD        (true)
+#endif
 
+// debug checks on unchecked element access, compiled out in release (NDEBUG) builds.
+#ifndef LAO_ASSERT
+#ifdef NDEBUG
+#define LAO_ASSERT(cond)    ((void)0)
+#else
+#include <cassert>
+#define LAO_ASSERT(cond)    assert(cond)
+#endif
+#endif
 
-#endif // LAO_CONFIG_H_
\ No newline at end of file
+// matrices with at most this many elements are stored inline rather than on the heap.
+#ifndef LAO_STATIC_STORAGE_THRESHOLD
+#define LAO_STATIC_STORAGE_THRESHOLD    (64)
+#endif
+
+// alignment in bytes of inline matrix storage.
+#ifndef LAO_STATIC_STORAGE_ALIGNMENT
+#define LAO_STATIC_STORAGE_ALIGNMENT    (16)
+#endif
+
+// GEMM cache blocking, sized for a block of A in L2 and a panel of B in L1.
+#ifndef LAO_GEMM_MC
+#define LAO_GEMM_MC     (120)
+#endif
+#ifndef LAO_GEMM_KC
+#define LAO_GEMM_KC     (256)
+#endif
+#ifndef LAO_GEMM_NC
+#define LAO_GEMM_NC     (4096)
+#endif
+// products with at most this many multiply-adds skip packing.
+#ifndef LAO_GEMM_SMALL_THRESHOLD
+#define LAO_GEMM_SMALL_THRESHOLD    (16 * 16 * 16)
+#endif
+// matrices with fixed extents of at most this many rows and columns are multiplied, transposed,
+// inverted and solved with the fully unrolled kernels in fixed.hpp.
+#ifndef LAO_FIXED_UNROLL_SIZE
+#define LAO_FIXED_UNROLL_SIZE   (6)
+#endif
+// number of columns factored per panel by LUFactorization, the rest of the work is a GEMM update.
+#ifndef LAO_LU_BLOCK_SIZE
+#define LAO_LU_BLOCK_SIZE   (64)
+#endif
+// number of iterations between the convergence checks of the stationary iterative solvers.
+#ifndef LAO_SOLVER_CHECK_INTERVAL
+#define LAO_SOLVER_CHECK_INTERVAL   (8)
+#endif
+
+// size in bytes of the first block of an Arena, later blocks double in size.
+#ifndef LAO_ARENA_BLOCK_SIZE
+#define LAO_ARENA_BLOCK_SIZE    (1 << 20)
+#endif
+// number of threads parallel kernels use, 0 for the hardware concurrency.
+#ifndef LAO_NUM_THREADS
+#define LAO_NUM_THREADS     (0)
+#endif
+
+// dense element-wise evaluation and solver sweeps over at least this many elements run in parallel,
+// anything smaller stays on the calling thread. Fixed-size matrices below it never reach the pool.
+#ifndef LAO_PARALLEL_THRESHOLD
+#define LAO_PARALLEL_THRESHOLD  (1 << 15)
+#endif
+
+// matrix products with at least this many multiply-adds run in parallel.
+#ifndef LAO_GEMM_PARALLEL_THRESHOLD
+#define LAO_GEMM_PARALLEL_THRESHOLD     (1 << 21)
+#endif
+
+// sparse assembly with at least this many entries runs in parallel.
+#ifndef LAO_SPARSE_PARALLEL_THRESHOLD
+#define LAO_SPARSE_PARALLEL_THRESHOLD   (1 << 16)
+#endif
+
+// number of consecutive epochs each task of an EphemerisEngine evaluates a body at.
+#ifndef LAO_EPHEMERIS_CHUNK_SIZE
+#define LAO_EPHEMERIS_CHUNK_SIZE    (1024)
+#endif
+
+// count matrix allocations and copies, solver iterations and residuals, and time the main kernels,
+// see lao/instrumentation.hpp. Off, every hook compiles to nothing.
+#ifndef LAO_INSTRUMENTATION
+#define LAO_INSTRUMENTATION     (false)
+#endif
+
+#endif // LAO_CONFIG_H_
@@ -0,0 +1,390 @@
+/// instrumentation.hpp implements the optional counters and timers of the hot paths of the library:
+/// the allocations and copies of dense matrix storage, the iterations and residuals of the solvers,
+/// and the time spent in the main kernels.
+///
+/// It is enabled with LAO_INSTRUMENTATION in lao/config.hpp. It is off by default, and then every
+/// hook is an empty inline function and ScopedTimer an empty class, so they compile to nothing.
+/// When it is on, each thread counts into counters of its own, with no contention between threads.
+/// snapshot() sums the counters of every thread, including those which have exited, and
+/// thread_snapshot() returns those of the calling thread alone, e.g. around a single call:
+///
+///     const instrumentation::Snapshot before = instrumentation::thread_snapshot();
+///     const auto state = body.eph(epoch);
+///     const uint64_t allocations = instrumentation::thread_snapshot().allocations - before.allocations;
+///
+/// A sink set with set_sink() is additionally called with an Event at the end of every timed
+/// kernel and every solve, on the thread which ran it, e.g. to forward them to a metrics system.
+
+#ifndef LAO_INSTRUMENTATION_H_
+#define LAO_INSTRUMENTATION_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <lao/config.hpp>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace lao {
+namespace instrumentation {
+
+    /// @brief Whether the library is built with instrumentation, see LAO_INSTRUMENTATION.
+    inline constexpr bool enabled = LAO_INSTRUMENTATION;
+
+    /// @brief The kernels timed by ScopedTimer.
+    /// @details Times are inclusive, e.g. the GEMM updates of an LU factorization are counted under
+    /// both lu and gemm.
+    enum class Kernel : size_t {
+        gemm,
+        lu,
+        spmv,
+        iterative,
+        ephemeris,
+        propagation,
+        lambert,
+        porkchop,
+        count
+    };
+
+    /// @brief The solvers whose iterations and residuals are recorded by record_solve.
+    enum class Solver : size_t {
+        jacobi,
+        sor,
+        pcg,
+        newton,
+        halley,
+        householder,
+        refinement,
+        propagation,
+        count
+    };
+
+    /// @brief Number of calls and time spent in one kernel.
+    struct KernelStats {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+    };
+
+    /// @brief Number of solves and iterations of one solver.
+    struct SolverStats {
+        uint64_t solves = 0;
+        uint64_t iterations = 0;
+        /// @brief Number of solves which stopped at their iteration limit.
+        uint64_t unconverged = 0;
+        /// @brief Largest residual any solve returned with.
+        double max_residual = 0.0;
+    };
+
+    /// @brief Values of the counters at one point in time.
+    struct Snapshot {
+        /// @brief Number of heap allocations of dense matrix storage.
+        uint64_t allocations = 0;
+        uint64_t allocated_bytes = 0;
+        /// @brief Number of copies of dense matrices, by copy construction or assignment.
+        uint64_t copies = 0;
+        uint64_t copied_bytes = 0;
+        std::array<KernelStats, static_cast<size_t>(Kernel::count)> kernels {};
+        std::array<SolverStats, static_cast<size_t>(Solver::count)> solvers {};
+
+        const KernelStats& kernel(Kernel k) const noexcept
+        {
+            return kernels[static_cast<size_t>(k)];
+        }
+
+        const SolverStats& solver(Solver s) const noexcept
+        {
+            return solvers[static_cast<size_t>(s)];
+        }
+    };
+
+    /// @brief One timed kernel or solve, as handed to the sink.
+    struct Event {
+        enum class Type {
+            kernel,
+            solve
+        };
+
+        Type type;
+        /// @brief The kernel, if type is kernel.
+        Kernel kernel;
+        /// @brief The solver, if type is solve.
+        Solver solver;
+        /// @brief Time spent in the kernel, if type is kernel.
+        uint64_t nanoseconds;
+        /// @brief Number of iterations, residual and outcome of the solve, if type is solve.
+        size_t iterations;
+        double residual;
+        bool converged;
+    };
+
+    /// @brief Callback called with every Event. It must be thread-safe and must not throw.
+    using Sink = std::function<void(const Event&)>;
+
+    namespace detail {
+
+        /// @brief The counters of one thread.
+        /// @details Only ever incremented by their own thread, and atomic only so that snapshot() and
+        /// reset() may read and clear them from others.
+        struct ThreadCounters {
+            std::atomic<uint64_t> allocations { 0 };
+            std::atomic<uint64_t> allocated_bytes { 0 };
+            std::atomic<uint64_t> copies { 0 };
+            std::atomic<uint64_t> copied_bytes { 0 };
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(Kernel::count)> kernel_calls {};
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(Kernel::count)> kernel_nanoseconds {};
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(Solver::count)> solves {};
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(Solver::count)> iterations {};
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(Solver::count)> unconverged {};
+            std::array<std::atomic<double>, static_cast<size_t>(Solver::count)> max_residual {};
+
+            /// @brief Adds these counters to a snapshot.
+            void add_to(Snapshot& snapshot) const noexcept
+            {
+                constexpr auto relaxed = std::memory_order_relaxed;
+                snapshot.allocations += allocations.load(relaxed);
+                snapshot.allocated_bytes += allocated_bytes.load(relaxed);
+                snapshot.copies += copies.load(relaxed);
+                snapshot.copied_bytes += copied_bytes.load(relaxed);
+                for (size_t k = 0; k < kernel_calls.size(); ++k) {
+                    snapshot.kernels[k].calls += kernel_calls[k].load(relaxed);
+                    snapshot.kernels[k].nanoseconds += kernel_nanoseconds[k].load(relaxed);
+                }
+                for (size_t s = 0; s < solves.size(); ++s) {
+                    snapshot.solvers[s].solves += solves[s].load(relaxed);
+                    snapshot.solvers[s].iterations += iterations[s].load(relaxed);
+                    snapshot.solvers[s].unconverged += unconverged[s].load(relaxed);
+                    snapshot.solvers[s].max_residual = std::max(snapshot.solvers[s].max_residual, max_residual[s].load(relaxed));
+                }
+            }
+
+            void clear() noexcept
+            {
+                constexpr auto relaxed = std::memory_order_relaxed;
+                allocations.store(0, relaxed);
+                allocated_bytes.store(0, relaxed);
+                copies.store(0, relaxed);
+                copied_bytes.store(0, relaxed);
+                for (size_t k = 0; k < kernel_calls.size(); ++k) {
+                    kernel_calls[k].store(0, relaxed);
+                    kernel_nanoseconds[k].store(0, relaxed);
+                }
+                for (size_t s = 0; s < solves.size(); ++s) {
+                    solves[s].store(0, relaxed);
+                    iterations[s].store(0, relaxed);
+                    unconverged[s].store(0, relaxed);
+                    max_residual[s].store(0.0, relaxed);
+                }
+            }
+        };
+
+        /// @brief The counters of every live thread, the sums of those which have exited, and the sink.
+        struct Registry {
+            std::mutex mutex;
+            std::vector<ThreadCounters*> threads;
+            Snapshot retired;
+            std::shared_ptr<const Sink> sink;
+            std::atomic<bool> has_sink { false };
+        };
+
+        /// @brief Returns the registry, which is never destroyed so that it outlives the counters of
+        /// every thread, including those destroyed after static objects.
+        inline Registry& registry()
+        {
+            static Registry* instance = new Registry();
+            return *instance;
+        }
+
+        /// @brief Counters of a thread, registered for as long as the thread lives.
+        struct ThreadRegistration {
+            ThreadCounters counters;
+
+            ThreadRegistration()
+            {
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.threads.push_back(&counters);
+            }
+
+            ThreadRegistration(const ThreadRegistration&) = delete;
+            ThreadRegistration& operator=(const ThreadRegistration&) = delete;
+
+            ~ThreadRegistration()
+            {
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                counters.add_to(r.retired);
+                r.threads.erase(std::find(r.threads.begin(), r.threads.end(), &counters));
+            }
+        };
+
+        inline ThreadCounters& thread_counters()
+        {
+            thread_local ThreadRegistration registration;
+            return registration.counters;
+        }
+
+        inline void add(std::atomic<uint64_t>& counter, uint64_t n) noexcept
+        {
+            counter.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        /// @brief Hands an event to the sink, if there is one.
+        inline void emit(const Event& event)
+        {
+            Registry& r = registry();
+            if (!r.has_sink.load(std::memory_order_acquire))
+                return;
+            std::shared_ptr<const Sink> sink;
+            {
+                std::lock_guard<std::mutex> lock(r.mutex);
+                sink = r.sink;
+            }
+            // called outside of the lock, so the sink may take snapshots.
+            if (sink)
+                (*sink)(event);
+        }
+
+    }; // namespace detail
+
+    /// @brief Counts a heap allocation of bytes bytes of dense matrix storage.
+    inline void count_allocation([[maybe_unused]] size_t bytes)
+    {
+        if constexpr (enabled) {
+            detail::ThreadCounters& counters = detail::thread_counters();
+            detail::add(counters.allocations, 1);
+            detail::add(counters.allocated_bytes, bytes);
+        }
+    }
+
+    /// @brief Counts a copy of bytes bytes of dense matrix storage.
+    inline void count_copy([[maybe_unused]] size_t bytes)
+    {
+        if constexpr (enabled) {
+            detail::ThreadCounters& counters = detail::thread_counters();
+            detail::add(counters.copies, 1);
+            detail::add(counters.copied_bytes, bytes);
+        }
+    }
+
+    /// @brief Records the time spent in one call of a kernel.
+    inline void record_kernel([[maybe_unused]] Kernel kernel, [[maybe_unused]] uint64_t nanoseconds)
+    {
+        if constexpr (enabled) {
+            detail::ThreadCounters& counters = detail::thread_counters();
+            const size_t k = static_cast<size_t>(kernel);
+            detail::add(counters.kernel_calls[k], 1);
+            detail::add(counters.kernel_nanoseconds[k], nanoseconds);
+            detail::emit(Event { Event::Type::kernel, kernel, Solver::count, nanoseconds, 0, 0.0, false });
+        }
+    }
+
+    /// @brief Records the outcome of one solve.
+    /// @param iterations the number of iterations performed.
+    /// @param residual the residual of the result, as defined by the solver.
+    /// @param converged whether the tolerance was reached.
+    inline void record_solve([[maybe_unused]] Solver solver, [[maybe_unused]] size_t iterations, [[maybe_unused]] double residual,
+        [[maybe_unused]] bool converged)
+    {
+        if constexpr (enabled) {
+            detail::ThreadCounters& counters = detail::thread_counters();
+            const size_t s = static_cast<size_t>(solver);
+            detail::add(counters.solves[s], 1);
+            detail::add(counters.iterations[s], iterations);
+            if (!converged)
+                detail::add(counters.unconverged[s], 1);
+            if (residual > counters.max_residual[s].load(std::memory_order_relaxed))
+                counters.max_residual[s].store(residual, std::memory_order_relaxed);
+            detail::emit(Event { Event::Type::solve, Kernel::count, solver, 0, iterations, residual, converged });
+        }
+    }
+
+    /// @brief Times the scope it lives in, and records it under a kernel when it ends.
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer([[maybe_unused]] Kernel kernel) noexcept
+#if LAO_INSTRUMENTATION
+            : m_kernel(kernel)
+            , m_start(std::chrono::steady_clock::now())
+#endif
+        {
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer()
+        {
+#if LAO_INSTRUMENTATION
+            const auto elapsed = std::chrono::steady_clock::now() - m_start;
+            record_kernel(m_kernel, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+#endif
+        }
+
+    private:
+#if LAO_INSTRUMENTATION
+        Kernel m_kernel;
+        std::chrono::steady_clock::time_point m_start;
+#endif
+    };
+
+    /// @brief Returns the counters summed over every thread, or all zeros if instrumentation is off.
+    /// @details The counters of threads which are counting meanwhile are read as they are, one at a
+    /// time, so the snapshot is exact only once they are done.
+    inline Snapshot snapshot()
+    {
+        Snapshot result;
+        if constexpr (enabled) {
+            detail::Registry& r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            result = r.retired;
+            for (const detail::ThreadCounters* counters : r.threads)
+                counters->add_to(result);
+        }
+        return result;
+    }
+
+    /// @brief Returns the counters of the calling thread, or all zeros if instrumentation is off.
+    inline Snapshot thread_snapshot()
+    {
+        Snapshot result;
+        if constexpr (enabled)
+            detail::thread_counters().add_to(result);
+        return result;
+    }
+
+    /// @brief Sets the counters of every thread to zero.
+    /// @details Increments made by other threads at the same time may survive the reset.
+    inline void reset()
+    {
+        if constexpr (enabled) {
+            detail::Registry& r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.retired = Snapshot {};
+            for (detail::ThreadCounters* counters : r.threads)
+                counters->clear();
+        }
+    }
+
+    /// @brief Sets the sink every event is handed to, replacing any previous one, or removes it if
+    /// sink is empty. Ignored if instrumentation is off.
+    /// @details Events already being handed to the previous sink on other threads still complete.
+    inline void set_sink([[maybe_unused]] Sink sink)
+    {
+        if constexpr (enabled) {
+            detail::Registry& r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.sink = sink ? std::make_shared<const Sink>(std::move(sink)) : nullptr;
+            r.has_sink.store(static_cast<bool>(r.sink), std::memory_order_release);
+        }
+    }
+
+}; // namespace instrumentation
+}; // namespace lao
+
+#endif // LAO_INSTRUMENTATION_H_
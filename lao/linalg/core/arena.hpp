@@ -0,0 +1,187 @@
+/// arena.hpp implements a bump allocating memory resource for short lived dense matrix temporaries,
+/// and the scoped selection of the resource that arena backed storage allocates from.
+///
+/// A typical use is a solver iteration or an ephemeris batch, where many same sized temporaries are
+/// created and destroyed:
+///
+///     Arena arena;
+///     for (...) {
+///         ScopedArena scope(arena);
+///         ArenaMatrix<double, Dynamic, Dynamic> tmp = A * x;
+///         ...
+///     } // everything allocated in the scope is released at once here
+///
+/// Matrices allocated from an arena must not outlive the scope they were created in.
+
+#ifndef LAO_LINALG_CORE_ARENA_H_
+#define LAO_LINALG_CORE_ARENA_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <lao/config.hpp>
+#include <memory_resource>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief Bump allocating memory resource.
+    /// @details Allocation moves a pointer through a list of blocks obtained from an upstream resource,
+    /// and deallocation is a no-op. Memory is only reclaimed all at once with `reset()`, or back to an
+    /// earlier `mark()` with `rewind()`, both O(1). The blocks are kept for reuse, so once an arena has
+    /// grown to the high water mark of its users it never goes to the upstream resource again.
+    class Arena : public std::pmr::memory_resource {
+    public:
+        /// @brief Position in the arena, returned by `mark()`.
+        struct Marker {
+            size_t block;
+            size_t offset;
+        };
+
+        /// @brief Constructs an arena with an initial block of block_size bytes.
+        explicit Arena(size_t block_size = LAO_ARENA_BLOCK_SIZE, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : m_upstream(upstream)
+        {
+            add_block(block_size);
+        }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena()
+        {
+            for (const auto& block : m_blocks)
+                m_upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+        }
+
+        /// @brief Releases everything allocated from the arena, keeping the blocks.
+        void reset() noexcept
+        {
+            m_block = 0;
+            m_offset = 0;
+        }
+
+        /// @brief Returns the current position, to later release everything allocated after it.
+        Marker mark() const noexcept
+        {
+            return Marker { m_block, m_offset };
+        }
+
+        /// @brief Releases everything allocated after marker was taken.
+        void rewind(Marker marker) noexcept
+        {
+            m_block = marker.block;
+            m_offset = marker.offset;
+        }
+
+        /// @brief Returns the number of bytes obtained from the upstream resource.
+        size_t capacity() const noexcept
+        {
+            size_t total = 0;
+            for (const auto& block : m_blocks)
+                total += block.size;
+            return total;
+        }
+
+        /// @brief Returns the number of blocks obtained from the upstream resource.
+        size_t blocks() const noexcept
+        {
+            return m_blocks.size();
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            while (true) {
+                if (m_block == m_blocks.size())
+                    add_block(std::max(2 * m_blocks.back().size, bytes + alignment));
+
+                const Block& block = m_blocks[m_block];
+                const auto base = reinterpret_cast<std::uintptr_t>(block.data);
+                const size_t offset = (base + m_offset + alignment - 1) / alignment * alignment - base;
+                if (offset + bytes <= block.size) {
+                    m_offset = offset + bytes;
+                    return block.data + offset;
+                }
+                // the tail of this block is wasted until the next reset.
+                ++m_block;
+                m_offset = 0;
+            }
+        }
+
+        void do_deallocate(void*, size_t, size_t) override
+        {
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        struct Block {
+            std::byte* data;
+            size_t size;
+        };
+
+        void add_block(size_t size)
+        {
+            auto* data = static_cast<std::byte*>(m_upstream->allocate(size, alignof(std::max_align_t)));
+            m_blocks.push_back(Block { data, size });
+        }
+
+        std::pmr::memory_resource* m_upstream;
+        std::vector<Block> m_blocks;
+        size_t m_block = 0;
+        size_t m_offset = 0;
+    };
+
+    namespace detail {
+        inline std::pmr::memory_resource*& current_resource_slot() noexcept
+        {
+            thread_local std::pmr::memory_resource* resource = nullptr;
+            return resource;
+        }
+    }; // namespace detail
+
+    /// @brief Returns the memory resource that arena backed storage on this thread allocates from.
+    /// @details This is the arena of the innermost ScopedArena, or the default resource outside of one.
+    inline std::pmr::memory_resource* current_resource() noexcept
+    {
+        std::pmr::memory_resource* resource = detail::current_resource_slot();
+        return resource ? resource : std::pmr::get_default_resource();
+    }
+
+    /// @brief Makes an arena the current resource of this thread for the lifetime of the scope.
+    /// @details On destruction the previous resource is restored and the arena is rewound to where it
+    /// was when the scope was entered, so scopes can be nested.
+    class ScopedArena {
+    public:
+        explicit ScopedArena(Arena& arena) noexcept
+            : m_arena(arena)
+            , m_marker(arena.mark())
+            , m_previous(detail::current_resource_slot())
+        {
+            detail::current_resource_slot() = &arena;
+        }
+
+        ScopedArena(const ScopedArena&) = delete;
+        ScopedArena& operator=(const ScopedArena&) = delete;
+
+        ~ScopedArena()
+        {
+            detail::current_resource_slot() = m_previous;
+            m_arena.rewind(m_marker);
+        }
+
+    private:
+        Arena& m_arena;
+        Arena::Marker m_marker;
+        std::pmr::memory_resource* m_previous;
+    };
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_CORE_ARENA_H_
@@ -2,6 +2,8 @@
 #define LAO_LINALG_CORE_EXPRESSION_H_
 
 #include <cstddef>
+#include <lao/linalg/core/forward.hpp>
+#include <type_traits>
 
 namespace lao {
 namespace linalg {
@@ -9,23 +11,120 @@ namespace linalg {
     template <typename Derived, typename S, size_t R, size_t C>
     class MatrixExpression {
     public:
+        using value_type = S;
+        static constexpr size_t row_extent = R;
+        static constexpr size_t col_extent = C;
+
+        // Evaluation policy, which derived expressions override by redeclaring the member.
+        //
+        // Expressions which are expensive to evaluate per element, such as matrix products, set
+        // `materialize_when_nested` so that when they are an operand of another expression they are
+        // evaluated once into a temporary matrix rather than being recomputed for every element read.
+        // Cheap element-wise expressions leave it unset and so stay fused into a single loop.
+        static constexpr bool materialize_when_nested = false;
+        // Expressions which own their elements, i.e. Matrix and SparseMatrix, set
+        // `nest_by_reference` so that nodes refer to them rather than copy them. Intermediate
+        // expression nodes are small and are held by value, so an expression stays valid for as
+        // long as the matrices at its leaves do.
+        static constexpr bool nest_by_reference = false;
+        // Expressions where an element of the result depends on other elements of the operands set
+        // `assume_aliasing`, so assigning them into one of their own operands goes through a
+        // temporary. Element-wise nodes inherit it from their operands through `assume_aliasing_v`,
+        // so `A = A + transpose(A)` is caught too. `Matrix::noalias()` skips the temporary.
+        static constexpr bool assume_aliasing = false;
+        // Expressions whose element (i, j) only depends on the operand elements at (i, j) set
+        // `linear_access` if all of their operands do and share a layout. They then provide `coeff(i)`,
+        // taking a flat 0 indexed index in the order given by `layout`, and assignment into a matrix
+        // of the same layout evaluates them in a single flat loop.
+        static constexpr bool linear_access = false;
+        // Linear expressions whose operands all support it additionally set `packet_access` and
+        // provide `packet(i)`, returning the simd::Packet of elements starting at flat index i.
+        // Assignment then evaluates the whole fused expression a packet at a time.
+        static constexpr bool packet_access = false;
+        // Memory layout that the flat index of `coeff(i)` and `packet(i)` refers to.
+        static constexpr Layout layout = Layout::RowMajor;
+        // SparseMatrix and the sparse expressions of sparse_arithmetic.hpp set `sparse_expression`.
+        // They are evaluated from the non-zeros of their operands, and the ones which also set
+        // `materialize_when_nested` are materialized into a SparseMatrix rather than a dense one.
+        static constexpr bool sparse_expression = false;
+
+        /// @brief Element access, 1 indexed.
         S operator()(size_t row, size_t col) const
         {
-            return static_cast<const Derived*>(this)->operator()(row, col);
+            return static_cast<const Derived*>(this)->coeff(row, col);
         }
 
+        /// @brief Unchecked element access, 1 indexed.
+        S coeff(size_t row, size_t col) const
+        {
+            return static_cast<const Derived*>(this)->coeff(row, col);
+        }
+
+        /// @brief Returns the number of rows.
+        /// @details Derived expressions with a dynamic extent provide their own `rows()`.
         size_t rows() const noexcept
         {
-            return R;
+            if constexpr (R != Dynamic)
+                return R;
+            else
+                return static_cast<const Derived*>(this)->rows();
         }
 
+        /// @brief Returns the number of columns.
+        /// @details Derived expressions with a dynamic extent provide their own `cols()`.
         size_t cols() const noexcept
         {
-            return C;
+            if constexpr (C != Dynamic)
+                return C;
+            else
+                return static_cast<const Derived*>(this)->cols();
         }
     };
 
+    /// @brief Whether an operand, as held through nested_t, may read elements of the destination
+    /// other than the one being written. Materialized operands are evaluated before assignment.
+    template <typename E>
+    inline constexpr bool assume_aliasing_v = E::assume_aliasing && !E::materialize_when_nested;
+
+    /// @brief Whether an operand, as held through nested_t, supports linear element access.
+    template <typename E>
+    inline constexpr bool linear_access_v = (E::materialize_when_nested && !E::sparse_expression) || E::linear_access;
+
+    /// @brief Whether an operand, as held through nested_t, supports packet element access.
+    template <typename E>
+    inline constexpr bool packet_access_v = (E::materialize_when_nested && !E::sparse_expression) || E::packet_access;
+
+    /// @brief Layout of an operand as held through nested_t. Materialized operands are row-major.
+    template <typename E>
+    inline constexpr Layout layout_v = E::materialize_when_nested ? Layout::RowMajor : E::layout;
+
+    /// @brief Whether two operands can be traversed together with a single flat index.
+    template <typename E1, typename E2>
+    inline constexpr bool same_layout_v = layout_v<E1> == layout_v<E2>;
+
+    /// @brief Concept for expressions backed by dense memory with a row and column stride.
+    /// @details Element (i, j), 0 indexed, is at `data()[i * row_stride() + j * col_stride()]`.
+    /// Kernels such as GEMM consume these directly, without evaluating them into a temporary.
+    template <typename E>
+    concept StridedExpression = requires(const E& e)
+    {
+        { e.data() };
+        { e.row_stride() };
+        { e.col_stride() };
+    };
+
+    /// @brief The type an expression node uses to hold one of its operands.
+    /// @details Matrices are held by reference and other expression nodes by value, unless the
+    /// evaluation policy of the operand asks for it to be materialized, in which case it is evaluated
+    /// into a dense matrix held by value, or a sparse matrix for sparse expressions.
+    template <typename E>
+    using nested_t = std::conditional_t<E::materialize_when_nested,
+        std::conditional_t<E::sparse_expression,
+            const SparseMatrix<typename E::value_type, E::row_extent, E::col_extent>,
+            const Matrix<typename E::value_type, E::row_extent, E::col_extent>>,
+        std::conditional_t<E::nest_by_reference, const E&, const E>>;
+
 }; // namespace linalg
 }; // namespace lao
 
-#endif // LAO_LINALG_CORE_EXPRESSION_H_
\ No newline at end of file
+#endif // LAO_LINALG_CORE_EXPRESSION_H_
@@ -0,0 +1,64 @@
+/// extent.hpp implements the extents of a matrix shape, which are either fixed at compile-time
+/// or `Dynamic` and then only known at runtime.
+
+#ifndef LAO_LINALG_CORE_EXTENT_H_
+#define LAO_LINALG_CORE_EXTENT_H_
+
+#include <cstddef>
+#include <limits>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief Extent of a matrix dimension which is only known at runtime, e.g. `Matrix<double, Dynamic, 6>`.
+    inline constexpr size_t Dynamic = std::numeric_limits<size_t>::max();
+
+    /// @brief Whether two extents can describe the same dimension, i.e. they are equal or either is dynamic.
+    constexpr bool extents_match(size_t a, size_t b) noexcept
+    {
+        return a == b || a == Dynamic || b == Dynamic;
+    }
+
+    /// @brief The extent of a dimension shared by two operands, static if either of them knows it.
+    template <size_t A, size_t B>
+    inline constexpr size_t merged_extent_v = A == Dynamic ? B : A;
+
+    /// @brief The extent of two dimensions laid end to end, dynamic if either of them is.
+    template <size_t A, size_t B>
+    inline constexpr size_t sum_extent_v = A == Dynamic || B == Dynamic ? Dynamic : A + B;
+
+    namespace detail {
+
+        /// @brief Holder for one extent of a matrix.
+        /// @details Static extents are empty and compile to a constant, dynamic extents store the value.
+        template <size_t N>
+        struct Extent {
+            static constexpr size_t value() noexcept
+            {
+                return N;
+            }
+
+            constexpr void set(size_t) noexcept { }
+        };
+
+        template <>
+        struct Extent<Dynamic> {
+            constexpr size_t value() const noexcept
+            {
+                return m_value;
+            }
+
+            constexpr void set(size_t value) noexcept
+            {
+                m_value = value;
+            }
+
+            size_t m_value = 0;
+        };
+
+    }; // namespace detail
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_CORE_EXTENT_H_
@@ -2,12 +2,20 @@
 #define LAO_LINALG_CORE_FORWARD_H_
 
 #include <cstddef>
+#include <lao/linalg/core/extent.hpp>
+#include <lao/linalg/core/storage.hpp>
 #include <vector>
 
 namespace lao {
 namespace linalg {
 
-    template <typename S, size_t R, size_t C, typename B = std::vector<S>>
+    /// @brief Order in which the elements of a dense matrix are laid out in memory.
+    enum class Layout {
+        RowMajor,
+        ColMajor
+    };
+
+    template <typename S, size_t R, size_t C, typename B = default_storage_t<S, R, C>, Layout L = Layout::RowMajor>
     class Matrix;
 
     template <typename S, size_t R, size_t C>
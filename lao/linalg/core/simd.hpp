@@ -0,0 +1,313 @@
+/// simd.hpp implements a thin packet abstraction over the SIMD instruction sets supported by the
+/// compiler target. Kernels are written against `Packet<S>` and the widest available instruction
+/// set (AVX-512, AVX, SSE2 or NEON) is selected at compile-time. Types without a SIMD mapping, or
+/// builds with LAO_USE_SIMD disabled, fall back to a single-lane scalar packet.
+///
+/// Which operand `max` and `min` return when a lane holds a NaN depends on the instruction set.
+
+#ifndef LAO_LINALG_CORE_SIMD_H_
+#define LAO_LINALG_CORE_SIMD_H_
+
+#include <cstddef>
+#include <lao/config.hpp>
+#include <type_traits>
+
+#if LAO_USE_SIMD
+#if defined(__AVX512F__) || defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace lao {
+namespace linalg {
+namespace simd {
+
+    /// @brief Scalar fallback packet with a single lane.
+    template <typename S>
+    struct Packet {
+        using value_type = S;
+        using type = S;
+        static constexpr size_t size = 1;
+
+        static type zero() { return S(0); }
+        static type set1(S s) { return s; }
+        static type load(const S* p) { return *p; }
+        static void store(S* p, type a) { *p = a; }
+        static type add(type a, type b) { return a + b; }
+        static type sub(type a, type b) { return a - b; }
+        static type mul(type a, type b) { return a * b; }
+        static type abs(type a)
+        {
+            if constexpr (std::is_unsigned_v<S>)
+                return a;
+            else
+                return a < S(0) ? -a : a;
+        }
+        static type max(type a, type b) { return a < b ? b : a; }
+        static type min(type a, type b) { return b < a ? b : a; }
+        static type fmadd(type a, type b, type c) { return a * b + c; }
+        static type eq(type a, type b) { return a == b; }
+        static type ne(type a, type b) { return a != b; }
+        static type ge(type a, type b) { return a >= b; }
+        static type gt(type a, type b) { return a > b; }
+        static type le(type a, type b) { return a <= b; }
+        static type lt(type a, type b) { return a < b; }
+    };
+
+#if LAO_USE_SIMD
+#if defined(__AVX512F__)
+    template <>
+    struct Packet<double> {
+        using value_type = double;
+        using type = __m512d;
+        static constexpr size_t size = 8;
+
+        static type zero() { return _mm512_setzero_pd(); }
+        static type set1(double s) { return _mm512_set1_pd(s); }
+        static type load(const double* p) { return _mm512_loadu_pd(p); }
+        static void store(double* p, type a) { _mm512_storeu_pd(p, a); }
+        static type add(type a, type b) { return _mm512_add_pd(a, b); }
+        static type sub(type a, type b) { return _mm512_sub_pd(a, b); }
+        static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+        static type abs(type a) { return _mm512_abs_pd(a); }
+        static type max(type a, type b) { return _mm512_max_pd(a, b); }
+        static type min(type a, type b) { return _mm512_min_pd(a, b); }
+        static type fmadd(type a, type b, type c) { return _mm512_fmadd_pd(a, b, c); }
+        static type eq(type a, type b) { return select(_mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ)); }
+        static type ne(type a, type b) { return select(_mm512_cmp_pd_mask(a, b, _CMP_NEQ_UQ)); }
+        static type ge(type a, type b) { return select(_mm512_cmp_pd_mask(a, b, _CMP_GE_OQ)); }
+        static type gt(type a, type b) { return select(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)); }
+        static type le(type a, type b) { return select(_mm512_cmp_pd_mask(a, b, _CMP_LE_OQ)); }
+        static type lt(type a, type b) { return select(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)); }
+
+    private:
+        // lanes set in the mask become 1, others 0.
+        static type select(__mmask8 mask) { return _mm512_maskz_mov_pd(mask, set1(1.0)); }
+    };
+
+    template <>
+    struct Packet<float> {
+        using value_type = float;
+        using type = __m512;
+        static constexpr size_t size = 16;
+
+        static type zero() { return _mm512_setzero_ps(); }
+        static type set1(float s) { return _mm512_set1_ps(s); }
+        static type load(const float* p) { return _mm512_loadu_ps(p); }
+        static void store(float* p, type a) { _mm512_storeu_ps(p, a); }
+        static type add(type a, type b) { return _mm512_add_ps(a, b); }
+        static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+        static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+        static type abs(type a) { return _mm512_abs_ps(a); }
+        static type max(type a, type b) { return _mm512_max_ps(a, b); }
+        static type min(type a, type b) { return _mm512_min_ps(a, b); }
+        static type fmadd(type a, type b, type c) { return _mm512_fmadd_ps(a, b, c); }
+        static type eq(type a, type b) { return select(_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)); }
+        static type ne(type a, type b) { return select(_mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ)); }
+        static type ge(type a, type b) { return select(_mm512_cmp_ps_mask(a, b, _CMP_GE_OQ)); }
+        static type gt(type a, type b) { return select(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)); }
+        static type le(type a, type b) { return select(_mm512_cmp_ps_mask(a, b, _CMP_LE_OQ)); }
+        static type lt(type a, type b) { return select(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)); }
+
+    private:
+        // lanes set in the mask become 1, others 0.
+        static type select(__mmask16 mask) { return _mm512_maskz_mov_ps(mask, set1(1.0f)); }
+    };
+#elif defined(__AVX__)
+    template <>
+    struct Packet<double> {
+        using value_type = double;
+        using type = __m256d;
+        static constexpr size_t size = 4;
+
+        static type zero() { return _mm256_setzero_pd(); }
+        static type set1(double s) { return _mm256_set1_pd(s); }
+        static type load(const double* p) { return _mm256_loadu_pd(p); }
+        static void store(double* p, type a) { _mm256_storeu_pd(p, a); }
+        static type add(type a, type b) { return _mm256_add_pd(a, b); }
+        static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+        static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+        static type abs(type a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+        static type max(type a, type b) { return _mm256_max_pd(a, b); }
+        static type min(type a, type b) { return _mm256_min_pd(a, b); }
+        static type eq(type a, type b) { return select(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+        static type ne(type a, type b) { return select(_mm256_cmp_pd(a, b, _CMP_NEQ_UQ)); }
+        static type ge(type a, type b) { return select(_mm256_cmp_pd(a, b, _CMP_GE_OQ)); }
+        static type gt(type a, type b) { return select(_mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+        static type le(type a, type b) { return select(_mm256_cmp_pd(a, b, _CMP_LE_OQ)); }
+        static type lt(type a, type b) { return select(_mm256_cmp_pd(a, b, _CMP_LT_OQ)); }
+        static type fmadd(type a, type b, type c)
+        {
+#if defined(__FMA__)
+            return _mm256_fmadd_pd(a, b, c);
+#else
+            return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+        }
+
+    private:
+        // lanes set in the mask become 1, others 0.
+        static type select(type mask) { return _mm256_and_pd(mask, set1(1.0)); }
+    };
+
+    template <>
+    struct Packet<float> {
+        using value_type = float;
+        using type = __m256;
+        static constexpr size_t size = 8;
+
+        static type zero() { return _mm256_setzero_ps(); }
+        static type set1(float s) { return _mm256_set1_ps(s); }
+        static type load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, type a) { _mm256_storeu_ps(p, a); }
+        static type add(type a, type b) { return _mm256_add_ps(a, b); }
+        static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+        static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+        static type abs(type a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static type max(type a, type b) { return _mm256_max_ps(a, b); }
+        static type min(type a, type b) { return _mm256_min_ps(a, b); }
+        static type eq(type a, type b) { return select(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+        static type ne(type a, type b) { return select(_mm256_cmp_ps(a, b, _CMP_NEQ_UQ)); }
+        static type ge(type a, type b) { return select(_mm256_cmp_ps(a, b, _CMP_GE_OQ)); }
+        static type gt(type a, type b) { return select(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+        static type le(type a, type b) { return select(_mm256_cmp_ps(a, b, _CMP_LE_OQ)); }
+        static type lt(type a, type b) { return select(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+        static type fmadd(type a, type b, type c)
+        {
+#if defined(__FMA__)
+            return _mm256_fmadd_ps(a, b, c);
+#else
+            return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+        }
+
+    private:
+        // lanes set in the mask become 1, others 0.
+        static type select(type mask) { return _mm256_and_ps(mask, set1(1.0f)); }
+    };
+#elif defined(__SSE2__)
+    template <>
+    struct Packet<double> {
+        using value_type = double;
+        using type = __m128d;
+        static constexpr size_t size = 2;
+
+        static type zero() { return _mm_setzero_pd(); }
+        static type set1(double s) { return _mm_set1_pd(s); }
+        static type load(const double* p) { return _mm_loadu_pd(p); }
+        static void store(double* p, type a) { _mm_storeu_pd(p, a); }
+        static type add(type a, type b) { return _mm_add_pd(a, b); }
+        static type sub(type a, type b) { return _mm_sub_pd(a, b); }
+        static type mul(type a, type b) { return _mm_mul_pd(a, b); }
+        static type abs(type a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+        static type max(type a, type b) { return _mm_max_pd(a, b); }
+        static type min(type a, type b) { return _mm_min_pd(a, b); }
+        static type fmadd(type a, type b, type c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        static type eq(type a, type b) { return select(_mm_cmpeq_pd(a, b)); }
+        static type ne(type a, type b) { return select(_mm_cmpneq_pd(a, b)); }
+        static type ge(type a, type b) { return select(_mm_cmpge_pd(a, b)); }
+        static type gt(type a, type b) { return select(_mm_cmpgt_pd(a, b)); }
+        static type le(type a, type b) { return select(_mm_cmple_pd(a, b)); }
+        static type lt(type a, type b) { return select(_mm_cmplt_pd(a, b)); }
+
+    private:
+        // lanes set in the mask become 1, others 0.
+        static type select(type mask) { return _mm_and_pd(mask, set1(1.0)); }
+    };
+
+    template <>
+    struct Packet<float> {
+        using value_type = float;
+        using type = __m128;
+        static constexpr size_t size = 4;
+
+        static type zero() { return _mm_setzero_ps(); }
+        static type set1(float s) { return _mm_set1_ps(s); }
+        static type load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, type a) { _mm_storeu_ps(p, a); }
+        static type add(type a, type b) { return _mm_add_ps(a, b); }
+        static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+        static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+        static type abs(type a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static type max(type a, type b) { return _mm_max_ps(a, b); }
+        static type min(type a, type b) { return _mm_min_ps(a, b); }
+        static type fmadd(type a, type b, type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static type eq(type a, type b) { return select(_mm_cmpeq_ps(a, b)); }
+        static type ne(type a, type b) { return select(_mm_cmpneq_ps(a, b)); }
+        static type ge(type a, type b) { return select(_mm_cmpge_ps(a, b)); }
+        static type gt(type a, type b) { return select(_mm_cmpgt_ps(a, b)); }
+        static type le(type a, type b) { return select(_mm_cmple_ps(a, b)); }
+        static type lt(type a, type b) { return select(_mm_cmplt_ps(a, b)); }
+
+    private:
+        // lanes set in the mask become 1, others 0.
+        static type select(type mask) { return _mm_and_ps(mask, set1(1.0f)); }
+    };
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    template <>
+    struct Packet<double> {
+        using value_type = double;
+        using type = float64x2_t;
+        static constexpr size_t size = 2;
+
+        static type zero() { return vdupq_n_f64(0.0); }
+        static type set1(double s) { return vdupq_n_f64(s); }
+        static type load(const double* p) { return vld1q_f64(p); }
+        static void store(double* p, type a) { vst1q_f64(p, a); }
+        static type add(type a, type b) { return vaddq_f64(a, b); }
+        static type sub(type a, type b) { return vsubq_f64(a, b); }
+        static type mul(type a, type b) { return vmulq_f64(a, b); }
+        static type abs(type a) { return vabsq_f64(a); }
+        static type max(type a, type b) { return vmaxq_f64(a, b); }
+        static type min(type a, type b) { return vminq_f64(a, b); }
+        static type fmadd(type a, type b, type c) { return vfmaq_f64(c, a, b); }
+        static type eq(type a, type b) { return select(vceqq_f64(a, b)); }
+        static type ne(type a, type b) { return sub(set1(1.0), eq(a, b)); }
+        static type ge(type a, type b) { return select(vcgeq_f64(a, b)); }
+        static type gt(type a, type b) { return select(vcgtq_f64(a, b)); }
+        static type le(type a, type b) { return select(vcleq_f64(a, b)); }
+        static type lt(type a, type b) { return select(vcltq_f64(a, b)); }
+
+    private:
+        // lanes set in the mask become 1, others 0.
+        static type select(uint64x2_t mask) { return vreinterpretq_f64_u64(vandq_u64(mask, vreinterpretq_u64_f64(set1(1.0)))); }
+    };
+
+    template <>
+    struct Packet<float> {
+        using value_type = float;
+        using type = float32x4_t;
+        static constexpr size_t size = 4;
+
+        static type zero() { return vdupq_n_f32(0.0f); }
+        static type set1(float s) { return vdupq_n_f32(s); }
+        static type load(const float* p) { return vld1q_f32(p); }
+        static void store(float* p, type a) { vst1q_f32(p, a); }
+        static type add(type a, type b) { return vaddq_f32(a, b); }
+        static type sub(type a, type b) { return vsubq_f32(a, b); }
+        static type mul(type a, type b) { return vmulq_f32(a, b); }
+        static type abs(type a) { return vabsq_f32(a); }
+        static type max(type a, type b) { return vmaxq_f32(a, b); }
+        static type min(type a, type b) { return vminq_f32(a, b); }
+        static type fmadd(type a, type b, type c) { return vfmaq_f32(c, a, b); }
+        static type eq(type a, type b) { return select(vceqq_f32(a, b)); }
+        static type ne(type a, type b) { return sub(set1(1.0f), eq(a, b)); }
+        static type ge(type a, type b) { return select(vcgeq_f32(a, b)); }
+        static type gt(type a, type b) { return select(vcgtq_f32(a, b)); }
+        static type le(type a, type b) { return select(vcleq_f32(a, b)); }
+        static type lt(type a, type b) { return select(vcltq_f32(a, b)); }
+
+    private:
+        // lanes set in the mask become 1, others 0.
+        static type select(uint32x4_t mask) { return vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(set1(1.0f)))); }
+    };
+#endif
+#endif
+
+}; // namespace simd
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_CORE_SIMD_H_
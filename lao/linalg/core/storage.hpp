@@ -0,0 +1,184 @@
+/// storage.hpp implements the storage policies that back the dense Matrix class, and the
+/// selection of the default policy given the shape of a matrix.
+
+#ifndef LAO_LINALG_CORE_STORAGE_H_
+#define LAO_LINALG_CORE_STORAGE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <lao/config.hpp>
+#include <lao/linalg/core/arena.hpp>
+#include <lao/linalg/core/extent.hpp>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief Fixed capacity storage with the elements held inline.
+    /// @details Models the subset of the std::vector interface used by Matrix so that it can be
+    /// used as a drop-in storage policy. The capacity N is fixed at compile-time and the elements
+    /// live inside the object, so no heap allocation is ever performed. The size is still tracked
+    /// such that `reset()` and `is_empty()` keep their meaning.
+    template <typename S, size_t N>
+    class StaticStorage {
+    public:
+        using value_type = S;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = S&;
+        using const_reference = const S&;
+        using pointer = S*;
+        using const_pointer = const S*;
+        using iterator = S*;
+        using const_iterator = const S*;
+
+        StaticStorage() = default;
+
+        /// @brief Constructs the storage with count copies of value.
+        StaticStorage(size_type count, const value_type& value)
+        {
+            resize(count, value);
+        }
+
+        /// @brief Replaces the contents with the elements in the range [first, last).
+        template <typename It>
+        void assign(It first, It last)
+        {
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            if (count > N)
+                throw std::length_error("Static storage capacity exceeded.");
+            std::copy(first, last, m_data);
+            m_size = count;
+        }
+
+        /// @brief Resizes the storage, filling any new elements with value.
+        void resize(size_type count, const value_type& value = value_type())
+        {
+            if (count > N)
+                throw std::length_error("Static storage capacity exceeded.");
+            if (count > m_size)
+                std::fill(m_data + m_size, m_data + count, value);
+            m_size = count;
+        }
+
+        void clear() noexcept
+        {
+            m_size = 0;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return m_size;
+        }
+
+        static constexpr size_type capacity() noexcept
+        {
+            return N;
+        }
+
+        pointer data() noexcept
+        {
+            return m_data;
+        }
+
+        const_pointer data() const noexcept
+        {
+            return m_data;
+        }
+
+        reference operator[](size_type i) noexcept
+        {
+            return m_data[i];
+        }
+
+        const_reference operator[](size_type i) const noexcept
+        {
+            return m_data[i];
+        }
+
+        iterator begin() noexcept
+        {
+            return m_data;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_data;
+        }
+
+        iterator end() noexcept
+        {
+            return m_data + m_size;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_data + m_size;
+        }
+
+    private:
+        alignas(LAO_STATIC_STORAGE_ALIGNMENT > alignof(S) ? LAO_STATIC_STORAGE_ALIGNMENT : alignof(S)) S m_data[N];
+        size_type m_size = 0;
+    };
+
+    /// @brief Heap storage allocating from the current resource, see ScopedArena.
+    /// @details A std::pmr::vector which picks up `current_resource()` whenever it is created,
+    /// including as a copy, so that matrices created inside a ScopedArena allocate from its arena with
+    /// a pointer bump instead of a malloc call. Moves keep the resource of the source.
+    template <typename S>
+    class ArenaStorage : public std::pmr::vector<S> {
+    public:
+        using base_type = std::pmr::vector<S>;
+
+        ArenaStorage()
+            : base_type(current_resource())
+        {
+        }
+
+        /// @brief Constructs the storage with count copies of value.
+        ArenaStorage(size_t count, const S& value)
+            : base_type(count, value, current_resource())
+        {
+        }
+
+        ArenaStorage(const ArenaStorage& other)
+            : base_type(other, current_resource())
+        {
+        }
+
+        ArenaStorage(ArenaStorage&& other) noexcept = default;
+        ArenaStorage& operator=(const ArenaStorage& other) = default;
+        ArenaStorage& operator=(ArenaStorage&& other) = default;
+    };
+
+    /// @brief Trait for detecting StaticStorage, which never allocates.
+    template <typename T>
+    struct is_static_storage : std::false_type { };
+
+    template <typename S, size_t N>
+    struct is_static_storage<StaticStorage<S, N>> : std::true_type { };
+
+    template <typename T>
+    inline constexpr bool is_static_storage_v = is_static_storage<T>::value;
+
+    /// @brief Selects the default storage policy for a matrix of shape R x C.
+    /// @details Matrices with at most LAO_STATIC_STORAGE_THRESHOLD elements are stored inline with
+    /// StaticStorage, anything larger or with a dynamic extent falls back to std::vector.
+    template <typename S, size_t R, size_t C>
+    using default_storage_t = std::conditional_t<(R != Dynamic && C != Dynamic && R * C > 0 && R * C <= LAO_STATIC_STORAGE_THRESHOLD),
+        StaticStorage<S, R * C>,
+        std::vector<S>>;
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_CORE_STORAGE_H_
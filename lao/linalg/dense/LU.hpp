@@ -1,16 +1,28 @@
 #ifndef LAO_LINALG_DENSE_LU_H_
 #define LAO_LINALG_DENSE_LU_H_
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <lao/config.hpp>
+#include <lao/instrumentation.hpp>
+#include <lao/linalg/core/expression.hpp>
+#include <lao/linalg/core/extent.hpp>
+#include <lao/linalg/dense/gemm.hpp>
 #include <lao/linalg/dense/matrix.hpp>
 #include <lao/linalg/math/constraints.hpp>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace lao {
 namespace linalg {
 
     /// @brief LU decomposition with Doolittle's algorithm.
     /// @details This decomposes a coefficient matrix A into the upper and lower matrices
-    /// given the equation Ax = b.
+    /// given the equation Ax = b. There is no pivoting, for a factorization which can be reused to
+    /// solve systems see LUFactorization.
     /// @param A A matrix used in the equation Ax=b to be solved.
     /// @param L Lower diagonal matrix, returned.
     /// @param U Upper diagonal matrix, returned.
@@ -26,20 +38,210 @@ namespace linalg {
             for (size_t i = j; i < C + 1; ++i) {
                 S sum = 0;
                 for (size_t k = 1; k < j; ++k)
-                    sum += L(j, k) * U(k, i);
-                U(j, i) = A(j, i) - sum;
+                    sum += L.coeff(j, k) * U.coeff(k, i);
+                U.coeff(j, i) = A.coeff(j, i) - sum;
             }
 
             for (size_t i = j + 1; i < R + 1; ++i) {
                 S sum = 0;
                 for (size_t k = 1; k < j; ++k)
-                    sum += L(i, k) * U(k, j);
-                L(i, j) = (A(i, j) - sum) / U(j, j);
+                    sum += L.coeff(i, k) * U.coeff(k, j);
+                L.coeff(i, j) = (A.coeff(i, j) - sum) / U.coeff(j, j);
             }
         }
     };
 
+    /// @brief LU factorization with partial pivoting, PA = LU.
+    /// @details The factors are packed into one N x N matrix, with the unit lower triangular L below
+    /// the diagonal and U on and above it, and P is stored as a permutation of the rows. The
+    /// factorization is computed once in O(N^3) and then reused to solve for any number of right
+    /// hand sides in O(N^2) each, or to compute the determinant in O(N).
+    ///
+    /// The algorithm is right-looking and blocked: a panel of LAO_LU_BLOCK_SIZE columns is factored
+    /// with row interchanges, the matching block row of U is solved for, and the trailing submatrix
+    /// is updated with a single gemm, so most of the work runs in the GEMM kernel.
+    template <typename S, size_t N>
+    class LUFactorization {
+    public:
+        using value_type = S;
+
+        LUFactorization() = default;
+
+        /// @brief Factors a square matrix.
+        template <typename E, size_t R, size_t C>
+        requires(EnforceSquareMatrix<S, R, C> && extents_match(N, R))
+        explicit LUFactorization(const MatrixExpression<E, S, R, C>& A)
+        {
+            compute(A);
+        }
+
+        /// @brief Factors a square matrix, replacing any previous factorization.
+        /// @details A singular matrix is factored to completion, with a zero on the diagonal of U.
+        template <typename E, size_t R, size_t C>
+        requires(EnforceSquareMatrix<S, R, C> && extents_match(N, R))
+        void compute(const MatrixExpression<E, S, R, C>& A)
+        {
+            detail::check_square(static_cast<const E&>(A));
+            instrumentation::ScopedTimer timer(instrumentation::Kernel::lu);
+            m_lu = A;
+            const size_t n = m_lu.rows();
+            m_perm.resize(n);
+            std::iota(m_perm.begin(), m_perm.end(), size_t(0));
+            m_sign = 1;
+            m_singular = false;
+
+            S* a = m_lu.data();
+            for (size_t k0 = 0; k0 < n; k0 += LAO_LU_BLOCK_SIZE) {
+                const size_t kb = std::min<size_t>(LAO_LU_BLOCK_SIZE, n - k0);
+                const size_t k1 = k0 + kb;
+
+                // factor the panel of columns [k0, k1) over rows [k0, n).
+                for (size_t j = k0; j < k1; ++j) {
+                    size_t p = j;
+                    for (size_t i = j + 1; i < n; ++i)
+                        if (std::abs(a[i * n + j]) > std::abs(a[p * n + j]))
+                            p = i;
+                    if (a[p * n + j] == S(0)) {
+                        m_singular = true;
+                        continue;
+                    }
+                    if (p != j) {
+                        std::swap_ranges(a + j * n, a + (j + 1) * n, a + p * n);
+                        std::swap(m_perm[j], m_perm[p]);
+                        m_sign = -m_sign;
+                    }
+
+                    const S pivot = a[j * n + j];
+                    for (size_t i = j + 1; i < n; ++i) {
+                        const S l = a[i * n + j] /= pivot;
+                        for (size_t c = j + 1; c < k1; ++c)
+                            a[i * n + c] -= l * a[j * n + c];
+                    }
+                }
+                if (k1 == n)
+                    break;
+
+                // solve L11 * U12 = A12 for the block row of U right of the panel.
+                for (size_t i = k0 + 1; i < k1; ++i)
+                    for (size_t k = k0; k < i; ++k) {
+                        const S l = a[i * n + k];
+                        for (size_t c = k1; c < n; ++c)
+                            a[i * n + c] -= l * a[k * n + c];
+                    }
+
+                // A22 -= L21 * U12.
+                gemm(n - k1, n - k1, kb, S(-1), a + k1 * n + k0, n, 1, a + k0 * n + k1, n, 1,
+                    S(1), a + k1 * n + k1, n, 1);
+            }
+        }
+
+        /// @brief Returns the order of the factored matrix.
+        size_t size() const noexcept
+        {
+            return m_lu.rows();
+        }
+
+        /// @brief Returns true if the factored matrix is singular, i.e. U has a zero on its diagonal.
+        bool is_singular() const noexcept
+        {
+            return m_singular;
+        }
+
+        /// @brief Returns L and U packed into one matrix, L below the diagonal and U on and above it.
+        const Matrix<S, N, N>& packed() const noexcept
+        {
+            return m_lu;
+        }
+
+        /// @brief Returns the row permutation, row i of PA is row permutation()[i] of A, 0 indexed.
+        const std::vector<size_t>& permutation() const noexcept
+        {
+            return m_perm;
+        }
+
+        /// @brief Returns the determinant of the factored matrix.
+        S det() const noexcept
+        {
+            S result = S(m_sign);
+            for (size_t i = 1; i < size() + 1; ++i)
+                result *= m_lu.coeff(i, i);
+            return result;
+        }
+
+        /// @brief Solves AX = B for X, for every column of B at once.
+        /// @details Throws std::invalid_argument if B does not have N rows, and std::runtime_error
+        /// if the factored matrix is singular.
+        template <typename E, size_t R2, size_t C2>
+        requires(extents_match(N, R2))
+        Matrix<S, merged_extent_v<N, R2>, C2> solve(const MatrixExpression<E, S, R2, C2>& B) const
+        {
+            if (B.rows() != size())
+                throw std::invalid_argument("Matrix dimensions do not match.");
+            if (m_singular)
+                throw std::runtime_error("Matrix is singular.");
+
+            // X = PB, then forward substitution with L and back substitution with U, in blocks of
+            // rows so that the updates from the solved rows are gemm calls.
+            const auto& b = detail::materialize(B);
+            Matrix<S, merged_extent_v<N, R2>, C2> X(b);
+            const size_t n = size();
+            const size_t m = X.cols();
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < m; ++j)
+                    X.coeff(i + 1, j + 1) = b.coeff(m_perm[i] + 1, j + 1);
+
+            const S* a = m_lu.data();
+            S* x = X.data();
+            for (size_t i0 = 0; i0 < n; i0 += LAO_LU_BLOCK_SIZE) {
+                const size_t i1 = std::min<size_t>(i0 + LAO_LU_BLOCK_SIZE, n);
+                gemm(i1 - i0, m, i0, S(-1), a + i0 * n, n, 1, x, m, 1, S(1), x + i0 * m, m, 1);
+                for (size_t i = i0 + 1; i < i1; ++i)
+                    for (size_t k = i0; k < i; ++k) {
+                        const S l = a[i * n + k];
+                        for (size_t j = 0; j < m; ++j)
+                            x[i * m + j] -= l * x[k * m + j];
+                    }
+            }
+            for (size_t i1 = n; i1 > 0;) {
+                const size_t i0 = i1 > LAO_LU_BLOCK_SIZE ? i1 - LAO_LU_BLOCK_SIZE : 0;
+                gemm(i1 - i0, m, n - i1, S(-1), a + i0 * n + i1, n, 1, x + i1 * m, m, 1, S(1), x + i0 * m, m, 1);
+                for (size_t i = i1; i-- > i0;) {
+                    for (size_t k = i + 1; k < i1; ++k) {
+                        const S u = a[i * n + k];
+                        for (size_t j = 0; j < m; ++j)
+                            x[i * m + j] -= u * x[k * m + j];
+                    }
+                    const S pivot = a[i * n + i];
+                    for (size_t j = 0; j < m; ++j)
+                        x[i * m + j] /= pivot;
+                }
+                i1 = i0;
+            }
+            return X;
+        }
+
+        /// @brief Returns the inverse of the factored matrix.
+        /// @details Throws std::runtime_error if the factored matrix is singular.
+        Matrix<S, N, N> inverse() const
+        {
+            Matrix<S, N, N> identity;
+            if constexpr (N == Dynamic)
+                identity.resize(size(), size());
+            identity.eye();
+            return solve(identity);
+        }
+
+    private:
+        Matrix<S, N, N> m_lu;
+        std::vector<size_t> m_perm;
+        int m_sign = 1;
+        bool m_singular = false;
+    };
+
+    template <typename E, typename S, size_t R, size_t C>
+    LUFactorization(const MatrixExpression<E, S, R, C>&) -> LUFactorization<S, merged_extent_v<R, C>>;
+
 }; // namespace linalg
 }; // namespace lao
 
-#endif // LAO_LINALG_DENSE_LU_H
\ No newline at end of file
+#endif // LAO_LINALG_DENSE_LU_H_
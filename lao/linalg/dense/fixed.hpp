@@ -0,0 +1,232 @@
+/// fixed.hpp implements fully unrolled kernels for matrices whose extents are fixed at compile-time
+/// and at most LAO_FIXED_UNROLL_SIZE, i.e. the 3x3 rotations and 6x6 state transition matrices of
+/// the astro code.
+///
+/// Every loop is unrolled with a fold over an index sequence rather than left to the optimizer, so
+/// each kernel compiles to straight-line code over a few registers. Partial pivoting is done with
+/// conditional swaps against each row below the pivot in turn, which brings the largest magnitude
+/// to the pivot row like the search in LUFactorization, but compiles to selects instead of branches.
+/// Operands are described by a pointer and a row and column stride, as for gemm.
+
+#ifndef LAO_LINALG_DENSE_FIXED_H_
+#define LAO_LINALG_DENSE_FIXED_H_
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <lao/config.hpp>
+#include <lao/linalg/core/extent.hpp>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace lao {
+namespace linalg {
+
+    namespace detail {
+
+        /// @brief Whether a matrix with extents R x C is evaluated with the unrolled kernels.
+        template <size_t R, size_t C>
+        inline constexpr bool is_fixed_unrolled_v = R != Dynamic && C != Dynamic && R <= LAO_FIXED_UNROLL_SIZE && C <= LAO_FIXED_UNROLL_SIZE;
+
+        template <typename F, size_t... I>
+        constexpr void unroll_impl(F& f, std::index_sequence<I...>)
+        {
+            (f(std::integral_constant<size_t, I> {}), ...);
+        }
+
+        /// @brief Calls f(std::integral_constant<size_t, I>) for I = 0, ..., N - 1, unrolled.
+        template <size_t N, typename F>
+        constexpr void unroll(F&& f)
+        {
+            unroll_impl(f, std::make_index_sequence<N> {});
+        }
+
+        /// @brief Returns c ? a : b, without a branch.
+        /// @details Compilers readily turn a conditional into a branch when it guards a row swap,
+        /// which mispredicts half the time on pivots, so 4 and 8 byte scalars are blended by a mask.
+        template <typename S>
+        S select(bool c, S a, S b) noexcept
+        {
+            if constexpr (std::is_arithmetic_v<S> && (sizeof(S) == 4 || sizeof(S) == 8)) {
+                using U = std::conditional_t<sizeof(S) == 8, std::uint64_t, std::uint32_t>;
+                const U mask = U(0) - U(c);
+                const U ua = std::bit_cast<U>(a);
+                const U ub = std::bit_cast<U>(b);
+                return std::bit_cast<S>(static_cast<U>(ub ^ ((ua ^ ub) & mask)));
+            } else {
+                return c ? a : b;
+            }
+        }
+
+        /// @brief Computes C = A * B for an M x K A and a K x N B. C must not alias A or B.
+        template <size_t M, size_t N, size_t K, typename S>
+        void fixed_gemm(const S* A, size_t rsa, size_t csa, const S* B, size_t rsb, size_t csb, S* C, size_t rsc, size_t csc) noexcept
+        {
+            unroll<M>([&](auto i) {
+                unroll<N>([&](auto j) {
+                    S sum = S(0);
+                    unroll<K>([&](auto k) { sum += A[i * rsa + k * csa] * B[k * rsb + j * csb]; });
+                    C[i * rsc + j * csc] = sum;
+                });
+            });
+        }
+
+        /// @brief Copies an R x C matrix into the row-major array out.
+        template <size_t R, size_t C, typename S>
+        void fixed_load(const S* A, size_t rsa, size_t csa, S* out) noexcept
+        {
+            unroll<R>([&](auto i) {
+                unroll<C>([&](auto j) { out[i * C + j] = A[i * rsa + j * csa]; });
+            });
+        }
+
+        /// @brief Gaussian elimination with partial pivoting of the row-major N x N array a, applying
+        /// the same row operations to the row-major N x M array b.
+        /// @details On return a holds U above its diagonal, and the determinant of the original a is
+        /// returned. singular is set if a pivot is zero, in which case that column is skipped.
+        template <size_t N, size_t M, typename S>
+        S fixed_eliminate(S* a, S* b, bool& singular) noexcept
+        {
+            S det = S(1);
+            singular = false;
+            unroll<N>([&](auto kc) {
+                constexpr size_t k = decltype(kc)::value;
+                unroll<N - k - 1>([&](auto ic) {
+                    constexpr size_t i = k + 1 + decltype(ic)::value;
+                    const bool swap = std::abs(a[i * N + k]) > std::abs(a[k * N + k]);
+                    unroll<N - k>([&](auto c) {
+                        const S top = a[k * N + k + c];
+                        const S bottom = a[i * N + k + c];
+                        a[k * N + k + c] = select(swap, bottom, top);
+                        a[i * N + k + c] = select(swap, top, bottom);
+                    });
+                    unroll<M>([&](auto c) {
+                        const S top = b[k * M + c];
+                        const S bottom = b[i * M + c];
+                        b[k * M + c] = select(swap, bottom, top);
+                        b[i * M + c] = select(swap, top, bottom);
+                    });
+                    det = select(swap, -det, det);
+                });
+
+                const S pivot = a[k * N + k];
+                det *= pivot;
+                singular |= pivot == S(0);
+                // both sides of a select are evaluated, so never divide by a zero pivot.
+                const S inv_pivot = select(pivot == S(0), S(0), S(1) / select(pivot == S(0), S(1), pivot));
+                unroll<N - k - 1>([&](auto ic) {
+                    constexpr size_t i = k + 1 + decltype(ic)::value;
+                    const S l = a[i * N + k] * inv_pivot;
+                    unroll<N - k - 1>([&](auto c) { a[i * N + k + 1 + c] -= l * a[k * N + k + 1 + c]; });
+                    unroll<M>([&](auto c) { b[i * M + c] -= l * b[k * M + c]; });
+                });
+            });
+            return det;
+        }
+
+        /// @brief Solves U X = B in place of the row-major N x M array b, for the upper triangle U of
+        /// the row-major N x N array u.
+        template <size_t N, size_t M, typename S>
+        void fixed_back_substitute(const S* u, S* b) noexcept
+        {
+            unroll<N>([&](auto rc) {
+                constexpr size_t i = N - 1 - decltype(rc)::value;
+                const S inv_pivot = S(1) / u[i * N + i];
+                unroll<M>([&](auto c) {
+                    S sum = b[i * M + c];
+                    unroll<N - 1 - i>([&](auto kc) {
+                        constexpr size_t k = i + 1 + decltype(kc)::value;
+                        sum -= u[i * N + k] * b[k * M + c];
+                    });
+                    b[i * M + c] = sum * inv_pivot;
+                });
+            });
+        }
+
+        /// @brief Returns the determinant of an N x N matrix.
+        /// @details In closed form up to 3 x 3, by elimination with partial pivoting otherwise.
+        template <size_t N, typename S>
+        S fixed_det(const S* A, size_t rsa, size_t csa) noexcept
+        {
+            const auto a = [&](size_t i, size_t j) { return A[i * rsa + j * csa]; };
+            if constexpr (N == 1) {
+                return a(0, 0);
+            } else if constexpr (N == 2) {
+                return a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+            } else if constexpr (N == 3) {
+                return a(0, 0) * (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1))
+                    - a(0, 1) * (a(1, 0) * a(2, 2) - a(1, 2) * a(2, 0))
+                    + a(0, 2) * (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0));
+            } else {
+                S lu[N * N];
+                fixed_load<N, N>(A, rsa, csa, lu);
+                bool singular;
+                return fixed_eliminate<N, 0>(lu, static_cast<S*>(nullptr), singular);
+            }
+        }
+
+        /// @brief Solves AX = B for an N x N A and an N x M B, writing X to out.
+        /// @details out may alias B. Throws std::runtime_error if A is singular.
+        template <size_t N, size_t M, typename S>
+        void fixed_solve(const S* A, size_t rsa, size_t csa, const S* B, size_t rsb, size_t csb, S* out, size_t rso, size_t cso)
+        {
+            S lu[N * N];
+            S x[N * M];
+            fixed_load<N, N>(A, rsa, csa, lu);
+            fixed_load<N, M>(B, rsb, csb, x);
+            bool singular;
+            fixed_eliminate<N, M>(lu, x, singular);
+            if (singular)
+                throw std::runtime_error("Matrix is singular.");
+            fixed_back_substitute<N, M>(lu, x);
+            unroll<N>([&](auto i) {
+                unroll<M>([&](auto j) { out[i * rso + j * cso] = x[i * M + j]; });
+            });
+        }
+
+        /// @brief Computes the inverse of an N x N matrix into out, which must not alias A.
+        /// @details From the adjugate up to 3 x 3, by solving against the identity otherwise. Throws
+        /// std::runtime_error if A is singular.
+        template <size_t N, typename S>
+        void fixed_inverse(const S* A, size_t rsa, size_t csa, S* out, size_t rso, size_t cso)
+        {
+            const auto a = [&](size_t i, size_t j) { return A[i * rsa + j * csa]; };
+            const auto o = [&](size_t i, size_t j) -> S& { return out[i * rso + j * cso]; };
+            if constexpr (N <= 3) {
+                const S det = fixed_det<N>(A, rsa, csa);
+                if (det == S(0))
+                    throw std::runtime_error("Matrix is singular.");
+                const S inv_det = S(1) / det;
+                if constexpr (N == 1) {
+                    o(0, 0) = inv_det;
+                } else if constexpr (N == 2) {
+                    o(0, 0) = a(1, 1) * inv_det;
+                    o(0, 1) = -a(0, 1) * inv_det;
+                    o(1, 0) = -a(1, 0) * inv_det;
+                    o(1, 1) = a(0, 0) * inv_det;
+                } else {
+                    o(0, 0) = (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1)) * inv_det;
+                    o(0, 1) = (a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2)) * inv_det;
+                    o(0, 2) = (a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1)) * inv_det;
+                    o(1, 0) = (a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2)) * inv_det;
+                    o(1, 1) = (a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0)) * inv_det;
+                    o(1, 2) = (a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2)) * inv_det;
+                    o(2, 0) = (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0)) * inv_det;
+                    o(2, 1) = (a(0, 1) * a(2, 0) - a(0, 0) * a(2, 1)) * inv_det;
+                    o(2, 2) = (a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0)) * inv_det;
+                }
+            } else {
+                S identity[N * N] = {};
+                unroll<N>([&](auto i) { identity[i * N + i] = S(1); });
+                fixed_solve<N, N>(A, rsa, csa, identity, N, 1, out, rso, cso);
+            }
+        }
+
+    }; // namespace detail
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_DENSE_FIXED_H_
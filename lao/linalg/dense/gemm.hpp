@@ -0,0 +1,213 @@
+/// gemm.hpp implements the general matrix-matrix multiplication kernel C = alpha * A * B + beta * C
+/// used when a matrix product is evaluated into a dense matrix.
+///
+/// The structure follows the well known GotoBLAS/BLIS decomposition:
+/// * the k dimension is split into KC panels, and a KC x NC block of B is packed into NR wide panels
+///   which stay resident in L3/L2,
+/// * the m dimension is split into MC blocks, and an MC x KC block of A is packed into MR tall panels
+///   which stay resident in L2,
+/// * an MR x NR register tile of C is updated by the micro-kernel, streaming the packed panels from L1.
+///
+/// The micro-kernel is written against simd::Packet and so compiles to AVX-512, AVX, SSE2 or NEON
+/// depending on the target, or to scalar code otherwise. Operands are described by a pointer and a row
+/// and column stride, so row-major, column-major and transposed operands are all handled by the packing.
+/// Products with at least LAO_GEMM_PARALLEL_THRESHOLD multiply-adds split the MC blocks across threads.
+
+#ifndef LAO_LINALG_DENSE_GEMM_H_
+#define LAO_LINALG_DENSE_GEMM_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <lao/config.hpp>
+#include <lao/instrumentation.hpp>
+#include <lao/linalg/core/simd.hpp>
+#include <lao/parallel.hpp>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    namespace detail {
+
+        /// @brief Register tile and cache block sizes for the GEMM kernel.
+        template <typename S>
+        struct GemmBlocking {
+            using packet = simd::Packet<S>;
+            // register tile is MR x NR, the accumulators are MR * NR / packet::size packets.
+            static constexpr size_t mr = 6;
+            static constexpr size_t nr = packet::size == 1 ? 4 : 2 * packet::size;
+            static constexpr size_t kc = LAO_GEMM_KC;
+            static constexpr size_t mc = (LAO_GEMM_MC / mr) * mr;
+            static constexpr size_t nc = (LAO_GEMM_NC / nr) * nr;
+        };
+
+        /// @brief Packs an mc x kc block of A into MR tall panels, scaling by alpha.
+        /// @details Rows past mc are zero padded so the micro-kernel never needs to special case them.
+        template <typename S>
+        void gemm_pack_a(size_t mc, size_t kc, S alpha, const S* A, size_t rsa, size_t csa, S* buf)
+        {
+            constexpr size_t mr = GemmBlocking<S>::mr;
+            for (size_t i0 = 0; i0 < mc; i0 += mr) {
+                const size_t m_eff = std::min(mr, mc - i0);
+                for (size_t p = 0; p < kc; ++p) {
+                    for (size_t i = 0; i < mr; ++i)
+                        buf[i] = i < m_eff ? alpha * A[(i0 + i) * rsa + p * csa] : S(0);
+                    buf += mr;
+                }
+            }
+        }
+
+        /// @brief Packs a kc x nc block of B into NR wide panels.
+        /// @details Columns past nc are zero padded so the micro-kernel never needs to special case them.
+        template <typename S>
+        void gemm_pack_b(size_t kc, size_t nc, const S* B, size_t rsb, size_t csb, S* buf)
+        {
+            constexpr size_t nr = GemmBlocking<S>::nr;
+            for (size_t j0 = 0; j0 < nc; j0 += nr) {
+                const size_t n_eff = std::min(nr, nc - j0);
+                for (size_t p = 0; p < kc; ++p) {
+                    const S* row = B + p * rsb + j0 * csb;
+                    for (size_t j = 0; j < nr; ++j)
+                        buf[j] = j < n_eff ? row[j * csb] : S(0);
+                    buf += nr;
+                }
+            }
+        }
+
+        /// @brief Updates an MR x NR tile of C with the product of a packed A and B panel.
+        /// @details Partial tiles on the edges of C (m_eff < MR or n_eff < NR) and non unit column strides
+        /// are accumulated through a scratch tile instead of being stored directly.
+        template <typename S>
+        void gemm_micro_kernel(size_t kc, const S* Ap, const S* Bp, S* C, size_t rsc, size_t csc, size_t m_eff, size_t n_eff)
+        {
+            using blocking = GemmBlocking<S>;
+            using P = typename blocking::packet;
+            constexpr size_t mr = blocking::mr;
+            constexpr size_t nr = blocking::nr;
+            constexpr size_t nv = nr / P::size;
+
+            typename P::type acc[mr][nv];
+            for (size_t i = 0; i < mr; ++i)
+                for (size_t j = 0; j < nv; ++j)
+                    acc[i][j] = P::zero();
+
+            for (size_t p = 0; p < kc; ++p) {
+                typename P::type b[nv];
+                for (size_t j = 0; j < nv; ++j)
+                    b[j] = P::load(Bp + j * P::size);
+                for (size_t i = 0; i < mr; ++i) {
+                    const typename P::type a = P::set1(Ap[i]);
+                    for (size_t j = 0; j < nv; ++j)
+                        acc[i][j] = P::fmadd(a, b[j], acc[i][j]);
+                }
+                Ap += mr;
+                Bp += nr;
+            }
+
+            if (m_eff == mr && n_eff == nr && csc == 1) {
+                for (size_t i = 0; i < mr; ++i)
+                    for (size_t j = 0; j < nv; ++j) {
+                        S* c = C + i * rsc + j * P::size;
+                        P::store(c, P::add(P::load(c), acc[i][j]));
+                    }
+            } else {
+                S tile[mr * nr];
+                for (size_t i = 0; i < mr; ++i)
+                    for (size_t j = 0; j < nv; ++j)
+                        P::store(tile + i * nr + j * P::size, acc[i][j]);
+                for (size_t i = 0; i < m_eff; ++i)
+                    for (size_t j = 0; j < n_eff; ++j)
+                        C[i * rsc + j * csc] += tile[i * nr + j];
+            }
+        }
+
+        /// @brief Scales C by beta, treating beta == 0 as an overwrite.
+        template <typename S>
+        void gemm_scale(size_t m, size_t n, S beta, S* C, size_t rsc, size_t csc)
+        {
+            if (beta == S(1))
+                return;
+            for (size_t i = 0; i < m; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    C[i * rsc + j * csc] = beta == S(0) ? S(0) : beta * C[i * rsc + j * csc];
+        }
+
+    }; // namespace detail
+
+    /// @brief General matrix-matrix multiplication, C = alpha * A * B + beta * C.
+    /// @details All matrices are 0 indexed and described by a pointer and a row and column stride,
+    /// i.e. element (i, j) of A is `A[i * rsa + j * csa]`. A is m x k, B is k x n and C is m x n.
+    /// C must not alias A or B.
+    /// @param m number of rows of A and C.
+    /// @param n number of columns of B and C.
+    /// @param k number of columns of A and rows of B.
+    template <typename S>
+    void gemm(size_t m, size_t n, size_t k, S alpha, const S* A, size_t rsa, size_t csa,
+        const S* B, size_t rsb, size_t csb, S beta, S* C, size_t rsc, size_t csc)
+    {
+        using blocking = detail::GemmBlocking<S>;
+        instrumentation::ScopedTimer timer(instrumentation::Kernel::gemm);
+
+        detail::gemm_scale(m, n, beta, C, rsc, csc);
+        if (m == 0 || n == 0 || k == 0 || alpha == S(0))
+            return;
+
+        // packing does not pay for itself on small products, use a plain i-p-j loop which
+        // streams B and C along rows.
+        if (m * n * k <= LAO_GEMM_SMALL_THRESHOLD) {
+            for (size_t i = 0; i < m; ++i)
+                for (size_t p = 0; p < k; ++p) {
+                    const S a = alpha * A[i * rsa + p * csa];
+                    for (size_t j = 0; j < n; ++j)
+                        C[i * rsc + j * csc] += a * B[p * rsb + j * csb];
+                }
+            return;
+        }
+
+        const size_t kc_max = std::min(blocking::kc, k);
+        const size_t mc_max = std::min(blocking::mc, (m + blocking::mr - 1) / blocking::mr * blocking::mr);
+        const size_t nc_max = std::min(blocking::nc, (n + blocking::nr - 1) / blocking::nr * blocking::nr);
+        std::vector<S> b_buf(kc_max * nc_max);
+
+        // the MC blocks of A update disjoint rows of C, so large products split them across threads,
+        // each packing into its own buffer while sharing the packed panel of B.
+        const size_t m_blocks = (m + blocking::mc - 1) / blocking::mc;
+        const size_t grain = m * n * k >= LAO_GEMM_PARALLEL_THRESHOLD ? 1 : m_blocks;
+        std::vector<S> a_buf(grain == 1 ? 0 : mc_max * kc_max);
+
+        for (size_t jc = 0; jc < n; jc += blocking::nc) {
+            const size_t nc = std::min(blocking::nc, n - jc);
+            for (size_t pc = 0; pc < k; pc += blocking::kc) {
+                const size_t kc = std::min(blocking::kc, k - pc);
+                detail::gemm_pack_b(kc, nc, B + pc * rsb + jc * csb, rsb, csb, b_buf.data());
+
+                parallel_for(0, m_blocks, grain, [&](size_t first, size_t last) {
+                    std::vector<S> local;
+                    S* a_pack = a_buf.data();
+                    if (a_buf.empty()) {
+                        local.resize(mc_max * kc_max);
+                        a_pack = local.data();
+                    }
+
+                    for (size_t block = first; block < last; ++block) {
+                        const size_t ic = block * blocking::mc;
+                        const size_t mc = std::min(blocking::mc, m - ic);
+                        detail::gemm_pack_a(mc, kc, alpha, A + ic * rsa + pc * csa, rsa, csa, a_pack);
+
+                        for (size_t jr = 0; jr < nc; jr += blocking::nr) {
+                            for (size_t ir = 0; ir < mc; ir += blocking::mr) {
+                                detail::gemm_micro_kernel(kc, a_pack + ir * kc, b_buf.data() + jr * kc,
+                                    C + (ic + ir) * rsc + (jc + jr) * csc, rsc, csc,
+                                    std::min(blocking::mr, mc - ir), std::min(blocking::nr, nc - jr));
+                            }
+                        }
+                    }
+                });
+            }
+        }
+    }
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_DENSE_GEMM_H_
@@ -9,10 +9,24 @@
 #include <functional>
 #include <iostream>
 #include <iterator>
+#include <lao/config.hpp>
+#include <lao/instrumentation.hpp>
 #include <lao/linalg/core/expression.hpp>
+#include <lao/linalg/core/extent.hpp>
 #include <lao/linalg/core/forward.hpp>
+#include <lao/linalg/core/simd.hpp>
+#include <lao/linalg/core/storage.hpp>
+#include <lao/linalg/dense/fixed.hpp>
+#include <lao/linalg/dense/view.hpp>
+#include <lao/linalg/math/constraints.hpp>
+#include <lao/parallel.hpp>
+#include <limits>
+#include <memory>
 #include <random>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace lao {
@@ -30,20 +44,31 @@ namespace linalg {
     /// @details A matrix is represented by a number of rows and columns,
     /// noted as `row x column`.
     /// It is templated with a Scalar parameter, and a Row and Column.
-    /// The default storage mechanism is using std::vector with row-major ordering,
-    /// though this can be swapped out assuming it has a linear access pattern.
+    /// The default storage mechanism is inline (StaticStorage) for small matrices,
+    /// or std::vector otherwise, though this can be swapped out assuming it has a linear access pattern.
+    /// Elements are laid out in row-major order by default, or column-major order with `Layout::ColMajor`.
+    /// Either extent can be `Dynamic`, in which case it is set at runtime by the constructor, `resize()`
+    /// or assignment, and shape mismatches which cannot be caught at compile-time throw std::invalid_argument.
+    /// Blocks, rows and columns are viewed in place with `submat`, `rview`, `cview`, `rviews` and
+    /// `cviews`, see view.hpp.
     /// It also uses 1 indexing.
-    template <typename S, size_t R, size_t C, typename B>
-    class Matrix : public MatrixExpression<Matrix<S, R, C>, S, R, C> {
+    template <typename S, size_t R, size_t C, typename B, Layout L>
+    class Matrix : public MatrixExpression<Matrix<S, R, C, B, L>, S, R, C>,
+                   public BlockAccess<Matrix<S, R, C, B, L>, S, const S, R, C, L, false> {
     public:
         using value_type = S;
         using storage_type = B;
         using iterator = typename B::iterator;
         using const_iterator = typename B::const_iterator;
 
+        static constexpr bool nest_by_reference = true;
+        static constexpr bool linear_access = true;
+        static constexpr bool packet_access = true;
+        static constexpr Layout layout = L;
+
         class RowIterator {
         public:
-            explicit RowIterator(size_t row, size_t col, Matrix<S, R, C>& matrix)
+            explicit RowIterator(size_t row, size_t col, Matrix& matrix)
                 : current_row(row)
                 , current_col(col)
                 , matrix_ref(matrix)
@@ -90,12 +115,12 @@ namespace linalg {
         private:
             size_t current_row;
             size_t current_col;
-            Matrix<S, R, C>& matrix_ref;
+            Matrix& matrix_ref;
         };
 
         class ColIterator {
         public:
-            ColIterator(size_t row, size_t col, Matrix<S, R, C>& matrix)
+            ColIterator(size_t row, size_t col, Matrix& matrix)
                 : current_row(row)
                 , current_col(col)
                 , matrix_ref(matrix)
@@ -142,116 +167,352 @@ namespace linalg {
         private:
             size_t current_row;
             size_t current_col;
-            Matrix<S, R, C>& matrix_ref;
+            Matrix& matrix_ref;
         };
 
         /// @brief Default constructor which zero initializes the matrix.
+        /// @details Dynamic extents start out as 0.
         Matrix()
-            : m_elements(R * C, value_type(0))
+            : m_elements(size(), value_type(0))
+        {
+            count_allocation(size());
+        }
+
+        /// @brief Constructor for a zero initialized matrix of the given shape.
+        /// @details Extents which are fixed at compile-time must match.
+        Matrix(size_t rows, size_t cols) requires(R == Dynamic || C == Dynamic)
+        {
+            resize(rows, cols);
+        }
+
+        /// @brief Constructor for a matrix of the given shape initialized with a fill type.
+        Matrix(size_t rows, size_t cols, filltype fill) requires(R == Dynamic || C == Dynamic)
+            : Matrix(rows, cols)
+        {
+            apply_fill(fill);
+        }
+
+        /// @brief Constructor taking a vector of elements, in storage order, to construct a matrix.
+        Matrix(const std::vector<S>& elements) requires(R != Dynamic && C != Dynamic)
         {
+            if (elements.size() != R * C)
+                throw std::invalid_argument("Initializer list does not match matrix size.");
+            count_growth(elements.size());
+            m_elements.assign(elements.begin(), elements.end());
         }
 
-        /// @brief Constructor taking a vector of elements to construct a matrix.
-        Matrix(const std::vector<S>& elements)
+        /// @brief Constructor taking ownership of a vector of elements, in storage order.
+        /// @details The vector becomes the storage if the matrix is stored in a std::vector, and is
+        /// copied into it otherwise.
+        Matrix(std::vector<S>&& elements) requires(R != Dynamic && C != Dynamic)
         {
             if (elements.size() != R * C)
                 throw std::invalid_argument("Initializer list does not match matrix size.");
-            m_elements = elements;
+            take(std::move(elements));
+        }
+
+        /// @brief Constructor taking the shape and a vector of elements, in storage order, to construct a matrix.
+        Matrix(size_t rows, size_t cols, const std::vector<S>& elements) requires(R == Dynamic || C == Dynamic)
+        {
+            set_shape(rows, cols);
+            if (elements.size() != size())
+                throw std::invalid_argument("Initializer list does not match matrix size.");
+            m_elements.assign(elements.begin(), elements.end());
+        }
+
+        /// @brief Constructor taking the shape and ownership of a vector of elements, in storage order.
+        /// @details The vector becomes the storage if the matrix is stored in a std::vector, and is
+        /// copied into it otherwise.
+        Matrix(size_t rows, size_t cols, std::vector<S>&& elements) requires(R == Dynamic || C == Dynamic)
+        {
+            if (!extents_match(R, rows) || !extents_match(C, cols))
+                throw std::invalid_argument("Matrix dimensions do not match.");
+            if (elements.size() != rows * cols)
+                throw std::invalid_argument("Initializer list does not match matrix size.");
+            m_rows.set(rows);
+            m_cols.set(cols);
+            take(std::move(elements));
         }
 
         /// @brief Constructor to initialize with an initializer list.
+        /// @details Dynamic extents are taken from the shape of the list.
         Matrix(std::initializer_list<std::initializer_list<value_type>> list)
-            : m_elements(R * C, value_type(0))
         {
-            if (list.size() != R || list.begin()->size() != C)
+            const size_t cols = list.size() == 0 ? 0 : list.begin()->size();
+            if (!extents_match(R, list.size()) || !extents_match(C, cols))
                 throw std::invalid_argument("Initializer list does not match matrix size.");
+            for (const auto& il : list)
+                if (il.size() != cols)
+                    throw std::invalid_argument("Initializer list does not match matrix size.");
+            resize(list.size(), cols);
             size_t row = 0;
             for (const auto& il : list) {
-                std::copy(il.begin(), il.end(), m_elements.begin() + row * C);
+                if constexpr (L == Layout::RowMajor) {
+                    std::copy(il.begin(), il.end(), m_elements.begin() + row * cols);
+                } else {
+                    size_t col = 0;
+                    for (const auto& val : il)
+                        m_elements[index(row, col++)] = val;
+                }
                 ++row;
             }
         }
 
         /// @brief Constructor to initialize the matrix with a fill type.
         Matrix(filltype fill)
-            : m_elements(R * C, value_type(0))
+            : m_elements(size(), value_type(0))
         {
-            if (fill == filltype::zeros) {
-                // Set the matrix to all zeros
-                zeros();
-            } else if (fill == filltype::ones) {
-                // Set the matrix to all ones
-                ones();
-            } else if (fill == filltype::eye) {
-                // Set the matrix to the identity, i.e. the diagonal has ones.
-                // This is only valid for square matrics.
-                eye();
-            } else if (fill == filltype::rand) {
-                // Fill in the matrix with random values in range [0,1].
-                rand();
-            } else if (fill == filltype::none) {
-                // nada
-            } else {
-                throw std::invalid_argument("Invalid filltype.");
-            }
+            count_allocation(size());
+            apply_fill(fill);
         }
 
         /// @brief Copy constructor.
         Matrix(const Matrix& other)
-            : m_elements(other.m_elements)
+            : m_rows(other.m_rows)
+            , m_cols(other.m_cols)
+            , m_elements(other.m_elements)
         {
+            count_allocation(m_elements.size());
+            instrumentation::count_copy(m_elements.size() * sizeof(value_type));
         }
 
         Matrix& operator=(const Matrix& other)
         {
-            if (&other != this)
+            if (&other != this) {
+                count_growth(other.m_elements.size());
+                instrumentation::count_copy(other.m_elements.size() * sizeof(value_type));
+                m_rows = other.m_rows;
+                m_cols = other.m_cols;
                 m_elements = other.m_elements;
+            }
+            return *this;
+        }
+
+        /// @brief Move constructor.
+        /// @details Heap storage is taken over, while inline storage is copied and other is left as
+        /// it was. A source with a dynamic extent is left empty as after `reset()`. One with only
+        /// static extents cannot change its shape, so it is left without storage: it reads as zeros
+        /// and allocates zeroed storage of its shape on the first write.
+        Matrix(Matrix&& other) noexcept(std::is_nothrow_move_constructible_v<B>)
+            : m_rows(other.m_rows)
+            , m_cols(other.m_cols)
+            , m_elements(std::move(other.m_elements))
+        {
+            if constexpr (!is_static_storage_v<B>)
+                other.release();
+        }
+
+        /// @brief Move assignment, see the move constructor.
+        /// @details A matrix with heap storage and static extents swaps storage with other instead,
+        /// so neither is left without it. Arena storage from different arenas cannot be swapped and
+        /// is moved as in the move constructor.
+        Matrix& operator=(Matrix&& other) noexcept(std::is_nothrow_move_assignable_v<B>)
+        {
+            if (&other != this) {
+                if constexpr (lazy_after_move) {
+                    if (swappable_with(other)) {
+                        std::swap(m_elements, other.m_elements);
+                        return *this;
+                    }
+                }
+                m_rows = other.m_rows;
+                m_cols = other.m_cols;
+                m_elements = std::move(other.m_elements);
+                if constexpr (!is_static_storage_v<B>)
+                    other.release();
+            }
             return *this;
         }
 
         /// @brief Operator for converting MatrixExpression <-> Matrix
-        template <typename E>
-        Matrix(const MatrixExpression<E, S, R, C>& expr)
-            : m_elements(R * C, value_type(0))
+        /// @details The expression may have dynamic extents where this matrix has static ones and vice
+        /// versa, as long as the extents known at compile-time agree.
+        template <typename E, size_t R2, size_t C2>
+        requires EnforceSameShape<S, S, R, R2, C, C2>
+        Matrix(const MatrixExpression<E, S, R2, C2>& expr)
+        {
+            evaluate(expr);
+        }
+
+        /// @brief Assigns the value of an expression.
+        /// @details If the expression may alias this matrix (see `MatrixExpression::assume_aliasing`),
+        /// e.g. `A = A * B`, it is evaluated into a temporary first. Use `noalias()` to skip this.
+        /// Dynamic extents are resized to the shape of the expression.
+        template <typename E, size_t R2, size_t C2>
+        requires EnforceSameShape<S, S, R, R2, C, C2>
+        Matrix& operator=(const MatrixExpression<E, S, R2, C2>& expr)
+        {
+            if constexpr (E::assume_aliasing) {
+                Matrix tmp(expr);
+                std::swap(m_rows, tmp.m_rows);
+                std::swap(m_cols, tmp.m_cols);
+                std::swap(m_elements, tmp.m_elements);
+            } else {
+                evaluate(expr);
+            }
+            return *this;
+        }
+
+        /// @brief Proxy returned by `noalias()`, assigning expressions directly into the matrix.
+        class NoAlias {
+        public:
+            explicit NoAlias(Matrix& matrix)
+                : m_matrix(matrix)
+            {
+            }
+
+            template <typename E, size_t R2, size_t C2>
+            requires EnforceSameShape<S, S, R, R2, C, C2>
+            Matrix& operator=(const MatrixExpression<E, S, R2, C2>& expr)
+            {
+                m_matrix.evaluate(expr);
+                return m_matrix;
+            }
+
+        private:
+            Matrix& m_matrix;
+        };
+
+        /// @brief Asserts that the next assigned expression does not alias this matrix.
+        /// @details `A.noalias() = B * C` evaluates the product straight into A without a temporary.
+        /// The result is undefined if the expression does read from A.
+        NoAlias noalias()
         {
-            for (size_t i = 1; i < R + 1; ++i)
-                for (size_t j = 1; j < C + 1; ++j)
-                    m_elements[(i - 1) * C + (j - 1)] = static_cast<value_type>(expr(i, j));
+            return NoAlias(*this);
         }
 
         /// @brief operator overload for () to access elements.
         value_type& operator()(size_t row, size_t col)
         {
-            if (row > R || col > C || row == 0 || col == 0)
+            if (row > rows() || col > cols() || row == 0 || col == 0)
                 throw std::out_of_range("Specified indices are out of range.");
-            return m_elements[(row - 1) * C + (col - 1)];
+            ensure_storage();
+            return m_elements[index(row - 1, col - 1)];
         }
 
         /// @brief operator overload for () to access elements.
         const value_type& operator()(size_t row, size_t col) const
         {
-            if (row > R || col > C || row == 0 || col == 0)
+            if (row > rows() || col > cols() || row == 0 || col == 0)
                 throw std::out_of_range("Specified indices are out of range.");
-            return m_elements[(row - 1) * C + (col - 1)];
+            return elements()[index(row - 1, col - 1)];
+        }
+
+        /// @brief Unchecked element access, 1 indexed.
+        /// @details Bounds are only asserted in debug builds, see LAO_ASSERT.
+        value_type& coeff(size_t row, size_t col) noexcept(!lazy_after_move)
+        {
+            LAO_ASSERT(row > 0 && row <= rows() && col > 0 && col <= cols());
+            ensure_storage();
+            return m_elements[index(row - 1, col - 1)];
+        }
+
+        /// @brief Unchecked element access, 1 indexed.
+        /// @details Bounds are only asserted in debug builds, see LAO_ASSERT.
+        const value_type& coeff(size_t row, size_t col) const noexcept
+        {
+            LAO_ASSERT(row > 0 && row <= rows() && col > 0 && col <= cols());
+            return elements()[index(row - 1, col - 1)];
+        }
+
+        /// @brief Unchecked linear element access, 0 indexed in storage order.
+        value_type& coeff(size_t i) noexcept(!lazy_after_move)
+        {
+            LAO_ASSERT(i < size());
+            ensure_storage();
+            return m_elements[i];
+        }
+
+        /// @brief Unchecked linear element access, 0 indexed in storage order.
+        const value_type& coeff(size_t i) const noexcept
+        {
+            LAO_ASSERT(i < size());
+            return elements()[i];
+        }
+
+        /// @brief Loads the packet of elements starting at flat index i, 0 indexed in storage order.
+        typename simd::Packet<S>::type packet(size_t i) const noexcept
+        {
+            LAO_ASSERT(i + simd::Packet<S>::size <= size());
+            return simd::Packet<S>::load(elements() + i);
+        }
+
+        /// @brief Returns a view over the element storage, in storage order.
+        std::span<value_type> span() noexcept(!lazy_after_move)
+        {
+            ensure_storage();
+            return std::span<value_type>(m_elements.data(), m_elements.size());
+        }
+
+        /// @brief Returns a view over the element storage, in storage order.
+        std::span<const value_type> span() const noexcept
+        {
+            return std::span<const value_type>(elements(), size());
+        }
+
+        /// @brief Returns a pointer to the underlying element storage, in storage order.
+        value_type* data() noexcept(!lazy_after_move)
+        {
+            ensure_storage();
+            return m_elements.data();
+        }
+
+        /// @brief Returns a pointer to the underlying element storage, in storage order.
+        const value_type* data() const noexcept
+        {
+            return elements();
+        }
+
+        /// @brief Returns the distance in elements between two consecutive rows.
+        constexpr size_t row_stride() const noexcept
+        {
+            return L == Layout::RowMajor ? cols() : 1;
+        }
+
+        /// @brief Returns the distance in elements between two consecutive columns.
+        constexpr size_t col_stride() const noexcept
+        {
+            return L == Layout::RowMajor ? 1 : rows();
+        }
+
+        /// @brief Returns the position in storage of element (row, col), 0 indexed.
+        constexpr size_t index(size_t row, size_t col) const noexcept
+        {
+            return row * row_stride() + col * col_stride();
         }
 
         /// @brief Returns the number of rows.
-        size_t rows() const noexcept
+        constexpr size_t rows() const noexcept
         {
-            return R;
+            return m_rows.value();
         }
 
         /// @brief Returns the number of columns.
-        size_t cols() const noexcept
+        constexpr size_t cols() const noexcept
+        {
+            return m_cols.value();
+        }
+
+        /// @brief Returns the number of elements, rows() * cols().
+        constexpr size_t size() const noexcept
+        {
+            return rows() * cols();
+        }
+
+        /// @brief Resizes the matrix to rows x cols and sets all elements to zero.
+        /// @details Extents which are fixed at compile-time must match, otherwise std::invalid_argument
+        /// is thrown.
+        void resize(size_t rows, size_t cols)
         {
-            return C;
+            set_shape(rows, cols);
+            zeros();
         }
 
         /// @brief Returns an iterator to the first element of a row.
         /// @param row The row number, 0 indexed.
         RowIterator row_begin(const size_t row)
         {
-            if (row > R || row == 0)
+            if (row > rows() || row == 0)
                 throw std::out_of_range("Row index is out of range.");
             return RowIterator(row, 1, *this);
         }
@@ -260,16 +521,16 @@ namespace linalg {
         /// @param row The row number, 0 indexed.
         RowIterator row_end(const size_t row)
         {
-            if (row > R || row == 0)
+            if (row > rows() || row == 0)
                 throw std::out_of_range("Row index is out of range.");
-            return RowIterator(row, C, *this);
+            return RowIterator(row, cols(), *this);
         }
 
         /// @brief Returns an iterator to the first element of a col.
         /// @param col The col number, 0 indexed.
         ColIterator col_begin(const size_t col)
         {
-            if (col > C || col == 0)
+            if (col > cols() || col == 0)
                 throw std::out_of_range("Col index is out of range.");
             return ColIterator(1, col, *this);
         }
@@ -278,9 +539,9 @@ namespace linalg {
         /// @param col The col number, 0 indexed.
         ColIterator col_end(const size_t col)
         {
-            if (col > C || col == 0)
+            if (col > cols() || col == 0)
                 throw std::out_of_range("Col index is out of range.");
-            return ColIterator(R, col, *this);
+            return ColIterator(rows(), col, *this);
         }
 
         /// @brief Checks if the matrix is empty.
@@ -292,25 +553,26 @@ namespace linalg {
         /// @brief Sets all elements to zero.
         void zeros()
         {
+            ensure_storage();
             std::fill(m_elements.begin(), m_elements.end(), value_type(0));
         }
 
         /// @brief Sets all elements to ones.
         void ones()
         {
+            ensure_storage();
             std::fill(m_elements.begin(), m_elements.end(), value_type(1));
         }
 
         /// @brief Sets all elements to the identity matrix.
         void eye()
         {
-            if constexpr (R == C) {
-                std::fill(m_elements.begin(), m_elements.end(), value_type(0));
-                for (size_t i = 0; i < R; ++i) {
-                    m_elements[i * C + i] = value_type(1);
-                }
-            } else {
+            if (rows() != cols())
                 throw std::logic_error("Identity matrix is only defined for square matrices.");
+            ensure_storage();
+            std::fill(m_elements.begin(), m_elements.end(), value_type(0));
+            for (size_t i = 0; i < rows(); ++i) {
+                m_elements[index(i, i)] = value_type(1);
             }
         }
 
@@ -319,35 +581,48 @@ namespace linalg {
         {
             std::random_device rd;
             std::mt19937 gen(rd());
-            std::uniform_int_distribution<value_type> dis(std::numeric_limits<value_type>::min(), std::numeric_limits<value_type>::max());
-            for (size_t i = 0; i < m_elements.size(); ++i)
-                m_elements[i] = dis(gen);
+            ensure_storage();
+            if constexpr (std::is_floating_point_v<value_type>) {
+                std::uniform_real_distribution<value_type> dis(value_type(0), value_type(1));
+                for (size_t i = 0; i < m_elements.size(); ++i)
+                    m_elements[i] = dis(gen);
+            } else {
+                std::uniform_int_distribution<value_type> dis(std::numeric_limits<value_type>::min(), std::numeric_limits<value_type>::max());
+                for (size_t i = 0; i < m_elements.size(); ++i)
+                    m_elements[i] = dis(gen);
+            }
         }
 
         /// @brief Sets all elements to a specified value.
         void fill(value_type val)
         {
+            ensure_storage();
             std::fill(m_elements.begin(), m_elements.end(), val);
         }
 
         /// @brief Sets all elements using a lambda function.
         void fillf(std::function<value_type()> lambda)
         {
+            ensure_storage();
             for (size_t i = 0; i < m_elements.size(); ++i)
                 m_elements[i] = lambda();
         }
 
         /// @brief Resets the matrix to empty.
+        /// @details Dynamic extents are set to 0. A matrix with heap storage and static extents reads
+        /// as zeros until it is written to, as after a move.
         void reset()
         {
+            m_rows.set(0);
+            m_cols.set(0);
             m_elements.clear();
         }
 
         /// @brief Printing method implementation, for printing the matrix.
-        friend std::ostream& operator<<(std::ostream& os, const Matrix<S, R, C>& matrix)
+        friend std::ostream& operator<<(std::ostream& os, const Matrix& matrix)
         {
-            for (size_t i = 1; i < R + 1; ++i) {
-                for (size_t j = 1; j < C + 1; ++j) {
+            for (size_t i = 1; i < matrix.rows() + 1; ++i) {
+                for (size_t j = 1; j < matrix.cols() + 1; ++j) {
                     os << matrix(i, j) << " ";
                 }
                 os << std::endl;
@@ -356,15 +631,242 @@ namespace linalg {
         }
 
     private:
+        // whether a move can leave the matrix without storage while it keeps its shape, i.e. it has
+        // heap storage and a fixed shape. It then reads as zeros until ensure_storage() is called.
+        static constexpr bool lazy_after_move = !is_static_storage_v<B> && R != Dynamic && C != Dynamic;
+
+        /// @brief Leaves a moved-from matrix valid: empty, or without storage if its shape is fixed.
+        void release() noexcept
+        {
+            if constexpr (lazy_after_move)
+                m_elements.clear();
+            else
+                reset();
+        }
+
+        /// @brief Whether the storage can be swapped with other, i.e. it is not owned by another arena.
+        bool swappable_with(const Matrix& other) const noexcept
+        {
+            if constexpr (std::allocator_traits<typename storage_type::allocator_type>::is_always_equal::value)
+                return true;
+            else
+                return m_elements.get_allocator() == other.m_elements.get_allocator();
+        }
+
+        /// @brief Allocates zeroed storage for a matrix left without it by a move.
+        void ensure_storage()
+        {
+            if constexpr (lazy_after_move) {
+                if (m_elements.empty()) [[unlikely]] {
+                    count_growth(R * C);
+                    m_elements.resize(R * C);
+                }
+            }
+        }
+
+        /// @brief The elements for reading, which are shared zeros for a matrix left without storage
+        /// by a move.
+        const value_type* elements() const noexcept
+        {
+            if constexpr (lazy_after_move) {
+                if (m_elements.empty()) [[unlikely]] {
+                    static const std::vector<S> zeros = [] {
+                        count_allocation(R * C);
+                        return std::vector<S>(R * C, value_type(0));
+                    }();
+                    return zeros.data();
+                }
+            }
+            return m_elements.data();
+        }
+
+        /// @brief Sets the shape, resizing the storage without initializing new elements.
+        void set_shape(size_t rows, size_t cols)
+        {
+            if (!extents_match(R, rows) || !extents_match(C, cols))
+                throw std::invalid_argument("Matrix dimensions do not match.");
+            m_rows.set(rows);
+            m_cols.set(cols);
+            if (m_elements.size() != rows * cols) {
+                count_growth(rows * cols);
+                m_elements.resize(rows * cols);
+            }
+        }
+
+        /// @brief Replaces the storage with elements, of size() elements, moving it in if possible.
+        void take(std::vector<S>&& elements)
+        {
+            if constexpr (std::is_same_v<B, std::vector<S>>) {
+                m_elements = std::move(elements);
+            } else {
+                count_growth(elements.size());
+                m_elements.assign(elements.begin(), elements.end());
+            }
+        }
+
+        /// @brief Counts a heap allocation of count elements, see lao/instrumentation.hpp.
+        static void count_allocation([[maybe_unused]] size_t count)
+        {
+            if constexpr (instrumentation::enabled && !is_static_storage_v<B>)
+                if (count > 0)
+                    instrumentation::count_allocation(count * sizeof(value_type));
+        }
+
+        /// @brief Counts the heap allocation made by growing the storage to count elements, if any.
+        void count_growth([[maybe_unused]] size_t count) const
+        {
+            if constexpr (instrumentation::enabled && !is_static_storage_v<B>)
+                if (count > m_elements.capacity())
+                    instrumentation::count_allocation(count * sizeof(value_type));
+        }
+
+        void apply_fill(filltype fill)
+        {
+            if (fill == filltype::zeros) {
+                // Set the matrix to all zeros
+                zeros();
+            } else if (fill == filltype::ones) {
+                // Set the matrix to all ones
+                ones();
+            } else if (fill == filltype::eye) {
+                // Set the matrix to the identity, i.e. the diagonal has ones.
+                // This is only valid for square matrics.
+                eye();
+            } else if (fill == filltype::rand) {
+                // Fill in the matrix with random values in range [0,1].
+                rand();
+            } else if (fill == filltype::none) {
+                // nada
+            } else {
+                throw std::invalid_argument("Invalid filltype.");
+            }
+        }
+
+        /// @brief Evaluates an expression into this matrix in place.
+        /// @details Expressions which provide an `eval_to(Matrix&)` member, such as matrix products,
+        /// evaluate themselves with a dedicated kernel. Everything else is evaluated element-wise,
+        /// split by rows (columns if column-major) across threads once there are more than
+        /// LAO_PARALLEL_THRESHOLD elements. Fixed-size matrices below that are evaluated inline
+        /// without any check, and those within LAO_FIXED_UNROLL_SIZE which have no flat loop are
+        /// evaluated fully unrolled.
+        template <typename E, size_t R2, size_t C2>
+        void evaluate(const MatrixExpression<E, S, R2, C2>& expr)
+        {
+            const E& derived = static_cast<const E&>(expr);
+            set_shape(derived.rows(), derived.cols());
+
+            if constexpr (requires { derived.eval_to(*this); }) {
+                derived.eval_to(*this);
+            } else {
+                const size_t outer = L == Layout::RowMajor ? rows() : cols();
+                const size_t inner = L == Layout::RowMajor ? cols() : rows();
+                if constexpr (detail::is_fixed_unrolled_v<R, C> && !(E::linear_access && E::layout == L)) {
+                    // e.g. a transpose, which has no flat loop, is written element by element, unrolled.
+                    detail::unroll<R>([&](auto i) {
+                        detail::unroll<C>([&](auto j) { m_elements[index(i, j)] = static_cast<value_type>(derived.coeff(i + 1, j + 1)); });
+                    });
+                } else if constexpr (R != Dynamic && C != Dynamic && R * C < LAO_PARALLEL_THRESHOLD)
+                    evaluate_lines(derived, 0, outer);
+                else
+                    parallel_rows(0, outer, inner, [&](size_t first, size_t last) { evaluate_lines(derived, first, last); });
+            }
+        }
+
+        /// @brief Evaluates the rows [first, last) of an expression, or columns if column-major.
+        /// @details With a flat loop if the expression has the same layout as this matrix, a packet
+        /// at a time if it also supports packet access, or otherwise by walking this matrix in
+        /// storage order.
+        template <typename E>
+        void evaluate_lines(const E& derived, size_t first, size_t last)
+        {
+            value_type* dst = m_elements.data();
+            const size_t inner = L == Layout::RowMajor ? cols() : rows();
+            if constexpr (E::packet_access && E::layout == L && simd::Packet<S>::size > 1) {
+                // evaluate the fused expression a packet at a time, with a scalar tail.
+                using P = simd::Packet<S>;
+                const size_t end = last * inner;
+                size_t i = first * inner;
+                for (; i + P::size <= end; i += P::size)
+                    P::store(dst + i, derived.packet(i));
+                for (; i < end; ++i)
+                    dst[i] = derived.coeff(i);
+            } else if constexpr (E::linear_access && E::layout == L) {
+                // all operands share this matrix's layout, so a single flat loop the compiler
+                // can vectorize covers the whole expression.
+                for (size_t i = first * inner; i < last * inner; ++i)
+                    dst[i] = static_cast<value_type>(derived.coeff(i));
+            } else if constexpr (L == Layout::RowMajor) {
+                for (size_t i = first; i < last; ++i)
+                    for (size_t j = 0; j < inner; ++j)
+                        dst[index(i, j)] = static_cast<value_type>(derived.coeff(i + 1, j + 1));
+            } else {
+                for (size_t j = first; j < last; ++j)
+                    for (size_t i = 0; i < inner; ++i)
+                        dst[index(i, j)] = static_cast<value_type>(derived.coeff(i + 1, j + 1));
+            }
+        }
+
+        [[no_unique_address]] detail::Extent<R> m_rows;
+        [[no_unique_address]] detail::Extent<C> m_cols;
         storage_type m_elements;
     };
 
-    template <typename S, size_t C, typename B = std::vector<S>>
+    /// @brief Trait for detecting the dense Matrix class.
+    template <typename T>
+    struct is_matrix : std::false_type { };
+
+    template <typename S, size_t R, size_t C, typename B, Layout L>
+    struct is_matrix<Matrix<S, R, C, B, L>> : std::true_type { };
+
+    template <typename T>
+    inline constexpr bool is_matrix_v = is_matrix<T>::value;
+
+    namespace detail {
+        /// @brief Returns a strided dense view of the value of an expression.
+        /// @details If the expression already is strided, e.g. a matrix of either layout or its
+        /// transpose, then a reference to it is returned, otherwise the expression is evaluated
+        /// into a temporary row-major matrix.
+        template <typename E, typename S, size_t R, size_t C>
+        decltype(auto) materialize(const MatrixExpression<E, S, R, C>& expr)
+        {
+            if constexpr (StridedExpression<E>)
+                return static_cast<const E&>(expr);
+            else
+                return Matrix<S, R, C>(expr);
+        }
+    }; // namespace detail
+
+    /// @brief Evaluates an expression into a dense matrix.
+    /// @details Useful to force a sub-expression which is read many times to be computed once.
+    template <typename E, typename S, size_t R, size_t C>
+    Matrix<S, R, C> eval(const MatrixExpression<E, S, R, C>& expr)
+    {
+        return Matrix<S, R, C>(expr);
+    }
+
+    /// @brief Evaluates an expression into an existing matrix, reusing its storage where the shape
+    /// allows, so that repeated evaluations into the same matrix allocate nothing.
+    /// @details As `out.noalias() = expr`, so the expression must not read from out.
+    template <typename E, typename S, size_t R, size_t C, size_t R2, size_t C2, typename B, Layout L>
+    requires EnforceSameShape<S, S, R, R2, C, C2>
+    Matrix<S, R2, C2, B, L>& eval_into(const MatrixExpression<E, S, R, C>& expr, Matrix<S, R2, C2, B, L>& out)
+    {
+        return out.noalias() = expr;
+    }
+
+    template <typename S, size_t C, typename B = default_storage_t<S, 1, C>>
     using RowVector = Matrix<S, 1, C, B>;
 
-    template <typename S, size_t R, typename B = std::vector<S>>
+    template <typename S, size_t R, typename B = default_storage_t<S, R, 1>>
     using ColVector = Matrix<S, R, 1, B>;
 
+    template <typename S, size_t R, size_t C, typename B = default_storage_t<S, R, C>>
+    using ColMajorMatrix = Matrix<S, R, C, B, Layout::ColMajor>;
+
+    /// @brief Dense matrix whose elements are allocated from the current ScopedArena.
+    template <typename S, size_t R, size_t C, Layout L = Layout::RowMajor>
+    using ArenaMatrix = Matrix<S, R, C, ArenaStorage<S>, L>;
+
 }; // namespace linalg
 }; // namespace lao
 
@@ -0,0 +1,492 @@
+/// view.hpp implements MatrixView, a view of a block of the elements of a dense matrix, and the
+/// BlockAccess members which create them, i.e. `submat`, `rview`, `cview`, `rviews` and `cviews`.
+///
+/// A view is a pointer to its first element, its extents and the distance between consecutive
+/// elements along its rows and columns. It is an expression like any other, so it is read in place
+/// by arithmetic, and as a strided expression it goes through `detail::materialize` untouched, so
+/// GEMM, the fixed-size kernels and LUFactorization read a block of a larger matrix without copying
+/// it. Views whose elements are adjacent along the layout of the viewed matrix keep that inner stride
+/// of 1 as a compile-time constant, which leaves the inner loops over them contiguous for the compiler
+/// to vectorize, while views from the strided overload of `submat` store it.
+///
+/// Views are writable through non-const matrices, e.g. the position and velocity halves of a state:
+///
+///     RowVector<double, 6> state = ...;
+///     auto r = state.submat<1, 3>(1, 1);
+///     auto v = state.submat<1, 3>(1, 4);
+///     r = r + dt * v;
+///
+/// Assigning a view, or a transpose of one, to a view which overlaps it goes through a temporary,
+/// see `MatrixView::operator=`.
+///
+/// A view does not own its elements, so it must not outlive the matrix it views, nor be used once
+/// that matrix has been resized or reassigned to a different shape.
+
+#ifndef LAO_LINALG_DENSE_VIEW_H_
+#define LAO_LINALG_DENSE_VIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <lao/config.hpp>
+#include <lao/linalg/core/expression.hpp>
+#include <lao/linalg/core/extent.hpp>
+#include <lao/linalg/core/forward.hpp>
+#include <lao/linalg/core/simd.hpp>
+#include <lao/linalg/dense/fixed.hpp>
+#include <lao/linalg/math/constraints.hpp>
+#include <lao/parallel.hpp>
+#include <stdexcept>
+#include <type_traits>
+
+namespace lao {
+namespace linalg {
+
+    template <typename T, size_t R, size_t C, Layout L = Layout::RowMajor, bool Strided = false>
+    class MatrixView;
+
+    namespace detail {
+
+        /// @brief Whether the rows or columns [first, last], 1 indexed, lie within extent.
+        constexpr bool block_in_range(size_t first, size_t last, size_t extent) noexcept
+        {
+            return first > 0 && first <= last && last <= extent;
+        }
+
+        /// @brief Whether two strided expressions share elements other than at the same positions, so
+        /// that writing one element by element may overwrite elements of the other before they are read.
+        /// @details Compares the address ranges the two span, so views which interleave without sharing
+        /// an element, e.g. alternate columns, are also taken as overlapping.
+        template <typename E1, typename E2>
+        bool overlaps(const E1& dst, const E2& src) noexcept
+        {
+            if (dst.rows() == 0 || dst.cols() == 0)
+                return false;
+            const auto first = [](const auto& e) { return reinterpret_cast<std::uintptr_t>(e.data()); };
+            const auto last = [](const auto& e) {
+                return reinterpret_cast<std::uintptr_t>(e.data() + (e.rows() - 1) * e.row_stride() + (e.cols() - 1) * e.col_stride());
+            };
+            if (first(dst) == first(src) && dst.row_stride() == src.row_stride() && dst.col_stride() == src.col_stride())
+                return false;
+            return first(dst) <= last(src) && first(src) <= last(dst);
+        }
+
+    }; // namespace detail
+
+    /// @brief Members creating views of blocks of a dense matrix or of another view, 1 indexed.
+    /// @details Derived provides `data()`, `row_stride()`, `col_stride()`, `rows()` and `cols()`.
+    /// Non-const members return views of elements of type T, const members views of elements of
+    /// type CT, i.e. `const S` for a matrix, whereas a view is shallow and returns T from both.
+    /// Indices outside of the matrix throw std::out_of_range.
+    template <typename Derived, typename T, typename CT, size_t R, size_t C, Layout L, bool Strided>
+    class BlockAccess {
+    public:
+        /// @brief Returns a view of the rows [first_row, last_row] of the columns [first_col, last_col].
+        MatrixView<T, Dynamic, Dynamic, L, Strided> submat(size_t first_row, size_t first_col, size_t last_row, size_t last_col)
+        {
+            return block<T, Dynamic, Dynamic>(mutable_data(), first_row, first_col, last_row, last_col);
+        }
+
+        /// @brief Returns a view of the rows [first_row, last_row] of the columns [first_col, last_col].
+        MatrixView<CT, Dynamic, Dynamic, L, Strided> submat(size_t first_row, size_t first_col, size_t last_row, size_t last_col) const
+        {
+            return block<CT, Dynamic, Dynamic>(derived().data(), first_row, first_col, last_row, last_col);
+        }
+
+        /// @brief Returns a view of the BR x BC block whose first element is (row, col).
+        template <size_t BR, size_t BC>
+        MatrixView<T, BR, BC, L, Strided> submat(size_t row, size_t col)
+        {
+            return block<T, BR, BC>(mutable_data(), row, col, row + BR - 1, col + BC - 1);
+        }
+
+        /// @brief Returns a view of the BR x BC block whose first element is (row, col).
+        template <size_t BR, size_t BC>
+        MatrixView<CT, BR, BC, L, Strided> submat(size_t row, size_t col) const
+        {
+            return block<CT, BR, BC>(derived().data(), row, col, row + BR - 1, col + BC - 1);
+        }
+
+        /// @brief Returns a view of every row_step-th row in [first_row, last_row] and every
+        /// col_step-th column in [first_col, last_col], starting from the first.
+        MatrixView<T, Dynamic, Dynamic, L, true> submat(size_t first_row, size_t first_col, size_t last_row, size_t last_col, size_t row_step, size_t col_step)
+        {
+            return strided<T>(mutable_data(), first_row, first_col, last_row, last_col, row_step, col_step);
+        }
+
+        /// @brief Returns a view of every row_step-th row in [first_row, last_row] and every
+        /// col_step-th column in [first_col, last_col], starting from the first.
+        MatrixView<CT, Dynamic, Dynamic, L, true> submat(size_t first_row, size_t first_col, size_t last_row, size_t last_col, size_t row_step, size_t col_step) const
+        {
+            return strided<CT>(derived().data(), first_row, first_col, last_row, last_col, row_step, col_step);
+        }
+
+        /// @brief Returns a view of a row.
+        MatrixView<T, 1, C, L, Strided> rview(size_t row)
+        {
+            return block<T, 1, C>(mutable_data(), row, 1, row, derived().cols());
+        }
+
+        /// @brief Returns a view of a row.
+        MatrixView<CT, 1, C, L, Strided> rview(size_t row) const
+        {
+            return block<CT, 1, C>(derived().data(), row, 1, row, derived().cols());
+        }
+
+        /// @brief Returns a view of a column.
+        MatrixView<T, R, 1, L, Strided> cview(size_t col)
+        {
+            return block<T, R, 1>(mutable_data(), 1, col, derived().rows(), col);
+        }
+
+        /// @brief Returns a view of a column.
+        MatrixView<CT, R, 1, L, Strided> cview(size_t col) const
+        {
+            return block<CT, R, 1>(derived().data(), 1, col, derived().rows(), col);
+        }
+
+        /// @brief Returns a view of the rows [first_row, last_row].
+        MatrixView<T, Dynamic, C, L, Strided> rviews(size_t first_row, size_t last_row)
+        {
+            return block<T, Dynamic, C>(mutable_data(), first_row, 1, last_row, derived().cols());
+        }
+
+        /// @brief Returns a view of the rows [first_row, last_row].
+        MatrixView<CT, Dynamic, C, L, Strided> rviews(size_t first_row, size_t last_row) const
+        {
+            return block<CT, Dynamic, C>(derived().data(), first_row, 1, last_row, derived().cols());
+        }
+
+        /// @brief Returns a view of the columns [first_col, last_col].
+        MatrixView<T, R, Dynamic, L, Strided> cviews(size_t first_col, size_t last_col)
+        {
+            return block<T, R, Dynamic>(mutable_data(), 1, first_col, derived().rows(), last_col);
+        }
+
+        /// @brief Returns a view of the columns [first_col, last_col].
+        MatrixView<CT, R, Dynamic, L, Strided> cviews(size_t first_col, size_t last_col) const
+        {
+            return block<CT, R, Dynamic>(derived().data(), 1, first_col, derived().rows(), last_col);
+        }
+
+    private:
+        const Derived& derived() const noexcept
+        {
+            return static_cast<const Derived&>(*this);
+        }
+
+        T* mutable_data() noexcept
+        {
+            return static_cast<Derived&>(*this).data();
+        }
+
+        /// @brief Distance between consecutive elements along, and across, the layout.
+        size_t outer_stride() const noexcept
+        {
+            return L == Layout::RowMajor ? derived().row_stride() : derived().col_stride();
+        }
+
+        size_t inner_stride() const noexcept
+        {
+            return L == Layout::RowMajor ? derived().col_stride() : derived().row_stride();
+        }
+
+        template <typename U, size_t BR, size_t BC>
+        MatrixView<U, BR, BC, L, Strided> block(U* data, size_t first_row, size_t first_col, size_t last_row, size_t last_col) const
+        {
+            if (!detail::block_in_range(first_row, last_row, derived().rows()) || !detail::block_in_range(first_col, last_col, derived().cols()))
+                throw std::out_of_range("Specified indices are out of range.");
+            return MatrixView<U, BR, BC, L, Strided>(data + (first_row - 1) * derived().row_stride() + (first_col - 1) * derived().col_stride(),
+                last_row - first_row + 1, last_col - first_col + 1, outer_stride(), inner_stride());
+        }
+
+        template <typename U>
+        MatrixView<U, Dynamic, Dynamic, L, true> strided(U* data, size_t first_row, size_t first_col, size_t last_row, size_t last_col, size_t row_step, size_t col_step) const
+        {
+            if (row_step == 0 || col_step == 0)
+                throw std::invalid_argument("Steps of a strided view must be positive.");
+            if (!detail::block_in_range(first_row, last_row, derived().rows()) || !detail::block_in_range(first_col, last_col, derived().cols()))
+                throw std::out_of_range("Specified indices are out of range.");
+            const size_t row_stride = derived().row_stride() * row_step;
+            const size_t col_stride = derived().col_stride() * col_step;
+            return MatrixView<U, Dynamic, Dynamic, L, true>(data + (first_row - 1) * derived().row_stride() + (first_col - 1) * derived().col_stride(),
+                (last_row - first_row) / row_step + 1, (last_col - first_col) / col_step + 1,
+                L == Layout::RowMajor ? row_stride : col_stride, L == Layout::RowMajor ? col_stride : row_stride);
+        }
+    };
+
+    /// @brief A view of a block of the elements of a dense matrix, see view.hpp.
+    /// @details T is the element type, const-qualified for a read-only view. L is the layout of the
+    /// viewed matrix, along which consecutive elements are adjacent unless Strided is set, in which
+    /// case their distance is also stored. Constness is shallow as for std::span: a const view of
+    /// mutable elements can still be written through. It uses 1 indexing.
+    template <typename T, size_t R, size_t C, Layout L, bool Strided>
+    class MatrixView : public MatrixExpression<MatrixView<T, R, C, L, Strided>, std::remove_const_t<T>, R, C>,
+                       public BlockAccess<MatrixView<T, R, C, L, Strided>, T, T, R, C, L, Strided> {
+    public:
+        using value_type = std::remove_const_t<T>;
+        using element_type = T;
+
+        // a single row of a row-major matrix, or column of a column-major one, is contiguous unless
+        // Strided, so it is read with a flat index and a packet at a time like a matrix.
+        static constexpr bool linear_access = !Strided && (L == Layout::RowMajor ? R == 1 : C == 1);
+        static constexpr bool packet_access = linear_access;
+        static constexpr Layout layout = L;
+
+        /// @brief Constructor for a view of rows x cols elements starting at data.
+        /// @param outer_stride the distance between the first elements of consecutive rows, or
+        /// columns if column-major.
+        /// @param inner_stride the distance between consecutive elements of a row, or column if
+        /// column-major, which must be 1 unless Strided.
+        MatrixView(T* data, size_t rows, size_t cols, size_t outer_stride, size_t inner_stride = 1) noexcept
+            : m_data(data)
+            , m_outer_stride(outer_stride)
+        {
+            LAO_ASSERT(extents_match(R, rows) && extents_match(C, cols) && (Strided || inner_stride == 1));
+            m_rows.set(rows);
+            m_cols.set(cols);
+            m_inner_stride.set(inner_stride);
+        }
+
+        MatrixView(const MatrixView&) = default;
+
+        /// @brief Converts a view of mutable elements into a read-only view.
+        template <typename U>
+        requires(std::is_const_v<T> && std::is_same_v<const U, T>)
+        MatrixView(const MatrixView<U, R, C, L, Strided>& other) noexcept
+            : MatrixView(other.data(), other.rows(), other.cols(), other.outer_stride(), other.inner_stride())
+        {
+        }
+
+        /// @brief Assigns the elements of another view of the same type, rather than rebinding.
+        /// @details Views which overlap without coinciding, e.g. the same row shifted by one column,
+        /// are copied through a temporary.
+        MatrixView& operator=(const MatrixView& other) requires(!std::is_const_v<T>)
+        {
+            if (detail::overlaps(*this, other))
+                assign(Matrix<value_type, R, C>(other));
+            else
+                assign(other);
+            return *this;
+        }
+
+        MatrixView& operator=(const MatrixView& other) requires(std::is_const_v<T>) = delete;
+
+        /// @brief Assigns the value of an expression to the viewed elements.
+        /// @details The shape must match. If the expression may alias the viewed matrix, e.g. a
+        /// product, or is strided, e.g. another view or a transpose, and overlaps the viewed elements
+        /// other than at the same positions, it is evaluated into a temporary first. Use `noalias()`
+        /// to skip this. Element-wise expressions of such overlapping views, e.g. `v = w + 1.0` with
+        /// w a shifted view of the same row as v, are not detected and must be evaluated with `eval`.
+        template <typename E, size_t R2, size_t C2>
+        requires(EnforceSameShape<value_type, value_type, R, R2, C, C2> && !std::is_const_v<T>)
+        MatrixView& operator=(const MatrixExpression<E, value_type, R2, C2>& expr)
+        {
+            const E& derived = static_cast<const E&>(expr);
+            if constexpr (E::assume_aliasing) {
+                assign(Matrix<value_type, merged_extent_v<R, R2>, merged_extent_v<C, C2>>(expr));
+            } else if constexpr (StridedExpression<E>) {
+                if (detail::overlaps(*this, derived))
+                    assign(Matrix<value_type, merged_extent_v<R, R2>, merged_extent_v<C, C2>>(expr));
+                else
+                    assign(derived);
+            } else {
+                assign(derived);
+            }
+            return *this;
+        }
+
+        /// @brief Proxy returned by `noalias()`, assigning expressions directly into the view.
+        class NoAlias {
+        public:
+            explicit NoAlias(MatrixView& view)
+                : m_view(view)
+            {
+            }
+
+            template <typename E, size_t R2, size_t C2>
+            requires EnforceSameShape<value_type, value_type, R, R2, C, C2>
+            MatrixView& operator=(const MatrixExpression<E, value_type, R2, C2>& expr)
+            {
+                m_view.assign(static_cast<const E&>(expr));
+                return m_view;
+            }
+
+        private:
+            MatrixView& m_view;
+        };
+
+        /// @brief Asserts that the next assigned expression does not alias the viewed matrix.
+        /// @details `A.submat(1, 1, 3, 3).noalias() = B * C` writes the product straight into the
+        /// block of A with gemm. The result is undefined if the expression does read from A.
+        NoAlias noalias() requires(!std::is_const_v<T>)
+        {
+            return NoAlias(*this);
+        }
+
+        /// @brief operator overload for () to access elements.
+        T& operator()(size_t row, size_t col) const
+        {
+            if (row > rows() || col > cols() || row == 0 || col == 0)
+                throw std::out_of_range("Specified indices are out of range.");
+            return coeff(row, col);
+        }
+
+        /// @brief Unchecked element access, 1 indexed.
+        /// @details Bounds are only asserted in debug builds, see LAO_ASSERT.
+        T& coeff(size_t row, size_t col) const noexcept
+        {
+            LAO_ASSERT(row > 0 && row <= rows() && col > 0 && col <= cols());
+            return m_data[(row - 1) * row_stride() + (col - 1) * col_stride()];
+        }
+
+        /// @brief Unchecked linear element access, 0 indexed, for views with `linear_access`.
+        T& coeff(size_t i) const noexcept requires linear_access
+        {
+            LAO_ASSERT(i < rows() * cols());
+            return m_data[i];
+        }
+
+        /// @brief Loads the packet of elements starting at flat index i, for views with `packet_access`.
+        typename simd::Packet<value_type>::type packet(size_t i) const noexcept requires packet_access
+        {
+            LAO_ASSERT(i + simd::Packet<value_type>::size <= rows() * cols());
+            return simd::Packet<value_type>::load(m_data + i);
+        }
+
+        /// @brief Returns a pointer to the first element.
+        T* data() const noexcept
+        {
+            return m_data;
+        }
+
+        /// @brief Returns the distance in elements between two consecutive rows.
+        size_t row_stride() const noexcept
+        {
+            return L == Layout::RowMajor ? m_outer_stride : m_inner_stride.value();
+        }
+
+        /// @brief Returns the distance in elements between two consecutive columns.
+        size_t col_stride() const noexcept
+        {
+            return L == Layout::RowMajor ? m_inner_stride.value() : m_outer_stride;
+        }
+
+        /// @brief Returns the distance in elements between two consecutive rows, or columns if column-major.
+        size_t outer_stride() const noexcept
+        {
+            return m_outer_stride;
+        }
+
+        /// @brief Returns the distance in elements between two consecutive elements of a row, or
+        /// column if column-major, 1 unless Strided.
+        constexpr size_t inner_stride() const noexcept
+        {
+            return m_inner_stride.value();
+        }
+
+        /// @brief Returns the number of rows.
+        constexpr size_t rows() const noexcept
+        {
+            return m_rows.value();
+        }
+
+        /// @brief Returns the number of columns.
+        constexpr size_t cols() const noexcept
+        {
+            return m_cols.value();
+        }
+
+        /// @brief Returns the number of elements, rows() * cols().
+        constexpr size_t size() const noexcept
+        {
+            return rows() * cols();
+        }
+
+        /// @brief Sets all viewed elements to a specified value.
+        void fill(value_type val) const requires(!std::is_const_v<T>)
+        {
+            for (size_t i = 0; i < outer(); ++i) {
+                T* line = m_data + i * m_outer_stride;
+                for (size_t j = 0; j < inner(); ++j)
+                    line[j * inner_stride()] = val;
+            }
+        }
+
+        /// @brief Sets all viewed elements to zero.
+        void zeros() const requires(!std::is_const_v<T>)
+        {
+            fill(value_type(0));
+        }
+
+    private:
+        size_t outer() const noexcept
+        {
+            return L == Layout::RowMajor ? rows() : cols();
+        }
+
+        size_t inner() const noexcept
+        {
+            return L == Layout::RowMajor ? cols() : rows();
+        }
+
+        /// @brief Evaluates an expression of the same shape into the viewed elements.
+        /// @details As Matrix::evaluate: with `eval_to` if the expression provides it, e.g. a product
+        /// into a block, otherwise element-wise a row (column if column-major) at a time, unrolled
+        /// within LAO_FIXED_UNROLL_SIZE and across threads beyond LAO_PARALLEL_THRESHOLD elements.
+        template <typename E>
+        void assign(const E& derived)
+        {
+            detail::check_same_shape(*this, derived);
+            if constexpr (requires { derived.eval_to(*this); }) {
+                derived.eval_to(*this);
+            } else if constexpr (detail::is_fixed_unrolled_v<R, C>) {
+                detail::unroll<R>([&](auto i) {
+                    detail::unroll<C>([&](auto j) { coeff(i + 1, j + 1) = static_cast<value_type>(derived.coeff(i + 1, j + 1)); });
+                });
+            } else if constexpr (R != Dynamic && C != Dynamic && R * C < LAO_PARALLEL_THRESHOLD) {
+                assign_lines(derived, 0, outer());
+            } else {
+                parallel_rows(0, outer(), inner(), [&](size_t first, size_t last) { assign_lines(derived, first, last); });
+            }
+        }
+
+        /// @brief Evaluates the rows [first, last) of an expression, or columns if column-major.
+        template <typename E>
+        void assign_lines(const E& derived, size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i) {
+                T* line = m_data + i * m_outer_stride;
+                for (size_t j = 0; j < inner(); ++j) {
+                    if constexpr (L == Layout::RowMajor)
+                        line[j * inner_stride()] = static_cast<value_type>(derived.coeff(i + 1, j + 1));
+                    else
+                        line[j * inner_stride()] = static_cast<value_type>(derived.coeff(j + 1, i + 1));
+                }
+            }
+        }
+
+        T* m_data;
+        [[no_unique_address]] detail::Extent<R> m_rows;
+        [[no_unique_address]] detail::Extent<C> m_cols;
+        size_t m_outer_stride;
+        [[no_unique_address]] detail::Extent<Strided ? Dynamic : 1> m_inner_stride;
+    };
+
+    /// @brief A view whose elements are a fixed distance apart along both rows and columns.
+    template <typename T, size_t R, size_t C, Layout L = Layout::RowMajor>
+    using StridedView = MatrixView<T, R, C, L, true>;
+
+    /// @brief Trait for detecting MatrixView.
+    template <typename T>
+    struct is_matrix_view : std::false_type { };
+
+    template <typename T, size_t R, size_t C, Layout L, bool Strided>
+    struct is_matrix_view<MatrixView<T, R, C, L, Strided>> : std::true_type { };
+
+    template <typename T>
+    inline constexpr bool is_matrix_view_v = is_matrix_view<T>::value;
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_DENSE_VIEW_H_
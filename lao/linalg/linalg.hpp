@@ -4,9 +4,17 @@
 #include <lao/linalg/dense/LU.hpp>
 #include <lao/linalg/dense/jacobi.hpp>
 #include <lao/linalg/dense/matrix.hpp>
+#include <lao/linalg/dense/view.hpp>
 #include <lao/linalg/math/arithmetic.hpp>
 #include <lao/linalg/math/constraints.hpp>
 #include <lao/linalg/math/fundamental.hpp>
+#include <lao/linalg/math/reductions.hpp>
+#include <lao/linalg/solvers/iterative.hpp>
+#include <lao/linalg/solvers/preconditioners.hpp>
+#include <lao/linalg/solvers/refinement.hpp>
+#include <lao/linalg/sparse/io.hpp>
+#include <lao/linalg/sparse/sparse_arithmetic.hpp>
 #include <lao/linalg/sparse/sparse_matrix.hpp>
+#include <lao/linalg/sparse/triplet.hpp>
 
 #endif // LAO_LINALG_LINALG_H_
\ No newline at end of file
@@ -2,8 +2,13 @@
 #define LAO_LINALG_MATH_ARITHMETIC_H_
 
 #include <lao/linalg/core/expression.hpp>
+#include <lao/linalg/core/simd.hpp>
+#include <lao/linalg/dense/fixed.hpp>
+#include <lao/linalg/dense/gemm.hpp>
 #include <lao/linalg/dense/matrix.hpp>
 #include <lao/linalg/math/constraints.hpp>
+#include <lao/linalg/sparse/sparse_matrix.hpp>
+#include <lao/linalg/sparse/spmv.hpp>
 
 namespace lao {
 namespace linalg {
@@ -15,20 +20,48 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixAddition(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_lhs.cols();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) + m_rhs.coeff(row, col);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_lhs.coeff(i) + m_rhs.coeff(i);
         }
 
-        S operator()(size_t row, size_t col) const
+        packet_type packet(size_t i) const
         {
-            return m_lhs(row, col) + m_rhs(row, col);
+            return simd::Packet<S>::add(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator+ overload for matrix addition.
@@ -36,7 +69,7 @@ namespace linalg {
     requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator+(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixAddition<S1, R1, C1, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixAddition<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Matrix subtraction.
@@ -46,54 +79,132 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixSubtraction(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_lhs.cols();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) - m_rhs.coeff(row, col);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_lhs.coeff(i) - m_rhs.coeff(i);
         }
 
-        S operator()(size_t row, size_t col) const
+        packet_type packet(size_t i) const
         {
-            return m_lhs(row, col) - m_rhs(row, col);
+            return simd::Packet<S>::sub(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator- overload for matrix subtraction.
     template <typename S1, typename S2, size_t R1, size_t R2, size_t C1, size_t C2, typename E1, typename E2>
+    requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator-(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixSubtraction<S1, R1, C1, MatrixExpression<E1, S2, R2, C2>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixSubtraction<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Matrix multiplication.
+    /// @details Element access computes a single dot product. When the product is assigned into a
+    /// Matrix the whole result is instead computed at once with the blocked GEMM kernel, or with the
+    /// sparse kernels in spmv.hpp if an operand is a SparseMatrix or a sparse expression, see `eval_to`.
+    /// As an operand of another expression the product is materialized once, so `A * B * C` and
+    /// `A * B + C` never recompute the inner product per element.
     template <typename S, size_t R, size_t C, typename E1, typename E2>
     class MatrixMultiplication : public MatrixExpression<MatrixMultiplication<S, R, C, E1, E2>, S, R, C> {
     public:
         using left_expr = E1;
         using right_expr = E2;
 
+        static constexpr bool materialize_when_nested = true;
+        static constexpr bool assume_aliasing = true;
+
         MatrixMultiplication(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_product_shape(lhs, rhs);
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_rhs.cols();
         }
 
-        S operator()(size_t row, size_t col) const
+        S coeff(size_t row, size_t col) const
         {
             S dot_product = S();
             for (size_t i = 1; i < m_lhs.cols() + 1; ++i) {
-                dot_product += m_lhs(row, i) * m_rhs(i, col);
+                dot_product += m_lhs.coeff(row, i) * m_rhs.coeff(i, col);
             }
             return dot_product;
         }
 
+        /// @brief Evaluates the product into a dense matrix with the GEMM kernel.
+        /// @details Operands which are strided, i.e. matrices of either layout and their transposes,
+        /// are read in place. Other operands are evaluated into temporaries first.
+        /// A sparse operand is read through its CSR arrays, visiting only its non-zeros. A sparse
+        /// expression, e.g. `(A + B) * x`, is first evaluated into a SparseMatrix, see nested_t.
+        /// Products of fixed-size matrices within LAO_FIXED_UNROLL_SIZE are fully unrolled instead.
+        template <typename Dst>
+        void eval_to(Dst& dst) const
+        {
+            if constexpr (E1::sparse_expression) {
+                const auto& rhs = detail::materialize(m_rhs);
+                spmm<S>(rows(), cols(), m_lhs.row_offsets(), m_lhs.col_indices(), m_lhs.values(),
+                    rhs.data(), rhs.row_stride(), rhs.col_stride(), dst.data(), dst.row_stride(), dst.col_stride());
+            } else if constexpr (E2::sparse_expression) {
+                const auto& lhs = detail::materialize(m_lhs);
+                dense_spmm<S>(rows(), cols(), m_lhs.cols(), lhs.data(), lhs.row_stride(), lhs.col_stride(),
+                    m_rhs.row_offsets(), m_rhs.col_indices(), m_rhs.values(), dst.data(), dst.row_stride(), dst.col_stride());
+            } else if constexpr (detail::is_fixed_unrolled_v<R, C> && detail::is_fixed_unrolled_v<R, E1::col_extent>) {
+                const auto& lhs = detail::materialize(m_lhs);
+                const auto& rhs = detail::materialize(m_rhs);
+                detail::fixed_gemm<R, C, E1::col_extent, S>(lhs.data(), lhs.row_stride(), lhs.col_stride(),
+                    rhs.data(), rhs.row_stride(), rhs.col_stride(), dst.data(), dst.row_stride(), dst.col_stride());
+            } else {
+                const auto& lhs = detail::materialize(m_lhs);
+                const auto& rhs = detail::materialize(m_rhs);
+                gemm<S>(rows(), cols(), m_lhs.cols(), S(1), lhs.data(), lhs.row_stride(), lhs.col_stride(),
+                    rhs.data(), rhs.row_stride(), rhs.col_stride(), S(0), dst.data(), dst.row_stride(), dst.col_stride());
+            }
+        }
+
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator* overload for matrix multiplication.
@@ -101,7 +212,7 @@ namespace linalg {
     requires EnforceMatMulReqs<S1, S2, R1, R2, C1, C2>
     auto operator*(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixMultiplication<S1, R1, C2, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixMultiplication<S1, R1, C2, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Scalar-Matrix multiplication.
@@ -117,14 +228,41 @@ namespace linalg {
         {
         }
 
-        S operator()(size_t row, size_t col) const
+        size_t rows() const noexcept
+        {
+            return m_rhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_rhs.cols();
+        }
+
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E>;
+        static constexpr bool linear_access = linear_access_v<E>;
+        static constexpr bool packet_access = packet_access_v<E>;
+        static constexpr Layout layout = layout_v<E>;
+
+        S coeff(size_t row, size_t col) const
         {
-            return m_lhs * m_rhs(row, col);
+            return m_lhs * m_rhs.coeff(row, col);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_lhs * m_rhs.coeff(i);
+        }
+
+        packet_type packet(size_t i) const
+        {
+            return simd::Packet<S>::mul(simd::Packet<S>::set1(m_lhs), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        left_expr m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator* overload for scalar-matrix multiplication.
@@ -132,14 +270,63 @@ namespace linalg {
     requires EnforceSameType<S1, S2>
     auto operator*(const MatrixExpression<E, S1, R, C>& lhs, const S2& rhs)
     {
-        return MatrixScalarMultiplication<S2, R, C, MatrixExpression<E, S1, R, C>>(lhs, rhs);
+        return MatrixScalarMultiplication<S2, R, C, E>(rhs, static_cast<const E&>(lhs));
     }
 
     template <typename S1, typename S2, size_t R, size_t C, typename E>
     requires EnforceSameType<S1, S2>
     auto operator*(const S1& lhs, const MatrixExpression<E, S2, R, C>& rhs)
     {
-        return MatrixScalarMultiplication<S1, R, C, MatrixExpression<E, S2, R, C>>(lhs, rhs);
+        return MatrixScalarMultiplication<S1, R, C, E>(lhs, static_cast<const E&>(rhs));
+    }
+
+    /// @brief Conversion of the elements of a matrix to another scalar type.
+    /// @details Each element is converted with static_cast as it is read. There is no conversion of
+    /// packets, so a cast is evaluated one element at a time.
+    template <typename T, typename S, size_t R, size_t C, typename E>
+    class MatrixCast : public MatrixExpression<MatrixCast<T, S, R, C, E>, T, R, C> {
+    public:
+        using expr = E;
+
+        explicit MatrixCast(const expr& mat)
+            : m_mat(mat)
+        {
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_mat.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_mat.cols();
+        }
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E>;
+        static constexpr bool linear_access = linear_access_v<E>;
+        static constexpr Layout layout = layout_v<E>;
+
+        T coeff(size_t row, size_t col) const
+        {
+            return static_cast<T>(m_mat.coeff(row, col));
+        }
+
+        T coeff(size_t i) const
+        {
+            return static_cast<T>(m_mat.coeff(i));
+        }
+
+    private:
+        nested_t<expr> m_mat;
+    };
+
+    /// @brief Converts the elements of a matrix to T, e.g. cast<float>(A) for a single precision
+    /// copy of A.
+    template <typename T, typename S, size_t R, size_t C, typename E>
+    auto cast(const MatrixExpression<E, S, R, C>& mat)
+    {
+        return MatrixCast<T, S, R, C, E>(static_cast<const E&>(mat));
     }
 
     /// @brief Matrix element-wise multiplication.
@@ -149,20 +336,48 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixElementWiseMultiplication(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_lhs.rows();
         }
 
-        S operator()(size_t row, size_t col) const
+        size_t cols() const noexcept
         {
-            return m_lhs(row, col) * m_rhs(row, col);
+            return m_lhs.cols();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) * m_rhs.coeff(row, col);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_lhs.coeff(i) * m_rhs.coeff(i);
+        }
+
+        packet_type packet(size_t i) const
+        {
+            return simd::Packet<S>::mul(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator% overload for matrix element-wise multiplication.
@@ -170,7 +385,7 @@ namespace linalg {
     requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator%(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixElementWiseMultiplication<S1, R1, C2, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixElementWiseMultiplication<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Matrix element-wise equality check.
@@ -180,20 +395,48 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixElementWiseEquality(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
         }
 
-        S operator()(size_t row, size_t col) const
+        size_t rows() const noexcept
         {
-            return m_lhs(row, col) == m_rhs(row, col);
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_lhs.cols();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) == m_rhs.coeff(row, col);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_lhs.coeff(i) == m_rhs.coeff(i);
+        }
+
+        packet_type packet(size_t i) const
+        {
+            return simd::Packet<S>::eq(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator== overload for matrix element-wise equality check.
@@ -202,7 +445,7 @@ namespace linalg {
     requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator==(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixElementWiseEquality<S1, R1, C2, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixElementWiseEquality<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Matrix element-wise non-equality check.
@@ -212,20 +455,48 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixElementWiseNonEquality(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_lhs.cols();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) != m_rhs.coeff(row, col);
         }
 
-        S operator()(size_t row, size_t col) const
+        S coeff(size_t i) const
         {
-            return m_lhs(row, col) != m_rhs(row, col);
+            return m_lhs.coeff(i) != m_rhs.coeff(i);
+        }
+
+        packet_type packet(size_t i) const
+        {
+            return simd::Packet<S>::ne(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator!= overload for matrix element-wise non equality check.
@@ -234,7 +505,7 @@ namespace linalg {
     requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator!=(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixElementWiseNonEquality<S1, R1, C2, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixElementWiseNonEquality<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Matrix element-wise greater than equal check.
@@ -244,20 +515,48 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixElementWiseGEQ(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_lhs.cols();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) >= m_rhs.coeff(row, col);
         }
 
-        S operator()(size_t row, size_t col) const
+        S coeff(size_t i) const
         {
-            return m_lhs(row, col) >= m_rhs(row, col);
+            return m_lhs.coeff(i) >= m_rhs.coeff(i);
+        }
+
+        packet_type packet(size_t i) const
+        {
+            return simd::Packet<S>::ge(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator>= overload for matrix element-wise greater than equal check.
@@ -265,7 +564,7 @@ namespace linalg {
     requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator>=(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixElementWiseGEQ<S1, R1, C2, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixElementWiseGEQ<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Matrix element-wise greater than check.
@@ -275,20 +574,48 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixElementWiseGT(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_lhs.cols();
         }
 
-        S operator()(size_t row, size_t col) const
+        S coeff(size_t row, size_t col) const
         {
-            return m_lhs(row, col) > m_rhs(row, col);
+            return m_lhs.coeff(row, col) > m_rhs.coeff(row, col);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_lhs.coeff(i) > m_rhs.coeff(i);
+        }
+
+        packet_type packet(size_t i) const
+        {
+            return simd::Packet<S>::gt(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator> overload for matrix element-wise greater than check.
@@ -296,7 +623,7 @@ namespace linalg {
     requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator>(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixElementWiseGT<S1, R1, C2, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixElementWiseGT<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Matrix element-wise greater less than equal check.
@@ -306,20 +633,48 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixElementWiseLEQ(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
+        }
+
+        size_t rows() const noexcept
+        {
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_lhs.cols();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) <= m_rhs.coeff(row, col);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_lhs.coeff(i) <= m_rhs.coeff(i);
         }
 
-        S operator()(size_t row, size_t col) const
+        packet_type packet(size_t i) const
         {
-            return m_lhs(row, col) <= m_rhs(row, col);
+            return simd::Packet<S>::le(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator<= overload for matrix element-wise less than equal check.
@@ -327,7 +682,7 @@ namespace linalg {
     requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator<=(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixElementWiseLEQ<S1, R1, C2, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixElementWiseLEQ<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
     /// @brief Matrix element-wise greater less than check.
@@ -337,20 +692,48 @@ namespace linalg {
         using left_expr = E1;
         using right_expr = E2;
 
+        using packet_type = typename simd::Packet<S>::type;
+
+        static constexpr bool assume_aliasing = assume_aliasing_v<E1> || assume_aliasing_v<E2>;
+        static constexpr bool linear_access = linear_access_v<E1> && linear_access_v<E2> && same_layout_v<E1, E2>;
+        static constexpr bool packet_access = linear_access && packet_access_v<E1> && packet_access_v<E2>;
+        static constexpr Layout layout = layout_v<E1>;
+
         MatrixElementWiseLT(const left_expr& lhs, const right_expr& rhs)
             : m_lhs(lhs)
             , m_rhs(rhs)
         {
+            detail::check_same_shape(lhs, rhs);
         }
 
-        S operator()(size_t row, size_t col) const
+        size_t rows() const noexcept
         {
-            return m_lhs(row, col) <= m_rhs(row, col);
+            return m_lhs.rows();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_lhs.cols();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) < m_rhs.coeff(row, col);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_lhs.coeff(i) < m_rhs.coeff(i);
+        }
+
+        packet_type packet(size_t i) const
+        {
+            return simd::Packet<S>::lt(m_lhs.packet(i), m_rhs.packet(i));
         }
 
     private:
-        const left_expr& m_lhs;
-        const right_expr& m_rhs;
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
     };
 
     /// @brief operator< overload for matrix element-wise less than check.
@@ -358,31 +741,43 @@ namespace linalg {
     requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
     auto operator<(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
     {
-        return MatrixElementWiseLT<S1, R1, C2, MatrixExpression<E1, S1, R1, C1>, MatrixExpression<E2, S2, R2, C2>>(lhs, rhs);
+        return MatrixElementWiseLT<S1, merged_extent_v<R1, R2>, merged_extent_v<C1, C2>, E1, E2>(static_cast<const E1&>(lhs), static_cast<const E2&>(rhs));
     }
 
+    /// @brief Performs matrix concatenation into result, reusing its storage if it already has the
+    /// shape of the concatenation.
+    /// @param matrix1 the first matrix
+    /// @param matrix2 the second matrix
+    /// @param result the concatenation, which must not be either matrix.
+    template <typename S, size_t R1, size_t C1, size_t R2, size_t C2>
+    requires(extents_match(R1, R2))
+    void concat(const Matrix<S, R1, C1>& mat1, const Matrix<S, R2, C2>& mat2, Matrix<S, merged_extent_v<R1, R2>, sum_extent_v<C1, C2>>& result)
+    {
+        if (mat1.rows() != mat2.rows())
+            throw std::invalid_argument("Matrix dimensions do not match.");
+
+        if constexpr (R1 == Dynamic || R2 == Dynamic || C1 == Dynamic || C2 == Dynamic)
+            if (result.rows() != mat1.rows() || result.cols() != mat1.cols() + mat2.cols())
+                result.resize(mat1.rows(), mat1.cols() + mat2.cols());
+
+        // each half is copied a row at a time into a view of its columns.
+        if (mat1.size() > 0)
+            result.cviews(1, mat1.cols()).noalias() = mat1;
+        if (mat2.size() > 0)
+            result.cviews(mat1.cols() + 1, result.cols()).noalias() = mat2;
+    };
+
     /// @brief Performs matrix concatenation.
     /// @param matrix1 the first matrix
     /// @param matrix2 the second matrix
     /// @returns the result of the concatenation.
     /// TODO: this is only lengthwise right now, should add vertical support.
     template <typename S, size_t R1, size_t C1, size_t R2, size_t C2>
-    Matrix<S, R1, C1 + C2> concat(const Matrix<S, R1, C1>& mat1, const Matrix<S, R2, C2>& mat2)
+    requires(extents_match(R1, R2))
+    Matrix<S, merged_extent_v<R1, R2>, sum_extent_v<C1, C2>> concat(const Matrix<S, R1, C1>& mat1, const Matrix<S, R2, C2>& mat2)
     {
-        Matrix<S, R1, C1 + C2> result;
-
-        for (size_t i = 1; i < R1 + 1; ++i) {
-            for (size_t j = 1; j < C1 + 1; ++j) {
-                result(i, j) = mat1(i, j);
-            }
-        }
-
-        for (size_t i = 1; i < R2 + 1; ++i) {
-            for (size_t j = 1; j < C2 + 1; ++j) {
-                result(i, C1 + j) = mat2(i, j);
-            }
-        }
-
+        Matrix<S, merged_extent_v<R1, R2>, sum_extent_v<C1, C2>> result;
+        concat(mat1, mat2, result);
         return result;
     };
 
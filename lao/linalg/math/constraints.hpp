@@ -3,6 +3,8 @@
 
 #include <cstddef>
 #include <functional>
+#include <lao/linalg/core/extent.hpp>
+#include <stdexcept>
 
 namespace lao {
 namespace linalg {
@@ -20,6 +22,9 @@ namespace linalg {
         requires std::same_as<S1, S2>;
     };
 
+    // The shape concepts below only constrain extents known at compile-time. A `Dynamic` extent
+    // matches anything, and is checked at runtime when the expression is built instead.
+
     /// @brief Concept for enforcing matrix addition/subtraction constraints.
     template <typename S1, typename S2, size_t R1, size_t R2, size_t C1, size_t C2>
     concept EnforceSameShape = requires
@@ -27,7 +32,7 @@ namespace linalg {
         // Check if the scalar types match
         requires std::same_as<S1, S2>;
         // Check if the dimensions match
-        requires R1 == R2&& C1 == C2;
+        requires extents_match(R1, R2) && extents_match(C1, C2);
     };
 
     /// @brief Concept for enforcing matrix multiplication constraints.
@@ -37,16 +42,50 @@ namespace linalg {
         // Check if the scalar types match
         requires std::same_as<S1, S2>;
         // Check if the dimensions match
-        requires C1 == R2;
+        requires extents_match(C1, R2);
     };
 
     /// @brief Concept for enforcing square matrices.
     template <typename S, size_t R, size_t C>
     concept EnforceSquareMatrix = requires
     {
-        requires R == C;
+        requires extents_match(R, C);
     };
 
+    namespace detail {
+
+        /// @brief Runtime counterpart of EnforceSameShape for operands with a dynamic extent.
+        template <typename E1, typename E2>
+        void check_same_shape(const E1& lhs, const E2& rhs)
+        {
+            if constexpr (E1::row_extent == Dynamic || E2::row_extent == Dynamic || E1::col_extent == Dynamic || E2::col_extent == Dynamic) {
+                if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols())
+                    throw std::invalid_argument("Matrix dimensions do not match.");
+            }
+        }
+
+        /// @brief Runtime counterpart of EnforceMatMulReqs for operands with a dynamic extent.
+        template <typename E1, typename E2>
+        void check_product_shape(const E1& lhs, const E2& rhs)
+        {
+            if constexpr (E1::col_extent == Dynamic || E2::row_extent == Dynamic) {
+                if (lhs.cols() != rhs.rows())
+                    throw std::invalid_argument("Matrix dimensions do not match.");
+            }
+        }
+
+        /// @brief Runtime counterpart of EnforceSquareMatrix for operands with a dynamic extent.
+        template <typename E>
+        void check_square(const E& matrix)
+        {
+            if constexpr (E::row_extent == Dynamic || E::col_extent == Dynamic) {
+                if (matrix.rows() != matrix.cols())
+                    throw std::invalid_argument("Matrix is not square.");
+            }
+        }
+
+    }; // namespace detail
+
 }; // namespace linalg
 }; // namespace lao
 
@@ -1,32 +1,45 @@
 #ifndef LAO_LINALG_MATH_FUNDAMENTAL_H_
 #define LAO_LINALG_MATH_FUNDAMENTAL_H_
 
+#include <algorithm>
 #include <lao/linalg/core/expression.hpp>
+#include <lao/linalg/core/simd.hpp>
+#include <lao/linalg/dense/LU.hpp>
+#include <lao/linalg/dense/fixed.hpp>
+#include <lao/linalg/dense/matrix.hpp>
 #include <lao/linalg/math/constraints.hpp>
+#include <lao/linalg/math/reductions.hpp>
+#include <lao/parallel.hpp>
+#include <vector>
 
 namespace lao {
 namespace linalg {
 
     /// @brief Accumulates all of the elements in a matrix.
+    /// @details The same as `sum`, see reductions.hpp, so the result does not depend on the number
+    /// of threads.
     template <typename S, size_t R, size_t C, typename E>
     S accumulate(const MatrixExpression<E, S, R, C>& matrix)
     {
-        S sum = 0;
-        for (size_t i = 1; i < matrix.rows() + 1; ++i) {
-            for (size_t j = 1; j < matrix.cols() + 1; ++j) {
-                sum += matrix(i, j);
-            }
+        return sum(matrix);
+    }
+
+    /// @brief Calculates the determinant of a matrix.
+    /// @details Only works for square matrices, computed from an LU factorization, or fully unrolled
+    /// for fixed sizes within LAO_FIXED_UNROLL_SIZE. To also solve systems with the same matrix, keep
+    /// the LUFactorization instead.
+    template <typename S, size_t R, size_t C, typename E>
+    requires EnforceSquareMatrix<S, R, C>
+        S det(const MatrixExpression<E, S, R, C>& matrix)
+    {
+        if constexpr (detail::is_fixed_unrolled_v<R, C>) {
+            const auto& a = detail::materialize(matrix);
+            return detail::fixed_det<R>(a.data(), a.row_stride(), a.col_stride());
+        } else {
+            return LUFactorization(matrix).det();
         }
-        return sum;
     }
 
-//    /// @brief Calculates the determinant of a matrix.
-//    template <typename S, size_t R, size_t C, typename E>
-//    S det(const MatrixExpression<E, S, R, C>& matrix)
-//    {
-//        // TODO
-//    }
-//
 //    /// @brief Calculates the rank of a matrix.
 //    template <typename S, size_t R, size_t C, typename E>
 //    size_t rank(const MatrixExpression<E, S, R, C>& matrix)
@@ -34,71 +47,138 @@ namespace linalg {
 //        // TODO
 //    }
 
+    /// @brief Matrix transposition.
+    /// @details Element (i, j) of the result reads element (j, i) of the operand, so assigning the
+    /// transpose of a matrix into itself goes through a temporary.
+    /// The transpose of a linear expression is the same flat sequence of elements read in the opposite
+    /// layout, so e.g. the transpose of a column-major matrix is a free reinterpretation as a row-major
+    /// one. Likewise the transpose of a strided matrix is strided, with the strides swapped.
     template <typename S, size_t R, size_t C, typename E>
     class MatrixTranspose : public MatrixExpression<MatrixTranspose<S, R, C, E>, S, C, R> {
     public:
         using value_type = S;
+        using packet_type = typename simd::Packet<S>::type;
 
-        MatrixTranspose(const MatrixExpression<E, S, R, C>& matrix)
+        static constexpr bool assume_aliasing = true;
+        static constexpr bool linear_access = linear_access_v<E>;
+        static constexpr bool packet_access = packet_access_v<E>;
+        static constexpr Layout layout = layout_v<E> == Layout::RowMajor ? Layout::ColMajor : Layout::RowMajor;
+
+        MatrixTranspose(const E& matrix)
             : m_matrix(matrix)
         {
         }
 
-        S operator()(size_t row, size_t col) const override
+        size_t rows() const noexcept
+        {
+            return m_matrix.cols();
+        }
+
+        size_t cols() const noexcept
+        {
+            return m_matrix.rows();
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_matrix.coeff(col, row);
+        }
+
+        S coeff(size_t i) const
+        {
+            return m_matrix.coeff(i);
+        }
+
+        packet_type packet(size_t i) const
         {
-            return m_matrix(col, row);
+            return m_matrix.packet(i);
+        }
+
+        const S* data() const requires StridedExpression<E>
+        {
+            return m_matrix.data();
+        }
+
+        size_t row_stride() const requires StridedExpression<E>
+        {
+            return m_matrix.col_stride();
+        }
+
+        size_t col_stride() const requires StridedExpression<E>
+        {
+            return m_matrix.row_stride();
         }
 
     private:
-        const MatrixExpression<E, S, R, C>& m_matrix;
+        nested_t<E> m_matrix;
     };
 
     /// @brief Returns the transposition of a matrix.
     template <typename S, size_t R, size_t C, typename E>
     auto transpose(const MatrixExpression<E, S, R, C>& matrix)
     {
-        return MatrixTranspose<S, R, C, E>(matrix);
+        return MatrixTranspose<S, R, C, E>(static_cast<const E&>(matrix));
     }
 
     /// @brief Calculates the trace of a matrix.
-    /// @details Only works for square matrices.
+    /// @details Only works for square matrices. Only the diagonal of an expression is evaluated, e.g.
+    /// `trace(A * B)` computes n dot products rather than the product, into four accumulators.
     template <typename S, size_t R, size_t C, typename E>
     requires EnforceSquareMatrix<S, R, C>
         S trace(const MatrixExpression<E, S, R, C>& matrix)
     {
-        S sum = 0;
-        for (size_t i = 1; i < std::min(matrix.rows() + 1, matrix.cols() + 1); ++i) {
-            sum += matrix(i, i);
+        detail::check_square(matrix);
+        const E& derived = static_cast<const E&>(matrix);
+        const size_t n = derived.rows();
+        S acc[4] = { S(0), S(0), S(0), S(0) };
+        size_t i = 1;
+        for (; i + 3 <= n; i += 4)
+            for (size_t k = 0; k < 4; ++k)
+                acc[k] += derived.coeff(i + k, i + k);
+        for (; i <= n; ++i)
+            acc[0] += derived.coeff(i, i);
+        return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+
+    /// @brief Calculates the inverse of a matrix.
+    /// @details Only works for square matrices, computed from an LU factorization, or fully unrolled
+    /// for fixed sizes within LAO_FIXED_UNROLL_SIZE. Throws std::runtime_error if the matrix is
+    /// singular. To solve a system, `solve` is cheaper and more accurate than multiplying by the
+    /// inverse.
+    template <typename S, size_t R, size_t C, typename E>
+    requires EnforceSquareMatrix<S, R, C>
+        auto inv(const MatrixExpression<E, S, R, C>& matrix)
+    {
+        if constexpr (detail::is_fixed_unrolled_v<R, C>) {
+            const auto& a = detail::materialize(matrix);
+            Matrix<S, R, C> result;
+            detail::fixed_inverse<R>(a.data(), a.row_stride(), a.col_stride(), result.data(), result.row_stride(), result.col_stride());
+            return result;
+        } else {
+            return LUFactorization(matrix).inverse();
         }
-        return sum;
     }
 
-//    template <typename S, size_t R, size_t C, typename E>
-//    class MatrixInverse : public MatrixExpression<MatrixInverse<S, R, C, E>, S, C, R> {
-//    public:
-//        using value_type = S;
-//
-//        MatrixInverse(const MatrixExpression<E, S, R, C>& matrix)
-//            : m_matrix(matrix)
-//        {
-//        }
-//
-//        S operator()(size_t row, size_t col) const override
-//        {
-//        }
-//
-//    private:
-//        const MatrixExpression<E, S, R, C>& m_matrix;
-//    };
-
-//    /// @brief Calculates the inverse of a matrix.
-//    /// @details Only works for square matrices.
-//    template <typename S, size_t R, size_t C, typename E>
-//    requires EnforceSquareMatrix<S, R, C>
-//    auto inv(const MatrixExpression<E, S, R, C>& matrix)
-//    {
-//        // TODO
-//    }
+    /// @brief Solves AX = B for X, for a vector or any number of right hand sides at once.
+    /// @details Only works for square A, by LU factorization with partial pivoting, or fully unrolled
+    /// for fixed sizes within LAO_FIXED_UNROLL_SIZE. To solve many systems with the same A, keep the
+    /// LUFactorization instead. Throws std::invalid_argument if B does not have as many rows as A,
+    /// and std::runtime_error if A is singular.
+    template <typename S, size_t R, size_t C, size_t R2, size_t C2, typename E1, typename E2>
+    requires(EnforceSquareMatrix<S, R, C> && extents_match(R, R2))
+    Matrix<S, merged_extent_v<merged_extent_v<R, C>, R2>, C2> solve(const MatrixExpression<E1, S, R, C>& A, const MatrixExpression<E2, S, R2, C2>& B)
+    {
+        if constexpr (detail::is_fixed_unrolled_v<R, C> && detail::is_fixed_unrolled_v<R2, C2>) {
+            const auto& a = detail::materialize(A);
+            const auto& b = detail::materialize(B);
+            Matrix<S, R, C2> result;
+            detail::fixed_solve<R, C2>(a.data(), a.row_stride(), a.col_stride(), b.data(), b.row_stride(), b.col_stride(),
+                result.data(), result.row_stride(), result.col_stride());
+            return result;
+        } else {
+            return LUFactorization(A).solve(B);
+        }
+    }
 
 }; // namespace linalg
 }; // namespace lao
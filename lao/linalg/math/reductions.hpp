@@ -0,0 +1,362 @@
+/// reductions.hpp implements the reductions of a matrix expression to a scalar: sum, dot, the
+/// entry-wise norms and the smallest and largest element.
+///
+/// An expression is reduced in one pass without being evaluated, except for those the evaluation
+/// policy materializes, e.g. products. Linear expressions are read as one flat sequence of elements
+/// with four independent accumulators, a simd::Packet at a time where they support packet access,
+/// and the rest a row at a time. The elements are split into blocks of detail::REDUCTION_BLOCK
+/// elements which are reduced on their own, in parallel once there are LAO_PARALLEL_THRESHOLD
+/// elements, and the results of the blocks are then combined pairwise in a fixed order. As the order
+/// of the operations depends only on the shape of the expression, the result is the same on any
+/// number of threads, though it differs in the last bits from a sum in storage order.
+///
+/// Sums take a Summation, where `Summation::compensated` adds the elements of each block with
+/// Kahan's compensated summation, at about twice the cost, for an error which does not grow with the
+/// number of elements. It relies on IEEE arithmetic, so it is defeated by -ffast-math.
+
+#ifndef LAO_LINALG_MATH_REDUCTIONS_H_
+#define LAO_LINALG_MATH_REDUCTIONS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <lao/config.hpp>
+#include <lao/linalg/core/expression.hpp>
+#include <lao/linalg/core/simd.hpp>
+#include <lao/linalg/dense/matrix.hpp>
+#include <lao/linalg/math/arithmetic.hpp>
+#include <lao/linalg/math/constraints.hpp>
+#include <lao/parallel.hpp>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief How a sum adds its elements, see reductions.hpp.
+    enum class Summation {
+        // four accumulators, or packets of them, combined pairwise.
+        fast,
+        // Kahan's compensated summation within each block.
+        compensated
+    };
+
+    namespace detail {
+
+        /// @brief Number of elements in each block of a reduction, see reductions.hpp.
+        inline constexpr size_t REDUCTION_BLOCK = 4096;
+
+        /// @brief Returns |x|, for signed and unsigned S alike.
+        template <typename S>
+        S magnitude(S x) noexcept
+        {
+            if constexpr (std::is_unsigned_v<S>)
+                return x;
+            else
+                return x < S(0) ? -x : x;
+        }
+
+        /// @brief The reductions, as an identity, a map applied to each element and an associative
+        /// combination of two mapped elements, for both scalars and packets.
+        template <typename S>
+        struct SumReduction {
+            using P = simd::Packet<S>;
+            static constexpr bool additive = true;
+            static S identity() noexcept { return S(0); }
+            static S map(S x) noexcept { return x; }
+            static typename P::type map_packet(typename P::type x) noexcept { return x; }
+            static S combine(S a, S b) noexcept { return a + b; }
+            static typename P::type combine_packet(typename P::type a, typename P::type b) noexcept { return P::add(a, b); }
+        };
+
+        template <typename S>
+        struct AbsSumReduction : SumReduction<S> {
+            using P = simd::Packet<S>;
+            static S map(S x) noexcept { return magnitude(x); }
+            static typename P::type map_packet(typename P::type x) noexcept { return P::abs(x); }
+        };
+
+        template <typename S>
+        struct SquaredSumReduction : SumReduction<S> {
+            using P = simd::Packet<S>;
+            static S map(S x) noexcept { return x * x; }
+            static typename P::type map_packet(typename P::type x) noexcept { return P::mul(x, x); }
+        };
+
+        template <typename S>
+        struct MaxReduction {
+            using P = simd::Packet<S>;
+            static constexpr bool additive = false;
+            static S identity() noexcept { return std::numeric_limits<S>::lowest(); }
+            static S map(S x) noexcept { return x; }
+            static typename P::type map_packet(typename P::type x) noexcept { return x; }
+            static S combine(S a, S b) noexcept { return a < b ? b : a; }
+            static typename P::type combine_packet(typename P::type a, typename P::type b) noexcept { return P::max(a, b); }
+        };
+
+        template <typename S>
+        struct MinReduction : MaxReduction<S> {
+            using P = simd::Packet<S>;
+            static S identity() noexcept { return std::numeric_limits<S>::max(); }
+            static S combine(S a, S b) noexcept { return b < a ? b : a; }
+            static typename P::type combine_packet(typename P::type a, typename P::type b) noexcept { return P::min(a, b); }
+        };
+
+        template <typename S>
+        struct MaxAbsReduction : MaxReduction<S> {
+            using P = simd::Packet<S>;
+            static S identity() noexcept { return S(0); }
+            static S map(S x) noexcept { return magnitude(x); }
+            static typename P::type map_packet(typename P::type x) noexcept { return P::abs(x); }
+        };
+
+        /// @brief Two contiguous arrays read as the flat sequence of their products, for dot.
+        template <typename S>
+        struct ProductSource {
+            static constexpr bool packet_access = true;
+            const S* x;
+            const S* y;
+            S coeff(size_t i) const noexcept { return x[i] * y[i]; }
+            typename simd::Packet<S>::type packet(size_t i) const noexcept
+            {
+                return simd::Packet<S>::mul(simd::Packet<S>::load(x + i), simd::Packet<S>::load(y + i));
+            }
+        };
+
+        /// @brief Reduces the elements [first, last) of a flat sequence, i.e. an expression with
+        /// linear access or a source such as ProductSource.
+        template <typename Op, typename S, typename Source>
+        S reduce_flat(const Source& source, size_t first, size_t last, Summation summation)
+        {
+            using P = simd::Packet<S>;
+            constexpr bool packets = Source::packet_access && P::size > 1;
+            size_t i = first;
+            S result = Op::identity();
+            if (Op::additive && summation == Summation::compensated) {
+                // Kahan's summation, where c holds the low order bits lost by the last addition.
+                S c = S(0);
+                const auto add = [&](S x) {
+                    const S y = x - c;
+                    const S t = result + y;
+                    c = (t - result) - y;
+                    result = t;
+                };
+                if constexpr (packets) {
+                    typename P::type sum = P::zero();
+                    typename P::type cs = P::zero();
+                    for (; i + P::size <= last; i += P::size) {
+                        const typename P::type y = P::sub(Op::map_packet(source.packet(i)), cs);
+                        const typename P::type t = P::add(sum, y);
+                        cs = P::sub(P::sub(t, sum), y);
+                        sum = t;
+                    }
+                    S sums[P::size];
+                    S compensations[P::size];
+                    P::store(sums, sum);
+                    P::store(compensations, cs);
+                    for (size_t k = 0; k < P::size; ++k) {
+                        add(sums[k]);
+                        add(-compensations[k]);
+                    }
+                }
+                for (; i < last; ++i)
+                    add(Op::map(source.coeff(i)));
+                return result;
+            }
+
+            if constexpr (packets) {
+                // four packets in flight hide the latency of the combination.
+                typename P::type acc[4] = { P::set1(Op::identity()), P::set1(Op::identity()), P::set1(Op::identity()), P::set1(Op::identity()) };
+                for (; i + 4 * P::size <= last; i += 4 * P::size)
+                    for (size_t k = 0; k < 4; ++k)
+                        acc[k] = Op::combine_packet(acc[k], Op::map_packet(source.packet(i + k * P::size)));
+                for (; i + P::size <= last; i += P::size)
+                    acc[0] = Op::combine_packet(acc[0], Op::map_packet(source.packet(i)));
+                S lanes[P::size];
+                P::store(lanes, Op::combine_packet(Op::combine_packet(acc[0], acc[1]), Op::combine_packet(acc[2], acc[3])));
+                for (size_t k = 0; k < P::size; ++k)
+                    result = Op::combine(result, lanes[k]);
+            } else {
+                S acc[4] = { Op::identity(), Op::identity(), Op::identity(), Op::identity() };
+                for (; i + 4 <= last; i += 4)
+                    for (size_t k = 0; k < 4; ++k)
+                        acc[k] = Op::combine(acc[k], Op::map(source.coeff(i + k)));
+                result = Op::combine(Op::combine(acc[0], acc[1]), Op::combine(acc[2], acc[3]));
+            }
+            for (; i < last; ++i)
+                result = Op::combine(result, Op::map(source.coeff(i)));
+            return result;
+        }
+
+        /// @brief Reduces the rows [first, last) of an expression, 0 indexed, through `coeff(i, j)`.
+        template <typename Op, typename S, typename E>
+        S reduce_rows(const E& expr, size_t first, size_t last, Summation summation)
+        {
+            const size_t cols = expr.cols();
+            if (Op::additive && summation == Summation::compensated) {
+                S result = S(0);
+                S c = S(0);
+                for (size_t i = first; i < last; ++i) {
+                    for (size_t j = 0; j < cols; ++j) {
+                        const S y = Op::map(static_cast<S>(expr.coeff(i + 1, j + 1))) - c;
+                        const S t = result + y;
+                        c = (t - result) - y;
+                        result = t;
+                    }
+                }
+                return result;
+            }
+            S acc[4] = { Op::identity(), Op::identity(), Op::identity(), Op::identity() };
+            for (size_t i = first; i < last; ++i) {
+                size_t j = 0;
+                for (; j + 4 <= cols; j += 4)
+                    for (size_t k = 0; k < 4; ++k)
+                        acc[k] = Op::combine(acc[k], Op::map(static_cast<S>(expr.coeff(i + 1, j + k + 1))));
+                for (; j < cols; ++j)
+                    acc[0] = Op::combine(acc[0], Op::map(static_cast<S>(expr.coeff(i + 1, j + 1))));
+            }
+            return Op::combine(Op::combine(acc[0], acc[1]), Op::combine(acc[2], acc[3]));
+        }
+
+        /// @brief Reduces blocks [0, blocks) with reduce_block(b) and combines their results pairwise.
+        /// @details The blocks run in parallel if parallel is set, and the order of the combination
+        /// only depends on the number of blocks.
+        template <typename Op, typename S, typename F>
+        S reduce_blocks(size_t blocks, bool parallel, const F& reduce_block)
+        {
+            if (blocks == 0)
+                return Op::identity();
+            if (blocks == 1)
+                return reduce_block(0);
+            std::vector<S> partials(blocks);
+            const auto run = [&](size_t first, size_t last) {
+                for (size_t b = first; b < last; ++b)
+                    partials[b] = reduce_block(b);
+            };
+            if (parallel)
+                parallel_for(0, blocks, std::max<size_t>(1, LAO_PARALLEL_THRESHOLD / 2 / REDUCTION_BLOCK), run);
+            else
+                run(0, blocks);
+            for (size_t width = 1; width < blocks; width *= 2)
+                for (size_t b = 0; b + width < blocks; b += 2 * width)
+                    partials[b] = Op::combine(partials[b], partials[b + width]);
+            return partials[0];
+        }
+
+        /// @brief Reduces n contiguous elements of a flat source in blocks, see reductions.hpp.
+        template <typename Op, typename S, typename Source>
+        S reduce_source(const Source& source, size_t n, Summation summation)
+        {
+            if (n <= REDUCTION_BLOCK)
+                return reduce_flat<Op, S>(source, 0, n, summation);
+            return reduce_blocks<Op, S>((n + REDUCTION_BLOCK - 1) / REDUCTION_BLOCK, n >= LAO_PARALLEL_THRESHOLD, [&](size_t b) {
+                return reduce_flat<Op, S>(source, b * REDUCTION_BLOCK, std::min(n, (b + 1) * REDUCTION_BLOCK), summation);
+            });
+        }
+
+        /// @brief Reduces all elements of an expression, see reductions.hpp.
+        template <typename Op, typename E, typename S, size_t R, size_t C>
+        S reduce(const MatrixExpression<E, S, R, C>& expr, Summation summation)
+        {
+            // held as an operand is, so products are evaluated once and matrices are not copied.
+            nested_t<E> operand(static_cast<const E&>(expr));
+            const size_t rows = operand.rows();
+            const size_t cols = operand.cols();
+            if constexpr (linear_access_v<E>) {
+                if constexpr (R != Dynamic && C != Dynamic && R * C <= REDUCTION_BLOCK)
+                    return reduce_flat<Op, S>(operand, 0, R * C, summation);
+                else
+                    return reduce_source<Op, S>(operand, rows * cols, summation);
+            } else {
+                const size_t rows_per_block = std::max<size_t>(1, REDUCTION_BLOCK / std::max<size_t>(cols, 1));
+                if (rows <= rows_per_block)
+                    return reduce_rows<Op, S>(operand, 0, rows, summation);
+                return reduce_blocks<Op, S>((rows + rows_per_block - 1) / rows_per_block, rows * cols >= LAO_PARALLEL_THRESHOLD, [&](size_t b) {
+                    return reduce_rows<Op, S>(operand, b * rows_per_block, std::min(rows, (b + 1) * rows_per_block), summation);
+                });
+            }
+        }
+
+        template <typename E>
+        void check_not_empty(const E& expr)
+        {
+            if (expr.rows() == 0 || expr.cols() == 0)
+                throw std::invalid_argument("Matrix is empty.");
+        }
+
+        /// @brief Returns the dot product of two contiguous vectors of size n, see reductions.hpp.
+        template <typename S>
+        S dot(size_t n, const S* x, const S* y)
+        {
+            return reduce_source<SumReduction<S>, S>(ProductSource<S> { x, y }, n, Summation::fast);
+        }
+
+    }; // namespace detail
+
+    /// @brief Returns the sum of all of the elements of an expression.
+    template <typename S, size_t R, size_t C, typename E>
+    S sum(const MatrixExpression<E, S, R, C>& expr, Summation summation = Summation::fast)
+    {
+        return detail::reduce<detail::SumReduction<S>>(expr, summation);
+    }
+
+    /// @brief Returns the dot product of two expressions of the same shape, the sum of the products
+    /// of their elements.
+    /// @details The product is fused into the sum, so `dot(a, b)` reads each element once without
+    /// evaluating `a % b`. For a row and a column vector use `dot(a, transpose(b))`.
+    template <typename S1, typename S2, size_t R1, size_t R2, size_t C1, size_t C2, typename E1, typename E2>
+    requires EnforceSameShape<S1, S2, R1, R2, C1, C2>
+    S1 dot(const MatrixExpression<E1, S1, R1, C1>& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs, Summation summation = Summation::fast)
+    {
+        return sum(lhs % rhs, summation);
+    }
+
+    /// @brief Returns the L1 norm of the elements of an expression, the sum of their magnitudes.
+    template <typename S, size_t R, size_t C, typename E>
+    S norm1(const MatrixExpression<E, S, R, C>& expr, Summation summation = Summation::fast)
+    {
+        return detail::reduce<detail::AbsSumReduction<S>>(expr, summation);
+    }
+
+    /// @brief Returns the L2 norm of the elements of an expression, the Frobenius norm of a matrix.
+    /// @details The squares are summed unscaled, so elements beyond the square root of the largest
+    /// value of S overflow.
+    template <typename S, size_t R, size_t C, typename E>
+    S norm2(const MatrixExpression<E, S, R, C>& expr, Summation summation = Summation::fast)
+    {
+        return std::sqrt(detail::reduce<detail::SquaredSumReduction<S>>(expr, summation));
+    }
+
+    /// @brief Returns the infinity norm of the elements of an expression, their largest magnitude.
+    template <typename S, size_t R, size_t C, typename E>
+    S norm_inf(const MatrixExpression<E, S, R, C>& expr)
+    {
+        return detail::reduce<detail::MaxAbsReduction<S>>(expr, Summation::fast);
+    }
+
+    /// @brief Returns the largest element of an expression.
+    /// @details Throws std::invalid_argument if the expression is empty. The result is unspecified
+    /// if an element is NaN.
+    template <typename S, size_t R, size_t C, typename E>
+    S max_coeff(const MatrixExpression<E, S, R, C>& expr)
+    {
+        detail::check_not_empty(expr);
+        return detail::reduce<detail::MaxReduction<S>>(expr, Summation::fast);
+    }
+
+    /// @brief Returns the smallest element of an expression.
+    /// @details Throws std::invalid_argument if the expression is empty. The result is unspecified
+    /// if an element is NaN.
+    template <typename S, size_t R, size_t C, typename E>
+    S min_coeff(const MatrixExpression<E, S, R, C>& expr)
+    {
+        detail::check_not_empty(expr);
+        return detail::reduce<detail::MinReduction<S>>(expr, Summation::fast);
+    }
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_MATH_REDUCTIONS_H_
@@ -0,0 +1,254 @@
+/// iterative.hpp implements the stationary and Krylov iterative solvers for Ax = b, for dense and
+/// sparse system matrices alike (see operator.hpp).
+///
+/// Every solver starts from the value of x passed in, updates it in place, and stops once the
+/// relative residual ||b - Ax|| / ||b|| is at most the tolerance or the iteration limit is hit. The
+/// outcome is returned as an IterativeResult rather than reported, so nothing is printed.
+///
+///     IterativeResult<double> result = pcg(A, x, b, ILU0Preconditioner<double>(A));
+///     if (!result.converged)
+///         ...
+
+#ifndef LAO_LINALG_SOLVERS_ITERATIVE_H_
+#define LAO_LINALG_SOLVERS_ITERATIVE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <lao/config.hpp>
+#include <lao/instrumentation.hpp>
+#include <lao/linalg/dense/matrix.hpp>
+#include <lao/linalg/solvers/operator.hpp>
+#include <lao/linalg/solvers/preconditioners.hpp>
+#include <lao/parallel.hpp>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief Stopping criteria and parameters of the iterative solvers.
+    template <typename S>
+    struct IterativeOptions {
+        /// @brief Maximum number of iterations.
+        size_t max_iterations = 1000;
+        /// @brief Tolerance on the relative residual ||b - Ax|| / ||b||, or ||b - Ax|| if b is zero.
+        S tolerance = S(1e-10);
+        /// @brief Number of iterations between convergence checks of the stationary methods.
+        /// @details Each check of Jacobi or SOR costs a matrix-vector product, CG gets its residual
+        /// for free and checks every iteration.
+        size_t check_interval = LAO_SOLVER_CHECK_INTERVAL;
+        /// @brief Relaxation factor of SOR, in (0, 2). 1 is Gauss-Seidel.
+        S omega = S(1);
+    };
+
+    /// @brief Outcome of an iterative solve.
+    template <typename S>
+    struct IterativeResult {
+        /// @brief Number of iterations performed.
+        size_t iterations = 0;
+        /// @brief Relative residual of the returned solution, as of the last check.
+        S residual = S(0);
+        /// @brief Whether the tolerance was reached.
+        bool converged = false;
+    };
+
+    namespace detail {
+
+        template <typename M, size_t N>
+        void check_system(const M& A, const Matrix<typename M::value_type, N, 1>& x, const Matrix<typename M::value_type, N, 1>& b)
+        {
+            check_square(A);
+            if (x.rows() != A.rows() || b.rows() != A.rows())
+                throw std::invalid_argument("Matrix dimensions do not match.");
+        }
+
+        /// @brief Runs sweep() until the relative residual is within tolerance.
+        /// @details x is the initial iterate, and sweep() returns where the next iterate is stored. The
+        /// outcome is recorded under solver, see lao/instrumentation.hpp.
+        template <typename M, typename S, typename F>
+        IterativeResult<S> iterate(const M& A, const S* x, const S* b, const IterativeOptions<S>& options, instrumentation::Solver solver, F&& sweep)
+        {
+            const size_t n = A.rows();
+            std::vector<S> r(n);
+            const S b_norm = std::sqrt(dot(n, b, b));
+            const S scale = b_norm == S(0) ? S(1) : S(1) / b_norm;
+            const size_t interval = std::max<size_t>(options.check_interval, 1);
+
+            IterativeResult<S> result;
+            result.residual = residual_norm(A, x, b, r.data()) * scale;
+            result.converged = result.residual <= options.tolerance;
+            while (!result.converged && result.iterations < options.max_iterations) {
+                x = sweep();
+                ++result.iterations;
+                if (result.iterations % interval == 0 || result.iterations == options.max_iterations) {
+                    result.residual = residual_norm(A, x, b, r.data()) * scale;
+                    result.converged = result.residual <= options.tolerance;
+                }
+            }
+            instrumentation::record_solve(solver, result.iterations, static_cast<double>(result.residual), result.converged);
+            return result;
+        }
+
+    }; // namespace detail
+
+    /// @brief The Jacobi method.
+    /// @details Each sweep computes every element of the new iterate from the old one,
+    /// x'_i = x_i + (b_i - (Ax)_i) / a_ii, alternating between x and one scratch vector rather than
+    /// copying. The rows are independent, so large sweeps run in parallel. Converges for strictly
+    /// diagonally dominant A. Throws std::invalid_argument if the
+    /// dimensions do not match or A has a zero on its diagonal.
+    template <SolverOperator M, size_t N>
+    IterativeResult<typename M::value_type> jacobi(const M& A, Matrix<typename M::value_type, N, 1>& x,
+        const Matrix<typename M::value_type, N, 1>& b, const IterativeOptions<typename M::value_type>& options = {})
+    {
+        using S = typename M::value_type;
+        detail::check_system(A, x, b);
+        instrumentation::ScopedTimer timer(instrumentation::Kernel::iterative);
+        const size_t n = A.rows();
+        std::vector<S> inv_diag = detail::operator_diagonal(A);
+        for (S& d : inv_diag)
+            d = S(1) / d;
+
+        std::vector<S> scratch(n);
+        S* current = x.data();
+        S* next = scratch.data();
+        const S* rhs = b.data();
+        const size_t row_cost = detail::row_cost(A);
+        const auto result = detail::iterate(A, static_cast<const S*>(current), rhs, options, instrumentation::Solver::jacobi, [&]() {
+            // rows only read the old iterate, so large sweeps are split across threads.
+            parallel_rows(0, n, row_cost, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    S sum = S(0);
+                    detail::for_each_in_row(A, i, [&](size_t j, S a) { sum += a * current[j]; });
+                    next[i] = current[i] + (rhs[i] - sum) * inv_diag[i];
+                }
+            });
+            std::swap(current, next);
+            return static_cast<const S*>(current);
+        });
+        if (current != x.data())
+            std::copy(current, current + n, x.data());
+        return result;
+    }
+
+    /// @brief Successive over-relaxation.
+    /// @details Each sweep updates x in place, row by row and so serially, from the latest values,
+    /// x_i = (1 - omega) x_i + omega (b_i - sum_{j != i} a_ij x_j) / a_ii, using options.omega.
+    /// Converges for symmetric positive definite A and 0 < omega < 2, and for strictly diagonally
+    /// dominant A with omega = 1. Throws std::invalid_argument if the dimensions do not match,
+    /// omega is outside of (0, 2) or A has a zero on its diagonal.
+    template <SolverOperator M, size_t N>
+    IterativeResult<typename M::value_type> sor(const M& A, Matrix<typename M::value_type, N, 1>& x,
+        const Matrix<typename M::value_type, N, 1>& b, const IterativeOptions<typename M::value_type>& options = {})
+    {
+        using S = typename M::value_type;
+        detail::check_system(A, x, b);
+        if (!(options.omega > S(0) && options.omega < S(2)))
+            throw std::invalid_argument("SOR relaxation factor must be in (0, 2).");
+        instrumentation::ScopedTimer timer(instrumentation::Kernel::iterative);
+        const size_t n = A.rows();
+        const std::vector<S> diag = detail::operator_diagonal(A);
+
+        S* xs = x.data();
+        const S* rhs = b.data();
+        const S omega = options.omega;
+        return detail::iterate(A, static_cast<const S*>(xs), rhs, options, instrumentation::Solver::sor, [&]() {
+            for (size_t i = 0; i < n; ++i) {
+                S sum = S(0);
+                detail::for_each_in_row(A, i, [&](size_t j, S a) { sum += a * xs[j]; });
+                // sum includes a_ii x_i, so this is the update above written as a correction.
+                xs[i] += omega * (rhs[i] - sum) / diag[i];
+            }
+            return static_cast<const S*>(xs);
+        });
+    }
+
+    /// @brief The Gauss-Seidel method, SOR with omega = 1.
+    template <SolverOperator M, size_t N>
+    IterativeResult<typename M::value_type> gauss_seidel(const M& A, Matrix<typename M::value_type, N, 1>& x,
+        const Matrix<typename M::value_type, N, 1>& b, IterativeOptions<typename M::value_type> options = {})
+    {
+        options.omega = typename M::value_type(1);
+        return sor(A, x, b, options);
+    }
+
+    /// @brief The preconditioned conjugate gradient method.
+    /// @details For symmetric positive definite A, and a symmetric positive definite preconditioner
+    /// P, see preconditioners.hpp. Converges in at most N iterations in exact arithmetic, and in far
+    /// fewer when P clusters the spectrum of A. Each iteration costs one product with A, one
+    /// application of P and a few vector updates. Throws std::invalid_argument if the dimensions do
+    /// not match, and std::runtime_error if A or P is found not to be positive definite.
+    template <SolverOperator M, size_t N, typename P>
+    IterativeResult<typename M::value_type> pcg(const M& A, Matrix<typename M::value_type, N, 1>& x,
+        const Matrix<typename M::value_type, N, 1>& b, const P& preconditioner, const IterativeOptions<typename M::value_type>& options = {})
+    {
+        using S = typename M::value_type;
+        detail::check_system(A, x, b);
+        instrumentation::ScopedTimer timer(instrumentation::Kernel::iterative);
+        const size_t n = A.rows();
+        S* xs = x.data();
+        const S* rhs = b.data();
+
+        std::vector<S> r(n);
+        std::vector<S> z(n);
+        std::vector<S> p(n);
+        std::vector<S> q(n);
+        const S b_norm = std::sqrt(detail::dot(n, rhs, rhs));
+        const S scale = b_norm == S(0) ? S(1) : S(1) / b_norm;
+
+        IterativeResult<S> result;
+        result.residual = detail::residual_norm(A, static_cast<const S*>(xs), rhs, r.data()) * scale;
+        result.converged = result.residual <= options.tolerance;
+        if (result.converged) {
+            instrumentation::record_solve(instrumentation::Solver::pcg, 0, static_cast<double>(result.residual), true);
+            return result;
+        }
+
+        preconditioner.apply(r.data(), z.data());
+        p = z;
+        S rz = detail::dot(n, r.data(), z.data());
+        while (result.iterations < options.max_iterations) {
+            detail::apply_operator(A, static_cast<const S*>(p.data()), q.data());
+            const S pq = detail::dot(n, p.data(), q.data());
+            if (!(pq > S(0)))
+                throw std::runtime_error("Matrix is not positive definite.");
+            const S alpha = rz / pq;
+            for (size_t i = 0; i < n; ++i) {
+                xs[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+            }
+            ++result.iterations;
+
+            result.residual = std::sqrt(detail::dot(n, r.data(), r.data())) * scale;
+            if (result.residual <= options.tolerance) {
+                result.converged = true;
+                break;
+            }
+
+            preconditioner.apply(r.data(), z.data());
+            const S rz_next = detail::dot(n, r.data(), z.data());
+            if (!(rz_next > S(0)))
+                throw std::runtime_error("Preconditioner is not positive definite.");
+            const S beta = rz_next / rz;
+            rz = rz_next;
+            for (size_t i = 0; i < n; ++i)
+                p[i] = z[i] + beta * p[i];
+        }
+        instrumentation::record_solve(instrumentation::Solver::pcg, result.iterations, static_cast<double>(result.residual), result.converged);
+        return result;
+    }
+
+    /// @brief The conjugate gradient method without preconditioning.
+    template <SolverOperator M, size_t N>
+    IterativeResult<typename M::value_type> conjugate_gradient(const M& A, Matrix<typename M::value_type, N, 1>& x,
+        const Matrix<typename M::value_type, N, 1>& b, const IterativeOptions<typename M::value_type>& options = {})
+    {
+        return pcg(A, x, b, IdentityPreconditioner<typename M::value_type>(A), options);
+    }
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_SOLVERS_ITERATIVE_H_
@@ -0,0 +1,120 @@
+/// operator.hpp implements the access to a system matrix shared by the iterative solvers and their
+/// preconditioners, so each of them is written once for both dense and sparse matrices.
+///
+/// A solver operator is a square `Matrix` of either layout or a square `SparseMatrix`. The helpers
+/// visit the stored elements of one row, 0 indexed, and compute products with vectors given as
+/// contiguous arrays, streaming dense matrices in storage order and sparse ones through spmv.
+
+#ifndef LAO_LINALG_SOLVERS_OPERATOR_H_
+#define LAO_LINALG_SOLVERS_OPERATOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <lao/linalg/dense/matrix.hpp>
+#include <lao/linalg/math/constraints.hpp>
+#include <lao/linalg/math/reductions.hpp>
+#include <lao/linalg/sparse/sparse_matrix.hpp>
+#include <lao/linalg/sparse/spmv.hpp>
+#include <lao/parallel.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief Concept for the matrices the iterative solvers accept.
+    template <typename M>
+    concept SolverOperator = (is_matrix_v<M> || is_sparse_matrix_v<M>)&&EnforceSquareMatrix<typename M::value_type, M::row_extent, M::col_extent>;
+
+    namespace detail {
+
+        /// @brief Calls f(col, value) for the elements of row i, 0 indexed.
+        /// @details Every element of a dense row is visited, only the non-zeros of a sparse one.
+        template <typename M, typename F>
+        void for_each_in_row(const M& A, size_t i, F&& f)
+        {
+            if constexpr (is_sparse_matrix_v<M>) {
+                const size_t* rowvec = A.row_offsets();
+                const size_t* colvec = A.col_indices();
+                const auto* values = A.values();
+                for (size_t p = rowvec[i]; p < rowvec[i + 1]; ++p)
+                    f(colvec[p], values[p]);
+            } else {
+                const auto* row = A.data() + i * A.row_stride();
+                const size_t cs = A.col_stride();
+                for (size_t j = 0; j < A.cols(); ++j)
+                    f(j, row[j * cs]);
+            }
+        }
+
+        /// @brief Returns the diagonal of A, throwing std::invalid_argument if it has a zero.
+        template <typename M>
+        std::vector<typename M::value_type> operator_diagonal(const M& A)
+        {
+            using S = typename M::value_type;
+            check_square(A);
+            std::vector<S> diag(A.rows(), S(0));
+            for (size_t i = 0; i < A.rows(); ++i)
+                for_each_in_row(A, i, [&](size_t j, S a) {
+                    if (j == i)
+                        diag[i] = a;
+                });
+            for (const S d : diag)
+                if (d == S(0))
+                    throw std::invalid_argument("Matrix has a zero on its diagonal.");
+            return diag;
+        }
+
+        /// @brief Returns the average number of stored elements in a row of A.
+        template <typename M>
+        size_t row_cost(const M& A) noexcept
+        {
+            if constexpr (is_sparse_matrix_v<M>)
+                return A.rows() > 0 ? A.nnz() / A.rows() + 1 : 1;
+            else
+                return A.cols();
+        }
+
+        /// @brief Computes y = A * x, where x and y are contiguous vectors which must not alias.
+        /// @details Large products are split across threads by rows.
+        template <typename M, typename S>
+        void apply_operator(const M& A, const S* x, S* y)
+        {
+            if constexpr (is_sparse_matrix_v<M>) {
+                spmv(A.rows(), A.row_offsets(), A.col_indices(), A.values(), x, 1, y, 1);
+            } else if constexpr (M::layout == Layout::RowMajor) {
+                parallel_rows(0, A.rows(), A.cols(), [&](size_t first, size_t last) {
+                    for (size_t i = first; i < last; ++i)
+                        y[i] = dot(A.cols(), A.data() + i * A.row_stride(), x);
+                });
+            } else {
+                // accumulate the columns over each range of rows, so A is streamed in storage order.
+                parallel_rows(0, A.rows(), A.cols(), [&](size_t first, size_t last) {
+                    std::fill(y + first, y + last, S(0));
+                    for (size_t j = 0; j < A.cols(); ++j) {
+                        const S* col = A.data() + j * A.col_stride();
+                        for (size_t i = first; i < last; ++i)
+                            y[i] += col[i] * x[j];
+                    }
+                });
+            }
+        }
+
+        /// @brief Returns ||b - A * x||_2, using r as scratch space of size n.
+        template <typename M, typename S>
+        S residual_norm(const M& A, const S* x, const S* b, S* r)
+        {
+            const size_t n = A.rows();
+            apply_operator(A, x, r);
+            for (size_t i = 0; i < n; ++i)
+                r[i] = b[i] - r[i];
+            return std::sqrt(dot(n, r, r));
+        }
+
+    }; // namespace detail
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_SOLVERS_OPERATOR_H_
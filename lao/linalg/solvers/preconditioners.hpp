@@ -0,0 +1,149 @@
+/// preconditioners.hpp implements the preconditioners for the conjugate gradient solver.
+///
+/// A preconditioner M approximates the system matrix A, and `apply(r, z)` solves M z = r for
+/// contiguous vectors of size N. Each one is built once from A, and then applied once per iteration.
+
+#ifndef LAO_LINALG_SOLVERS_PRECONDITIONERS_H_
+#define LAO_LINALG_SOLVERS_PRECONDITIONERS_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <lao/linalg/solvers/operator.hpp>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief The identity preconditioner, M = I, which turns PCG into plain conjugate gradient.
+    template <typename S>
+    class IdentityPreconditioner {
+    public:
+        using value_type = S;
+
+        IdentityPreconditioner() = default;
+
+        template <SolverOperator M>
+        explicit IdentityPreconditioner(const M& A)
+            : m_size(A.rows())
+        {
+        }
+
+        void apply(const S* r, S* z) const noexcept
+        {
+            std::copy(r, r + m_size, z);
+        }
+
+    private:
+        size_t m_size = 0;
+    };
+
+    /// @brief The Jacobi (diagonal) preconditioner, M = diag(A).
+    /// @details Cheap to build and apply, and effective when the diagonal varies a lot in scale.
+    /// Throws std::invalid_argument if A has a zero on its diagonal.
+    template <typename S>
+    class JacobiPreconditioner {
+    public:
+        using value_type = S;
+
+        template <SolverOperator M>
+        explicit JacobiPreconditioner(const M& A)
+            : m_inv_diag(detail::operator_diagonal(A))
+        {
+            for (S& d : m_inv_diag)
+                d = S(1) / d;
+        }
+
+        void apply(const S* r, S* z) const noexcept
+        {
+            for (size_t i = 0; i < m_inv_diag.size(); ++i)
+                z[i] = m_inv_diag[i] * r[i];
+        }
+
+    private:
+        std::vector<S> m_inv_diag;
+    };
+
+    /// @brief The incomplete LU preconditioner with zero fill-in, M = LU restricted to the pattern of A.
+    /// @details L and U are computed by Gaussian elimination without pivoting, dropping every update
+    /// outside of the pattern of stored elements of A, and stored in CSR with that same pattern.
+    /// Applying it costs two triangular solves, O(nnz). For a dense A nothing is dropped and this is
+    /// a full LU.
+    /// Throws std::invalid_argument if a zero pivot is met.
+    template <typename S>
+    class ILU0Preconditioner {
+    public:
+        using value_type = S;
+
+        template <SolverOperator M>
+        explicit ILU0Preconditioner(const M& A)
+        {
+            const size_t n = A.rows();
+            m_rowvec.assign(n + 1, 0);
+            m_diag.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                detail::for_each_in_row(A, i, [&](size_t j, S a) {
+                    if (j == i)
+                        m_diag[i] = m_colvec.size();
+                    m_colvec.push_back(j);
+                    m_values.push_back(a);
+                });
+                m_rowvec[i + 1] = m_colvec.size();
+            }
+
+            // IKJ elimination, with position maps the current row's columns to its storage.
+            constexpr size_t none = std::numeric_limits<size_t>::max();
+            std::vector<size_t> position(n, none);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t p = m_rowvec[i]; p < m_rowvec[i + 1]; ++p)
+                    position[m_colvec[p]] = p;
+                if (position[i] == none)
+                    throw std::invalid_argument("Matrix has a zero on its diagonal.");
+
+                for (size_t p = m_rowvec[i]; p < m_rowvec[i + 1] && m_colvec[p] < i; ++p) {
+                    const size_t k = m_colvec[p];
+                    const S l = m_values[p] /= m_values[m_diag[k]];
+                    for (size_t q = m_diag[k] + 1; q < m_rowvec[k + 1]; ++q)
+                        if (position[m_colvec[q]] != none)
+                            m_values[position[m_colvec[q]]] -= l * m_values[q];
+                }
+                if (m_values[m_diag[i]] == S(0))
+                    throw std::invalid_argument("Incomplete LU factorization has a zero pivot.");
+
+                for (size_t p = m_rowvec[i]; p < m_rowvec[i + 1]; ++p)
+                    position[m_colvec[p]] = none;
+            }
+        }
+
+        void apply(const S* r, S* z) const noexcept
+        {
+            const size_t n = m_diag.size();
+            // L y = r, with the unit diagonal of L implied.
+            for (size_t i = 0; i < n; ++i) {
+                S sum = r[i];
+                for (size_t p = m_rowvec[i]; p < m_diag[i]; ++p)
+                    sum -= m_values[p] * z[m_colvec[p]];
+                z[i] = sum;
+            }
+            // U z = y.
+            for (size_t i = n; i-- > 0;) {
+                S sum = z[i];
+                for (size_t p = m_diag[i] + 1; p < m_rowvec[i + 1]; ++p)
+                    sum -= m_values[p] * z[m_colvec[p]];
+                z[i] = sum / m_values[m_diag[i]];
+            }
+        }
+
+    private:
+        std::vector<S> m_values;
+        std::vector<size_t> m_rowvec;
+        std::vector<size_t> m_colvec;
+        // position of the diagonal element of each row in m_values.
+        std::vector<size_t> m_diag;
+    };
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_SOLVERS_PRECONDITIONERS_H_
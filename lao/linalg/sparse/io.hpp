@@ -0,0 +1,489 @@
+/// io.hpp implements the file formats sparse matrices are loaded from and saved to.
+///
+/// Matrix Market coordinate files (https://math.nist.gov/MatrixMarket/formats.html) are read whole
+/// into memory and split into newline aligned chunks, which are parsed in parallel with
+/// `std::from_chars` into one TripletBuilder each and then compressed to CSR in one pass.
+///
+/// The native binary format is the CSR arrays as they are in memory, behind a fixed header:
+///
+///     uint64 magic, version, scalar size, scalar kind, rows, cols, nnz, reserved
+///     uint64 row offsets[rows + 1]
+///     uint64 column indices[nnz]
+///     S      values[nnz]
+///
+/// Every array starts at a multiple of 8 bytes, so a MappedCSR can point straight into the mapped
+/// file, and `read_binary` copies each array into a SparseMatrix with a single memcpy. The format
+/// uses the byte order of the machine which wrote it, and is rejected on one with the other order.
+
+#ifndef LAO_LINALG_SPARSE_IO_H_
+#define LAO_LINALG_SPARSE_IO_H_
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <lao/config.hpp>
+#include <lao/linalg/sparse/sparse_matrix.hpp>
+#include <lao/linalg/sparse/triplet.hpp>
+#include <lao/parallel.hpp>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LAO_HAS_MMAP 1
+#else
+#define LAO_HAS_MMAP 0
+#endif
+
+namespace lao {
+namespace linalg {
+
+    namespace detail {
+
+        /// @brief Reads a whole file into a string.
+        inline std::string read_file(const std::string& filename)
+        {
+            std::ifstream file(filename, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+                throw std::runtime_error("Failed to open file");
+            std::string contents(static_cast<size_t>(file.tellg()), '\0');
+            file.seekg(0);
+            file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+            if (!file)
+                throw std::runtime_error("Failed to read file");
+            return contents;
+        }
+
+        inline const char* skip_blanks(const char* p, const char* end) noexcept
+        {
+            while (p != end && (*p == ' ' || *p == '\t' || *p == '\r'))
+                ++p;
+            return p;
+        }
+
+        inline const char* next_line(const char* p, const char* end) noexcept
+        {
+            p = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            return p ? p + 1 : end;
+        }
+
+        /// @brief Parses a number after optional blanks, throwing std::runtime_error if there is none.
+        template <typename T>
+        const char* parse_number(const char* p, const char* end, T& value)
+        {
+            p = skip_blanks(p, end);
+            if (p != end && *p == '+')
+                ++p;
+            const auto [ptr, ec] = std::from_chars(p, end, value);
+            if (ec != std::errc())
+                throw std::runtime_error("Malformed Matrix Market file");
+            return ptr;
+        }
+
+        enum class MarketField {
+            Real,
+            Integer,
+            Pattern
+        };
+
+        enum class MarketSymmetry {
+            General,
+            Symmetric,
+            SkewSymmetric
+        };
+
+        /// @brief Parses the entries in [p, end) into builder, returning how many lines were read.
+        template <typename S, size_t R, size_t C>
+        size_t parse_market_entries(const char* p, const char* end, MarketField field, MarketSymmetry symmetry, TripletBuilder<S, R, C>& builder)
+        {
+            size_t count = 0;
+            while (p != end) {
+                p = skip_blanks(p, end);
+                if (p == end || *p == '\n' || *p == '%') {
+                    p = next_line(p, end);
+                    continue;
+                }
+
+                size_t row = 0;
+                size_t col = 0;
+                S value = S(1);
+                p = parse_number(p, end, row);
+                p = parse_number(p, end, col);
+                if (field != MarketField::Pattern)
+                    p = parse_number(p, end, value);
+                p = skip_blanks(p, end);
+                if (p != end && *p != '\n')
+                    throw std::runtime_error("Malformed Matrix Market file");
+                if (row == 0 || col == 0)
+                    throw std::out_of_range("Specified indices are out of range.");
+
+                builder.add(row - 1, col - 1, value);
+                if (symmetry != MarketSymmetry::General && row != col)
+                    builder.add(col - 1, row - 1, symmetry == MarketSymmetry::SkewSymmetric ? S(-value) : value);
+                ++count;
+                p = next_line(p, end);
+            }
+            return count;
+        }
+
+        inline constexpr std::uint64_t binary_magic = 0x5253434f414cull; // "LAOCSR" in little endian
+        inline constexpr std::uint64_t binary_version = 1;
+        inline constexpr size_t binary_header_words = 8;
+
+        /// @brief Returns 0 for unsigned integers, 1 for signed integers and 2 for floating point.
+        template <typename S>
+        constexpr std::uint64_t binary_scalar_kind() noexcept
+        {
+            if constexpr (std::is_floating_point_v<S>)
+                return 2;
+            else if constexpr (std::is_signed_v<S>)
+                return 1;
+            else
+                return 0;
+        }
+
+    }; // namespace detail
+
+    /// @brief Reads a Matrix Market coordinate file.
+    /// @details Real, integer and pattern fields are supported, with general, symmetric and
+    /// skew-symmetric storage. Pattern entries are read as 1, and the mirrored half of symmetric
+    /// files is filled in. Entries at the same position are summed. Files with more than
+    /// LAO_SPARSE_PARALLEL_THRESHOLD entries are parsed in parallel.
+    /// Throws std::runtime_error if the file cannot be read or is malformed, std::invalid_argument
+    /// if its size or field does not match the matrix type, and std::out_of_range for an entry
+    /// outside of the matrix.
+    template <typename S, size_t R, size_t C>
+    SparseMatrix<S, R, C> read_matrix_market(const std::string& filename)
+    {
+        const std::string contents = detail::read_file(filename);
+        const char* p = contents.data();
+        const char* const end = p + contents.size();
+
+        // banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+        const char* const banner_end = detail::next_line(p, end);
+        std::string banner(p, banner_end);
+        std::transform(banner.begin(), banner.end(), banner.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        std::vector<std::string> tokens;
+        for (size_t pos = 0; (pos = banner.find_first_not_of(" \t\r\n", pos)) != std::string::npos;) {
+            const size_t last = banner.find_first_of(" \t\r\n", pos);
+            tokens.push_back(banner.substr(pos, last - pos));
+            pos = last;
+        }
+        if (tokens.size() != 5 || tokens[0] != "%%matrixmarket" || tokens[1] != "matrix")
+            throw std::runtime_error("Malformed Matrix Market file");
+        if (tokens[2] != "coordinate")
+            throw std::invalid_argument("Only coordinate Matrix Market files are supported.");
+
+        detail::MarketField field;
+        if (tokens[3] == "real" || tokens[3] == "double") {
+            if constexpr (!std::is_floating_point_v<S>)
+                throw std::invalid_argument("Cannot read a real Matrix Market file into an integral matrix.");
+            field = detail::MarketField::Real;
+        } else if (tokens[3] == "integer") {
+            field = detail::MarketField::Integer;
+        } else if (tokens[3] == "pattern") {
+            field = detail::MarketField::Pattern;
+        } else {
+            throw std::invalid_argument("Unsupported Matrix Market field.");
+        }
+
+        detail::MarketSymmetry symmetry;
+        if (tokens[4] == "general")
+            symmetry = detail::MarketSymmetry::General;
+        else if (tokens[4] == "symmetric")
+            symmetry = detail::MarketSymmetry::Symmetric;
+        else if (tokens[4] == "skew-symmetric")
+            symmetry = detail::MarketSymmetry::SkewSymmetric;
+        else
+            throw std::invalid_argument("Unsupported Matrix Market symmetry.");
+
+        // comments, then the size line: <rows> <cols> <entries>
+        p = banner_end;
+        while (p != end) {
+            const char* q = detail::skip_blanks(p, end);
+            if (q != end && *q != '%' && *q != '\n')
+                break;
+            p = detail::next_line(q, end);
+        }
+        size_t rows = 0;
+        size_t cols = 0;
+        size_t entries = 0;
+        p = detail::parse_number(p, end, rows);
+        p = detail::parse_number(p, end, cols);
+        p = detail::parse_number(p, end, entries);
+        if (rows != R || cols != C || (symmetry != detail::MarketSymmetry::General && R != C))
+            throw std::invalid_argument("Matrix dimensions do not match.");
+        p = detail::next_line(p, end);
+
+        // split the entries into newline aligned chunks, one per thread.
+        const size_t parts = entries >= LAO_SPARSE_PARALLEL_THRESHOLD ? thread_count() : 1;
+        std::vector<const char*> bounds(parts + 1, end);
+        bounds[0] = p;
+        for (size_t t = 1; t < parts; ++t) {
+            const char* guess = p + static_cast<size_t>(end - p) / parts * t;
+            bounds[t] = std::max(bounds[t - 1], guess == p ? p : detail::next_line(guess - 1, end));
+        }
+
+        const size_t reserve = (symmetry == detail::MarketSymmetry::General ? entries : 2 * entries) / parts + 1;
+        std::vector<TripletBuilder<S, R, C>> builders(parts);
+        std::vector<size_t> counts(parts, 0);
+        std::vector<std::exception_ptr> errors(parts);
+        parallel_for(0, parts, 1, [&](size_t first, size_t last) {
+            for (size_t t = first; t < last; ++t) {
+                try {
+                    builders[t].reserve(reserve);
+                    counts[t] = detail::parse_market_entries(bounds[t], bounds[t + 1], field, symmetry, builders[t]);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            }
+        });
+        for (const auto& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+
+        size_t count = counts[0];
+        for (size_t t = 1; t < parts; ++t) {
+            builders[0].append(builders[t]);
+            builders[t] = TripletBuilder<S, R, C>();
+            count += counts[t];
+        }
+        if (count != entries)
+            throw std::runtime_error("Malformed Matrix Market file");
+        return SparseMatrix<S, R, C>(builders[0]);
+    }
+
+    /// @brief Writes a sparse matrix in the native binary CSR format.
+    template <typename S, size_t R, size_t C>
+    void write_binary(const SparseMatrix<S, R, C>& mat, const std::string& filename)
+    {
+        static_assert(sizeof(size_t) == sizeof(std::uint64_t), "The binary CSR format requires a 64 bit size_t.");
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open file");
+
+        const std::uint64_t header[detail::binary_header_words] = {
+            detail::binary_magic, detail::binary_version, sizeof(S), detail::binary_scalar_kind<S>(), R, C, mat.nnz(), 0
+        };
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(mat.row_offsets()), static_cast<std::streamsize>((R + 1) * sizeof(size_t)));
+        file.write(reinterpret_cast<const char*>(mat.col_indices()), static_cast<std::streamsize>(mat.nnz() * sizeof(size_t)));
+        file.write(reinterpret_cast<const char*>(mat.values()), static_cast<std::streamsize>(mat.nnz() * sizeof(S)));
+        if (!file)
+            throw std::runtime_error("Failed to write file");
+    }
+
+    /// @brief How much of a binary CSR file is validated when it is opened as a MappedCSR.
+    enum class csrcheck {
+        // only the header and the array sizes, in O(1). The file is trusted input, e.g. written by
+        // write_binary, since corrupt row offsets or column indices make the kernels read out of bounds.
+        trusted,
+        // also that the row offsets are sorted and that the columns of each row are sorted, unique
+        // and in range, in O(rows + nnz), for files from outside the program.
+        structure,
+    };
+
+    /// @brief Read only view of a native binary CSR file mapped into memory.
+    /// @details The arrays point directly into the mapping, so large matrices can be used with the
+    /// kernels in spmv.hpp without being copied or even fully read. Where mmap is not available the
+    /// file is read into a buffer instead. The file is unmapped when the view is destroyed.
+    /// By default the file is trusted, see `csrcheck`, and only its header is validated.
+    /// Throws std::runtime_error if the file cannot be opened, is truncated, is not a binary CSR
+    /// file or fails the requested check, and std::invalid_argument if it was written with a
+    /// different scalar type.
+    template <typename S>
+    class MappedCSR {
+    public:
+        using value_type = S;
+
+        static_assert(sizeof(size_t) == sizeof(std::uint64_t), "The binary CSR format requires a 64 bit size_t.");
+        static_assert(alignof(S) <= sizeof(std::uint64_t), "The binary CSR format requires scalars aligned to at most 8 bytes.");
+
+        explicit MappedCSR(const std::string& filename, csrcheck check = csrcheck::trusted)
+        {
+#if LAO_HAS_MMAP
+            const int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error("Failed to open file");
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Failed to read file");
+            }
+            m_size = static_cast<size_t>(st.st_size);
+            if (m_size > 0) {
+                void* map = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ::close(fd);
+                if (map == MAP_FAILED)
+                    throw std::runtime_error("Failed to read file");
+                m_data = static_cast<const std::byte*>(map);
+            } else {
+                ::close(fd);
+            }
+#else
+            const std::string contents = detail::read_file(filename);
+            m_size = contents.size();
+            m_buffer.resize((m_size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+            std::memcpy(m_buffer.data(), contents.data(), m_size);
+            m_data = reinterpret_cast<const std::byte*>(m_buffer.data());
+#endif
+            try {
+                validate();
+                if (check == csrcheck::structure)
+                    validate_structure();
+            } catch (...) {
+                release();
+                throw;
+            }
+        }
+
+        MappedCSR(const MappedCSR&) = delete;
+        MappedCSR& operator=(const MappedCSR&) = delete;
+
+        MappedCSR(MappedCSR&& other) noexcept
+            : m_data(std::exchange(other.m_data, nullptr))
+            , m_size(std::exchange(other.m_size, 0))
+#if !LAO_HAS_MMAP
+            , m_buffer(std::move(other.m_buffer))
+#endif
+        {
+        }
+
+        MappedCSR& operator=(MappedCSR&& other) noexcept
+        {
+            if (&other != this) {
+                release();
+                m_data = std::exchange(other.m_data, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+#if !LAO_HAS_MMAP
+                m_buffer = std::move(other.m_buffer);
+#endif
+            }
+            return *this;
+        }
+
+        ~MappedCSR()
+        {
+            release();
+        }
+
+        /// @brief Returns the number of rows.
+        size_t rows() const noexcept
+        {
+            return header()[4];
+        }
+
+        /// @brief Returns the number of columns.
+        size_t cols() const noexcept
+        {
+            return header()[5];
+        }
+
+        /// @brief Returns the number of stored non-zero values.
+        size_t nnz() const noexcept
+        {
+            return header()[6];
+        }
+
+        /// @brief Returns the CSR row offsets into the values, size rows + 1.
+        const size_t* row_offsets() const noexcept
+        {
+            return reinterpret_cast<const size_t*>(header() + detail::binary_header_words);
+        }
+
+        /// @brief Returns the CSR column of each value, 0 indexed, size nnz.
+        const size_t* col_indices() const noexcept
+        {
+            return row_offsets() + rows() + 1;
+        }
+
+        /// @brief Returns the CSR non-zero values, size nnz.
+        const value_type* values() const noexcept
+        {
+            return reinterpret_cast<const value_type*>(col_indices() + nnz());
+        }
+
+        /// @brief Checks the CSR structure of the file, see `csrcheck::structure`, in O(rows + nnz).
+        /// @details Throws std::runtime_error if the file is corrupt.
+        void validate_structure() const
+        {
+            const size_t* rowvec = row_offsets();
+            const size_t* colvec = col_indices();
+            for (size_t i = 0; i < rows(); ++i)
+                if (rowvec[i] > rowvec[i + 1])
+                    throw std::runtime_error("Binary CSR file is corrupt");
+            // the offsets are now known to lie within the column indices.
+            for (size_t i = 0; i < rows(); ++i)
+                for (size_t p = rowvec[i]; p < rowvec[i + 1]; ++p)
+                    if (colvec[p] >= cols() || (p > rowvec[i] && colvec[p] <= colvec[p - 1]))
+                        throw std::runtime_error("Binary CSR file is corrupt");
+        }
+
+    private:
+        const std::uint64_t* header() const noexcept
+        {
+            return reinterpret_cast<const std::uint64_t*>(m_data);
+        }
+
+        void validate() const
+        {
+            constexpr size_t header_bytes = detail::binary_header_words * sizeof(std::uint64_t);
+            if (m_size < header_bytes || header()[0] != detail::binary_magic || header()[1] != detail::binary_version)
+                throw std::runtime_error("Not a binary CSR file");
+            if (header()[2] != sizeof(S) || header()[3] != detail::binary_scalar_kind<S>())
+                throw std::invalid_argument("Binary CSR file has a different scalar type.");
+            const size_t words = (m_size - header_bytes) / sizeof(std::uint64_t);
+            if (rows() >= words || nnz() > words || header_bytes + (rows() + 1 + nnz()) * sizeof(size_t) + nnz() * sizeof(S) > m_size)
+                throw std::runtime_error("Binary CSR file is truncated");
+            if (row_offsets()[0] != 0 || row_offsets()[rows()] != nnz())
+                throw std::runtime_error("Binary CSR file is corrupt");
+        }
+
+        void release() noexcept
+        {
+#if LAO_HAS_MMAP
+            if (m_data)
+                ::munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+        const std::byte* m_data = nullptr;
+        size_t m_size = 0;
+#if !LAO_HAS_MMAP
+        std::vector<std::uint64_t> m_buffer;
+#endif
+    };
+
+    /// @brief Reads a sparse matrix from the native binary CSR format.
+    /// @details The file is mapped, its CSR structure validated, and each CSR array is copied into
+    /// the matrix with one memcpy. Throws std::runtime_error if the file is truncated or corrupt, and
+    /// std::invalid_argument if it holds a matrix of a different size or scalar type.
+    template <typename S, size_t R, size_t C>
+    SparseMatrix<S, R, C> read_binary(const std::string& filename)
+    {
+        const MappedCSR<S> mapped(filename, csrcheck::structure);
+        if (mapped.rows() != R || mapped.cols() != C)
+            throw std::invalid_argument("Matrix dimensions do not match.");
+        return SparseMatrix<S, R, C>(
+            std::vector<S>(mapped.values(), mapped.values() + mapped.nnz()),
+            std::vector<size_t>(mapped.row_offsets(), mapped.row_offsets() + R + 1),
+            std::vector<size_t>(mapped.col_indices(), mapped.col_indices() + mapped.nnz()));
+    }
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_SPARSE_IO_H_
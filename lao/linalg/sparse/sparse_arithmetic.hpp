@@ -0,0 +1,474 @@
+/// sparse_arithmetic.hpp implements the element-wise expressions of sparse matrices: sums and
+/// differences, products with a scalar, element-wise products with a sparse or dense matrix, and
+/// transposes. They are evaluated from the CSR arrays of their operands, visiting only the stored
+/// non-zeros, so that e.g. an update of a 1e6 x 1e6 matrix costs O(nnz + R) rather than O(R * C).
+///
+/// The pattern of a sum or difference is the union of the patterns of its operands, that of an
+/// element-wise product their intersection, or the pattern of the sparse operand for a product
+/// with a dense matrix. Entries which cancel, e.g. in A - A, stay stored as zeros, so the pattern of
+/// a result only depends on the patterns of its operands. When a result is assigned into a
+/// SparseMatrix which already has its pattern, as with an update repeated every iteration, only
+/// the values are written, in place and split across threads above
+/// LAO_SPARSE_PARALLEL_THRESHOLD non-zeros. Otherwise the CSR arrays are built in one pass.
+/// A sparse operand which is itself an expression is first evaluated into a SparseMatrix.
+///
+///     SparseMatrix<double, N, N> A = J + 2.0 * K;
+///     for (...)
+///         A = A + h * K; // the pattern of A is reused, only the values are written
+///     Matrix<double, N, N> dense = A; // zeroed, then the non-zeros scattered into it
+
+#ifndef LAO_LINALG_SPARSE_ARITHMETIC_H_
+#define LAO_LINALG_SPARSE_ARITHMETIC_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <lao/linalg/core/expression.hpp>
+#include <lao/linalg/dense/matrix.hpp>
+#include <lao/linalg/math/constraints.hpp>
+#include <lao/linalg/sparse/sparse_matrix.hpp>
+#include <lao/linalg/sparse/spmv.hpp>
+#include <utility>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief Concept for a SparseMatrix or a sparse expression of sparse_arithmetic.hpp.
+    template <typename E>
+    concept SparseExpression = E::sparse_expression;
+
+    namespace detail {
+
+        /// @brief Calls f(col, a_ij, b_ij) for each column j of row i in the union of the patterns of
+        /// a and b, or in their intersection, in increasing order. Missing values are read as zero.
+        template <bool Intersect, typename S, size_t R, size_t C, typename F>
+        void merge_row(const SparseMatrix<S, R, C>& a, const SparseMatrix<S, R, C>& b, size_t i, F&& f)
+        {
+            const size_t* acol = a.col_indices();
+            const size_t* bcol = b.col_indices();
+            const S* aval = a.values();
+            const S* bval = b.values();
+            size_t p = a.row_offsets()[i];
+            size_t q = b.row_offsets()[i];
+            const size_t pend = a.row_offsets()[i + 1];
+            const size_t qend = b.row_offsets()[i + 1];
+            while (p < pend && q < qend) {
+                if (acol[p] < bcol[q]) {
+                    if constexpr (!Intersect)
+                        f(acol[p], aval[p], S(0));
+                    ++p;
+                } else if (bcol[q] < acol[p]) {
+                    if constexpr (!Intersect)
+                        f(bcol[q], S(0), bval[q]);
+                    ++q;
+                } else {
+                    f(acol[p], aval[p], bval[q]);
+                    ++p;
+                    ++q;
+                }
+            }
+            if constexpr (!Intersect) {
+                for (; p < pend; ++p)
+                    f(acol[p], aval[p], S(0));
+                for (; q < qend; ++q)
+                    f(bcol[q], S(0), bval[q]);
+            }
+        }
+
+        /// @brief Evaluates op(a_ij, b_ij) over the union or intersection of the patterns of a and b
+        /// into dst, see sparse_arithmetic.hpp. dst may be a or b.
+        template <bool Intersect, typename S, size_t R, size_t C, typename Op>
+        void merge_into(const SparseMatrix<S, R, C>& a, const SparseMatrix<S, R, C>& b, SparseMatrix<S, R, C>& dst, Op op)
+        {
+            // the symbolic pass, checking the merged pattern against the one of dst without writing.
+            const size_t* drow = dst.row_offsets();
+            const size_t* dcol = dst.col_indices();
+            bool reuse = Intersect ? dst.nnz() <= std::min(a.nnz(), b.nnz()) : dst.nnz() >= std::max(a.nnz(), b.nnz());
+            for (size_t i = 0; i < R && reuse; ++i) {
+                size_t k = drow[i];
+                merge_row<Intersect>(a, b, i, [&](size_t col, S, S) {
+                    reuse = reuse && k < drow[i + 1] && dcol[k] == col;
+                    ++k;
+                });
+                reuse = reuse && k == drow[i + 1];
+            }
+
+            if (reuse) {
+                // each value only depends on the operand values at its own position, which come
+                // before it in the merge, so writing in place is safe when dst is an operand.
+                S* out = dst.values();
+                parallel_rows_by_nnz(R, drow, [&](size_t first, size_t last) {
+                    for (size_t i = first; i < last; ++i) {
+                        S* row = out + drow[i];
+                        merge_row<Intersect>(a, b, i, [&](size_t, S x, S y) { *row++ = op(x, y); });
+                    }
+                });
+                return;
+            }
+
+            std::vector<S> values;
+            std::vector<size_t> rowvec(R + 1, 0);
+            std::vector<size_t> colvec;
+            values.reserve(Intersect ? std::min(a.nnz(), b.nnz()) : a.nnz() + b.nnz());
+            colvec.reserve(values.capacity());
+            for (size_t i = 0; i < R; ++i) {
+                merge_row<Intersect>(a, b, i, [&](size_t col, S x, S y) {
+                    colvec.push_back(col);
+                    values.push_back(op(x, y));
+                });
+                rowvec[i + 1] = values.size();
+            }
+            dst = SparseMatrix<S, R, C>(std::move(values), std::move(rowvec), std::move(colvec));
+        }
+
+        /// @brief Evaluates f(i, p) for each non-zero p, in row i, of a into dst, with the pattern of
+        /// a. The values are written in place if dst already has the pattern, e.g. if it is a.
+        template <typename S, size_t R, size_t C, typename F>
+        void map_into(const SparseMatrix<S, R, C>& a, SparseMatrix<S, R, C>& dst, F f)
+        {
+            const size_t* arow = a.row_offsets();
+            const bool reuse = dst.same_pattern(a);
+            std::vector<S> values(reuse ? 0 : a.nnz());
+            S* out = reuse ? dst.values() : values.data();
+            parallel_rows_by_nnz(R, arow, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i)
+                    for (size_t p = arow[i]; p < arow[i + 1]; ++p)
+                        out[p] = f(i, p);
+            });
+            if (!reuse)
+                dst = SparseMatrix<S, R, C>(std::move(values), std::vector<size_t>(arow, arow + R + 1),
+                    std::vector<size_t>(a.col_indices(), a.col_indices() + a.nnz()));
+        }
+
+    }; // namespace detail
+
+    /// @brief Sparse matrix addition, over the union of the patterns.
+    template <typename S, size_t R, size_t C, typename E1, typename E2>
+    class SparseAddition : public MatrixExpression<SparseAddition<S, R, C, E1, E2>, S, R, C> {
+    public:
+        using left_expr = E1;
+        using right_expr = E2;
+
+        static constexpr bool sparse_expression = true;
+        static constexpr bool materialize_when_nested = true;
+
+        SparseAddition(const left_expr& lhs, const right_expr& rhs)
+            : m_lhs(lhs)
+            , m_rhs(rhs)
+        {
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) + m_rhs.coeff(row, col);
+        }
+
+        /// @brief Evaluates the sum into a sparse matrix in O(nnz + R), see sparse_arithmetic.hpp.
+        void eval_sparse(SparseMatrix<S, R, C>& dst) const
+        {
+            detail::merge_into<false>(m_lhs, m_rhs, dst, [](S x, S y) { return x + y; });
+        }
+
+        /// @brief Evaluates the sum into a dense matrix, see SparseMatrix::eval_to.
+        template <typename Dst>
+        requires StridedExpression<Dst>
+        void eval_to(Dst& dst) const
+        {
+            SparseMatrix<S, R, C>(*this).eval_to(dst);
+        }
+
+    private:
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
+    };
+
+    /// @brief operator+ overload for sparse matrix addition.
+    template <SparseExpression E1, SparseExpression E2>
+    requires EnforceSameShape<typename E1::value_type, typename E2::value_type, E1::row_extent, E2::row_extent, E1::col_extent, E2::col_extent>
+    auto operator+(const E1& lhs, const E2& rhs)
+    {
+        return SparseAddition<typename E1::value_type, E1::row_extent, E1::col_extent, E1, E2>(lhs, rhs);
+    }
+
+    /// @brief Sparse matrix subtraction, over the union of the patterns.
+    template <typename S, size_t R, size_t C, typename E1, typename E2>
+    class SparseSubtraction : public MatrixExpression<SparseSubtraction<S, R, C, E1, E2>, S, R, C> {
+    public:
+        using left_expr = E1;
+        using right_expr = E2;
+
+        static constexpr bool sparse_expression = true;
+        static constexpr bool materialize_when_nested = true;
+
+        SparseSubtraction(const left_expr& lhs, const right_expr& rhs)
+            : m_lhs(lhs)
+            , m_rhs(rhs)
+        {
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) - m_rhs.coeff(row, col);
+        }
+
+        /// @brief Evaluates the difference into a sparse matrix in O(nnz + R), see sparse_arithmetic.hpp.
+        void eval_sparse(SparseMatrix<S, R, C>& dst) const
+        {
+            detail::merge_into<false>(m_lhs, m_rhs, dst, [](S x, S y) { return x - y; });
+        }
+
+        /// @brief Evaluates the difference into a dense matrix, see SparseMatrix::eval_to.
+        template <typename Dst>
+        requires StridedExpression<Dst>
+        void eval_to(Dst& dst) const
+        {
+            SparseMatrix<S, R, C>(*this).eval_to(dst);
+        }
+
+    private:
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
+    };
+
+    /// @brief operator- overload for sparse matrix subtraction.
+    template <SparseExpression E1, SparseExpression E2>
+    requires EnforceSameShape<typename E1::value_type, typename E2::value_type, E1::row_extent, E2::row_extent, E1::col_extent, E2::col_extent>
+    auto operator-(const E1& lhs, const E2& rhs)
+    {
+        return SparseSubtraction<typename E1::value_type, E1::row_extent, E1::col_extent, E1, E2>(lhs, rhs);
+    }
+
+    /// @brief Scalar-sparse matrix multiplication, over the pattern of the matrix.
+    template <typename S, size_t R, size_t C, typename E>
+    class SparseScalarMultiplication : public MatrixExpression<SparseScalarMultiplication<S, R, C, E>, S, R, C> {
+    public:
+        using left_expr = S;
+        using right_expr = E;
+
+        static constexpr bool sparse_expression = true;
+        static constexpr bool materialize_when_nested = true;
+
+        SparseScalarMultiplication(const S& lhs, const right_expr& rhs)
+            : m_lhs(lhs)
+            , m_rhs(rhs)
+        {
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs * m_rhs.coeff(row, col);
+        }
+
+        /// @brief Evaluates the product into a sparse matrix in O(nnz + R), see sparse_arithmetic.hpp.
+        void eval_sparse(SparseMatrix<S, R, C>& dst) const
+        {
+            const S* values = m_rhs.values();
+            detail::map_into(m_rhs, dst, [&](size_t, size_t p) { return m_lhs * values[p]; });
+        }
+
+        /// @brief Evaluates the product into a dense matrix, see SparseMatrix::eval_to.
+        template <typename Dst>
+        requires StridedExpression<Dst>
+        void eval_to(Dst& dst) const
+        {
+            SparseMatrix<S, R, C>(*this).eval_to(dst);
+        }
+
+    private:
+        left_expr m_lhs;
+        nested_t<right_expr> m_rhs;
+    };
+
+    /// @brief operator* overload for scalar-sparse matrix multiplication.
+    template <SparseExpression E, typename S>
+    requires EnforceSameType<typename E::value_type, S>
+    auto operator*(const E& lhs, const S& rhs)
+    {
+        return SparseScalarMultiplication<S, E::row_extent, E::col_extent, E>(rhs, lhs);
+    }
+
+    template <typename S, SparseExpression E>
+    requires EnforceSameType<S, typename E::value_type>
+    auto operator*(const S& lhs, const E& rhs)
+    {
+        return SparseScalarMultiplication<S, E::row_extent, E::col_extent, E>(lhs, rhs);
+    }
+
+    /// @brief Sparse matrix element-wise multiplication, over the intersection of the patterns.
+    template <typename S, size_t R, size_t C, typename E1, typename E2>
+    class SparseElementWiseMultiplication : public MatrixExpression<SparseElementWiseMultiplication<S, R, C, E1, E2>, S, R, C> {
+    public:
+        using left_expr = E1;
+        using right_expr = E2;
+
+        static constexpr bool sparse_expression = true;
+        static constexpr bool materialize_when_nested = true;
+
+        SparseElementWiseMultiplication(const left_expr& lhs, const right_expr& rhs)
+            : m_lhs(lhs)
+            , m_rhs(rhs)
+        {
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) * m_rhs.coeff(row, col);
+        }
+
+        /// @brief Evaluates the product into a sparse matrix in O(nnz + R), see sparse_arithmetic.hpp.
+        void eval_sparse(SparseMatrix<S, R, C>& dst) const
+        {
+            detail::merge_into<true>(m_lhs, m_rhs, dst, [](S x, S y) { return x * y; });
+        }
+
+        /// @brief Evaluates the product into a dense matrix, see SparseMatrix::eval_to.
+        template <typename Dst>
+        requires StridedExpression<Dst>
+        void eval_to(Dst& dst) const
+        {
+            SparseMatrix<S, R, C>(*this).eval_to(dst);
+        }
+
+    private:
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
+    };
+
+    /// @brief operator% overload for sparse matrix element-wise multiplication.
+    template <SparseExpression E1, SparseExpression E2>
+    requires EnforceSameShape<typename E1::value_type, typename E2::value_type, E1::row_extent, E2::row_extent, E1::col_extent, E2::col_extent>
+    auto operator%(const E1& lhs, const E2& rhs)
+    {
+        return SparseElementWiseMultiplication<typename E1::value_type, E1::row_extent, E1::col_extent, E1, E2>(lhs, rhs);
+    }
+
+    /// @brief Element-wise multiplication of a sparse and a dense matrix, over the pattern of the
+    /// sparse one.
+    /// @details Each non-zero reads a single element of the dense operand, so a dense expression is
+    /// only evaluated at the non-zeros.
+    template <typename S, size_t R, size_t C, typename E1, typename E2>
+    class SparseDenseElementWiseMultiplication : public MatrixExpression<SparseDenseElementWiseMultiplication<S, R, C, E1, E2>, S, R, C> {
+    public:
+        using left_expr = E1;
+        using right_expr = E2;
+
+        static constexpr bool sparse_expression = true;
+        static constexpr bool materialize_when_nested = true;
+
+        SparseDenseElementWiseMultiplication(const left_expr& lhs, const right_expr& rhs)
+            : m_lhs(lhs)
+            , m_rhs(rhs)
+        {
+            detail::check_same_shape(lhs, rhs);
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_lhs.coeff(row, col) * m_rhs.coeff(row, col);
+        }
+
+        /// @brief Evaluates the product into a sparse matrix in O(nnz + R), see sparse_arithmetic.hpp.
+        void eval_sparse(SparseMatrix<S, R, C>& dst) const
+        {
+            const S* values = m_lhs.values();
+            const size_t* cols = m_lhs.col_indices();
+            detail::map_into(m_lhs, dst, [&](size_t i, size_t p) { return values[p] * m_rhs.coeff(i + 1, cols[p] + 1); });
+        }
+
+        /// @brief Evaluates the product into a dense matrix, see SparseMatrix::eval_to.
+        template <typename Dst>
+        requires StridedExpression<Dst>
+        void eval_to(Dst& dst) const
+        {
+            SparseMatrix<S, R, C>(*this).eval_to(dst);
+        }
+
+    private:
+        nested_t<left_expr> m_lhs;
+        nested_t<right_expr> m_rhs;
+    };
+
+    /// @brief operator% overloads for element-wise multiplication of a sparse and a dense matrix.
+    template <SparseExpression E1, typename S2, size_t R2, size_t C2, typename E2>
+    requires(!SparseExpression<E2> && EnforceSameShape<typename E1::value_type, S2, E1::row_extent, R2, E1::col_extent, C2>)
+    auto operator%(const E1& lhs, const MatrixExpression<E2, S2, R2, C2>& rhs)
+    {
+        return SparseDenseElementWiseMultiplication<S2, E1::row_extent, E1::col_extent, E1, E2>(lhs, static_cast<const E2&>(rhs));
+    }
+
+    template <typename S1, size_t R1, size_t C1, typename E1, SparseExpression E2>
+    requires(!SparseExpression<E1> && EnforceSameShape<S1, typename E2::value_type, R1, E2::row_extent, C1, E2::col_extent>)
+    auto operator%(const MatrixExpression<E1, S1, R1, C1>& lhs, const E2& rhs)
+    {
+        return SparseDenseElementWiseMultiplication<S1, E2::row_extent, E2::col_extent, E2, E1>(rhs, static_cast<const E1&>(lhs));
+    }
+
+    /// @brief Transposition of a sparse matrix.
+    /// @details Evaluated by a counting sort of the non-zeros by column, in O(nnz + R + C), which
+    /// visits the rows in order and so leaves the columns of each row of the result sorted.
+    template <typename S, size_t R, size_t C, typename E>
+    class SparseTranspose : public MatrixExpression<SparseTranspose<S, R, C, E>, S, C, R> {
+    public:
+        static constexpr bool sparse_expression = true;
+        static constexpr bool materialize_when_nested = true;
+
+        SparseTranspose(const E& matrix)
+            : m_matrix(matrix)
+        {
+        }
+
+        S coeff(size_t row, size_t col) const
+        {
+            return m_matrix.coeff(col, row);
+        }
+
+        /// @brief Evaluates the transpose into a sparse matrix, which may be the operand.
+        void eval_sparse(SparseMatrix<S, C, R>& dst) const
+        {
+            const size_t nnz = m_matrix.nnz();
+            const size_t* arow = m_matrix.row_offsets();
+            const size_t* acol = m_matrix.col_indices();
+            const S* aval = m_matrix.values();
+
+            std::vector<size_t> rowvec(C + 1, 0);
+            for (size_t p = 0; p < nnz; ++p)
+                ++rowvec[acol[p] + 1];
+            for (size_t j = 0; j < C; ++j)
+                rowvec[j + 1] += rowvec[j];
+
+            std::vector<size_t> next(rowvec.begin(), rowvec.end() - 1);
+            std::vector<size_t> colvec(nnz);
+            std::vector<S> values(nnz);
+            for (size_t i = 0; i < R; ++i) {
+                for (size_t p = arow[i]; p < arow[i + 1]; ++p) {
+                    const size_t pos = next[acol[p]]++;
+                    colvec[pos] = i;
+                    values[pos] = aval[p];
+                }
+            }
+            dst = SparseMatrix<S, C, R>(std::move(values), std::move(rowvec), std::move(colvec));
+        }
+
+        /// @brief Evaluates the transpose into a dense matrix, see SparseMatrix::eval_to.
+        template <typename Dst>
+        requires StridedExpression<Dst>
+        void eval_to(Dst& dst) const
+        {
+            SparseMatrix<S, C, R>(*this).eval_to(dst);
+        }
+
+    private:
+        nested_t<E> m_matrix;
+    };
+
+    /// @brief Returns the transposition of a sparse matrix.
+    template <SparseExpression E>
+    auto transpose(const E& matrix)
+    {
+        return SparseTranspose<typename E::value_type, E::row_extent, E::col_extent, E>(matrix);
+    }
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_SPARSE_ARITHMETIC_H_
@@ -1,14 +1,18 @@
 #ifndef LAO_LINALG_SPARSE_MATRIX_H_
 #define LAO_LINALG_SPARSE_MATRIX_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <fstream>
 #include <functional>
 #include <lao/linalg/core/expression.hpp>
 #include <lao/linalg/core/forward.hpp>
+#include <lao/linalg/sparse/triplet.hpp>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace lao {
@@ -18,7 +22,8 @@ namespace linalg {
     /// @details A matrix is represented by a number of rows and columns,
     /// noted as `row x column`.
     /// It is templated with a Scalar parameter, and a Row and Column.
-    /// The storage mechanism is using std::vectors with compressed sparse row format.
+    /// The storage mechanism is using std::vectors with compressed sparse row format, with the
+    /// columns of each row sorted. Large matrices are best assembled with a TripletBuilder.
     template <typename S, size_t R, size_t C>
     class SparseMatrix : public MatrixExpression<SparseMatrix<S, R, C>, S, R, C> {
     public:
@@ -27,6 +32,9 @@ namespace linalg {
         using storage_type_row = std::vector<size_t>;
         using storage_type_col = std::vector<size_t>;
 
+        static constexpr bool nest_by_reference = true;
+        static constexpr bool sparse_expression = true;
+
         SparseMatrix()
         {
             m_csr.m_rowvec.resize(R + 1, value_type(0));
@@ -39,6 +47,7 @@ namespace linalg {
             if (!file.is_open())
                 throw std::runtime_error("Failed to open file");
 
+            TripletBuilder<S, R, C> builder;
             std::string line;
             size_t row = 0;
             while (std::getline(file, line)) {
@@ -48,11 +57,44 @@ namespace linalg {
                 while (std::getline(iss, cell, ',')) {
                     value_type val = std::stod(cell);
                     if (val != 0)
-                        m_csr.insert(row, col, val);
+                        builder.add(row, col, val);
                     ++col;
                 }
                 ++row;
             }
+            builder.compress(m_csr.m_values, m_csr.m_rowvec, m_csr.m_colvec);
+        }
+
+        /// @brief Constructor taking ownership of CSR arrays.
+        /// @details The columns of each row must be sorted and unique, see `CSRStorage`. The array
+        /// sizes, the order of the row offsets and of the columns within each row, and the column
+        /// bounds are checked, in O(nnz + R).
+        SparseMatrix(storage_type_v values, storage_type_row rowvec, storage_type_col colvec)
+        {
+            if (rowvec.size() != R + 1 || rowvec.front() != 0 || rowvec.back() != values.size() || colvec.size() != values.size())
+                throw std::invalid_argument("CSR arrays do not match matrix size.");
+            for (size_t i = 0; i < R; ++i)
+                if (rowvec[i] > rowvec[i + 1])
+                    throw std::invalid_argument("CSR row offsets are not sorted.");
+            // the offsets are now known to lie within colvec.
+            for (size_t i = 0; i < R; ++i) {
+                for (size_t p = rowvec[i]; p < rowvec[i + 1]; ++p) {
+                    if (colvec[p] >= C)
+                        throw std::out_of_range("Specified indices are out of range.");
+                    if (p > rowvec[i] && colvec[p] <= colvec[p - 1])
+                        throw std::invalid_argument("CSR columns are not sorted within each row.");
+                }
+            }
+            m_csr.m_values = std::move(values);
+            m_csr.m_rowvec = std::move(rowvec);
+            m_csr.m_colvec = std::move(colvec);
+        }
+
+        /// @brief Constructor compressing the entries collected by a builder.
+        /// @details Costs O(nnz + R) plus sorting the columns within each row.
+        SparseMatrix(const TripletBuilder<S, R, C>& builder)
+        {
+            builder.compress(m_csr.m_values, m_csr.m_rowvec, m_csr.m_colvec);
         }
 
         /// @brief Copy constructor.
@@ -61,6 +103,13 @@ namespace linalg {
         {
         }
 
+        /// @brief Move constructor, leaving other empty.
+        SparseMatrix(SparseMatrix&& other)
+            : m_csr(std::move(other.m_csr))
+        {
+            other.zeros();
+        }
+
         SparseMatrix& operator=(const SparseMatrix& other)
         {
             if (&other != this)
@@ -68,34 +117,124 @@ namespace linalg {
             return *this;
         }
 
+        /// @brief Move assignment, exchanging the storage with other.
+        SparseMatrix& operator=(SparseMatrix&& other) noexcept
+        {
+            std::swap(m_csr, other.m_csr);
+            return *this;
+        }
+
         /// @brief Operator for converting MatrixExpression <-> SparseMatrix
+        /// @details Sparse expressions, see sparse_arithmetic.hpp, are evaluated from the non-zeros of
+        /// their operands in O(nnz + R). Dense expressions are read once in row order, in place if
+        /// they are strided, and their non-zeros appended to the CSR arrays as they are found, with
+        /// no sort.
         template <typename E>
         SparseMatrix(const MatrixExpression<E, S, R, C>& expr)
             : SparseMatrix()
         {
-            for (size_t i = 0; i < R; ++i) {
-                for (size_t j = 0; j < C; ++j) {
-                    value_type val = static_cast<value_type>(expr(i, j));
-                    if (val != 0)
-                        m_csr.insert(i, j, val);
-                }
-            }
+            assign(static_cast<const E&>(expr));
         }
 
-        /// @brief operator overload for () to access elements.
-        value_type& operator()(size_t row, size_t col)
+        /// @brief Assigns the value of an expression, see the expression constructor.
+        /// @details A sparse expression whose pattern is that of this matrix, e.g. `A = A + B` where
+        /// the non-zeros of B are a subset of those of A, only writes the values, reusing the CSR
+        /// row offsets and columns.
+        template <typename E>
+        SparseMatrix& operator=(const MatrixExpression<E, S, R, C>& expr)
         {
-            if (row > R || col > C)
+            assign(static_cast<const E&>(expr));
+            return *this;
+        }
+
+        /// @brief operator overload for () to read elements, 0 indexed.
+        /// @details Elements which are not stored read as zero, so this returns by value.
+        value_type operator()(size_t row, size_t col) const
+        {
+            if (row >= R || col >= C)
                 throw std::out_of_range("Specified indices are out of range.");
             return m_csr.get(row, col);
         }
 
-        /// @brief operator overload for () to access elements.
-        const value_type& operator()(size_t row, size_t col) const
+        /// @brief Sets a single element, 0 indexed.
+        /// @details This is O(nnz + R), for bulk assembly use TripletBuilder.
+        void set(size_t row, size_t col, value_type val)
         {
-            if (row > R || col > C)
+            if (row >= R || col >= C)
                 throw std::out_of_range("Specified indices are out of range.");
-            return m_csr.get(row, col);
+            m_csr.insert(row, col, val);
+        }
+
+        /// @brief Unchecked element access, 1 indexed like every MatrixExpression.
+        value_type coeff(size_t row, size_t col) const
+        {
+            return m_csr.get(row - 1, col - 1);
+        }
+
+        /// @brief Returns the number of stored non-zero values.
+        size_t nnz() const noexcept
+        {
+            return m_csr.m_values.size();
+        }
+
+        /// @brief Returns the CSR non-zero values, size nnz.
+        const value_type* values() const noexcept
+        {
+            return m_csr.m_values.data();
+        }
+
+        /// @brief Returns the CSR non-zero values for writing, size nnz.
+        /// @details The pattern is unchanged, so a value set to zero stays stored.
+        value_type* values() noexcept
+        {
+            return m_csr.m_values.data();
+        }
+
+        /// @brief Returns the CSR row offsets into the values, size R + 1.
+        const size_t* row_offsets() const noexcept
+        {
+            return m_csr.m_rowvec.data();
+        }
+
+        /// @brief Returns the CSR column of each value, 0 indexed, size nnz.
+        const size_t* col_indices() const noexcept
+        {
+            return m_csr.m_colvec.data();
+        }
+
+        /// @brief Checks if another sparse matrix stores exactly the same positions.
+        /// @details O(1) for the same matrix, O(nnz + R) otherwise.
+        template <typename S2>
+        bool same_pattern(const SparseMatrix<S2, R, C>& other) const noexcept
+        {
+            if (static_cast<const void*>(&other) == static_cast<const void*>(this))
+                return true;
+            return nnz() == other.nnz() && std::equal(m_csr.m_rowvec.begin(), m_csr.m_rowvec.end(), other.row_offsets())
+                && std::equal(m_csr.m_colvec.begin(), m_csr.m_colvec.end(), other.col_indices());
+        }
+
+        /// @brief Evaluates the matrix into a dense one.
+        /// @details The destination is zeroed in storage order and the non-zeros scattered into it,
+        /// so `Matrix dense = sparse` costs O(R * C + nnz) with no search per element.
+        template <typename Dst>
+        requires StridedExpression<Dst>
+        void eval_to(Dst& dst) const
+        {
+            value_type* out = dst.data();
+            const size_t rs = dst.row_stride();
+            const size_t cs = dst.col_stride();
+            if (rs >= cs) {
+                for (size_t i = 0; i < R; ++i)
+                    for (size_t j = 0; j < C; ++j)
+                        out[i * rs + j * cs] = value_type(0);
+            } else {
+                for (size_t j = 0; j < C; ++j)
+                    for (size_t i = 0; i < R; ++i)
+                        out[i * rs + j * cs] = value_type(0);
+            }
+            for (size_t i = 0; i < R; ++i)
+                for (size_t p = m_csr.m_rowvec[i]; p < m_csr.m_rowvec[i + 1]; ++p)
+                    out[i * rs + m_csr.m_colvec[p] * cs] = m_csr.m_values[p];
         }
 
         /// @brief Returns the number of rows.
@@ -123,7 +262,7 @@ namespace linalg {
         {
             m_csr.m_values.clear();
             m_csr.m_colvec.clear();
-            m_csr.m_rowvec.clear();
+            m_csr.m_rowvec.assign(R + 1, 0);
         }
 
         /// @brief Sets all elements to the identity matrix.
@@ -139,29 +278,21 @@ namespace linalg {
         }
 
         /// @brief Sets all elements using a lambda function.
-        /// @details This is applying to every element, not just the non-zero elements.
+        /// @details Only the non-zero elements can be set without making the matrix dense, so this
+        /// replaces the stored values which are not zero, in storage order, in O(nnz).
         void fillf(std::function<value_type()> lambda)
         {
-            for (size_t i = 0; i < R; ++i) {
-                for (size_t j = 0; j < C; ++j) {
-                    value_type val = m_csr.get(i, j);
-                    if (val != 0) {
-                        m_csr.insert(i, j, lambda());
-                    }
-                }
-            }
+            for (value_type& val : m_csr.m_values)
+                if (val != 0)
+                    val = lambda();
         }
 
         /// @brief Sets only the non-zero elements using a lambda function.
+        /// @details Every stored value is replaced, including stored zeros, in storage order, in O(nnz).
         void fillfnz(std::function<value_type()> lambda)
         {
-            for (size_t i = 0; i < m_csr.rows(); ++i) {
-                for (auto it = m_csr.row_begin(i); it != m_csr.row_end(i); ++it) {
-                    size_t j = it->column;
-                    value_type val = it->value;
-                    m_csr.insert(i, j, lambda());
-                }
-            }
+            for (value_type& val : m_csr.m_values)
+                val = lambda();
         }
 
         /// @brief Resets the matrix to empty.
@@ -173,6 +304,32 @@ namespace linalg {
         }
 
     private:
+        template <typename E>
+        void assign(const E& expr)
+        {
+            if constexpr (requires { expr.eval_sparse(*this); }) {
+                expr.eval_sparse(*this);
+            } else {
+                CSRStorage csr;
+                csr.m_rowvec.resize(R + 1, 0);
+                for (size_t i = 0; i < R; ++i) {
+                    for (size_t j = 0; j < C; ++j) {
+                        value_type val;
+                        if constexpr (StridedExpression<E>)
+                            val = static_cast<value_type>(expr.data()[i * expr.row_stride() + j * expr.col_stride()]);
+                        else
+                            val = static_cast<value_type>(expr.coeff(i + 1, j + 1));
+                        if (val != 0) {
+                            csr.m_values.push_back(val);
+                            csr.m_colvec.push_back(j);
+                        }
+                    }
+                    csr.m_rowvec[i + 1] = csr.m_values.size();
+                }
+                m_csr = std::move(csr);
+            }
+        }
+
         struct CSRStorage {
             // Compressed sparse row format uses three vectors to store information about
             // a sparse matrix.
@@ -184,10 +341,20 @@ namespace linalg {
             // contains the column indices. size NNZ.
             storage_type_col m_colvec;
 
+            // inserts a single element at its sorted position in the row, or overwrites it if it
+            // already exists. This is O(nnz + R), for bulk assembly use TripletBuilder.
             void insert(size_t row, size_t col, value_type val)
             {
-                m_values.push_back(val);
-                m_colvec.push_back(col);
+                const auto first = m_colvec.begin() + m_rowvec[row];
+                const auto last = m_colvec.begin() + m_rowvec[row + 1];
+                const auto it = std::lower_bound(first, last, col);
+                const size_t pos = it - m_colvec.begin();
+                if (it != last && *it == col) {
+                    m_values[pos] = val;
+                    return;
+                }
+                m_colvec.insert(it, col);
+                m_values.insert(m_values.begin() + pos, val);
                 for (size_t i = row + 1; i < m_rowvec.size(); ++i) {
                     ++m_rowvec[i];
                 }
@@ -195,13 +362,11 @@ namespace linalg {
 
             value_type get(size_t row, size_t col) const
             {
-                size_t start = m_rowvec[row];
-                size_t end = m_rowvec[row + 1];
-                for (size_t i = start; i < end; ++i) {
-                    if (m_colvec[i] == col) {
-                        return m_values[i];
-                    }
-                }
+                const auto first = m_colvec.begin() + m_rowvec[row];
+                const auto last = m_colvec.begin() + m_rowvec[row + 1];
+                const auto it = std::lower_bound(first, last, col);
+                if (it != last && *it == col)
+                    return m_values[it - m_colvec.begin()];
                 return value_type(0);
             }
         };
@@ -209,6 +374,16 @@ namespace linalg {
         CSRStorage m_csr;
     };
 
+    /// @brief Trait for detecting the SparseMatrix class.
+    template <typename T>
+    struct is_sparse_matrix : std::false_type { };
+
+    template <typename S, size_t R, size_t C>
+    struct is_sparse_matrix<SparseMatrix<S, R, C>> : std::true_type { };
+
+    template <typename T>
+    inline constexpr bool is_sparse_matrix_v = is_sparse_matrix<T>::value;
+
 }; // namespace linalg
 }; // namespace lao
 
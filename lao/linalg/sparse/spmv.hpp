@@ -0,0 +1,126 @@
+/// spmv.hpp implements the sparse-dense product kernels used when a product with a SparseMatrix
+/// operand is evaluated into a dense matrix. They visit only the stored non-zeros, so an m x k
+/// sparse matrix times an k x n dense matrix costs O(nnz * n) rather than O(m * k * n).
+///
+/// Sparse matrices are described by their CSR arrays and dense matrices by a pointer and a row and
+/// column stride, as in gemm.hpp. All indices are 0 based. Large products are split across threads
+/// by rows, with the split balanced by the number of non-zeros rather than the number of rows.
+
+#ifndef LAO_LINALG_SPARSE_SPMV_H_
+#define LAO_LINALG_SPARSE_SPMV_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <lao/config.hpp>
+#include <lao/instrumentation.hpp>
+#include <lao/parallel.hpp>
+
+namespace lao {
+namespace linalg {
+
+    namespace detail {
+
+        /// @brief Returns the first row of part p out of parts, splitting the rows by non-zero count.
+        inline size_t nnz_balanced_row(size_t m, const size_t* rowvec, size_t p, size_t parts)
+        {
+            if (p == parts)
+                return m;
+            const size_t target = rowvec[m] / parts * p + rowvec[m] % parts * p / parts;
+            return static_cast<size_t>(std::lower_bound(rowvec, rowvec + m, target) - rowvec);
+        }
+
+        /// @brief Calls f(first_row, last_row) over row ranges with about equal non-zero counts.
+        template <typename F>
+        void parallel_rows_by_nnz(size_t m, const size_t* rowvec, F&& f)
+        {
+            const size_t parts = rowvec[m] >= LAO_SPARSE_PARALLEL_THRESHOLD ? std::min(thread_count(), m) : 1;
+            if (parts < 2) {
+                f(size_t(0), m);
+                return;
+            }
+            parallel_for(0, parts, 1, [&](size_t first, size_t last) {
+                for (size_t p = first; p < last; ++p)
+                    f(nnz_balanced_row(m, rowvec, p, parts), nnz_balanced_row(m, rowvec, p + 1, parts));
+            });
+        }
+
+    }; // namespace detail
+
+    /// @brief Sparse matrix-vector product, y = A * x.
+    /// @details A is m x k in CSR format, x has k elements spaced incx apart and y has m elements
+    /// spaced incy apart. y must not alias x.
+    template <typename S>
+    void spmv(size_t m, const size_t* rowvec, const size_t* colvec, const S* values,
+        const S* x, size_t incx, S* y, size_t incy)
+    {
+        instrumentation::ScopedTimer timer(instrumentation::Kernel::spmv);
+        detail::parallel_rows_by_nnz(m, rowvec, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                S sum = S(0);
+                for (size_t p = rowvec[i]; p < rowvec[i + 1]; ++p)
+                    sum += values[p] * x[colvec[p] * incx];
+                y[i * incy] = sum;
+            }
+        });
+    }
+
+    /// @brief Sparse-dense matrix multiplication, C = A * B.
+    /// @details A is m x k in CSR format, B is k x n and C is m x n. Each row of C is accumulated
+    /// from the rows of B selected by the non-zeros in the same row of A. C must not alias B.
+    template <typename S>
+    void spmm(size_t m, size_t n, const size_t* rowvec, const size_t* colvec, const S* values,
+        const S* B, size_t rsb, size_t csb, S* C, size_t rsc, size_t csc)
+    {
+        if (n == 1) {
+            spmv(m, rowvec, colvec, values, B, rsb, C, rsc);
+            return;
+        }
+
+        detail::parallel_rows_by_nnz(m, rowvec, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                S* c = C + i * rsc;
+                for (size_t j = 0; j < n; ++j)
+                    c[j * csc] = S(0);
+                for (size_t p = rowvec[i]; p < rowvec[i + 1]; ++p) {
+                    const S a = values[p];
+                    const S* b = B + colvec[p] * rsb;
+                    if (csb == 1 && csc == 1) {
+                        for (size_t j = 0; j < n; ++j)
+                            c[j] += a * b[j];
+                    } else {
+                        for (size_t j = 0; j < n; ++j)
+                            c[j * csc] += a * b[j * csb];
+                    }
+                }
+            }
+        });
+    }
+
+    /// @brief Dense-sparse matrix multiplication, C = B * A.
+    /// @details B is m x k, A is k x n in CSR format and C is m x n. Each row of C is accumulated
+    /// from the rows of A scaled by the elements of the same row of B. C must not alias B.
+    template <typename S>
+    void dense_spmm(size_t m, size_t n, size_t k, const S* B, size_t rsb, size_t csb,
+        const size_t* rowvec, const size_t* colvec, const S* values, S* C, size_t rsc, size_t csc)
+    {
+        const size_t grain = m * rowvec[k] >= LAO_SPARSE_PARALLEL_THRESHOLD ? std::max<size_t>(1, m / thread_count()) : m;
+        parallel_for(0, m, grain, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                S* c = C + i * rsc;
+                for (size_t j = 0; j < n; ++j)
+                    c[j * csc] = S(0);
+                for (size_t p = 0; p < k; ++p) {
+                    const S b = B[i * rsb + p * csb];
+                    if (b == S(0))
+                        continue;
+                    for (size_t q = rowvec[p]; q < rowvec[p + 1]; ++q)
+                        c[colvec[q] * csc] += b * values[q];
+                }
+            }
+        });
+    }
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_SPARSE_SPMV_H_
@@ -0,0 +1,164 @@
+/// triplet.hpp implements the coordinate (COO) format builder used to assemble sparse matrices.
+///
+/// Entries are collected unordered as (row, col, value) triplets and compressed into CSR in one
+/// pass: a counting sort buckets them by row in O(nnz + R), then each row is sorted by column and
+/// duplicates are summed. Rows are independent, so for large inputs they are processed in parallel.
+
+#ifndef LAO_LINALG_SPARSE_TRIPLET_H_
+#define LAO_LINALG_SPARSE_TRIPLET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <lao/config.hpp>
+#include <lao/parallel.hpp>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace lao {
+namespace linalg {
+
+    /// @brief Builder collecting the entries of an R x C sparse matrix in coordinate format.
+    /// @details Entries are 0 indexed, like the compressed storage of SparseMatrix, and may be added
+    /// in any order. Entries at the same position are summed, and entries which end up as zero are
+    /// dropped. Construct a SparseMatrix from the builder to compress it.
+    template <typename S, size_t R, size_t C>
+    class TripletBuilder {
+    public:
+        using value_type = S;
+
+        TripletBuilder() = default;
+
+        /// @brief Constructs a builder with room for capacity entries.
+        explicit TripletBuilder(size_t capacity)
+        {
+            reserve(capacity);
+        }
+
+        /// @brief Reserves room for capacity entries.
+        void reserve(size_t capacity)
+        {
+            m_rows.reserve(capacity);
+            m_cols.reserve(capacity);
+            m_values.reserve(capacity);
+        }
+
+        /// @brief Adds an entry, 0 indexed.
+        void add(size_t row, size_t col, value_type value)
+        {
+            if (row >= R || col >= C)
+                throw std::out_of_range("Specified indices are out of range.");
+            m_rows.push_back(row);
+            m_cols.push_back(col);
+            m_values.push_back(value);
+        }
+
+        /// @brief Adds all entries of another builder.
+        void append(const TripletBuilder& other)
+        {
+            m_rows.insert(m_rows.end(), other.m_rows.begin(), other.m_rows.end());
+            m_cols.insert(m_cols.end(), other.m_cols.begin(), other.m_cols.end());
+            m_values.insert(m_values.end(), other.m_values.begin(), other.m_values.end());
+        }
+
+        /// @brief Returns the number of entries added, duplicates included.
+        size_t size() const noexcept
+        {
+            return m_values.size();
+        }
+
+        /// @brief Removes all entries, keeping the reserved memory.
+        void clear() noexcept
+        {
+            m_rows.clear();
+            m_cols.clear();
+            m_values.clear();
+        }
+
+        /// @brief Compresses the entries into CSR arrays.
+        /// @param values the non-zero values, size nnz.
+        /// @param rowvec the offset of each row into values, size R + 1.
+        /// @param colvec the column of each value, size nnz.
+        template <typename VV, typename RV, typename CV>
+        void compress(VV& values, RV& rowvec, CV& colvec) const
+        {
+            const size_t n = m_values.size();
+
+            // count the entries of each row, then scatter them into row buckets.
+            std::vector<size_t> offsets(R + 1, 0);
+            for (size_t e = 0; e < n; ++e)
+                ++offsets[m_rows[e] + 1];
+            for (size_t r = 0; r < R; ++r)
+                offsets[r + 1] += offsets[r];
+
+            std::vector<size_t> cols(n);
+            std::vector<value_type> vals(n);
+            {
+                std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+                for (size_t e = 0; e < n; ++e) {
+                    const size_t p = next[m_rows[e]]++;
+                    cols[p] = m_cols[e];
+                    vals[p] = m_values[e];
+                }
+            }
+
+            // sort each row by column, sum duplicates and drop zeros, in place.
+            std::vector<size_t> counts(R);
+            const size_t grain = n >= LAO_SPARSE_PARALLEL_THRESHOLD ? 64 : R + 1;
+            parallel_for(0, R, grain, [&](size_t first, size_t last) {
+                std::vector<std::pair<size_t, value_type>> scratch;
+                for (size_t r = first; r < last; ++r) {
+                    const size_t begin = offsets[r];
+                    const size_t end = offsets[r + 1];
+                    if (!std::is_sorted(cols.begin() + begin, cols.begin() + end)) {
+                        scratch.clear();
+                        for (size_t k = begin; k < end; ++k)
+                            scratch.emplace_back(cols[k], vals[k]);
+                        std::stable_sort(scratch.begin(), scratch.end(),
+                            [](const auto& a, const auto& b) { return a.first < b.first; });
+                        for (size_t k = begin; k < end; ++k) {
+                            cols[k] = scratch[k - begin].first;
+                            vals[k] = scratch[k - begin].second;
+                        }
+                    }
+
+                    size_t write = begin;
+                    for (size_t k = begin; k < end;) {
+                        const size_t col = cols[k];
+                        value_type sum = vals[k];
+                        for (++k; k < end && cols[k] == col; ++k)
+                            sum += vals[k];
+                        if (sum != value_type(0)) {
+                            cols[write] = col;
+                            vals[write] = sum;
+                            ++write;
+                        }
+                    }
+                    counts[r] = write - begin;
+                }
+            });
+
+            // pack the rows together.
+            rowvec.assign(R + 1, 0);
+            for (size_t r = 0; r < R; ++r)
+                rowvec[r + 1] = rowvec[r] + counts[r];
+            values.resize(rowvec[R]);
+            colvec.resize(rowvec[R]);
+            parallel_for(0, R, grain, [&](size_t first, size_t last) {
+                for (size_t r = first; r < last; ++r) {
+                    std::copy_n(cols.begin() + offsets[r], counts[r], colvec.begin() + rowvec[r]);
+                    std::copy_n(vals.begin() + offsets[r], counts[r], values.begin() + rowvec[r]);
+                }
+            });
+        }
+
+    private:
+        std::vector<size_t> m_rows;
+        std::vector<size_t> m_cols;
+        std::vector<value_type> m_values;
+    };
+
+}; // namespace linalg
+}; // namespace lao
+
+#endif // LAO_LINALG_SPARSE_TRIPLET_H_
@@ -0,0 +1,264 @@
+/// parallel.hpp implements the threading primitives shared by the linalg and astro kernels.
+///
+/// Work runs on one library wide ThreadPool, created on first use with thread_count() threads
+/// (including the calling thread) and reused for the lifetime of the program. Each thread has its
+/// own queue of tasks: it pushes and pops its own tasks at the back, and when it runs out it steals
+/// from the front of the other queues, so the split of a parallel_for balances itself when chunks
+/// take uneven time. A thread waiting for its tasks to finish runs queued tasks in the meantime, so
+/// parallel_for can be nested without deadlocking.
+///
+/// Ranges too small to split never touch the pool, and run inline on the calling thread.
+
+#ifndef LAO_PARALLEL_H_
+#define LAO_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <lao/config.hpp>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lao {
+
+    /// @brief Returns the number of threads parallel kernels split their work across.
+    /// @details Given by LAO_NUM_THREADS, or the hardware concurrency if that is 0.
+    inline size_t thread_count() noexcept
+    {
+        if constexpr (LAO_NUM_THREADS > 0) {
+            return LAO_NUM_THREADS;
+        } else {
+            static const size_t count = std::max(1u, std::thread::hardware_concurrency());
+            return count;
+        }
+    }
+
+    /// @brief Work-stealing pool of threads.
+    /// @details Use the pool returned by `instance()` rather than creating more, so that the library
+    /// never runs more threads than thread_count().
+    class ThreadPool {
+    public:
+        /// @brief Creates a pool which runs work on threads threads, including the calling thread.
+        explicit ThreadPool(size_t threads)
+        {
+            const size_t workers = std::max<size_t>(threads, 1) - 1;
+            // one queue per worker, plus a shared one for threads outside of the pool.
+            for (size_t i = 0; i < workers + 1; ++i)
+                m_queues.push_back(std::make_unique<Queue>());
+            m_workers.reserve(workers);
+            for (size_t i = 0; i < workers; ++i)
+                m_workers.emplace_back([this, i]() { work(i); });
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (auto& worker : m_workers)
+                worker.join();
+        }
+
+        /// @brief Returns the pool shared by the library, with thread_count() threads.
+        static ThreadPool& instance()
+        {
+            static ThreadPool pool(thread_count());
+            return pool;
+        }
+
+        /// @brief Returns the number of threads work runs on, including the calling thread.
+        size_t size() const noexcept
+        {
+            return m_workers.size() + 1;
+        }
+
+        /// @brief Calls f(first, last) over disjoint chunks of at least grain elements covering
+        /// [begin, end), and returns once all of them are done.
+        /// @details The range is split into up to 4 chunks per thread, so that threads which finish
+        /// early can steal the remaining ones. If a chunk throws, the first exception is rethrown
+        /// here once all chunks are done.
+        template <typename F>
+        void parallel_for(size_t begin, size_t end, size_t grain, F&& f)
+        {
+            const size_t n = end > begin ? end - begin : 0;
+            const size_t chunks = std::min(4 * size(), n / std::max<size_t>(grain, 1));
+            if (chunks < 2 || size() < 2) {
+                if (n > 0)
+                    f(begin, end);
+                return;
+            }
+
+            using JobType = Job<std::remove_reference_t<F>>;
+            JobType job(f, chunks);
+            const size_t home = home_queue();
+            // count the tasks before queueing them, so the count never drops below the queued tasks.
+            m_queued.fetch_add(chunks - 1, std::memory_order_release);
+            {
+                Queue& queue = *m_queues[home];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                for (size_t c = 1; c < chunks; ++c)
+                    queue.tasks.push_back(Task { &JobType::run, &job, begin + n * c / chunks, begin + n * (c + 1) / chunks });
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            }
+            m_wake.notify_all();
+
+            // run the first chunk here, then help with queued tasks until every chunk is done.
+            JobType::run(&job, begin, begin + n / chunks);
+            while (job.pending.load(std::memory_order_acquire) > 0) {
+                if (!try_run(home))
+                    std::this_thread::yield();
+            }
+            if (job.error)
+                std::rethrow_exception(job.error);
+        }
+
+    private:
+        struct Task {
+            void (*run)(void*, size_t, size_t);
+            void* job;
+            size_t first;
+            size_t last;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        template <typename F>
+        struct Job {
+            Job(F& f, size_t chunks)
+                : f(f)
+                , pending(chunks)
+            {
+            }
+
+            static void run(void* p, size_t first, size_t last)
+            {
+                auto* job = static_cast<Job*>(p);
+                try {
+                    job->f(first, last);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(job->error_mutex);
+                    if (!job->error)
+                        job->error = std::current_exception();
+                }
+                // the job lives on the stack of the thread waiting for it, so this is the last use.
+                job->pending.fetch_sub(1, std::memory_order_acq_rel);
+            }
+
+            F& f;
+            std::atomic<size_t> pending;
+            std::mutex error_mutex;
+            std::exception_ptr error;
+        };
+
+        static size_t& worker_index() noexcept
+        {
+            thread_local size_t index = std::numeric_limits<size_t>::max();
+            return index;
+        }
+
+        size_t home_queue() const noexcept
+        {
+            const size_t index = worker_index();
+            return index < m_workers.size() ? index : m_workers.size();
+        }
+
+        /// @brief Runs one queued task, preferring the back of the home queue, then stealing from
+        /// the front of the others. Returns false if every queue is empty.
+        bool try_run(size_t home)
+        {
+            Task task {};
+            bool found = false;
+            {
+                Queue& queue = *m_queues[home];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty()) {
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                    found = true;
+                }
+            }
+            for (size_t i = 1; !found && i < m_queues.size(); ++i) {
+                Queue& queue = *m_queues[(home + i) % m_queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty()) {
+                    task = queue.tasks.front();
+                    queue.tasks.pop_front();
+                    found = true;
+                }
+            }
+            if (!found)
+                return false;
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            task.run(task.job, task.first, task.last);
+            return true;
+        }
+
+        void work(size_t index)
+        {
+            worker_index() = index;
+            while (true) {
+                if (try_run(index))
+                    continue;
+                std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                m_wake.wait(lock, [this]() { return m_stop || m_queued.load(std::memory_order_acquire) > 0; });
+                if (m_stop && m_queued.load(std::memory_order_acquire) == 0)
+                    return;
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_workers;
+        std::atomic<size_t> m_queued { 0 };
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake;
+        bool m_stop = false;
+    };
+
+    /// @brief Calls f(first, last) over disjoint chunks covering [begin, end), in parallel.
+    /// @details Ranges with fewer than 2 * grain elements, or a single thread, run inline on the
+    /// calling thread with no threading overhead. Otherwise the range is split into chunks of at
+    /// least grain elements which run on the shared ThreadPool, and this returns once all of them
+    /// are done.
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F&& f)
+    {
+        const size_t n = end > begin ? end - begin : 0;
+        if (n / std::max<size_t>(grain, 1) < 2 || thread_count() < 2) {
+            if (n > 0)
+                f(begin, end);
+            return;
+        }
+        ThreadPool::instance().parallel_for(begin, end, grain, f);
+    }
+
+    /// @brief Calls f(first, last) over disjoint chunks of rows covering [begin, end), in parallel
+    /// once the rows add up to LAO_PARALLEL_THRESHOLD elements of work.
+    /// @param row_cost the number of elements of work in each row.
+    template <typename F>
+    void parallel_rows(size_t begin, size_t end, size_t row_cost, F&& f)
+    {
+        // ranges shorter than 2 * grain run inline, i.e. fewer than LAO_PARALLEL_THRESHOLD elements.
+        const size_t grain = std::max<size_t>(1, LAO_PARALLEL_THRESHOLD / 2 / std::max<size_t>(row_cost, 1));
+        parallel_for(begin, end, grain, f);
+    }
+
+}; // namespace lao
+
+#endif // LAO_PARALLEL_H_
@@ -1,18 +1,28 @@
+#include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <iterator>
+#include <limits>
 #include <lao/lao.hpp>
-#include <sstream>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 class AstroTest : public ::testing::Test {
 protected:
     template <typename S, size_t R, size_t C>
-    bool matricesEqual(const lao::linalg::Matrix<S, R, C>& mat1, const lao::linalg::Matrix<S, R, C>& mat2) const
+    bool matricesEqual(const lao::linalg::Matrix<S, R, C>& mat1, const lao::linalg::Matrix<S, R, C>& mat2, double tol) const
     {
-        double tol = 1e-9;
         for (size_t i = 1; i <= mat1.rows(); ++i) {
             for (size_t j = 1; j <= mat1.cols(); ++j) {
-                if (fabs(mat1(i,j) - mat2(i,j)) < tol)
+                if (std::fabs(mat1(i, j) - mat2(i, j)) > tol * std::max(1.0, std::fabs(mat2(i, j))))
                     return false;
             }
         }
@@ -20,12 +30,831 @@ protected:
     }
 };
 
+/// @brief Test the Earth-Moon barycenter at J2000 against its known heliocentric ecliptic state.
 TEST_F(AstroTest, JPLLP_Ephemeris)
 {
-    lao::linalg::Matrix<double, 1, 6> expected_state {{3.92554e+10, -1.47559e+10, -2.27302e+10, 21964.7, 13898.2, 39307.7}};
-    auto body = lao::astro::JPLLP("Mercury");
+    // earth at 2000-01-01 12:00 TDB, 1 AU = 1.496e11 m, within the ~5000 km offset of the barycenter
+    // and the accuracy of the low precision elements.
+    lao::linalg::Matrix<double, 1, 6> expected_state { { -0.17713 * 1.495978707e11, 0.96724 * 1.495978707e11, 0.0, -29.78e3, -5.47e3, 0.0 } };
+    auto body = lao::astro::JPLLP("EM bary");
 
-    EXPECT_EQ(matricesEqual(body.eph(16263.0), expected_state), true);
+    const auto state = body.eph(lao::astro::Epoch(0.5));
+    for (size_t j = 1; j <= 3; ++j)
+        EXPECT_NEAR(state(1, j), expected_state(1, j), 1e-3 * 1.495978707e11);
+    for (size_t j = 4; j <= 6; ++j)
+        EXPECT_NEAR(state(1, j), expected_state(1, j), 0.05e3);
+}
+
+/// @brief Test that the state of each body lies on the two-body orbit of its elements at that epoch.
+TEST_F(AstroTest, JPLLP_OrbitInvariants)
+{
+    // semi-major axes at J2000 [AU].
+    const std::vector<std::pair<std::string, double>> bodies { { "Mercury", 0.38709927 }, { "Venus", 0.72333566 },
+        { "EM bary", 1.00000261 }, { "Mars", 1.52371034 }, { "Jupiter", 5.20288700 }, { "Saturn", 9.53667594 },
+        { "Uranus", 19.18916464 }, { "Neptune", 30.06992276 } };
+    for (const auto& [name, a_au] : bodies) {
+        auto body = lao::astro::JPLLP(name);
+        const auto state = body.eph(lao::astro::Epoch(16263.0));
+        const double r = std::sqrt(state(1, 1) * state(1, 1) + state(1, 2) * state(1, 2) + state(1, 3) * state(1, 3));
+        const double v2 = state(1, 4) * state(1, 4) + state(1, 5) * state(1, 5) + state(1, 6) * state(1, 6);
+        // vis-viva gives the semi-major axis back, which moves by far less than 1% over 45 years.
+        const double a = 1.0 / (2.0 / r - v2 / lao::astro::MU_SUN<double>);
+        EXPECT_NEAR(a / lao::astro::AU2M<double>, a_au, 1e-2 * a_au) << name;
+    }
+}
+
+/// @brief Test construction by id and by name, and the 3000 BC - 3000 AD table.
+TEST_F(AstroTest, JPLLP_Tables)
+{
+    static_assert(lao::astro::JPLLP::bodyId("Mars") == lao::astro::BodyId::Mars);
+    static_assert(lao::astro::JPLLP::bodyId("EM bary") == lao::astro::BodyId::EMBary);
+    EXPECT_THROW(lao::astro::JPLLP("Pluto"), std::invalid_argument);
+
+    const std::vector<lao::astro::BodyId> ids { lao::astro::BodyId::Mercury, lao::astro::BodyId::Venus, lao::astro::BodyId::EMBary,
+        lao::astro::BodyId::Mars, lao::astro::BodyId::Jupiter, lao::astro::BodyId::Saturn, lao::astro::BodyId::Uranus, lao::astro::BodyId::Neptune };
+    const std::vector<std::string> names { "Mercury", "Venus", "EM bary", "Mars", "Jupiter", "Saturn", "Uranus", "Neptune" };
+    for (size_t b = 0; b < ids.size(); ++b) {
+        auto by_name = lao::astro::JPLLP(names[b]);
+        auto by_id = lao::astro::JPLLP(ids[b]);
+        auto long_term = lao::astro::JPLLP(ids[b], lao::astro::JPLLPTable::Years3000BCTo3000AD);
+        for (double t = -70000.0; t < 18000.0; t += 7919.0) {
+            const auto state = by_id.eph(lao::astro::Epoch(t));
+            EXPECT_TRUE(matricesEqual(state, by_name.eph(lao::astro::Epoch(t)), 0.0));
+
+            // within 1800 AD - 2050 AD both tables agree on the direction of the body to well
+            // within a degree.
+            const auto other = long_term.eph(lao::astro::Epoch(t));
+            double dot = 0.0;
+            double r1 = 0.0;
+            double r2 = 0.0;
+            for (size_t j = 1; j <= 3; ++j) {
+                dot += state(1, j) * other(1, j);
+                r1 += state(1, j) * state(1, j);
+                r2 += other(1, j) * other(1, j);
+            }
+            EXPECT_LT(std::acos(std::min(1.0, dot / std::sqrt(r1 * r2))), 0.5 * lao::astro::DEG2RAD<double>) << names[b] << " " << t;
+            EXPECT_NEAR(std::sqrt(r2 / r1), 1.0, 1e-2) << names[b] << " " << t;
+        }
+    }
+
+    // only the long term table covers 1000 BC.
+    auto mars = lao::astro::JPLLP(lao::astro::BodyId::Mars, lao::astro::JPLLPTable::Years3000BCTo3000AD);
+    EXPECT_NO_THROW(mars.eph(lao::astro::Epoch(-1100000.0)));
+    EXPECT_THROW(lao::astro::JPLLP(lao::astro::BodyId::Mars).eph(lao::astro::Epoch(-1100000.0)), std::invalid_argument);
+    EXPECT_THROW(mars.eph(lao::astro::Epoch(-1900000.0)), std::invalid_argument);
+}
+
+/// @brief Test that batched evaluation matches evaluation one epoch at a time.
+TEST_F(AstroTest, JPLLP_Batch)
+{
+    auto body = lao::astro::JPLLP("Mars");
+    std::vector<double> mjd2000;
+    for (double t = -73000.0; t < 18000.0; t += 997.0)
+        mjd2000.push_back(t);
+
+    lao::astro::StateBatch states;
+    body.ephBatch(mjd2000, states);
+    ASSERT_EQ(states.rows(), mjd2000.size());
+    ASSERT_EQ(states.cols(), 6u);
+
+    std::vector<lao::astro::Epoch> epochs(mjd2000.begin(), mjd2000.end());
+    lao::astro::StateBatch from_epochs;
+    // through the base class, with a single virtual call.
+    const lao::astro::Base& base = body;
+    base.ephBatch(std::span<const lao::astro::Epoch>(epochs), from_epochs);
+
+    for (size_t k = 0; k < mjd2000.size(); ++k) {
+        const lao::linalg::Matrix<double, 1, 6> state = body.eph(lao::astro::Epoch(mjd2000[k]));
+        lao::linalg::Matrix<double, 1, 6> batched;
+        lao::linalg::Matrix<double, 1, 6> batched_epochs;
+        for (size_t j = 1; j <= 6; ++j) {
+            batched(1, j) = states(k + 1, j);
+            batched_epochs(1, j) = from_epochs(k + 1, j);
+        }
+        EXPECT_TRUE(matricesEqual(batched, state, 1e-15));
+        EXPECT_TRUE(matricesEqual(batched_epochs, state, 1e-15));
+    }
+
+    // each column is contiguous.
+    EXPECT_EQ(&states(2, 1), &states(1, 1) + 1);
+    EXPECT_EQ(&states(1, 2), &states(1, 1) + mjd2000.size());
+
+    mjd2000.push_back(20000.0);
+    EXPECT_THROW(body.ephBatch(mjd2000, states), std::invalid_argument);
+    EXPECT_THROW(body.eph(lao::astro::Epoch(-80000.0)), std::invalid_argument);
+}
+
+/// @brief Test the single precision ephemerides against the double ones, within their bound.
+TEST_F(AstroTest, JPLLP_SinglePrecision)
+{
+    const auto check = [](const lao::astro::Base& body, const std::vector<double>& mjd2000, double bound) {
+        const size_t n = mjd2000.size();
+        std::vector<double> exact(6 * n);
+        std::vector<float> single(6 * n);
+        body.ephBatch(mjd2000, exact.data(), n);
+        body.ephBatch(mjd2000, single.data(), n);
+        for (size_t k = 0; k < n; ++k) {
+            for (size_t j = 0; j < 6; j += 3) {
+                const double error = std::hypot(single[j * n + k] - exact[j * n + k], single[(j + 1) * n + k] - exact[(j + 1) * n + k],
+                    single[(j + 2) * n + k] - exact[(j + 2) * n + k]);
+                EXPECT_LE(error, bound * std::hypot(exact[j * n + k], exact[(j + 1) * n + k], exact[(j + 2) * n + k]))
+                    << body.name() << " at " << mjd2000[k];
+            }
+        }
+    };
+    for (const auto table : { lao::astro::JPLLPTable::Years1800To2050, lao::astro::JPLLPTable::Years3000BCTo3000AD }) {
+        const double first = table == lao::astro::JPLLPTable::Years1800To2050 ? -73000.0 : -1826000.0;
+        const double last = table == lao::astro::JPLLPTable::Years1800To2050 ? 18200.0 : 365000.0;
+        std::vector<double> mjd2000;
+        for (size_t k = 0; k < 1000; ++k)
+            mjd2000.push_back(first + (last - first) * static_cast<double>(k) / 999.0);
+        for (size_t b = 0; b < 8; ++b)
+            check(lao::astro::JPLLP(static_cast<lao::astro::BodyId>(b), table), mjd2000, lao::astro::JPLLP_FLOAT_ERROR);
+    }
+
+    // bodies without a float evaluation round their double states.
+    const auto mars = lao::astro::JPLLP("Mars");
+    const lao::astro::EphemerisCache cache(mars, 0.0, 1000.0, 10.0);
+    std::vector<double> mjd2000;
+    for (double t = 1.0; t < 999.0; t += 3.7)
+        mjd2000.push_back(t);
+    check(cache, mjd2000, std::ldexp(1.0, -24));
+}
+
+/// @brief Test sinCos against std::sin and std::cos.
+TEST_F(AstroTest, SinCos)
+{
+    for (double x = -1.0e4; x <= 1.0e4; x += 0.0173) {
+        double s, c;
+        lao::astro::sinCos(x, s, c);
+        EXPECT_NEAR(s, std::sin(x), 4e-16);
+        EXPECT_NEAR(c, std::cos(x), 4e-16);
+    }
+    double s, c;
+    lao::astro::sinCos(0.0, s, c);
+    EXPECT_EQ(s, 0.0);
+    EXPECT_EQ(c, 1.0);
+}
+
+/// @brief Test the single precision sinCos, Kepler solvers and conversion to cartesian.
+TEST_F(AstroTest, SinglePrecision)
+{
+    for (float x = -8000.0f; x <= 8000.0f; x += 0.0173f) {
+        float s, c;
+        lao::astro::sinCos(x, s, c);
+        EXPECT_NEAR(s, std::sin(static_cast<double>(x)), 1.2e-7);
+        EXPECT_NEAR(c, std::cos(static_cast<double>(x)), 1.2e-7);
+    }
+
+    std::vector<float> M, e;
+    for (float ecc = 0.0f; ecc < 0.99f; ecc += 0.0371f) {
+        for (float m = -20.0f; m <= 20.0f; m += 0.0917f) {
+            M.push_back(m);
+            e.push_back(ecc);
+        }
+    }
+    std::vector<float> E(M.size());
+    lao::astro::eccentricAnomalyBatch(M, e, E);
+    for (size_t k = 0; k < M.size(); ++k) {
+        // the E of the float M and e, to within a few ulp of float.
+        const double exact = lao::astro::eccentricAnomaly(static_cast<double>(M[k]), static_cast<double>(e[k]));
+        EXPECT_NEAR(E[k], exact, 4.0 * std::numeric_limits<float>::epsilon() * std::max(1.0, std::fabs(exact))) << "M = " << M[k] << ", e = " << e[k];
+    }
+    std::vector<float> one_orbit(M.begin(), M.begin() + 100);
+    lao::astro::eccentricAnomalyBatch(one_orbit, 0.3f, one_orbit);
+    EXPECT_EQ(one_orbit[10], lao::astro::eccentricAnomaly(M[10], 0.3f));
+
+    const float newton = lao::astro::meanAnomalyToEccentricAnomaly(1.0f, 0.5f);
+    EXPECT_NEAR(newton, lao::astro::meanAnomalyToEccentricAnomaly(1.0, 0.5), 1e-6);
+
+    const double mu = lao::astro::MU_SUN<double>;
+    const lao::linalg::RowVector<double, 6> elements({ 2.0e11, 0.2, 0.3, 1.0, 2.0, 0.5 });
+    const lao::linalg::RowVector<float, 6> single_elements({ 2.0e11f, 0.2f, 0.3f, 1.0f, 2.0f, 0.5f });
+    const lao::linalg::RowVector<double, 6> state = lao::astro::keplerianToCartesian(elements, mu);
+    const lao::linalg::RowVector<float, 6> single = lao::astro::keplerianToCartesian(single_elements, mu);
+    for (size_t j = 1; j <= 6; ++j)
+        EXPECT_NEAR(single(1, j), state(1, j), 1e-6 * (j <= 3 ? 2.4e11 : 4.0e4));
+}
+
+/// @brief Test the fixed-work Kepler solver over the elliptic range, in every step mode.
+TEST_F(AstroTest, KeplerBatch)
+{
+    using lao::astro::KeplerStep;
+    std::vector<double> M, e;
+    for (double ecc = 0.0; ecc < 0.9999; ecc += 0.0371) {
+        for (double m = -20.0; m <= 20.0; m += 0.0917) {
+            M.push_back(m);
+            e.push_back(ecc);
+        }
+    }
+    M.push_back(0.0);
+    e.push_back(0.9999);
+    M.push_back(1e-3);
+    e.push_back(0.9999);
+
+    const auto residual = [&](size_t k, double E) { return std::fabs(E - e[k] * std::sin(E) - M[k]); };
+
+    std::vector<double> E(M.size());
+    lao::astro::eccentricAnomalyBatch(M, e, E);
+    for (size_t k = 0; k < M.size(); ++k) {
+        EXPECT_LT(residual(k, E[k]), 1e-14) << "M = " << M[k] << ", e = " << e[k];
+        // the turns of M are kept, E - M = e sin E
+        EXPECT_LE(std::fabs(E[k] - M[k]), e[k] + 1e-14);
+        if (e[k] < 0.9) {
+            EXPECT_NEAR(E[k], lao::astro::meanAnomalyToEccentricAnomaly(M[k], e[k]), 1e-13);
+        }
+    }
+
+    std::vector<double> danby(M.size());
+    std::vector<double> newton(M.size());
+    lao::astro::eccentricAnomalyBatch<KeplerStep::Danby, 1>(M, e, danby);
+    lao::astro::eccentricAnomalyBatch<KeplerStep::Newton, 3>(M, e, newton);
+    for (size_t k = 0; k < M.size(); ++k) {
+        EXPECT_NEAR(danby[k], E[k], 1e-11);
+        EXPECT_NEAR(newton[k], E[k], 1e-13);
+    }
+
+    // one orbit, in place.
+    std::vector<double> in_place(M.begin(), M.begin() + 100);
+    lao::astro::eccentricAnomalyBatch(in_place, 0.3, in_place);
+    for (size_t k = 0; k < in_place.size(); ++k)
+        EXPECT_DOUBLE_EQ(in_place[k], lao::astro::eccentricAnomaly(M[k], 0.3));
+
+    E.pop_back();
+    EXPECT_THROW(lao::astro::eccentricAnomalyBatch(M, e, E), std::invalid_argument);
+    EXPECT_THROW(lao::astro::eccentricAnomalyBatch(M, 0.3, E), std::invalid_argument);
+}
+
+/// @brief Test fitting, evaluating, saving and loading a chebyshev ephemeris cache.
+TEST_F(AstroTest, EphemerisCache)
+{
+    const auto body = lao::astro::JPLLP("EM bary");
+    // 2000 - 2030 in segments of at most 16 days
+    const lao::astro::EphemerisCache cache(body, 0.0, 10957.0, 16.0);
+    EXPECT_EQ(cache.segments(), 685u);
+    EXPECT_EQ(cache.name(), body.name());
+    EXPECT_EQ(cache.mu(), body.mu());
+    EXPECT_LT(cache.fitError().position, 0.1);
+    EXPECT_LT(cache.fitError().velocity, 1e-6);
+    EXPECT_GT(cache.fitError().position, 0.0);
+
+    std::vector<double> mjd2000;
+    for (double t = 0.0; t <= 10957.0; t += 13.7)
+        mjd2000.push_back(t);
+    mjd2000.push_back(10957.0);
+    lao::astro::StateBatch expected;
+    lao::astro::StateBatch cached;
+    body.ephBatch(mjd2000, expected);
+    cache.ephBatch(mjd2000, cached);
+    for (size_t k = 0; k < mjd2000.size(); ++k) {
+        const lao::linalg::Matrix<double, 1, 6> state = cache.eph(lao::astro::Epoch(mjd2000[k]));
+        double dr = 0.0;
+        double dv = 0.0;
+        for (size_t j = 1; j <= 3; ++j) {
+            EXPECT_EQ(state(1, j), cached(k + 1, j));
+            EXPECT_EQ(state(1, j + 3), cached(k + 1, j + 3));
+            dr += std::pow(cached(k + 1, j) - expected(k + 1, j), 2);
+            dv += std::pow(cached(k + 1, j + 3) - expected(k + 1, j + 3), 2);
+        }
+        // the fit error is measured at other epochs, so allow some slack over it.
+        EXPECT_LT(std::sqrt(dr), 2.0 * cache.fitError().position + 1e-3);
+        EXPECT_LT(std::sqrt(dv), 2.0 * cache.fitError().velocity + 1e-9);
+    }
+    EXPECT_THROW(cache.eph(lao::astro::Epoch(-1.0)), std::invalid_argument);
+    EXPECT_THROW(cache.eph(lao::astro::Epoch(10958.0)), std::invalid_argument);
+
+    const std::string filename = "test_ephemeris_cache.bin";
+    cache.save(filename);
+    const lao::astro::EphemerisCache loaded = lao::astro::EphemerisCache::load(filename);
+    std::remove(filename.c_str());
+    EXPECT_EQ(loaded.name(), cache.name());
+    EXPECT_EQ(loaded.radius(), cache.radius());
+    EXPECT_EQ(loaded.segments(), cache.segments());
+    EXPECT_EQ(loaded.degree(), cache.degree());
+    EXPECT_EQ(loaded.fitError().position, cache.fitError().position);
+    lao::astro::StateBatch reloaded;
+    loaded.ephBatch(mjd2000, reloaded);
+    for (size_t k = 1; k <= mjd2000.size(); ++k)
+        for (size_t j = 1; j <= 6; ++j)
+            EXPECT_EQ(reloaded(k, j), cached(k, j));
+    EXPECT_EQ(loaded.measureError(body).velocity, cache.fitError().velocity);
+
+    // truncated files, trailing bytes, and header sizes which are too large or whose product wraps.
+    cache.save(filename);
+    std::vector<char> bytes;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    const auto loadModified = [&](size_t size, size_t word, std::uint64_t value) {
+        std::vector<char> modified(bytes);
+        modified.resize(size, '\0');
+        if (word < 8)
+            std::memcpy(modified.data() + word * sizeof(std::uint64_t), &value, sizeof(value));
+        std::ofstream(filename, std::ios::binary | std::ios::trunc).write(modified.data(), static_cast<std::streamsize>(modified.size()));
+        return lao::astro::EphemerisCache::load(filename);
+    };
+    EXPECT_NO_THROW(loadModified(bytes.size(), 8, 0));
+    EXPECT_THROW(loadModified(bytes.size() - 8, 8, 0), std::runtime_error);
+    EXPECT_THROW(loadModified(200, 8, 0), std::runtime_error);
+    EXPECT_THROW(loadModified(bytes.size() + 8, 8, 0), std::runtime_error);
+    EXPECT_THROW(loadModified(bytes.size(), 4, std::uint64_t(1) << 62), std::runtime_error);
+    EXPECT_THROW(loadModified(bytes.size(), 4, ~std::uint64_t(0)), std::runtime_error);
+    EXPECT_THROW(loadModified(bytes.size(), 2, ~std::uint64_t(0)), std::runtime_error);
+    const std::uint64_t wrapping = ~std::uint64_t(0) / (6 * (cache.degree() + 1) * sizeof(double)) + 1;
+    EXPECT_THROW(loadModified(bytes.size(), 3, wrapping), std::runtime_error);
+    EXPECT_THROW(loadModified(bytes.size(), 3, cache.segments() + 1), std::runtime_error);
+    std::remove(filename.c_str());
+
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "not an ephemeris cache, not an ephemeris cache, not an ephemeris cache";
+    }
+    EXPECT_THROW(lao::astro::EphemerisCache::load(filename), std::runtime_error);
+    std::remove(filename.c_str());
+    EXPECT_THROW(lao::astro::EphemerisCache::load(filename), std::runtime_error);
+
+    EXPECT_THROW(lao::astro::EphemerisCache(body, 10.0, 0.0, 16.0), std::invalid_argument);
+    EXPECT_THROW(lao::astro::EphemerisCache(body, 0.0, 10.0, 0.0), std::invalid_argument);
+    EXPECT_THROW(lao::astro::EphemerisCache(body, 0.0, 10.0, 1.0, 0), std::invalid_argument);
+}
+
+/// @brief Test every euler sequence against the product of its three elementary rotations.
+TEST_F(AstroTest, EulerSequences)
+{
+    using lao::astro::EulerSequence;
+    using Matrix3 = lao::linalg::Matrix<double, 3, 3>;
+    const auto elementary = [](char axis, double angle) {
+        const double c = std::cos(angle);
+        const double s = std::sin(angle);
+        if (axis == 'X')
+            return Matrix3 { { 1, 0, 0 }, { 0, c, -s }, { 0, s, c } };
+        if (axis == 'Y')
+            return Matrix3 { { c, 0, s }, { 0, 1, 0 }, { -s, 0, c } };
+        return Matrix3 { { c, -s, 0 }, { s, c, 0 }, { 0, 0, 1 } };
+    };
+
+    const double phi = 0.3;
+    const double theta = -1.2;
+    const double psi = 2.5;
+    lao::linalg::RowVector<double, 3> angles;
+    angles(1, 1) = phi;
+    angles(1, 2) = theta;
+    angles(1, 3) = psi;
+
+    const std::string names[] = { "XZX", "XYX", "YXY", "YZY", "ZXZ", "ZYZ", "XYZ", "XZY", "YXZ", "YZX", "ZXY", "ZYX" };
+    for (const std::string& name : names) {
+        const Matrix3 expected = elementary(name[0], phi) * elementary(name[1], theta) * elementary(name[2], psi);
+        const Matrix3 R = lao::astro::rotationFromEuler(name, angles);
+        EXPECT_TRUE(matricesEqual(R, expected, 1e-15)) << name;
+        const Matrix3 RtR = lao::linalg::transpose(R) * R;
+        Matrix3 identity;
+        identity.eye();
+        EXPECT_TRUE(matricesEqual(RtR, identity, 1e-15)) << name;
+    }
+
+    const Matrix3 zxz = lao::astro::rotationFromEuler<EulerSequence::ZXZ>(phi, theta, psi);
+    EXPECT_TRUE(matricesEqual(zxz, lao::astro::rotationFromEuler<EulerSequence::ZXZ>(angles), 0.0));
+    Matrix3 into;
+    lao::astro::rotationFromEuler<EulerSequence::ZXZ>(phi, theta, psi, into);
+    EXPECT_TRUE(matricesEqual(into, zxz, 0.0));
+    lao::astro::rotationFromEuler("XYZ", angles, into);
+    EXPECT_TRUE(matricesEqual(into, lao::astro::rotationFromEuler<EulerSequence::XYZ>(angles), 0.0));
+    static_assert(lao::astro::eulerSequence("ZYX") == EulerSequence::ZYX);
+    EXPECT_THROW(lao::astro::rotationFromEuler("ZZZ", angles), std::invalid_argument);
+
+    // the trig is done in float for float angles, and in double for double angles.
+    const lao::linalg::Matrix<float, 3, 3> zxzf = lao::astro::rotationFromEuler<EulerSequence::ZXZ>(0.3f, -1.2f, 2.5f);
+    for (size_t i = 1; i <= 3; ++i)
+        for (size_t j = 1; j <= 3; ++j)
+            EXPECT_NEAR(zxzf(i, j), zxz(i, j), 1e-6);
+}
+
+/// @brief Test the fused keplerian to cartesian conversion against the invariants of the orbit.
+TEST_F(AstroTest, KeplerianToCartesian)
+{
+    const double mu = lao::astro::MU_SUN<double>;
+    const double a = 2.0e11;
+    const double e = 0.3;
+    const double i = 0.4;
+    const double Omega = 1.1;
+    const double omega = -0.7;
+    for (double E = -3.0; E <= 3.0; E += 0.25) {
+        double state[6];
+        lao::astro::keplerianToCartesian(a, e, i, Omega, omega, E, mu, state);
+        const double r = std::sqrt(state[0] * state[0] + state[1] * state[1] + state[2] * state[2]);
+        const double v2 = state[3] * state[3] + state[4] * state[4] + state[5] * state[5];
+        EXPECT_NEAR(r, a * (1.0 - e * std::cos(E)), 1e-12 * a);
+        // vis-viva
+        EXPECT_NEAR(v2, mu * (2.0 / r - 1.0 / a), 1e-12 * v2);
+        // the angular momentum is normal to the orbital plane, with |h| = sqrt(mu a (1 - e^2))
+        const double hx = state[1] * state[5] - state[2] * state[4];
+        const double hy = state[2] * state[3] - state[0] * state[5];
+        const double hz = state[0] * state[4] - state[1] * state[3];
+        const double h = std::sqrt(mu * a * (1.0 - e * e));
+        EXPECT_NEAR(hx, h * std::sin(i) * std::sin(Omega), 1e-12 * h);
+        EXPECT_NEAR(hy, -h * std::sin(i) * std::cos(Omega), 1e-12 * h);
+        EXPECT_NEAR(hz, h * std::cos(i), 1e-12 * h);
+
+        lao::linalg::RowVector<double, 6> elements;
+        elements(1, 1) = a;
+        elements(1, 2) = e;
+        elements(1, 3) = i;
+        elements(1, 4) = Omega;
+        elements(1, 5) = omega;
+        elements(1, 6) = E;
+        const lao::linalg::RowVector<double, 6> vector = lao::astro::keplerianToCartesian(elements, mu);
+        lao::linalg::RowVector<double, 6> into;
+        lao::astro::keplerianToCartesian(elements, mu, into);
+        // the overloads may contract differently into FMAs, so they agree to a few ulp of the
+        // orbit's scale rather than exactly.
+        for (size_t j = 0; j < 6; ++j) {
+            const double scale = j < 3 ? a : std::sqrt(mu / a);
+            const double tol = 16.0 * std::numeric_limits<double>::epsilon() * scale;
+            EXPECT_NEAR(vector(1, j + 1), state[j], tol);
+            EXPECT_NEAR(into(1, j + 1), state[j], tol);
+        }
+        // the position and velocity halves of the state, viewed in place.
+        const auto position = into.submat<1, 3>(1, 1);
+        const auto velocity = into.submat<1, 3>(1, 4);
+        EXPECT_EQ(velocity.data(), into.data() + 3);
+        const lao::linalg::Matrix<double, 1, 1> rv = position * lao::linalg::transpose(velocity);
+        EXPECT_NEAR(rv(1, 1), state[0] * state[3] + state[1] * state[4] + state[2] * state[5], 1e-12 * r * std::sqrt(v2));
+    }
+}
+
+/// @brief Test the parallel evaluation of many bodies, whole and streamed, against each body alone.
+TEST_F(AstroTest, EphemerisEngine)
+{
+    const char* names[] = { "Mercury", "Venus", "EM bary", "Mars", "Jupiter", "Saturn", "Uranus", "Neptune" };
+    std::vector<lao::astro::JPLLP> planets;
+    for (const char* name : names)
+        planets.emplace_back(name);
+    std::vector<const lao::astro::Base*> bodies;
+    for (const auto& planet : planets)
+        bodies.push_back(&planet);
+
+    lao::ThreadPool pool(4);
+    const lao::astro::EphemerisEngine engine(bodies, 100, pool);
+    const lao::astro::EpochGrid grid = { -3000.0, 1.3, 3847 };
+
+    lao::astro::EphemerisTensor states;
+    engine.evaluate(grid, states);
+    ASSERT_EQ(states.rows(), grid.count);
+    ASSERT_EQ(states.cols(), 48u);
+
+    std::vector<double> mjd2000(grid.count);
+    for (size_t k = 0; k < grid.count; ++k)
+        mjd2000[k] = grid[k];
+    for (size_t b = 0; b < planets.size(); ++b) {
+        lao::astro::StateBatch expected;
+        planets[b].ephBatch(mjd2000, expected);
+        for (size_t k = 1; k <= grid.count; ++k)
+            for (size_t j = 1; j <= 6; ++j)
+                ASSERT_EQ(states(k, 6 * b + j), expected(k, j));
+    }
+
+    // streamed a chunk at a time, in order, with at most one window of chunks held at once.
+    size_t next = 0;
+    engine.stream(grid, [&](size_t first, std::span<const double> epochs, const lao::astro::EphemerisTensor& chunk) {
+        EXPECT_EQ(first, next);
+        EXPECT_LE(epochs.size(), engine.chunkSize());
+        ASSERT_EQ(chunk.rows(), epochs.size());
+        for (size_t k = 0; k < epochs.size(); ++k) {
+            EXPECT_EQ(epochs[k], grid[first + k]);
+            for (size_t j = 1; j <= chunk.cols(); ++j)
+                EXPECT_EQ(chunk(k + 1, j), states(first + k + 1, j));
+        }
+        next += epochs.size();
+    });
+    EXPECT_EQ(next, grid.count);
+
+    next = 0;
+    engine.stream(std::span<const double>(mjd2000).subspan(0, 250), [&](size_t first, std::span<const double> epochs, const lao::astro::EphemerisTensor&) {
+        EXPECT_EQ(first, next);
+        next += epochs.size();
+    });
+    EXPECT_EQ(next, 250u);
+
+    mjd2000.push_back(20000.0);
+    EXPECT_THROW(engine.evaluate(mjd2000, states), std::invalid_argument);
+    EXPECT_THROW(lao::astro::EphemerisEngine({ nullptr }), std::invalid_argument);
+    EXPECT_THROW(lao::astro::EphemerisEngine({}), std::invalid_argument);
+}
+
+/// @brief Test the two-body propagator against Kepler's equation, and on hyperbolic orbits.
+TEST_F(AstroTest, KeplerPropagation)
+{
+    const double mu = lao::astro::MU_SUN<double>;
+    const double dt = 3.0e7;
+    const size_t count = 1500;
+    lao::astro::StateBatch states(count, 6);
+    lao::astro::StateBatch expected(count, 6);
+    for (size_t k = 0; k < count; ++k) {
+        const double a = 1.0e11 * (1.0 + static_cast<double>(k % 7));
+        const double e = 0.95 * static_cast<double>(k) / static_cast<double>(count);
+        const double i = 0.001 * static_cast<double>(k % 300);
+        const double Omega = 0.37 * static_cast<double>(k % 17);
+        const double omega = -0.21 * static_cast<double>(k % 29);
+        const double E0 = -3.0 + 0.004 * static_cast<double>(k);
+        const double M1 = E0 - e * std::sin(E0) + std::sqrt(mu / (a * a * a)) * dt;
+        lao::astro::keplerianToCartesian(a, e, i, Omega, omega, E0, mu, states.data() + k, count);
+        lao::astro::keplerianToCartesian(a, e, i, Omega, omega, lao::astro::eccentricAnomaly(M1, e), mu, expected.data() + k, count);
+    }
+
+    lao::astro::StateBatch propagated;
+    lao::astro::propagateKepler(states, mu, dt, propagated);
+    ASSERT_EQ(propagated.rows(), count);
+    for (size_t k = 1; k <= count; ++k) {
+        const double r = std::hypot(expected(k, 1), expected(k, 2), expected(k, 3));
+        const double v = std::hypot(expected(k, 4), expected(k, 5), expected(k, 6));
+        for (size_t j = 1; j <= 3; ++j) {
+            ASSERT_NEAR(propagated(k, j), expected(k, j), 1e-11 * r);
+            ASSERT_NEAR(propagated(k, j + 3), expected(k, j + 3), 1e-11 * v);
+        }
+    }
+
+    // the same in place, with one mu per object.
+    std::vector<double> mus(count, mu);
+    lao::astro::StateBatch in_place = states;
+    lao::astro::propagateKepler(in_place, mus, dt, in_place);
+    for (size_t k = 1; k <= count; ++k)
+        for (size_t j = 1; j <= 6; ++j)
+            ASSERT_EQ(in_place(k, j), propagated(k, j));
+
+    // hyperbolic and near parabolic orbits conserve energy and angular momentum, and return to their
+    // initial states when propagated back.
+    const double r0 = 1.5e11;
+    const double escape = std::sqrt(2.0 * mu / r0);
+    const double speeds[] = { 0.999999 * escape, escape, 1.2 * escape, 3.0 * escape };
+    lao::astro::StateBatch hyperbolic(4, 6);
+    for (size_t k = 0; k < 4; ++k) {
+        hyperbolic(k + 1, 1) = r0;
+        hyperbolic(k + 1, 2) = 0.0;
+        hyperbolic(k + 1, 3) = 0.0;
+        hyperbolic(k + 1, 4) = 0.3 * speeds[k];
+        hyperbolic(k + 1, 5) = std::sqrt(0.9) * speeds[k];
+        hyperbolic(k + 1, 6) = 0.1 * speeds[k];
+    }
+    lao::astro::StateBatch forward, back;
+    EXPECT_EQ(lao::astro::propagateKepler(hyperbolic, mu, dt, forward), 0u);
+    EXPECT_EQ(lao::astro::propagateKepler(forward, mu, -dt, back), 0u);
+    auto energy = [&](const lao::astro::StateBatch& s, size_t k) {
+        return 0.5 * (s(k, 4) * s(k, 4) + s(k, 5) * s(k, 5) + s(k, 6) * s(k, 6)) - mu / std::hypot(s(k, 1), s(k, 2), s(k, 3));
+    };
+    for (size_t k = 1; k <= 4; ++k) {
+        EXPECT_NEAR(energy(forward, k), energy(hyperbolic, k), 1e-9 * mu / r0);
+        EXPECT_NEAR(forward(k, 1) * forward(k, 5) - forward(k, 2) * forward(k, 4), r0 * hyperbolic(k, 5), 1e-10 * r0 * escape);
+        EXPECT_GT(std::hypot(forward(k, 1), forward(k, 2), forward(k, 3)), r0);
+        for (size_t j = 1; j <= 3; ++j) {
+            EXPECT_NEAR(back(k, j), hyperbolic(k, j), 1e-9 * r0);
+            EXPECT_NEAR(back(k, j + 3), hyperbolic(k, j + 3), 1e-9 * escape);
+        }
+    }
+
+    // chained onto the batched ephemerides, and no time leaves the states as they are.
+    const auto body = lao::astro::JPLLP("Mars");
+    const std::vector<double> mjd2000 = { 0.0, 100.0, 200.0 };
+    lao::astro::StateBatch ephemerides, same;
+    body.ephBatch(mjd2000, ephemerides);
+    lao::astro::propagateKepler(ephemerides, body.muCentralBody(), 0.0, same);
+    for (size_t k = 1; k <= 3; ++k)
+        for (size_t j = 1; j <= 6; ++j)
+            EXPECT_EQ(same(k, j), ephemerides(k, j));
+
+    EXPECT_THROW(lao::astro::propagateKepler(ephemerides, std::span<const double>(mus).subspan(0, 2), dt, same), std::invalid_argument);
+
+    // objects which fail are flagged by a NaN state and transition matrix, and counted, while the
+    // other objects of their chunk are propagated as usual: one at the origin, whose solution is not
+    // finite, and a hyperbolic orbit over so long a time that cosh and its state overflow.
+    lao::astro::StateBatch extreme = hyperbolic;
+    for (size_t j = 1; j <= 3; ++j)
+        extreme(2, j) = 0.0;
+    lao::astro::StateBatch flagged;
+    lao::astro::StmBatch flagged_stm = lao::astro::stmIdentity(4);
+    EXPECT_EQ(lao::astro::propagateKepler(extreme, mu, dt, flagged, flagged_stm), 1u);
+    for (size_t j = 1; j <= 6; ++j) {
+        EXPECT_TRUE(std::isnan(flagged(2, j)));
+        EXPECT_EQ(flagged(1, j), forward(1, j));
+        EXPECT_EQ(flagged(3, j), forward(3, j));
+    }
+    EXPECT_TRUE(std::isnan(flagged_stm(2, 1)));
+    EXPECT_TRUE(std::isfinite(flagged_stm(1, 1)));
+    lao::astro::StateBatch escaping = hyperbolic.rviews(4, 4);
+    EXPECT_EQ(lao::astro::propagateKepler(escaping, mu, 1e300, flagged), 1u);
+    EXPECT_TRUE(std::isnan(flagged(1, 1)));
+}
+
+/// @brief Test the state transition matrices of the propagator against finite differences, and
+/// their chaining over successive propagations.
+TEST_F(AstroTest, StateTransitionMatrix)
+{
+    const double mu = lao::astro::MU_SUN<double>;
+    const double dt = 2.0e7;
+    lao::astro::StateBatch states(3, 6);
+    // elliptic, e = 0.5
+    lao::astro::keplerianToCartesian(2.0e11, 0.5, 0.3, 1.0, 2.0, 0.5, mu, states.data(), 3);
+    // near circular
+    lao::astro::keplerianToCartesian(1.5e11, 1e-4, 0.1, -1.0, 0.5, 2.0, mu, states.data() + 1, 3);
+    // hyperbolic
+    const double speed = 1.5 * std::sqrt(2.0 * mu / 1.0e11);
+    const double hyperbolic[6] = { 1.0e11, 2.0e10, -1.0e10, 0.2 * speed, 0.97 * speed, 0.1 * speed };
+    for (size_t j = 0; j < 6; ++j)
+        states(3, j + 1) = hyperbolic[j];
+
+    lao::astro::StateBatch propagated;
+    lao::astro::StmBatch stm = lao::astro::stmIdentity(3);
+    lao::astro::propagateKepler(states, mu, dt, propagated, stm);
+
+    // central differences, with steps of 1 km and 1 mm/s.
+    for (size_t k = 1; k <= 3; ++k) {
+        lao::astro::StateBatch plus = states, minus = states, out_plus, out_minus;
+        double phi[6][6];
+        for (size_t j = 1; j <= 6; ++j) {
+            const double h = j <= 3 ? 1.0e3 : 1.0e-3;
+            plus = states;
+            minus = states;
+            plus(k, j) += h;
+            minus(k, j) -= h;
+            lao::astro::propagateKepler(plus, mu, dt, out_plus);
+            lao::astro::propagateKepler(minus, mu, dt, out_minus);
+            for (size_t i = 1; i <= 6; ++i)
+                phi[i - 1][j - 1] = (out_plus(k, i) - out_minus(k, i)) / (2.0 * h);
+        }
+        // each 3x3 block has its own units, so is compared relative to its largest element.
+        for (size_t bi = 0; bi < 2; ++bi) {
+            for (size_t bj = 0; bj < 2; ++bj) {
+                double scale = 0.0;
+                for (size_t i = 0; i < 3; ++i)
+                    for (size_t j = 0; j < 3; ++j)
+                        scale = std::max(scale, std::abs(phi[3 * bi + i][3 * bj + j]));
+                for (size_t i = 0; i < 3; ++i) {
+                    for (size_t j = 0; j < 3; ++j) {
+                        const size_t row = 3 * bi + i;
+                        const size_t col = 3 * bj + j;
+                        EXPECT_NEAR(stm(k, 6 * row + col + 1), phi[row][col], 1e-6 * scale) << k << " " << row << " " << col;
+                    }
+                }
+            }
+        }
+    }
+
+    // two steps of dt chain to the transition matrix of one step of 2 dt.
+    lao::astro::StmBatch chained = stm;
+    lao::astro::StateBatch twice, whole;
+    lao::astro::propagateKepler(propagated, mu, dt, twice, chained);
+    lao::astro::StmBatch direct = lao::astro::stmIdentity(3);
+    lao::astro::propagateKepler(states, mu, 2.0 * dt, whole, direct);
+    for (size_t k = 1; k <= 3; ++k) {
+        for (size_t e = 1; e <= 36; ++e) {
+            const size_t row = (e - 1) / 6;
+            const size_t col = (e - 1) % 6;
+            double scale = 0.0;
+            for (size_t i = 0; i < 3; ++i)
+                for (size_t j = 0; j < 3; ++j)
+                    scale = std::max(scale, std::abs(direct(k, 6 * (3 * (row / 3) + i) + 3 * (col / 3) + j + 1)));
+            EXPECT_NEAR(chained(k, e), direct(k, e), 1e-8 * scale);
+        }
+    }
+
+    EXPECT_THROW(lao::astro::propagateKepler(states, mu, dt, propagated, direct = lao::astro::stmIdentity(2)), std::invalid_argument);
+}
+
+/// @brief Test the solutions of lambert's problem reach the second position when propagated.
+TEST_F(AstroTest, Lambert)
+{
+    const auto earth = lao::astro::JPLLP("EM bary");
+    const auto mars = lao::astro::JPLLP("Mars");
+    const double mu = earth.muCentralBody();
+    auto check = [&](const lao::astro::Epoch& t1, const lao::astro::Epoch& t2, size_t revolutions, bool retrograde) {
+        const auto solutions = lao::astro::lambert(earth, t1, mars, t2, revolutions, retrograde);
+        const auto s1 = earth.eph(t1);
+        const auto s2 = mars.eph(t2);
+        lao::astro::StateBatch initial(solutions.size(), 6);
+        for (size_t k = 0; k < solutions.size(); ++k) {
+            for (size_t j = 0; j < 3; ++j) {
+                initial(k + 1, j + 1) = s1(1, j + 1);
+                initial(k + 1, j + 4) = solutions[k].v1[j];
+            }
+        }
+        lao::astro::StateBatch final;
+        lao::astro::propagateKepler(initial, mu, (t2.MJD2000() - t1.MJD2000()) * lao::astro::DAY2SEC<double>, final);
+        for (size_t k = 0; k < solutions.size(); ++k) {
+            EXPECT_EQ(solutions[k].revolutions, (k + 1) / 2);
+            const double r2 = std::hypot(s2(1, 1), s2(1, 2), s2(1, 3));
+            const double v2 = std::hypot(solutions[k].v2[0], solutions[k].v2[1], solutions[k].v2[2]);
+            for (size_t j = 0; j < 3; ++j) {
+                EXPECT_NEAR(final(k + 1, j + 1), s2(1, j + 1), 1e-8 * r2);
+                EXPECT_NEAR(final(k + 1, j + 4), solutions[k].v2[j], 1e-8 * v2);
+            }
+            // the sense of the orbit about the z axis.
+            const double hz = initial(k + 1, 1) * initial(k + 1, 5) - initial(k + 1, 2) * initial(k + 1, 4);
+            EXPECT_EQ(hz < 0.0, retrograde);
+        }
+        return solutions.size();
+    };
+
+    EXPECT_EQ(check(lao::astro::Epoch(7500.0), lao::astro::Epoch(7710.0), 0, false), 1u);
+    EXPECT_EQ(check(lao::astro::Epoch(7500.0), lao::astro::Epoch(7710.0), 0, true), 1u);
+    // a transfer angle beyond pi.
+    EXPECT_EQ(check(lao::astro::Epoch(7400.0), lao::astro::Epoch(7800.0), 0, false), 1u);
+    // over four years, with room for up to 4 revolutions of which the time of flight allows 2.
+    EXPECT_EQ(check(lao::astro::Epoch(7500.0), lao::astro::Epoch(9000.0), 4, false), 5u);
+    EXPECT_EQ(check(lao::astro::Epoch(7500.0), lao::astro::Epoch(9000.0), 1, false), 3u);
+
+    std::array<lao::astro::LambertSolution, 1> solution;
+    EXPECT_THROW(lao::astro::lambert({ 1.0e11, 0.0, 0.0 }, { 0.0, 1.0e11, 0.0 }, -1.0, mu, solution), std::invalid_argument);
+    EXPECT_THROW(lao::astro::lambert({ 1.0e11, 0.0, 0.0 }, { 2.0e11, 0.0, 0.0 }, 1.0e7, mu, solution), std::invalid_argument);
+}
+
+/// @brief Test the porkchop grid against lambert's problem solved for single cells.
+TEST_F(AstroTest, Porkchop)
+{
+    const auto earth = lao::astro::JPLLP("EM bary");
+    const auto mars = lao::astro::JPLLP("Mars");
+    // the 2020 window, departures over summer 2020 and arrivals over early 2021, and a few arrivals
+    // before the first departures.
+    const lao::astro::EpochGrid departures = { 7430.0, 2.0, 45 };
+    const lao::astro::EpochGrid arrivals = { 7420.0, 4.0, 70 };
+
+    lao::ThreadPool pool(4);
+    const lao::astro::Porkchop grid = lao::astro::porkchop(earth, mars, departures, arrivals, 0, pool);
+    ASSERT_EQ(grid.c3.rows(), departures.count);
+    ASSERT_EQ(grid.c3.cols(), arrivals.count);
+
+    double min_c3 = std::numeric_limits<double>::infinity();
+    for (size_t i = 1; i <= departures.count; ++i) {
+        for (size_t j = 1; j <= arrivals.count; ++j) {
+            if (arrivals[j - 1] <= departures[i - 1]) {
+                EXPECT_TRUE(std::isnan(grid.c3(i, j)));
+                EXPECT_TRUE(std::isnan(grid.delta_v(i, j)));
+                continue;
+            }
+            min_c3 = std::min(min_c3, grid.c3(i, j));
+            if ((i * 7 + j) % 37 != 0)
+                continue;
+            const lao::astro::Epoch t1(departures[i - 1]);
+            const lao::astro::Epoch t2(arrivals[j - 1]);
+            const auto solution = lao::astro::lambert(earth, t1, mars, t2).front();
+            const auto s1 = earth.eph(t1);
+            const auto s2 = mars.eph(t2);
+            const double vinf1 = std::hypot(solution.v1[0] - s1(1, 4), solution.v1[1] - s1(1, 5), solution.v1[2] - s1(1, 6));
+            const double vinf2 = std::hypot(solution.v2[0] - s2(1, 4), solution.v2[1] - s2(1, 5), solution.v2[2] - s2(1, 6));
+            EXPECT_NEAR(grid.c3(i, j), vinf1 * vinf1, 1e-9 * vinf1 * vinf1);
+            EXPECT_NEAR(grid.vinf_arrival(i, j), vinf2, 1e-9 * vinf2);
+            EXPECT_NEAR(grid.delta_v(i, j), vinf1 + vinf2, 1e-9 * (vinf1 + vinf2));
+        }
+    }
+    // the least C3 of the window is about 13 km^2/s^2.
+    EXPECT_GT(min_c3, 8.0e6);
+    EXPECT_LT(min_c3, 20.0e6);
+
+    // multiple revolutions only add candidates, so never raise delta_v.
+    const lao::astro::Porkchop multi = lao::astro::porkchop(earth, mars, departures, arrivals, 1, pool);
+    for (size_t i = 1; i <= departures.count; ++i) {
+        for (size_t j = 1; j <= arrivals.count; ++j) {
+            if (!std::isnan(grid.delta_v(i, j))) {
+                EXPECT_LE(multi.delta_v(i, j), grid.delta_v(i, j));
+            }
+        }
+    }
+
+    EXPECT_THROW(lao::astro::porkchop(earth, lao::astro::JPLLP("Mars"), lao::astro::EpochGrid { 0.0, 1.0, 0 }, arrivals), std::invalid_argument);
+}
+
+/// @brief Test that screening in float and refining in double finds exactly the epochs a pass in
+/// double does.
+TEST_F(AstroTest, CloseApproaches)
+{
+    const auto earth = lao::astro::JPLLP("EM bary");
+    const auto mars = lao::astro::JPLLP("Mars");
+    std::vector<double> mjd2000;
+    for (double t = -36000.0; t < 18000.0; t += 1.0)
+        mjd2000.push_back(t);
+    // the closest oppositions, about 0.4 AU apart.
+    const double threshold = 0.45 * lao::astro::AU<double>;
+
+    lao::ThreadPool pool(4);
+    const std::vector<lao::astro::CloseApproach> approaches = lao::astro::closeApproaches(earth, mars, mjd2000, threshold, lao::astro::JPLLP_FLOAT_ERROR, pool);
+    lao::astro::StateBatch from, to;
+    earth.ephBatch(mjd2000, from);
+    mars.ephBatch(mjd2000, to);
+    std::vector<lao::astro::CloseApproach> expected;
+    for (size_t k = 1; k <= mjd2000.size(); ++k) {
+        const double distance = std::hypot(from(k, 1) - to(k, 1), from(k, 2) - to(k, 2), from(k, 3) - to(k, 3));
+        if (distance <= threshold)
+            expected.push_back({ mjd2000[k - 1], distance });
+    }
+    ASSERT_FALSE(expected.empty());
+    ASSERT_LT(expected.size(), mjd2000.size() / 10);
+    ASSERT_EQ(approaches.size(), expected.size());
+    for (size_t k = 0; k < expected.size(); ++k) {
+        EXPECT_EQ(approaches[k].mjd2000, expected[k].mjd2000);
+        EXPECT_NEAR(approaches[k].distance, expected[k].distance, 1e-3);
+    }
+
+    EXPECT_TRUE(lao::astro::closeApproaches(earth, mars, mjd2000, 0.0).empty());
+    EXPECT_THROW(lao::astro::closeApproaches(earth, mars, mjd2000, -1.0), std::invalid_argument);
 }
 
 int main(int argc, char** argv)
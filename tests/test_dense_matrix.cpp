@@ -1,7 +1,11 @@
 #include <cstddef>
 #include <gtest/gtest.h>
 #include <lao/lao.hpp>
+#include <span>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 class MatrixTest : public ::testing::Test {
 protected:
@@ -227,6 +231,464 @@ TEST_F(MatrixTest, ColIteratorsOutOfRange)
     EXPECT_THROW(mat.col_end(4), std::out_of_range);
 }
 
+/// @brief Test that small matrices default to inline storage and large ones to the heap.
+TEST_F(MatrixTest, DefaultStorageSelection)
+{
+    EXPECT_TRUE((std::is_same_v<lao::linalg::Matrix<double, 3, 3>::storage_type, lao::linalg::StaticStorage<double, 9>>));
+    EXPECT_TRUE((std::is_same_v<lao::linalg::RowVector<double, 6>::storage_type, lao::linalg::StaticStorage<double, 6>>));
+    EXPECT_TRUE((std::is_same_v<lao::linalg::Matrix<int, 50, 50>::storage_type, std::vector<int>>));
+}
+
+/// @brief Test constructors, iterators and expression assignment on inline storage.
+TEST_F(MatrixTest, StaticStorageOperations)
+{
+    lao::linalg::Matrix<double, 2, 2> mat1 { { 1, 2 }, { 3, 4 } };
+    lao::linalg::Matrix<double, 2, 2> mat2(std::vector<double> { 5, 6, 7, 8 });
+    lao::linalg::Matrix<double, 2, 2> mat3;
+    mat3 = mat1 + mat2;
+
+    lao::linalg::Matrix<double, 2, 2> result { { 6, 8 }, { 10, 12 } };
+    EXPECT_TRUE(matricesEqual(mat3, result));
+
+    double sum = 0;
+    for (auto x : mat3.row_begin(2))
+        sum += x;
+    EXPECT_EQ(sum, 22);
+
+    lao::linalg::Matrix<double, 2, 2> copy(mat3);
+    EXPECT_TRUE(matricesEqual(copy, result));
+
+    EXPECT_THROW((lao::linalg::Matrix<double, 2, 2>(std::vector<double> { 1, 2, 3 })), std::invalid_argument);
+}
+
+/// @brief Test explicitly selecting heap storage for a small matrix.
+TEST_F(MatrixTest, ExplicitVectorStorage)
+{
+    lao::linalg::Matrix<double, 2, 2, std::vector<double>> mat1 { { 1, 2 }, { 3, 4 } };
+    lao::linalg::Matrix<double, 2, 2> mat2 { { 1, 2 }, { 3, 4 } };
+    lao::linalg::Matrix<double, 2, 2> mat3 = mat1 + mat2;
+
+    EXPECT_EQ(mat3(2, 2), 8);
+    mat1.reset();
+    EXPECT_TRUE(mat1.is_empty());
+}
+
+/// @brief Test unchecked, linear and span element access.
+TEST_F(MatrixTest, UncheckedAndLinearAccess)
+{
+    lao::linalg::Matrix<int, 2, 3> mat { { 1, 2, 3 }, { 4, 5, 6 } };
+
+    EXPECT_EQ(mat.coeff(2, 1), 4);
+    EXPECT_EQ(mat.coeff(4), 5);
+    EXPECT_EQ(mat.data()[5], 6);
+
+    mat.coeff(1, 1) = 7;
+    EXPECT_EQ(mat(1, 1), 7);
+
+    std::span<int> elements = mat.span();
+    EXPECT_EQ(elements.size(), 6);
+    int sum = 0;
+    for (int x : elements)
+        sum += x;
+    EXPECT_EQ(sum, 27);
+}
+
+/// @brief Test element layout and strides of row-major and column-major matrices.
+TEST_F(MatrixTest, ColumnMajorStorage)
+{
+    lao::linalg::Matrix<int, 2, 3> row { { 1, 2, 3 }, { 4, 5, 6 } };
+    lao::linalg::ColMajorMatrix<int, 2, 3> col { { 1, 2, 3 }, { 4, 5, 6 } };
+
+    EXPECT_EQ(row.row_stride(), 3u);
+    EXPECT_EQ(row.col_stride(), 1u);
+    EXPECT_EQ(col.row_stride(), 1u);
+    EXPECT_EQ(col.col_stride(), 2u);
+
+    std::vector<int> col_order = { 1, 4, 2, 5, 3, 6 };
+    for (size_t i = 0; i < col_order.size(); ++i)
+        EXPECT_EQ(col.coeff(i), col_order[i]);
+    for (size_t i = 1; i <= 2; ++i)
+        for (size_t j = 1; j <= 3; ++j)
+            EXPECT_EQ(col(i, j), row(i, j));
+
+    col(2, 1) = 7;
+    EXPECT_EQ(col.data()[1], 7);
+
+    lao::linalg::ColMajorMatrix<int, 3, 3> eye(lao::linalg::filltype::eye);
+    EXPECT_EQ(eye(2, 2), 1);
+    EXPECT_EQ(eye(2, 1), 0);
+}
+
+/// @brief Test construction, resizing and element access of matrices with dynamic extents.
+TEST_F(MatrixTest, DynamicExtent)
+{
+    using lao::linalg::Dynamic;
+
+    lao::linalg::Matrix<double, Dynamic, Dynamic> mat1;
+    EXPECT_EQ(mat1.rows(), 0u);
+    EXPECT_EQ(mat1.cols(), 0u);
+
+    mat1.resize(4, 7);
+    EXPECT_EQ(mat1.rows(), 4u);
+    EXPECT_EQ(mat1.cols(), 7u);
+    EXPECT_EQ(mat1.size(), 28u);
+    EXPECT_EQ(mat1.row_stride(), 7u);
+    mat1(4, 7) = 2.0;
+    EXPECT_DOUBLE_EQ(mat1.coeff(27), 2.0);
+    EXPECT_THROW(mat1(5, 1), std::out_of_range);
+
+    lao::linalg::Matrix<int, Dynamic, 3> mat2 { { 1, 2, 3 }, { 4, 5, 6 } };
+    EXPECT_EQ(mat2.rows(), 2u);
+    EXPECT_EQ(mat2(2, 3), 6);
+    EXPECT_THROW(mat2.resize(2, 4), std::invalid_argument);
+    EXPECT_THROW((lao::linalg::Matrix<int, Dynamic, 3> { { 1, 2 }, { 3, 4 } }), std::invalid_argument);
+
+    lao::linalg::Matrix<int, Dynamic, Dynamic> mat3(3, 3, lao::linalg::filltype::eye);
+    EXPECT_EQ(mat3(2, 2), 1);
+    EXPECT_EQ(mat3(2, 3), 0);
+
+    lao::linalg::Matrix<int, Dynamic, Dynamic> mat4(2, 2, std::vector<int> { 1, 2, 3, 4 });
+    EXPECT_EQ(mat4(2, 1), 3);
+
+    // static extents cost no storage.
+    EXPECT_EQ(sizeof(lao::linalg::Matrix<double, 3, 3>), sizeof(lao::linalg::StaticStorage<double, 9>));
+}
+
+/// @brief Test that arena backed matrices allocate from the current ScopedArena and are released with it.
+TEST_F(MatrixTest, ArenaStorage)
+{
+    using lao::linalg::Dynamic;
+
+    lao::linalg::Arena arena(1024);
+    const lao::linalg::Matrix<double, 8, 8> mat1(lao::linalg::filltype::eye);
+
+    const double* first = nullptr;
+    for (int iter = 0; iter < 3; ++iter) {
+        lao::linalg::ScopedArena scope(arena);
+        EXPECT_EQ(lao::linalg::current_resource(), &arena);
+
+        lao::linalg::ArenaMatrix<double, 8, 8> mat2 = 2.0 * mat1;
+        lao::linalg::ArenaMatrix<double, 8, 8> mat3 = mat2;
+        EXPECT_DOUBLE_EQ(mat3(3, 3), 2.0);
+        EXPECT_DOUBLE_EQ(mat3(3, 4), 0.0);
+
+        // each iteration reuses the same memory.
+        if (first == nullptr)
+            first = mat2.data();
+        EXPECT_EQ(mat2.data(), first);
+        EXPECT_GE(reinterpret_cast<const std::byte*>(mat3.data()), reinterpret_cast<const std::byte*>(first) + sizeof(double) * 64);
+    }
+    EXPECT_NE(lao::linalg::current_resource(), &arena);
+    EXPECT_EQ(arena.blocks(), 1u);
+
+    // allocations which outgrow the arena add a block rather than failing.
+    {
+        lao::linalg::ScopedArena scope(arena);
+        lao::linalg::ArenaMatrix<double, Dynamic, Dynamic> mat4(40, 40);
+        mat4.fill(1.0);
+        EXPECT_DOUBLE_EQ(mat4(40, 40), 1.0);
+        EXPECT_EQ(arena.blocks(), 2u);
+    }
+
+    // outside of a scope arena storage falls back to the default resource.
+    lao::linalg::ArenaMatrix<double, 2, 2> mat5 { { 1.0, 2.0 }, { 3.0, 4.0 } };
+    EXPECT_EQ(mat5.data()[2], 3.0);
+}
+
+/// @brief Test that moves take over heap storage, and that rvalue and in-place evaluation reuse it.
+TEST_F(MatrixTest, MoveSemantics)
+{
+    using lao::linalg::Dynamic;
+    using DynamicMatrix = lao::linalg::Matrix<double, Dynamic, Dynamic>;
+    static_assert(std::is_nothrow_move_constructible_v<DynamicMatrix>);
+    static_assert(std::is_nothrow_move_assignable_v<DynamicMatrix>);
+
+    DynamicMatrix mat1(3, 4, lao::linalg::filltype::ones);
+    const double* data = mat1.data();
+    DynamicMatrix mat2 = std::move(mat1);
+    EXPECT_EQ(mat2.data(), data);
+    EXPECT_EQ(mat2.rows(), 3u);
+    EXPECT_DOUBLE_EQ(mat2(3, 4), 1.0);
+    // the source is left empty, and usable again once resized.
+    EXPECT_EQ(mat1.rows(), 0u);
+    EXPECT_TRUE(mat1.is_empty());
+    mat1.resize(2, 2);
+    EXPECT_DOUBLE_EQ(mat1(2, 2), 0.0);
+
+    mat1 = std::move(mat2);
+    EXPECT_EQ(mat1.data(), data);
+    EXPECT_EQ(mat2.cols(), 0u);
+
+    // inline storage is copied, leaving the source as it was.
+    lao::linalg::Matrix<double, 2, 2> mat3 { { 1.0, 2.0 }, { 3.0, 4.0 } };
+    const lao::linalg::Matrix<double, 2, 2> mat4 = std::move(mat3);
+    EXPECT_DOUBLE_EQ(mat4(2, 1), 3.0);
+    EXPECT_DOUBLE_EQ(mat3(2, 1), 3.0);
+
+    // a vector of elements passed as an rvalue becomes the storage.
+    std::vector<double> elements(12, 2.0);
+    const double* buffer = elements.data();
+    const DynamicMatrix mat5(3, 4, std::move(elements));
+    EXPECT_EQ(mat5.data(), buffer);
+    EXPECT_DOUBLE_EQ(mat5(3, 4), 2.0);
+    std::vector<double> fixed_elements(100, 1.0);
+    buffer = fixed_elements.data();
+    lao::linalg::Matrix<double, 10, 10> mat6(std::move(fixed_elements));
+    EXPECT_EQ(mat6.data(), buffer);
+
+    // a fixed-size matrix on the heap keeps its shape once moved from and reads as zeros, while
+    // move assignment swaps storage.
+    using FixedMatrix = lao::linalg::Matrix<double, 10, 10>;
+    static_assert(std::is_nothrow_move_constructible_v<FixedMatrix>);
+    static_assert(std::is_nothrow_move_assignable_v<FixedMatrix>);
+    FixedMatrix fixed_moved(std::move(mat6));
+    EXPECT_EQ(fixed_moved.data(), buffer);
+    EXPECT_EQ(mat6.rows(), 10u);
+    EXPECT_TRUE(mat6.is_empty());
+    EXPECT_DOUBLE_EQ(std::as_const(mat6)(1, 1), 0.0);
+    EXPECT_DOUBLE_EQ(std::as_const(mat6)(10, 10), 0.0);
+    const FixedMatrix fixed_sum = lao::linalg::eval(mat6 + fixed_moved);
+    EXPECT_DOUBLE_EQ(fixed_sum(10, 10), 1.0);
+    mat6(5, 5) = 3.0;
+    EXPECT_DOUBLE_EQ(mat6(5, 6), 0.0);
+    const double* written = mat6.data();
+    fixed_moved = std::move(mat6);
+    EXPECT_EQ(fixed_moved.data(), written);
+    EXPECT_EQ(mat6.data(), buffer);
+    EXPECT_DOUBLE_EQ(mat6(5, 5), 1.0);
+    std::swap(mat6, fixed_moved);
+    EXPECT_EQ(mat6.data(), written);
+    EXPECT_DOUBLE_EQ(mat6(5, 5), 3.0);
+    mat6 = fixed_sum + fixed_sum;
+    EXPECT_DOUBLE_EQ(mat6(10, 10), 2.0);
+    EXPECT_THROW((DynamicMatrix(2, 2, std::vector<double>(3))), std::invalid_argument);
+
+    // evaluating into a matrix of the same shape keeps its storage.
+    DynamicMatrix mat7(3, 4);
+    const double* out = mat7.data();
+    lao::linalg::eval_into(mat5 + 2.0 * mat5, mat7);
+    EXPECT_EQ(mat7.data(), out);
+    EXPECT_DOUBLE_EQ(mat7(2, 3), 6.0);
+
+    DynamicMatrix mat8;
+    lao::linalg::concat(mat5, mat7, mat8);
+    EXPECT_EQ(mat8.cols(), 8u);
+    out = mat8.data();
+    lao::linalg::concat(mat7, mat5, mat8);
+    EXPECT_EQ(mat8.data(), out);
+    EXPECT_DOUBLE_EQ(mat8(1, 1), 6.0);
+    EXPECT_DOUBLE_EQ(mat8(1, 8), 2.0);
+}
+
+/// @brief Test that the instrumentation compiles to nothing when it is off, as by default.
+TEST_F(MatrixTest, InstrumentationOff)
+{
+    static_assert(!lao::instrumentation::enabled);
+    static_assert(std::is_empty_v<lao::instrumentation::ScopedTimer>);
+    const lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> A(8, 8);
+    const auto B = A;
+    EXPECT_EQ(B.rows(), 8u);
+    EXPECT_EQ(lao::instrumentation::snapshot().allocations, 0u);
+    EXPECT_EQ(lao::instrumentation::thread_snapshot().copies, 0u);
+}
+
+/// @brief Test that views read and write the elements of the viewed matrix in place.
+TEST_F(MatrixTest, Views)
+{
+    using lao::linalg::Dynamic;
+    lao::linalg::Matrix<double, 4, 5> mat;
+    for (size_t i = 1; i <= 4; ++i)
+        for (size_t j = 1; j <= 5; ++j)
+            mat(i, j) = 10.0 * i + j;
+
+    auto block = mat.submat(2, 2, 3, 4);
+    static_assert(std::is_same_v<decltype(block), lao::linalg::MatrixView<double, Dynamic, Dynamic>>);
+    EXPECT_EQ(block.rows(), 2u);
+    EXPECT_EQ(block.cols(), 3u);
+    EXPECT_EQ(block.data(), &mat(2, 2));
+    EXPECT_EQ(block.row_stride(), 5u);
+    EXPECT_DOUBLE_EQ(block(2, 3), 34.0);
+    block(1, 1) = -1.0;
+    EXPECT_DOUBLE_EQ(mat(2, 2), -1.0);
+    EXPECT_THROW(block(3, 1), std::out_of_range);
+    EXPECT_THROW(mat.submat(0, 1, 2, 2), std::out_of_range);
+    EXPECT_THROW(mat.submat(1, 1, 5, 2), std::out_of_range);
+    EXPECT_THROW(mat.submat(2, 1, 1, 2), std::out_of_range);
+
+    // rows and columns keep the fixed extent of the matrix.
+    auto row = mat.rview(3);
+    auto col = mat.cview(5);
+    static_assert(decltype(row)::col_extent == 5 && decltype(col)::row_extent == 4);
+    EXPECT_DOUBLE_EQ(row(1, 5), 35.0);
+    EXPECT_DOUBLE_EQ(col(4, 1), 45.0);
+    EXPECT_EQ(mat.rviews(2, 3).rows(), 2u);
+    EXPECT_EQ(mat.cviews(2, 5).cols(), 4u);
+    EXPECT_THROW(mat.rview(5), std::out_of_range);
+    EXPECT_THROW(mat.cview(0), std::out_of_range);
+
+    // views take part in expressions, and are assigned from them.
+    const lao::linalg::Matrix<double, 1, 5> sum = mat.rview(1) + 2.0 * mat.rview(4);
+    EXPECT_DOUBLE_EQ(sum(1, 2), 12.0 + 2.0 * 42.0);
+    mat.rview(4) = mat.rview(1) - mat.rview(4);
+    EXPECT_DOUBLE_EQ(mat(4, 3), 13.0 - 43.0);
+    mat.cview(1).fill(7.0);
+    EXPECT_DOUBLE_EQ(mat(3, 1), 7.0);
+    EXPECT_DOUBLE_EQ(mat(3, 2), 32.0);
+    EXPECT_THROW(block = mat.submat(1, 1, 3, 3), std::invalid_argument);
+
+    // assigning one view to another copies the elements rather than rebinding.
+    auto first = mat.rview(1);
+    first = mat.rview(2);
+    EXPECT_EQ(first.data(), mat.data());
+    EXPECT_DOUBLE_EQ(mat(1, 2), -1.0);
+
+    // views of views, and read-only views of const matrices.
+    auto inner = mat.submat(2, 2, 4, 5).submat<2, 2>(2, 3);
+    EXPECT_EQ(inner.data(), &mat(3, 4));
+    const auto& cmat = mat;
+    const lao::linalg::MatrixView<const double, 1, 5> crow = cmat.rview(2);
+    const lao::linalg::MatrixView<const double, 1, 5> converted = mat.rview(2);
+    EXPECT_EQ(crow.data(), converted.data());
+    static_assert(!std::is_assignable_v<decltype(crow)&, decltype(crow)>);
+    const lao::linalg::Matrix<double, 1, 5> copy = crow;
+    EXPECT_DOUBLE_EQ(copy(1, 2), -1.0);
+
+    // a strided view of every other row and column.
+    auto strided = mat.submat(1, 1, 4, 5, 2, 2);
+    EXPECT_EQ(strided.rows(), 2u);
+    EXPECT_EQ(strided.cols(), 3u);
+    EXPECT_DOUBLE_EQ(strided(2, 3), mat(3, 5));
+    strided.zeros();
+    EXPECT_DOUBLE_EQ(mat(3, 5), 0.0);
+    EXPECT_DOUBLE_EQ(mat(3, 4), 34.0);
+    EXPECT_THROW(mat.submat(1, 1, 4, 5, 0, 1), std::invalid_argument);
+
+    // column-major matrices are viewed with their own layout.
+    lao::linalg::ColMajorMatrix<double, 3, 3> cm { { 1.0, 2.0, 3.0 }, { 4.0, 5.0, 6.0 }, { 7.0, 8.0, 9.0 } };
+    auto cmcol = cm.cview(2);
+    EXPECT_EQ(cmcol.col_stride(), 3u);
+    EXPECT_EQ(cmcol.row_stride(), 1u);
+    cmcol = cm.cview(3);
+    EXPECT_DOUBLE_EQ(cm(2, 2), 6.0);
+    const lao::linalg::Matrix<double, 1, 3> cmrow = cm.rview(3);
+    EXPECT_DOUBLE_EQ(cmrow(1, 2), 9.0);
+}
+
+/// @brief Test assigning between views which overlap in the same matrix.
+TEST_F(MatrixTest, OverlappingViews)
+{
+    lao::linalg::Matrix<double, 3, 6> mat;
+    for (size_t i = 1; i <= 3; ++i)
+        for (size_t j = 1; j <= 6; ++j)
+            mat(i, j) = 10.0 * i + j;
+
+    // shifted forward and backward along a row, through views of the same type and as expressions.
+    auto row = mat.rview(2);
+    row.submat(1, 2, 1, 6) = row.submat(1, 1, 1, 5);
+    for (size_t j = 2; j <= 6; ++j)
+        EXPECT_DOUBLE_EQ(mat(2, j), 20.0 + j - 1);
+    mat.submat<1, 5>(3, 1) = mat.submat(3, 2, 3, 6);
+    for (size_t j = 1; j <= 5; ++j)
+        EXPECT_DOUBLE_EQ(mat(3, j), 30.0 + j + 1);
+
+    // a block shifted down and right, and a square block replaced by its own transpose.
+    mat.submat(2, 2, 3, 4) = mat.submat(1, 1, 2, 3);
+    EXPECT_DOUBLE_EQ(mat(2, 2), 11.0);
+    EXPECT_DOUBLE_EQ(mat(3, 4), 22.0);
+    lao::linalg::Matrix<double, 3, 3> square { { 1.0, 2.0, 3.0 }, { 4.0, 5.0, 6.0 }, { 7.0, 8.0, 9.0 } };
+    auto all = square.submat(1, 1, 3, 3);
+    all = lao::linalg::transpose(all);
+    EXPECT_DOUBLE_EQ(square(1, 3), 7.0);
+    EXPECT_DOUBLE_EQ(square(3, 1), 3.0);
+    EXPECT_DOUBLE_EQ(square(2, 3), 8.0);
+
+    // views which coincide are assigned in place.
+    all = square.submat(1, 1, 3, 3);
+    EXPECT_DOUBLE_EQ(square(3, 2), 6.0);
+}
+
+/// @brief Test that rows of a row-major matrix and columns of a column-major one are evaluated a
+/// packet at a time, like the matrix, and that other views are not.
+TEST_F(MatrixTest, ViewPacketEvaluation)
+{
+    lao::linalg::Matrix<double, 4, 9> mat;
+    double val = 0.0;
+    mat.fillf([&]() { return val += 1.5; });
+
+    auto row_expr = mat.rview(2) + 0.5 * mat.rview(3);
+    static_assert(decltype(row_expr)::packet_access);
+    static_assert(!decltype(mat.cview(2))::linear_access);
+    static_assert(!decltype(mat.submat<2, 3>(1, 1))::linear_access);
+    static_assert(!decltype(mat.submat(1, 1, 4, 9, 1, 2))::linear_access);
+    const lao::linalg::RowVector<double, 9> row = row_expr;
+    for (size_t j = 1; j <= 9; ++j)
+        EXPECT_DOUBLE_EQ(row(1, j), mat(2, j) + 0.5 * mat(3, j));
+
+    // a row of a dynamic matrix shifted by a step along another, as in r = r + dt * v.
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> state(2, 7);
+    state.fillf([&]() { return val -= 0.25; });
+    lao::linalg::Matrix<double, 1, lao::linalg::Dynamic> position = state.rview(1);
+    position = position + 2.0 * state.rview(2);
+    for (size_t j = 1; j <= 7; ++j)
+        EXPECT_DOUBLE_EQ(position(1, j), state(1, j) + 2.0 * state(2, j));
+
+    lao::linalg::ColMajorMatrix<double, 9, 4> cm;
+    cm.fillf([&]() { return val += 0.5; });
+    auto col_expr = cm.cview(4) - cm.cview(1);
+    static_assert(decltype(col_expr)::packet_access);
+    static_assert(!decltype(cm.rview(1))::linear_access);
+    const lao::linalg::ColMajorMatrix<double, 9, 1> col = col_expr;
+    for (size_t i = 1; i <= 9; ++i)
+        EXPECT_DOUBLE_EQ(col(i, 1), cm(i, 4) - cm(i, 1));
+}
+
+/// @brief Test that views feed the product and LU kernels without copies.
+TEST_F(MatrixTest, ViewKernels)
+{
+    using lao::linalg::Dynamic;
+    using DynamicMatrix = lao::linalg::Matrix<double, Dynamic, Dynamic>;
+    const DynamicMatrix A(80, 80, lao::linalg::filltype::rand);
+    const DynamicMatrix B(80, 40, lao::linalg::filltype::rand);
+    DynamicMatrix big(100, 100, lao::linalg::filltype::ones);
+    const double* data = big.data();
+
+    // the product is written straight into the block, leaving the rest of big untouched.
+    big.submat(11, 21, 90, 60).noalias() = A * B;
+    EXPECT_EQ(big.data(), data);
+    const DynamicMatrix expected = A * B;
+    for (size_t i = 1; i <= 80; i += 7)
+        for (size_t j = 1; j <= 40; j += 3)
+            EXPECT_NEAR(big(i + 10, j + 20), expected(i, j), 1e-12);
+    EXPECT_DOUBLE_EQ(big(10, 21), 1.0);
+    EXPECT_DOUBLE_EQ(big(91, 60), 1.0);
+    EXPECT_DOUBLE_EQ(big(50, 61), 1.0);
+
+    // a product of blocks of the same matrix assigned into another block of it.
+    DynamicMatrix C(6, 6, lao::linalg::filltype::rand);
+    const DynamicMatrix D = C;
+    C.submat(1, 1, 3, 3) = C.submat(4, 4, 6, 6) * C.submat(1, 4, 3, 6);
+    const DynamicMatrix product = D.submat(4, 4, 6, 6) * D.submat(1, 4, 3, 6);
+    EXPECT_NEAR(C(3, 2), product(3, 2), 1e-14);
+    EXPECT_DOUBLE_EQ(C(4, 1), D(4, 1));
+
+    // fixed-size blocks of a state transition matrix go through the unrolled kernels.
+    lao::linalg::Matrix<double, 6, 6> phi(lao::linalg::filltype::eye);
+    phi.submat<3, 3>(1, 4) = lao::linalg::Matrix<double, 3, 3>(lao::linalg::filltype::eye) * 2.0;
+    const lao::linalg::Matrix<double, 3, 1> dr = phi.submat<3, 3>(1, 4) * lao::linalg::transpose(phi.submat<1, 3>(4, 4));
+    EXPECT_DOUBLE_EQ(dr(1, 1), 2.0);
+    EXPECT_DOUBLE_EQ(dr(2, 1), 0.0);
+
+    // LU factorization and solves read the blocks in place.
+    DynamicMatrix system(12, 13, lao::linalg::filltype::rand);
+    for (size_t i = 1; i <= 12; ++i)
+        system(i, i) += 12.0;
+    const lao::linalg::LUFactorization<double, Dynamic> lu(system.submat(1, 1, 12, 12));
+    const DynamicMatrix x = lu.solve(system.cview(13));
+    const DynamicMatrix residual = system.submat(1, 1, 12, 12) * x - system.cview(13);
+    for (size_t i = 1; i <= 12; ++i)
+        EXPECT_NEAR(residual(i, 1), 0.0, 1e-12);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
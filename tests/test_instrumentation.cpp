@@ -0,0 +1,245 @@
+// the instrumentation is compiled in for this test alone, every other test runs with it off.
+#define LAO_INSTRUMENTATION (true)
+
+#include <cmath>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <lao/lao.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace instrumentation = lao::instrumentation;
+
+class InstrumentationTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        instrumentation::reset();
+    }
+
+    void TearDown() override
+    {
+        instrumentation::set_sink({});
+    }
+};
+
+/// @brief Test that copies of heap matrices count an allocation and a copy, and inline ones only a copy.
+TEST_F(InstrumentationTest, Allocations)
+{
+    static_assert(instrumentation::enabled);
+    const auto before = instrumentation::thread_snapshot();
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> A(10, 20);
+    auto after = instrumentation::thread_snapshot();
+    EXPECT_EQ(after.allocations - before.allocations, 1u);
+    EXPECT_EQ(after.allocated_bytes - before.allocated_bytes, 200 * sizeof(double));
+    EXPECT_EQ(after.copies, before.copies);
+
+    const auto B = A;
+    after = instrumentation::thread_snapshot();
+    EXPECT_EQ(after.allocations - before.allocations, 2u);
+    EXPECT_EQ(after.copies - before.copies, 1u);
+    EXPECT_EQ(after.copied_bytes - before.copied_bytes, 200 * sizeof(double));
+
+    // assigning into storage which is already large enough copies without allocating.
+    A = B;
+    after = instrumentation::thread_snapshot();
+    EXPECT_EQ(after.allocations - before.allocations, 2u);
+    EXPECT_EQ(after.copies - before.copies, 2u);
+
+    const lao::linalg::Matrix<double, 3, 3> C(lao::linalg::filltype::eye);
+    const auto D = C;
+    const auto fixed = instrumentation::thread_snapshot();
+    EXPECT_EQ(fixed.allocations, after.allocations);
+    EXPECT_EQ(fixed.copies - after.copies, 1u);
+    EXPECT_DOUBLE_EQ(D(2, 2), 1.0);
+
+    // moves of a fixed-size heap matrix do not allocate, and one left without storage by a move
+    // counts the allocation made by its first write.
+    lao::linalg::Matrix<double, 10, 10> E(lao::linalg::filltype::ones);
+    lao::linalg::Matrix<double, 10, 10> F(lao::linalg::filltype::eye);
+    const auto moves = instrumentation::thread_snapshot();
+    std::swap(E, F);
+    auto G = std::move(E);
+    F = std::move(G);
+    EXPECT_EQ(instrumentation::thread_snapshot().allocations, moves.allocations);
+    EXPECT_DOUBLE_EQ(G.coeff(3, 3), 1.0);
+    G.fill(2.0);
+    EXPECT_EQ(instrumentation::thread_snapshot().allocations - moves.allocations, 0u);
+    auto H = std::move(F);
+    F(1, 1) = 4.0;
+    after = instrumentation::thread_snapshot();
+    EXPECT_EQ(after.allocations - moves.allocations, 1u);
+    EXPECT_EQ(after.allocated_bytes - moves.allocated_bytes, 100 * sizeof(double));
+    EXPECT_DOUBLE_EQ(F(2, 2), 0.0);
+    EXPECT_DOUBLE_EQ(H(1, 1), 1.0);
+
+    // a state of the low precision ephemerides is built without any heap allocation.
+    const auto body = lao::astro::JPLLP("Mars");
+    const auto eph_before = instrumentation::thread_snapshot();
+    const auto state = body.eph(lao::astro::Epoch(1000.0));
+    EXPECT_EQ(instrumentation::thread_snapshot().allocations, eph_before.allocations);
+    EXPECT_GT(state(1, 1) * state(1, 1), 0.0);
+}
+
+/// @brief Test that moves, rvalue construction and the in-place overloads make no redundant
+/// copies or allocations, and that a steady-state eph call makes none at all.
+TEST_F(InstrumentationTest, NoRedundantCopies)
+{
+    using DynamicMatrix = lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic>;
+    DynamicMatrix A(6, 6, lao::linalg::filltype::eye);
+    const DynamicMatrix B(6, 2, lao::linalg::filltype::ones);
+    auto before = instrumentation::thread_snapshot();
+    DynamicMatrix moved = std::move(A);
+    A = std::move(moved);
+    const DynamicMatrix owned(6, 6, std::vector<double>(36, 1.0));
+    auto after = instrumentation::thread_snapshot();
+    EXPECT_EQ(after.allocations, before.allocations);
+    EXPECT_EQ(after.copies, before.copies);
+
+    // returned by value, the concatenation is allocated once and never copied.
+    const DynamicMatrix C = lao::linalg::concat(A, B);
+    after = instrumentation::thread_snapshot();
+    EXPECT_EQ(after.allocations - before.allocations, 1u);
+    EXPECT_EQ(after.copies, before.copies);
+    DynamicMatrix D;
+    lao::linalg::concat(A, B, D);
+    before = instrumentation::thread_snapshot();
+    for (int k = 0; k < 10; ++k) {
+        lao::linalg::concat(B, A, D);
+        lao::linalg::eval_into(owned + 2.0 * A, A);
+    }
+    after = instrumentation::thread_snapshot();
+    EXPECT_EQ(after.allocations, before.allocations);
+    EXPECT_EQ(after.copies, before.copies);
+    EXPECT_DOUBLE_EQ(D(1, 1), 1.0);
+    EXPECT_EQ(C.cols(), 8u);
+
+    const auto mars = lao::astro::JPLLP("Mars");
+    const lao::astro::EphemerisCache cache(mars, 0.0, 100.0, 10.0);
+    lao::linalg::RowVector<double, 6> state;
+    lao::linalg::RowVector<double, 6> cached;
+    before = instrumentation::thread_snapshot();
+    for (int k = 0; k < 10; ++k) {
+        const lao::astro::Epoch epoch(10.0 * k + 0.5);
+        state = mars.eph(epoch);
+        mars.eph(epoch, state);
+        cached = cache.eph(epoch);
+        cache.eph(epoch, cached);
+    }
+    const lao::linalg::Matrix<double, 3, 3> R = lao::astro::rotationFromEuler(std::string("ZXZ"), lao::linalg::RowVector<double, 3>({ 0.1, 0.2, 0.3 }));
+    after = instrumentation::thread_snapshot();
+    EXPECT_EQ(after.allocations, before.allocations);
+    EXPECT_EQ(after.copies, before.copies);
+    EXPECT_NEAR(state(1, 1), cached(1, 1), 1e-3 * std::abs(state(1, 1)));
+    EXPECT_NEAR(R(3, 3), std::cos(0.2), 1e-15);
+}
+
+/// @brief Test that the solvers record their iterations, residuals and outcome.
+TEST_F(InstrumentationTest, Solvers)
+{
+    const size_t n = 50;
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> A(n, n);
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> b(n, 1);
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> x(n, 1);
+    for (size_t i = 1; i <= n; ++i) {
+        A(i, i) = 4.0;
+        if (i > 1)
+            A(i, i - 1) = -1.0;
+        if (i < n)
+            A(i, i + 1) = -1.0;
+        b(i, 1) = 1.0;
+    }
+
+    const auto result = lao::linalg::solve_jacobi_element(x, A, b, 1000, 1e-10);
+    ASSERT_TRUE(result.converged);
+    auto stats = instrumentation::snapshot().solver(instrumentation::Solver::jacobi);
+    EXPECT_EQ(stats.solves, 1u);
+    EXPECT_EQ(stats.iterations, result.iterations);
+    EXPECT_EQ(stats.unconverged, 0u);
+    EXPECT_DOUBLE_EQ(stats.max_residual, result.residual);
+    EXPECT_EQ(instrumentation::snapshot().kernel(instrumentation::Kernel::iterative).calls, 1u);
+
+    // stopped at the iteration limit.
+    const auto limited = lao::linalg::solve_jacobi_element(x, A, b, 2, 1e-10);
+    ASSERT_FALSE(limited.converged);
+    stats = instrumentation::snapshot().solver(instrumentation::Solver::jacobi);
+    EXPECT_EQ(stats.solves, 2u);
+    EXPECT_EQ(stats.iterations, result.iterations + 2);
+    EXPECT_EQ(stats.unconverged, 1u);
+    EXPECT_DOUBLE_EQ(stats.max_residual, limited.residual);
+
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> refined(n, 1);
+    const auto mixed = lao::linalg::mixed_precision_solve(A, refined, b);
+    ASSERT_TRUE(mixed.converged);
+    const auto refinement = instrumentation::snapshot().solver(instrumentation::Solver::refinement);
+    EXPECT_EQ(refinement.solves, 1u);
+    EXPECT_EQ(refinement.iterations, mixed.iterations);
+    EXPECT_DOUBLE_EQ(refinement.max_residual, mixed.residual);
+
+    const double E = lao::astro::meanAnomalyToEccentricAnomaly(1.0, 0.5);
+    EXPECT_NEAR(E - 0.5 * std::sin(E), 1.0, 1e-12);
+    const auto newton = instrumentation::thread_snapshot().solver(instrumentation::Solver::newton);
+    EXPECT_EQ(newton.solves, 1u);
+    EXPECT_GT(newton.iterations, 1u);
+    EXPECT_LT(newton.iterations, 100u);
+    EXPECT_EQ(newton.unconverged, 0u);
+
+    // one solve per propagated object, the one at the origin not converged.
+    lao::astro::StateBatch states(2, 6);
+    states(1, 1) = 1.5e11;
+    states(1, 5) = 3e4;
+    EXPECT_EQ(lao::astro::propagateKepler(states, 1.327e20, 86400.0, states), 1u);
+    const auto propagation = instrumentation::snapshot().solver(instrumentation::Solver::propagation);
+    EXPECT_EQ(propagation.solves, 2u);
+    EXPECT_EQ(propagation.unconverged, 1u);
+    EXPECT_TRUE(std::isfinite(states(1, 1)));
+}
+
+/// @brief Test that kernels are timed, and the sink sees every event with counters summed across threads.
+TEST_F(InstrumentationTest, KernelsAndSink)
+{
+    std::mutex mutex;
+    std::vector<instrumentation::Event> events;
+    instrumentation::set_sink([&](const instrumentation::Event& event) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(event);
+    });
+
+    const lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> A(64, 64, lao::linalg::filltype::rand);
+    const lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> B = A * A;
+    EXPECT_EQ(B.rows(), 64u);
+    const auto gemm = instrumentation::snapshot().kernel(instrumentation::Kernel::gemm);
+    EXPECT_EQ(gemm.calls, 1u);
+    EXPECT_GT(gemm.nanoseconds, 0u);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT_EQ(events.size(), 1u);
+        EXPECT_EQ(events[0].type, instrumentation::Event::Type::kernel);
+        EXPECT_EQ(events[0].kernel, instrumentation::Kernel::gemm);
+        EXPECT_EQ(events[0].nanoseconds, gemm.nanoseconds);
+    }
+
+    // counters of threads which have exited are kept, and their events reach the sink.
+    std::thread([]() { lao::astro::meanAnomalyToEccentricAnomaly(2.0, 0.1); }).join();
+    EXPECT_EQ(instrumentation::snapshot().solver(instrumentation::Solver::newton).solves, 1u);
+    EXPECT_EQ(instrumentation::thread_snapshot().solver(instrumentation::Solver::newton).solves, 0u);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT_EQ(events.size(), 2u);
+        EXPECT_EQ(events[1].type, instrumentation::Event::Type::solve);
+        EXPECT_EQ(events[1].solver, instrumentation::Solver::newton);
+        EXPECT_TRUE(events[1].converged);
+    }
+
+    instrumentation::set_sink({});
+    const auto C = A * A;
+    EXPECT_EQ(C.rows(), 64u);
+    EXPECT_EQ(events.size(), 2u);
+
+    instrumentation::reset();
+    const auto cleared = instrumentation::snapshot();
+    EXPECT_EQ(cleared.kernel(instrumentation::Kernel::gemm).calls, 0u);
+    EXPECT_EQ(cleared.solver(instrumentation::Solver::newton).solves, 0u);
+    EXPECT_EQ(cleared.allocations, 0u);
+}
@@ -1,12 +1,15 @@
+#include <cmath>
 #include <cstddef>
 #include <gtest/gtest.h>
 #include <lao/lao.hpp>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 class MatrixTest : public ::testing::Test {
 protected:
-    template <typename S, size_t R, size_t C>
-    bool matricesEqual(const lao::linalg::Matrix<S, R, C>& mat1, const lao::linalg::Matrix<S, R, C>& mat2) const
+    template <typename M1, typename M2>
+    bool matricesEqual(const M1& mat1, const M2& mat2) const
     {
         for (size_t i = 1; i <= mat1.rows(); ++i) {
             for (size_t j = 1; j <= mat1.cols(); ++j) {
@@ -113,6 +116,456 @@ TEST_F(MatrixTest, ElementWiseEquality)
     EXPECT_EQ(matricesEqual(mat1, mat3), false);
 }
 
+/// @brief Test a product large enough to go through the blocked GEMM path, with ragged edges.
+TEST_F(MatrixTest, BlockedMatrixMultiplication)
+{
+    lao::linalg::Matrix<double, 67, 45> mat1;
+    lao::linalg::Matrix<double, 45, 83> mat2;
+    double val = 0.0;
+    mat1.fillf([&]() { return val = std::fmod(val + 0.37, 3.0) - 1.0; });
+    mat2.fillf([&]() { return val = std::fmod(val + 0.53, 5.0) - 2.0; });
+
+    lao::linalg::Matrix<double, 67, 83> mat3 = mat1 * mat2;
+
+    for (size_t i = 1; i <= mat3.rows(); ++i) {
+        for (size_t j = 1; j <= mat3.cols(); ++j) {
+            double expected = 0.0;
+            for (size_t k = 1; k <= mat1.cols(); ++k)
+                expected += mat1(i, k) * mat2(k, j);
+            EXPECT_NEAR(mat3(i, j), expected, 1e-12);
+        }
+    }
+}
+
+/// @brief Test the blocked GEMM path with an integral scalar type.
+TEST_F(MatrixTest, BlockedIntegerMatrixMultiplication)
+{
+    lao::linalg::Matrix<int, 40, 40> mat1(lao::linalg::filltype::eye);
+    lao::linalg::Matrix<int, 40, 40> mat2;
+    int val = 0;
+    mat2.fillf([&]() { return val++ % 7; });
+
+    lao::linalg::Matrix<int, 40, 40> mat3 = 2 * mat1 * mat2;
+    lao::linalg::Matrix<int, 40, 40> result = 2 * mat2;
+
+    EXPECT_EQ(matricesEqual(mat3, result), true);
+}
+
+/// @brief Test the GEMM kernel directly with strided operands and an accumulating beta.
+TEST_F(MatrixTest, GemmStridedOperands)
+{
+    // A is 2x3 stored column-major, B is 3x2 row-major, C is 2x2 row-major.
+    std::vector<double> A = { 1, 4, 2, 5, 3, 6 };
+    std::vector<double> B = { 7, 8, 9, 10, 11, 12 };
+    std::vector<double> C = { 1, 1, 1, 1 };
+
+    lao::linalg::gemm<double>(2, 2, 3, 2.0, A.data(), 1, 2, B.data(), 2, 1, 1.0, C.data(), 2, 1);
+
+    EXPECT_DOUBLE_EQ(C[0], 2 * 58 + 1);
+    EXPECT_DOUBLE_EQ(C[1], 2 * 64 + 1);
+    EXPECT_DOUBLE_EQ(C[2], 2 * 139 + 1);
+    EXPECT_DOUBLE_EQ(C[3], 2 * 154 + 1);
+}
+
+/// @brief Test that products nested in other expressions are materialized once.
+TEST_F(MatrixTest, NestedProductMaterialization)
+{
+    lao::linalg::Matrix<int, 2, 2> mat1 { { 1, 2 }, { 3, 4 } };
+    lao::linalg::Matrix<int, 2, 2> mat2 { { 5, 6 }, { 7, 8 } };
+    lao::linalg::Matrix<int, 2, 2> mat3 { { 9, 10 }, { 11, 12 } };
+
+    auto nested = (mat1 + mat2) * mat3;
+    EXPECT_TRUE((lao::linalg::MatrixMultiplication<int, 2, 2, lao::linalg::MatrixAddition<int, 2, 2, lao::linalg::Matrix<int, 2, 2>, lao::linalg::Matrix<int, 2, 2>>, lao::linalg::Matrix<int, 2, 2>>::materialize_when_nested));
+    EXPECT_FALSE((lao::linalg::MatrixAddition<int, 2, 2, lao::linalg::Matrix<int, 2, 2>, lao::linalg::Matrix<int, 2, 2>>::materialize_when_nested));
+
+    lao::linalg::Matrix<int, 2, 2> result1 { { 142, 156 }, { 222, 244 } };
+    lao::linalg::Matrix<int, 2, 2> mat4 = nested;
+    EXPECT_EQ(matricesEqual(mat4, result1), true);
+
+    lao::linalg::Matrix<int, 2, 2> result2 { { 24, 28 }, { 50, 58 } };
+    mat4 = mat1 * mat2 + mat3 - mat1 * mat2 + mat1 * mat2 - mat3 + mat2;
+    EXPECT_EQ(matricesEqual(mat4, result2), true);
+}
+
+/// @brief Test assigning a product into one of its own operands.
+TEST_F(MatrixTest, AliasedProductAssignment)
+{
+    lao::linalg::Matrix<int, 2, 2> mat1 { { 1, 2 }, { 3, 4 } };
+    lao::linalg::Matrix<int, 2, 2> mat2 { { 5, 6 }, { 7, 8 } };
+
+    lao::linalg::Matrix<int, 2, 2> result { { 19, 22 }, { 43, 50 } };
+
+    mat1 = mat1 * mat2;
+
+    EXPECT_EQ(matricesEqual(mat1, result), true);
+}
+
+/// @brief Test noalias assignment and explicit evaluation.
+TEST_F(MatrixTest, NoAliasAndEval)
+{
+    lao::linalg::Matrix<int, 2, 2> mat1 { { 1, 2 }, { 3, 4 } };
+    lao::linalg::Matrix<int, 2, 2> mat2 { { 5, 6 }, { 7, 8 } };
+    lao::linalg::Matrix<int, 2, 2> mat3;
+
+    lao::linalg::Matrix<int, 2, 2> result { { 19, 22 }, { 43, 50 } };
+
+    mat3.noalias() = mat1 * mat2;
+    EXPECT_EQ(matricesEqual(mat3, result), true);
+
+    auto sum = lao::linalg::eval(mat1 + mat2);
+    EXPECT_TRUE((std::is_same_v<decltype(sum), lao::linalg::Matrix<int, 2, 2>>));
+    EXPECT_EQ(sum(2, 2), 12);
+
+    mat3.reset();
+    mat3.noalias() = mat1 + mat2;
+    EXPECT_EQ(matricesEqual(mat3, sum), true);
+}
+
+/// @brief Test transposition, including assigning a transpose into its operand.
+TEST_F(MatrixTest, Transpose)
+{
+    lao::linalg::Matrix<int, 2, 3> mat1 { { 1, 2, 3 }, { 4, 5, 6 } };
+    lao::linalg::Matrix<int, 3, 2> result { { 1, 4 }, { 2, 5 }, { 3, 6 } };
+
+    lao::linalg::Matrix<int, 3, 2> mat2 = lao::linalg::transpose(mat1);
+    EXPECT_EQ(matricesEqual(mat2, result), true);
+
+    lao::linalg::Matrix<int, 2, 2> mat3 { { 1, 2 }, { 3, 4 } };
+    lao::linalg::Matrix<int, 2, 2> result2 { { 1, 3 }, { 2, 4 } };
+    mat3 = lao::linalg::transpose(mat3);
+    EXPECT_EQ(matricesEqual(mat3, result2), true);
+}
+
+/// @brief Test assigning element-wise expressions of a transpose into the transposed matrix.
+TEST_F(MatrixTest, AliasedElementWiseAssignment)
+{
+    static_assert(decltype(lao::linalg::Matrix<int, 3, 3>() + lao::linalg::transpose(lao::linalg::Matrix<int, 3, 3>()))::assume_aliasing);
+
+    lao::linalg::Matrix<int, 3, 3> mat1 { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+    lao::linalg::Matrix<int, 3, 3> result1 { { 2, 6, 10 }, { 6, 10, 14 }, { 10, 14, 18 } };
+    mat1 = mat1 + lao::linalg::transpose(mat1);
+    EXPECT_EQ(matricesEqual(mat1, result1), true);
+
+    lao::linalg::Matrix<int, 3, 3> mat2 { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+    lao::linalg::Matrix<int, 3, 3> result2 { { 2, 8, 14 }, { 4, 10, 16 }, { 6, 12, 18 } };
+    mat2 = 2 * lao::linalg::transpose(mat2);
+    EXPECT_EQ(matricesEqual(mat2, result2), true);
+
+    const size_t n = 40;
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> mat3(n, n);
+    for (size_t i = 1; i <= n; ++i)
+        for (size_t j = 1; j <= n; ++j)
+            mat3(i, j) = static_cast<double>(i * n + j);
+    mat3 = mat3 + lao::linalg::transpose(mat3);
+    for (size_t i = 1; i <= n; ++i)
+        for (size_t j = 1; j <= n; ++j)
+            EXPECT_DOUBLE_EQ(mat3(i, j), static_cast<double>(i * n + j + j * n + i));
+}
+
+/// @brief Test that element-wise expressions take the linear path and others do not.
+TEST_F(MatrixTest, LinearEvaluation)
+{
+    using Mat = lao::linalg::Matrix<int, 2, 3>;
+    Mat mat1 { { 1, 2, 3 }, { 4, 5, 6 } };
+    Mat mat2 { { 6, 5, 4 }, { 3, 2, 1 } };
+    lao::linalg::Matrix<int, 3, 2> mat3 { { 1, 1 }, { 1, 1 }, { 1, 1 } };
+
+    auto elementwise = 2 * (mat1 + mat2) - mat1 % mat2;
+    auto mixed = mat1 + lao::linalg::transpose(mat3);
+    EXPECT_TRUE(decltype(elementwise)::linear_access);
+    EXPECT_FALSE(decltype(mixed)::linear_access);
+
+    Mat result1 { { 8, 4, 2 }, { 2, 4, 8 } };
+    Mat result2 { { 2, 3, 4 }, { 5, 6, 7 } };
+    Mat mat4 = elementwise;
+    Mat mat5 = mixed;
+    EXPECT_EQ(matricesEqual(mat4, result1), true);
+    EXPECT_EQ(matricesEqual(mat5, result2), true);
+}
+
+/// @brief Test packet evaluation of fused element-wise and comparison expressions, with a scalar tail.
+TEST_F(MatrixTest, PacketEvaluation)
+{
+    using Mat = lao::linalg::Matrix<double, 7, 9>;
+    Mat mat1;
+    Mat mat2;
+    double val = 0.0;
+    mat1.fillf([&]() { return val = std::fmod(val + 1.0, 5.0); });
+    mat2.fillf([&]() { return val = std::fmod(val + 2.0, 7.0); });
+
+    auto expr = 0.5 * (mat1 + mat2) - mat1 % mat2;
+    EXPECT_TRUE(decltype(expr)::packet_access);
+
+    Mat result = expr;
+    Mat eq = mat1 == mat2;
+    Mat ne = mat1 != mat2;
+    Mat ge = mat1 >= mat2;
+    Mat gt = mat1 > mat2;
+    Mat le = mat1 <= mat2;
+    Mat lt = mat1 < mat2;
+
+    for (size_t i = 1; i <= result.rows(); ++i) {
+        for (size_t j = 1; j <= result.cols(); ++j) {
+            const double a = mat1(i, j);
+            const double b = mat2(i, j);
+            EXPECT_DOUBLE_EQ(result(i, j), 0.5 * (a + b) - a * b);
+            EXPECT_EQ(eq(i, j), a == b);
+            EXPECT_EQ(ne(i, j), a != b);
+            EXPECT_EQ(ge(i, j), a >= b);
+            EXPECT_EQ(gt(i, j), a > b);
+            EXPECT_EQ(le(i, j), a <= b);
+            EXPECT_EQ(lt(i, j), a < b);
+        }
+    }
+}
+
+/// @brief Test element-wise expressions over operands of the same and of mixed layouts.
+TEST_F(MatrixTest, MixedLayoutExpressions)
+{
+    lao::linalg::Matrix<int, 2, 3> row1 { { 1, 2, 3 }, { 4, 5, 6 } };
+    lao::linalg::ColMajorMatrix<int, 2, 3> col1 { { 1, 2, 3 }, { 4, 5, 6 } };
+    lao::linalg::ColMajorMatrix<int, 2, 3> col2 { { 6, 5, 4 }, { 3, 2, 1 } };
+
+    auto same = col1 + 2 * col2;
+    auto mixed = row1 + col2;
+    EXPECT_TRUE(decltype(same)::linear_access);
+    EXPECT_EQ(decltype(same)::layout, lao::linalg::Layout::ColMajor);
+    EXPECT_FALSE(decltype(mixed)::linear_access);
+
+    lao::linalg::Matrix<int, 2, 3> result1 { { 13, 12, 11 }, { 10, 9, 8 } };
+    lao::linalg::Matrix<int, 2, 3> result2 { { 7, 7, 7 }, { 7, 7, 7 } };
+    lao::linalg::ColMajorMatrix<int, 2, 3> mat1 = same;
+    lao::linalg::Matrix<int, 2, 3> mat2 = same;
+    lao::linalg::ColMajorMatrix<int, 2, 3> mat3 = mixed;
+    EXPECT_EQ(matricesEqual(mat1, result1), true);
+    EXPECT_EQ(matricesEqual(mat2, result1), true);
+    EXPECT_EQ(matricesEqual(mat3, result2), true);
+}
+
+/// @brief Test that the transpose of a column-major matrix is its storage read row-major.
+TEST_F(MatrixTest, ColumnMajorTranspose)
+{
+    lao::linalg::ColMajorMatrix<double, 3, 5> mat1;
+    double val = 0.0;
+    mat1.fillf([&]() { return val += 1.0; });
+
+    using Expr = decltype(lao::linalg::transpose(mat1));
+    EXPECT_TRUE(Expr::packet_access);
+    EXPECT_EQ(Expr::layout, lao::linalg::Layout::RowMajor);
+
+    lao::linalg::Matrix<double, 5, 3> mat2 = lao::linalg::transpose(mat1);
+    for (size_t i = 0; i < 15; ++i)
+        EXPECT_DOUBLE_EQ(mat2.coeff(i), mat1.coeff(i));
+    for (size_t i = 1; i <= mat2.rows(); ++i)
+        for (size_t j = 1; j <= mat2.cols(); ++j)
+            EXPECT_DOUBLE_EQ(mat2(i, j), mat1(j, i));
+
+    lao::linalg::Matrix<double, 5, 3> mat3 = lao::linalg::transpose(lao::linalg::transpose(mat2));
+    EXPECT_EQ(matricesEqual(mat3, mat2), true);
+}
+
+/// @brief Test products with column-major and transposed operands and destinations.
+TEST_F(MatrixTest, ColumnMajorMatrixMultiplication)
+{
+    lao::linalg::Matrix<double, 37, 29> row1;
+    lao::linalg::Matrix<double, 29, 41> row2;
+    double val = 0.0;
+    row1.fillf([&]() { return val = std::fmod(val + 0.37, 3.0) - 1.0; });
+    row2.fillf([&]() { return val = std::fmod(val + 0.53, 5.0) - 2.0; });
+    lao::linalg::ColMajorMatrix<double, 37, 29> col1 = row1;
+    lao::linalg::ColMajorMatrix<double, 29, 41> col2 = row2;
+    lao::linalg::Matrix<double, 29, 37> row1t = lao::linalg::transpose(row1);
+
+    lao::linalg::Matrix<double, 37, 41> expected = row1 * row2;
+    lao::linalg::Matrix<double, 37, 41> mat1 = col1 * col2;
+    lao::linalg::Matrix<double, 37, 41> mat2 = row1 * col2;
+    lao::linalg::ColMajorMatrix<double, 37, 41> mat3 = col1 * row2;
+    lao::linalg::Matrix<double, 37, 41> mat4 = lao::linalg::transpose(row1t) * row2;
+
+    for (size_t i = 1; i <= expected.rows(); ++i) {
+        for (size_t j = 1; j <= expected.cols(); ++j) {
+            EXPECT_NEAR(mat1(i, j), expected(i, j), 1e-12);
+            EXPECT_NEAR(mat2(i, j), expected(i, j), 1e-12);
+            EXPECT_NEAR(mat3(i, j), expected(i, j), 1e-12);
+            EXPECT_NEAR(mat4(i, j), expected(i, j), 1e-12);
+        }
+    }
+}
+
+/// @brief Test the unrolled products and transposes of fixed-size matrices.
+TEST_F(MatrixTest, FixedSizeKernels)
+{
+    lao::linalg::Matrix<double, 6, 6> mat1;
+    lao::linalg::ColMajorMatrix<double, 6, 6> mat2;
+    double val = 0.0;
+    mat1.fillf([&]() { return val = std::fmod(val + 0.37, 3.0) - 1.0; });
+    mat2.fillf([&]() { return val = std::fmod(val + 0.53, 5.0) - 2.0; });
+
+    lao::linalg::Matrix<double, 6, 6> mat3 = mat1 * mat2;
+    lao::linalg::Matrix<double, 6, 6> mat4 = lao::linalg::transpose(mat1) * mat2;
+    lao::linalg::Matrix<double, 3, 6> top;
+    top.fillf([&]() { return val = std::fmod(val + 0.29, 2.0) - 1.0; });
+    lao::linalg::Matrix<double, 6, 3> mat5 = mat1 * lao::linalg::transpose(top);
+    lao::linalg::Matrix<double, 6, 6> mat6 = lao::linalg::transpose(mat2);
+    lao::linalg::Matrix<double, 6, 6> mat7 = mat1 * (mat2 + mat2);
+    for (size_t i = 1; i <= 6; ++i) {
+        for (size_t j = 1; j <= 6; ++j) {
+            double expected3 = 0.0;
+            double expected4 = 0.0;
+            for (size_t k = 1; k <= 6; ++k) {
+                expected3 += mat1(i, k) * mat2(k, j);
+                expected4 += mat1(k, i) * mat2(k, j);
+            }
+            EXPECT_NEAR(mat3(i, j), expected3, 1e-12);
+            EXPECT_NEAR(mat4(i, j), expected4, 1e-12);
+            EXPECT_NEAR(mat7(i, j), 2.0 * expected3, 1e-12);
+            EXPECT_EQ(mat6(i, j), mat2(j, i));
+            if (j <= 3) {
+                double expected5 = 0.0;
+                for (size_t k = 1; k <= 6; ++k)
+                    expected5 += mat1(i, k) * top(j, k);
+                EXPECT_NEAR(mat5(i, j), expected5, 1e-12);
+            }
+        }
+    }
+
+    // aliased assignment still goes through a temporary.
+    mat3 = mat3 * mat1;
+    lao::linalg::Matrix<double, 6, 6> mat8 = mat1 * mat2 * mat1;
+    EXPECT_EQ(matricesEqual(mat3, mat8), true);
+
+    lao::linalg::Matrix<int, 3, 2> mat9 { { 1, 2 }, { 3, 4 }, { 5, 6 } };
+    lao::linalg::Matrix<int, 2, 3> mat10 = lao::linalg::transpose(mat9);
+    lao::linalg::Matrix<int, 3, 3> mat11 = mat9 * mat10;
+    lao::linalg::Matrix<int, 3, 3> result { { 5, 11, 17 }, { 11, 25, 39 }, { 17, 39, 61 } };
+    EXPECT_EQ(matricesEqual(mat11, result), true);
+}
+
+/// @brief Test expressions mixing static and dynamic extents, and their runtime shape checks.
+TEST_F(MatrixTest, DynamicExtentExpressions)
+{
+    using lao::linalg::Dynamic;
+
+    lao::linalg::Matrix<int, 2, 3> mat1 { { 1, 2, 3 }, { 4, 5, 6 } };
+    lao::linalg::Matrix<int, Dynamic, Dynamic> mat2 { { 6, 5, 4 }, { 3, 2, 1 } };
+    lao::linalg::Matrix<int, Dynamic, Dynamic> mat3 { { 1, 2 }, { 3, 4 } };
+
+    // extents known on either side stay static.
+    auto sum = mat1 + 2 * mat2;
+    EXPECT_EQ(decltype(sum)::row_extent, 2u);
+    EXPECT_EQ(decltype(sum)::col_extent, 3u);
+    EXPECT_TRUE(decltype(sum)::packet_access);
+
+    lao::linalg::Matrix<int, 2, 3> result { { 13, 12, 11 }, { 10, 9, 8 } };
+    lao::linalg::Matrix<int, Dynamic, Dynamic> mat4 = sum;
+    EXPECT_EQ(mat4.rows(), 2u);
+    EXPECT_EQ(mat4.cols(), 3u);
+    EXPECT_EQ(matricesEqual(mat4, result), true);
+
+    lao::linalg::Matrix<int, 2, 3> mat5 = mat2 - mat1;
+    EXPECT_EQ(mat5(1, 1), 5);
+
+    EXPECT_THROW(mat1 + mat3, std::invalid_argument);
+    EXPECT_THROW(mat1 * mat3, std::invalid_argument);
+    EXPECT_THROW((lao::linalg::Matrix<int, 2, 3>(mat3)), std::invalid_argument);
+
+    // assignment resizes dynamic extents.
+    mat4 = mat3 * mat1;
+    EXPECT_EQ(mat4.rows(), 2u);
+    EXPECT_EQ(mat4.cols(), 3u);
+    EXPECT_EQ(mat4(2, 3), 33);
+
+    lao::linalg::Matrix<int, Dynamic, Dynamic> mat6 = lao::linalg::transpose(mat4);
+    EXPECT_EQ(mat6.rows(), 3u);
+    EXPECT_EQ(mat6(3, 2), 33);
+    EXPECT_EQ(lao::linalg::trace(mat3), 5);
+
+    auto joined = lao::linalg::concat(mat2, mat3);
+    EXPECT_EQ(joined.cols(), 5u);
+    EXPECT_EQ(joined(2, 5), 4);
+}
+
+/// @brief Test a dynamically sized product large enough for the blocked GEMM path.
+TEST_F(MatrixTest, DynamicExtentMatrixMultiplication)
+{
+    using lao::linalg::Dynamic;
+
+    lao::linalg::Matrix<double, Dynamic, Dynamic> mat1(53, 31);
+    lao::linalg::Matrix<double, 31, Dynamic> mat2(31, 47);
+    double val = 0.0;
+    mat1.fillf([&]() { return val = std::fmod(val + 0.37, 3.0) - 1.0; });
+    mat2.fillf([&]() { return val = std::fmod(val + 0.53, 5.0) - 2.0; });
+
+    lao::linalg::Matrix<double, Dynamic, Dynamic> mat3 = mat1 * mat2;
+    ASSERT_EQ(mat3.rows(), 53u);
+    ASSERT_EQ(mat3.cols(), 47u);
+
+    for (size_t i = 1; i <= mat3.rows(); ++i) {
+        for (size_t j = 1; j <= mat3.cols(); ++j) {
+            double expected = 0.0;
+            for (size_t k = 1; k <= mat1.cols(); ++k)
+                expected += mat1(i, k) * mat2(k, j);
+            EXPECT_NEAR(mat3(i, j), expected, 1e-12);
+        }
+    }
+}
+
+/// @brief Test the reductions on every traversal path: packets, flat, by rows and in blocks.
+TEST_F(MatrixTest, Reductions)
+{
+    using lao::linalg::Dynamic;
+    const lao::linalg::Matrix<double, 2, 3> mat1 { { 1.0, -2.0, 3.0 }, { -4.0, 5.0, -6.0 } };
+    const lao::linalg::Matrix<double, 2, 3> mat2 { { 2.0, 1.0, 0.5 }, { 1.0, -1.0, 2.0 } };
+    EXPECT_EQ(lao::linalg::sum(mat1), -3.0);
+    EXPECT_EQ(lao::linalg::accumulate(mat1 + mat2), 2.5);
+    EXPECT_EQ(lao::linalg::dot(mat1, mat2), 2.0 - 2.0 + 1.5 - 4.0 - 5.0 - 12.0);
+    EXPECT_EQ(lao::linalg::norm1(mat1), 21.0);
+    EXPECT_DOUBLE_EQ(lao::linalg::norm2(mat1), std::sqrt(91.0));
+    EXPECT_EQ(lao::linalg::norm_inf(mat1), 6.0);
+    EXPECT_EQ(lao::linalg::max_coeff(mat1), 5.0);
+    EXPECT_EQ(lao::linalg::min_coeff(mat1 - mat2), -8.0);
+    // a transpose has no flat loop against a row-major operand, so it is reduced by rows.
+    EXPECT_EQ(lao::linalg::dot(lao::linalg::transpose(mat1), lao::linalg::ColMajorMatrix<double, 3, 2>(lao::linalg::transpose(mat2))), lao::linalg::dot(mat1, mat2));
+    EXPECT_EQ(lao::linalg::max_coeff(mat1.submat(1, 1, 2, 2)), 5.0);
+    const lao::linalg::Matrix<int, 2, 2> ints { { -3, 1 }, { 2, 7 } };
+    EXPECT_EQ(lao::linalg::norm_inf(ints), 7);
+    EXPECT_EQ(lao::linalg::min_coeff(ints), -3);
+    EXPECT_EQ(lao::linalg::trace(ints), 4);
+    EXPECT_EQ(lao::linalg::trace(mat1 * lao::linalg::transpose(mat2)), lao::linalg::dot(mat1, mat2));
+    EXPECT_THROW(lao::linalg::max_coeff(lao::linalg::Matrix<double, Dynamic, Dynamic>()), std::invalid_argument);
+    EXPECT_EQ(lao::linalg::sum(lao::linalg::Matrix<double, Dynamic, Dynamic>()), 0.0);
+
+    // large enough to be split into blocks, which run in parallel, with an odd tail.
+    const size_t n = 200003;
+    lao::linalg::Matrix<double, Dynamic, 1> x(n, 1);
+    lao::linalg::Matrix<double, Dynamic, 1> y(n, 1);
+    long double reference = 0.0L;
+    long double magnitudes = 0.0L;
+    double largest = 0.0;
+    for (size_t i = 1; i <= n; ++i) {
+        x(i, 1) = std::sin(0.001 * static_cast<double>(i)) * 1e3;
+        y(i, 1) = std::cos(0.0007 * static_cast<double>(i));
+        reference += static_cast<long double>(x(i, 1)) * y(i, 1);
+        magnitudes += std::abs(static_cast<long double>(x(i, 1)));
+        largest = std::max(largest, std::abs(x(i, 1)));
+    }
+    const double fast = lao::linalg::dot(x, y);
+    EXPECT_NEAR(fast, static_cast<double>(reference), 1e-10 * static_cast<double>(magnitudes));
+    EXPECT_EQ(lao::linalg::dot(x, y), fast);
+    EXPECT_NEAR(lao::linalg::norm1(x), static_cast<double>(magnitudes), 1e-12 * static_cast<double>(magnitudes));
+    EXPECT_EQ(lao::linalg::norm_inf(x), largest);
+    EXPECT_EQ(lao::linalg::norm_inf(x.submat(1, 1, n, 1)), largest);
+    EXPECT_NEAR(lao::linalg::norm2(x), std::sqrt(lao::linalg::dot(x, x)), 1e-9);
+
+    // compensated summation recovers what the fast sum loses to rounding.
+    lao::linalg::Matrix<double, Dynamic, Dynamic> small(1000, 1000, lao::linalg::filltype::none);
+    small.fill(0.1);
+    const long double exact = 1e6L * static_cast<long double>(0.1);
+    const double compensated = lao::linalg::sum(small, lao::linalg::Summation::compensated);
+    EXPECT_LE(std::abs(compensated - exact), std::abs(lao::linalg::sum(small) - exact));
+    EXPECT_NEAR(compensated, static_cast<double>(exact), 1e-9);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,114 @@
+#include <atomic>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <lao/lao.hpp>
+#include <stdexcept>
+#include <vector>
+
+class ParallelTest : public ::testing::Test {
+};
+
+/// @brief Test that every index is visited exactly once, in chunks of at least the grain.
+TEST_F(ParallelTest, CoversRange)
+{
+    lao::ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+
+    std::vector<std::atomic<int>> visits(10007);
+    std::atomic<size_t> chunks { 0 };
+    pool.parallel_for(0, visits.size(), 100, [&](size_t first, size_t last) {
+        EXPECT_GE(last - first, 100u);
+        ++chunks;
+        for (size_t i = first; i < last; ++i)
+            ++visits[i];
+    });
+    for (const auto& v : visits)
+        EXPECT_EQ(v.load(), 1);
+    EXPECT_GT(chunks.load(), 1u);
+    EXPECT_LE(chunks.load(), 4 * pool.size());
+
+    // ranges under two grains run inline as one chunk.
+    chunks = 0;
+    pool.parallel_for(5, 15, 6, [&](size_t first, size_t last) {
+        EXPECT_EQ(first, 5u);
+        EXPECT_EQ(last, 15u);
+        ++chunks;
+    });
+    EXPECT_EQ(chunks.load(), 1u);
+    pool.parallel_for(3, 3, 1, [&](size_t, size_t) { ++chunks; });
+    EXPECT_EQ(chunks.load(), 1u);
+}
+
+/// @brief Test nested parallel loops, which need waiting threads to run queued work.
+TEST_F(ParallelTest, Nested)
+{
+    lao::ThreadPool pool(3);
+    std::atomic<size_t> total { 0 };
+    pool.parallel_for(0, 64, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+            pool.parallel_for(0, 1000, 10, [&](size_t a, size_t b) { total += b - a; });
+    });
+    EXPECT_EQ(total.load(), 64000u);
+}
+
+/// @brief Test that an exception thrown by a chunk reaches the caller.
+TEST_F(ParallelTest, Exceptions)
+{
+    lao::ThreadPool pool(4);
+    EXPECT_THROW(pool.parallel_for(0, 1000, 1, [](size_t first, size_t last) {
+        if (first <= 500 && 500 < last)
+            throw std::runtime_error("chunk failed");
+    }),
+        std::runtime_error);
+
+    // the pool is still usable afterwards.
+    std::atomic<size_t> total { 0 };
+    pool.parallel_for(0, 1000, 1, [&](size_t first, size_t last) { total += last - first; });
+    EXPECT_EQ(total.load(), 1000u);
+}
+
+/// @brief Test dense kernels large enough to run on the shared pool against serial references.
+TEST_F(ParallelTest, DenseKernels)
+{
+    constexpr size_t n = 300;
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> A(n, n);
+    lao::linalg::ColMajorMatrix<double, n, n> B;
+    for (size_t i = 1; i <= n; ++i) {
+        for (size_t j = 1; j <= n; ++j) {
+            A(i, j) = static_cast<double>((i * 7 + j * 3) % 11) - 5.0;
+            B(i, j) = static_cast<double>((i + 2 * j) % 5) - 2.0;
+        }
+    }
+    ASSERT_GE(n * n, LAO_PARALLEL_THRESHOLD);
+
+    // element-wise, on the packet path and on the mixed layout path.
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> sum = A + A * 2.0;
+    lao::linalg::Matrix<double, n, n> mixed = A - B;
+    // products, with enough work to split the GEMM.
+    lao::linalg::Matrix<double, n, n> product = A * B;
+    ASSERT_GE(n * n * n, LAO_GEMM_PARALLEL_THRESHOLD);
+
+    double total = 0.0;
+    for (size_t i = 1; i <= n; ++i) {
+        for (size_t j = 1; j <= n; ++j) {
+            EXPECT_EQ(sum(i, j), 3.0 * A(i, j));
+            EXPECT_EQ(mixed(i, j), A(i, j) - B(i, j));
+            total += A(i, j);
+        }
+    }
+    for (size_t i = 1; i <= n; i += 37) {
+        for (size_t j = 1; j <= n; j += 41) {
+            double expected = 0.0;
+            for (size_t k = 1; k <= n; ++k)
+                expected += A(i, k) * B(k, j);
+            EXPECT_EQ(product(i, j), expected);
+        }
+    }
+    EXPECT_EQ(lao::linalg::accumulate(A), total);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,401 @@
+#include <cmath>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <lao/lao.hpp>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+class SolverTest : public ::testing::Test {
+protected:
+    /// @brief Fills a matrix with reproducible random values in [-1, 1], plus shift on the diagonal.
+    template <typename M>
+    void fillTestMatrix(M& mat, double shift) const
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (size_t i = 1; i <= mat.rows(); ++i)
+            for (size_t j = 1; j <= mat.cols(); ++j)
+                mat(i, j) = dist(gen) + (i == j ? shift : 0.0);
+    }
+    /// @brief Assembles the 5-point Laplacian on a K x K grid, which is symmetric positive definite.
+    template <size_t K>
+    lao::linalg::SparseMatrix<double, K * K, K * K> poisson() const
+    {
+        lao::linalg::TripletBuilder<double, K * K, K * K> builder(5 * K * K);
+        for (size_t i = 0; i < K; ++i) {
+            for (size_t j = 0; j < K; ++j) {
+                const size_t row = i * K + j;
+                builder.add(row, row, 4.0);
+                if (i > 0)
+                    builder.add(row, row - K, -1.0);
+                if (i + 1 < K)
+                    builder.add(row, row + K, -1.0);
+                if (j > 0)
+                    builder.add(row, row - 1, -1.0);
+                if (j + 1 < K)
+                    builder.add(row, row + 1, -1.0);
+            }
+        }
+        return lao::linalg::SparseMatrix<double, K * K, K * K>(builder);
+    }
+};
+
+/// @brief Test that the packed factors and permutation reproduce the matrix, PA = LU.
+TEST_F(SolverTest, LUFactors)
+{
+    lao::linalg::Matrix<double, 3, 3> A { { 1, 1, 2 }, { 2, 1, 3 }, { 3, 1, 1 } };
+    lao::linalg::LUFactorization lu(A);
+    static_assert(std::is_same_v<decltype(lu), lao::linalg::LUFactorization<double, 3>>);
+    EXPECT_FALSE(lu.is_singular());
+
+    const auto& packed = lu.packed();
+    const auto& perm = lu.permutation();
+    for (size_t i = 1; i <= 3; ++i) {
+        for (size_t j = 1; j <= 3; ++j) {
+            double sum = 0.0;
+            for (size_t k = 1; k <= std::min(i, j); ++k)
+                sum += (k == i ? 1.0 : packed(i, k)) * packed(k, j);
+            EXPECT_NEAR(sum, A(perm[i - 1] + 1, j), 1e-12);
+        }
+    }
+    // partial pivoting picks the largest element of the first column.
+    EXPECT_EQ(perm[0], 2u);
+    EXPECT_NEAR(lu.det(), 3.0, 1e-12);
+    EXPECT_NEAR(lao::linalg::det(A), 3.0, 1e-12);
+}
+
+/// @brief Test solving with one and many right hand sides.
+TEST_F(SolverTest, LUSolve)
+{
+    lao::linalg::Matrix<double, 3, 3> A { { 2, 1, 1 }, { 4, -6, 0 }, { -2, 7, 2 } };
+    lao::linalg::ColVector<double, 3> b { { 5 }, { -2 }, { 9 } };
+    lao::linalg::LUFactorization lu(A);
+
+    auto x = lu.solve(b);
+    EXPECT_NEAR(x(1, 1), 1.0, 1e-12);
+    EXPECT_NEAR(x(2, 1), 1.0, 1e-12);
+    EXPECT_NEAR(x(3, 1), 2.0, 1e-12);
+
+    lao::linalg::Matrix<double, 3, 2> B { { 5, 4 }, { -2, 4 }, { 9, 5 } };
+    auto X = lu.solve(B);
+    lao::linalg::Matrix<double, 3, 2> AX = A * X;
+    for (size_t i = 1; i <= 3; ++i)
+        for (size_t j = 1; j <= 2; ++j)
+            EXPECT_NEAR(AX(i, j), B(i, j), 1e-12);
+
+    auto Ainv = lao::linalg::inv(A);
+    lao::linalg::Matrix<double, 3, 3> I = A * Ainv;
+    for (size_t i = 1; i <= 3; ++i)
+        for (size_t j = 1; j <= 3; ++j)
+            EXPECT_NEAR(I(i, j), i == j ? 1.0 : 0.0, 1e-12);
+}
+
+/// @brief Test a factorization large enough to take the blocked path, with dynamic extents.
+TEST_F(SolverTest, LUBlocked)
+{
+    constexpr size_t n = 3 * LAO_LU_BLOCK_SIZE + 17;
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> A(n, n);
+    fillTestMatrix(A, 0.0);
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> B(n, 5);
+    fillTestMatrix(B, 1.0);
+
+    lao::linalg::LUFactorization lu(A);
+    static_assert(std::is_same_v<decltype(lu), lao::linalg::LUFactorization<double, lao::linalg::Dynamic>>);
+    EXPECT_EQ(lu.size(), n);
+    auto X = lu.solve(B);
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> AX = A * X;
+    for (size_t i = 1; i <= n; ++i)
+        for (size_t j = 1; j <= 5; ++j)
+            EXPECT_NEAR(AX(i, j), B(i, j), 1e-9);
+
+    // the determinant of a block diagonal matrix is the product of the diagonal blocks.
+    lao::linalg::Matrix<double, 2 * LAO_LU_BLOCK_SIZE, 2 * LAO_LU_BLOCK_SIZE> D;
+    for (size_t i = 1; i <= 2 * LAO_LU_BLOCK_SIZE; ++i)
+        D(i, i) = i % 2 ? 2.0 : 0.5;
+    D(1, 2) = 3.0;
+    EXPECT_NEAR(lao::linalg::det(D), 1.0, 1e-9);
+
+    lao::linalg::Matrix<double, 2, 2> wrong;
+    EXPECT_THROW(lu.solve(wrong), std::invalid_argument);
+}
+
+/// @brief Test that singular matrices are detected.
+TEST_F(SolverTest, LUSingular)
+{
+    lao::linalg::Matrix<double, 3, 3> A { { 1, 2, 3 }, { 2, 4, 6 }, { 1, 0, 1 } };
+    lao::linalg::LUFactorization lu(A);
+    EXPECT_TRUE(lu.is_singular());
+    EXPECT_EQ(lu.det(), 0.0);
+    lao::linalg::ColVector<double, 3> b { { 1 }, { 2 }, { 3 } };
+    EXPECT_THROW(lu.solve(b), std::runtime_error);
+    EXPECT_THROW(lao::linalg::inv(A), std::runtime_error);
+}
+
+/// @brief Test the unrolled fixed-size det, inv and solve against the LU factorization of the same
+/// matrix with dynamic extents.
+TEST_F(SolverTest, FixedSizeKernels)
+{
+    const auto check = [&](auto size) {
+        constexpr size_t N = decltype(size)::value;
+        lao::linalg::Matrix<double, N, N> A;
+        fillTestMatrix(A, 0.0);
+        // a zero in the first pivot position needs a row interchange.
+        if constexpr (N > 1)
+            A(1, 1) = 0.0;
+        lao::linalg::Matrix<double, N, 2> B;
+        fillTestMatrix(B, 1.0);
+
+        lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> D = A;
+        lao::linalg::LUFactorization lu(D);
+        EXPECT_NEAR(lao::linalg::det(A), lu.det(), 1e-12);
+
+        auto Ainv = lao::linalg::inv(A);
+        static_assert(std::is_same_v<decltype(Ainv), lao::linalg::Matrix<double, N, N>>);
+        auto X = lao::linalg::solve(A, B);
+        static_assert(std::is_same_v<decltype(X), lao::linalg::Matrix<double, N, 2>>);
+        auto expected_inv = lu.inverse();
+        auto expected_x = lu.solve(B);
+        for (size_t i = 1; i <= N; ++i) {
+            for (size_t j = 1; j <= N; ++j)
+                EXPECT_NEAR(Ainv(i, j), expected_inv(i, j), 1e-10);
+            for (size_t j = 1; j <= 2; ++j)
+                EXPECT_NEAR(X(i, j), expected_x(i, j), 1e-10);
+        }
+
+        // column-major and transposed operands are read in place.
+        lao::linalg::ColMajorMatrix<double, N, N> C = A;
+        EXPECT_NEAR(lao::linalg::det(C), lu.det(), 1e-12);
+        EXPECT_NEAR(lao::linalg::det(lao::linalg::transpose(A)), lu.det(), 1e-12);
+        auto Cinv = lao::linalg::inv(C);
+        EXPECT_NEAR(Cinv(N, 1), expected_inv(N, 1), 1e-10);
+    };
+    check(std::integral_constant<size_t, 1> {});
+    check(std::integral_constant<size_t, 2> {});
+    check(std::integral_constant<size_t, 3> {});
+    check(std::integral_constant<size_t, 4> {});
+    check(std::integral_constant<size_t, 5> {});
+    check(std::integral_constant<size_t, 6> {});
+
+    lao::linalg::Matrix<double, 6, 6> S;
+    fillTestMatrix(S, 0.0);
+    for (size_t j = 1; j <= 6; ++j)
+        S(4, j) = 2.0 * S(2, j);
+    EXPECT_NEAR(lao::linalg::det(S), 0.0, 1e-12);
+    EXPECT_THROW(lao::linalg::inv(S), std::runtime_error);
+    lao::linalg::ColVector<double, 6> b;
+    EXPECT_THROW(lao::linalg::solve(S, b), std::runtime_error);
+}
+
+/// @brief Test the stationary methods on dense and sparse matrices against a direct solve.
+TEST_F(SolverTest, StationaryMethods)
+{
+    lao::linalg::Matrix<double, 4, 4> A { { 10, -1, 2, 0 }, { -1, 11, -1, 3 }, { 2, -1, 10, -1 }, { 0, 3, -1, 8 } };
+    lao::linalg::ColVector<double, 4> b { { 6 }, { 25 }, { -11 }, { 15 } };
+    lao::linalg::SparseMatrix<double, 4, 4> sparse(A);
+    lao::linalg::IterativeOptions<double> options;
+    options.tolerance = 1e-12;
+    options.check_interval = 1;
+
+    lao::linalg::ColVector<double, 4> x;
+    auto jacobi = lao::linalg::jacobi(A, x, b, options);
+    EXPECT_TRUE(jacobi.converged);
+    EXPECT_LE(jacobi.residual, 1e-12);
+    const double expected[4] = { 1, 2, -1, 1 };
+    for (size_t i = 1; i <= 4; ++i)
+        EXPECT_NEAR(x(i, 1), expected[i - 1], 1e-10);
+
+    lao::linalg::ColVector<double, 4> y;
+    auto gs = lao::linalg::gauss_seidel(sparse, y, b, options);
+    EXPECT_TRUE(gs.converged);
+    EXPECT_LT(gs.iterations, jacobi.iterations);
+    for (size_t i = 1; i <= 4; ++i)
+        EXPECT_NEAR(y(i, 1), expected[i - 1], 1e-10);
+
+    // an exact initial guess needs no iterations.
+    auto again = lao::linalg::jacobi(sparse, y, b, options);
+    EXPECT_TRUE(again.converged);
+    EXPECT_EQ(again.iterations, 0u);
+
+    lao::linalg::ColVector<double, 4> z;
+    auto legacy = lao::linalg::solve_jacobi_element(z, A, b, 100, 1e-12);
+    EXPECT_TRUE(legacy.converged);
+    EXPECT_NEAR(z(1, 1), 1.0, 1e-10);
+}
+
+/// @brief Test SOR, the iteration limit and the convergence check interval on a sparse system.
+TEST_F(SolverTest, SuccessiveOverRelaxation)
+{
+    constexpr size_t K = 16;
+    const auto A = poisson<K>();
+    lao::linalg::ColVector<double, K * K> b;
+    b.ones();
+    lao::linalg::IterativeOptions<double> options;
+    options.tolerance = 1e-8;
+    options.max_iterations = 5000;
+
+    lao::linalg::ColVector<double, K * K> x;
+    auto gs = lao::linalg::gauss_seidel(A, x, b, options);
+    ASSERT_TRUE(gs.converged);
+    EXPECT_EQ(gs.iterations % LAO_SOLVER_CHECK_INTERVAL, 0u);
+
+    lao::linalg::ColVector<double, K * K> y;
+    options.omega = 1.7;
+    auto sor = lao::linalg::sor(A, y, b, options);
+    ASSERT_TRUE(sor.converged);
+    EXPECT_LT(3 * sor.iterations, gs.iterations);
+    for (size_t i = 1; i <= K * K; ++i)
+        EXPECT_NEAR(y(i, 1), x(i, 1), 1e-6);
+
+    lao::linalg::ColVector<double, K * K> z;
+    options.max_iterations = 3;
+    auto limited = lao::linalg::sor(A, z, b, options);
+    EXPECT_FALSE(limited.converged);
+    EXPECT_EQ(limited.iterations, 3u);
+    EXPECT_GT(limited.residual, 1e-8);
+
+    options.omega = 2.0;
+    EXPECT_THROW(lao::linalg::sor(A, z, b, options), std::invalid_argument);
+}
+
+/// @brief Test conjugate gradient with each preconditioner on dense and sparse matrices.
+TEST_F(SolverTest, PreconditionedConjugateGradient)
+{
+    constexpr size_t K = 20;
+    const auto A = poisson<K>();
+    lao::linalg::ColVector<double, K * K> b;
+    fillTestMatrix(b, 0.0);
+    lao::linalg::IterativeOptions<double> options;
+    options.tolerance = 1e-10;
+
+    lao::linalg::ColVector<double, K * K> x;
+    auto cg = lao::linalg::conjugate_gradient(A, x, b, options);
+    ASSERT_TRUE(cg.converged);
+    EXPECT_LE(cg.iterations, K * K);
+
+    lao::linalg::ColVector<double, K * K> y;
+    auto jacobi = lao::linalg::pcg(A, y, b, lao::linalg::JacobiPreconditioner<double>(A), options);
+    ASSERT_TRUE(jacobi.converged);
+
+    lao::linalg::ColVector<double, K * K> z;
+    auto ilu = lao::linalg::pcg(A, z, b, lao::linalg::ILU0Preconditioner<double>(A), options);
+    ASSERT_TRUE(ilu.converged);
+    EXPECT_LT(ilu.iterations, cg.iterations);
+
+    lao::linalg::ColVector<double, K * K> Ax = A * z;
+    for (size_t i = 1; i <= K * K; ++i) {
+        EXPECT_NEAR(y(i, 1), x(i, 1), 1e-7);
+        EXPECT_NEAR(z(i, 1), x(i, 1), 1e-7);
+        EXPECT_NEAR(Ax(i, 1), b(i, 1), 1e-8);
+    }
+
+    // on a dense matrix ILU(0) drops nothing, so it is an exact solve and PCG takes one step.
+    lao::linalg::Matrix<double, 4, 4> D { { 4, 1, 0, 1 }, { 1, 5, 2, 0 }, { 0, 2, 6, 1 }, { 1, 0, 1, 3 } };
+    lao::linalg::ColMajorMatrix<double, 4, 4> Dc = D;
+    lao::linalg::ColVector<double, 4> d { { 1 }, { 2 }, { 3 }, { 4 } };
+    lao::linalg::ColVector<double, 4> w;
+    auto exact = lao::linalg::pcg(Dc, w, d, lao::linalg::ILU0Preconditioner<double>(Dc), options);
+    EXPECT_TRUE(exact.converged);
+    EXPECT_EQ(exact.iterations, 1u);
+    auto direct = lao::linalg::LUFactorization(D).solve(d);
+    for (size_t i = 1; i <= 4; ++i)
+        EXPECT_NEAR(w(i, 1), direct(i, 1), 1e-12);
+}
+
+/// @brief Test that the solvers run in single precision as they do in double.
+TEST_F(SolverTest, SinglePrecision)
+{
+    constexpr size_t K = 8;
+    const auto poisson_double = poisson<K>();
+    lao::linalg::TripletBuilder<float, K * K, K * K> builder(5 * K * K);
+    for (size_t i = 0; i < K * K; ++i)
+        for (size_t p = poisson_double.row_offsets()[i]; p < poisson_double.row_offsets()[i + 1]; ++p)
+            builder.add(i, poisson_double.col_indices()[p], static_cast<float>(poisson_double.values()[p]));
+    const lao::linalg::SparseMatrix<float, K * K, K * K> A(builder);
+    lao::linalg::ColVector<float, K * K> b(lao::linalg::filltype::ones);
+    lao::linalg::IterativeOptions<float> options;
+    options.tolerance = 1e-5f;
+
+    lao::linalg::ColVector<float, K * K> x;
+    const lao::linalg::IterativeResult<float> cg = lao::linalg::pcg(A, x, b, lao::linalg::ILU0Preconditioner<float>(A), options);
+    ASSERT_TRUE(cg.converged);
+    EXPECT_LE(cg.residual, 1e-5f);
+
+    lao::linalg::ColVector<float, K * K> y;
+    const auto jacobi = lao::linalg::jacobi(A, y, b, options);
+    ASSERT_TRUE(jacobi.converged);
+    for (size_t i = 1; i <= K * K; ++i)
+        EXPECT_NEAR(y(i, 1), x(i, 1), 1e-3f * std::abs(x(i, 1)));
+}
+
+/// @brief Test that refinement of a single precision factorization reaches the accuracy of a
+/// factorization in double, and stops unconverged where A is too ill-conditioned for float.
+TEST_F(SolverTest, MixedPrecisionRefinement)
+{
+    constexpr size_t n = 2 * LAO_LU_BLOCK_SIZE + 5;
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> A(n, n);
+    fillTestMatrix(A, 4.0);
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> b(n, 1);
+    fillTestMatrix(b, 0.0);
+    lao::linalg::IterativeOptions<double> options;
+    options.tolerance = 1e-13;
+
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> x(n, 1);
+    const auto result = lao::linalg::mixed_precision_solve(A, x, b, options);
+    ASSERT_TRUE(result.converged);
+    EXPECT_LE(result.residual, 1e-13);
+    EXPECT_LE(result.iterations, 5u);
+    const auto direct = lao::linalg::LUFactorization(A).solve(b);
+    for (size_t i = 1; i <= n; ++i)
+        EXPECT_NEAR(x(i, 1), direct(i, 1), 1e-12);
+
+    // a float solve alone is only accurate to about 1e-6.
+    options.max_iterations = 0;
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> single(n, 1);
+    const auto unrefined = lao::linalg::mixed_precision_solve(A, single, b, options);
+    EXPECT_FALSE(unrefined.converged);
+    EXPECT_EQ(unrefined.iterations, 0u);
+
+    // the hilbert matrix of order 10 has a condition number of 1.6e13, far beyond 1 / 2^-24.
+    lao::linalg::Matrix<double, 10, 10> H;
+    for (size_t i = 1; i <= 10; ++i)
+        for (size_t j = 1; j <= 10; ++j)
+            H(i, j) = 1.0 / static_cast<double>(i + j - 1);
+    lao::linalg::ColVector<double, 10> h(lao::linalg::filltype::ones);
+    lao::linalg::ColVector<double, 10> z;
+    options.max_iterations = 100;
+    const auto ill = lao::linalg::mixed_precision_solve(H, z, h, options);
+    EXPECT_FALSE(ill.converged);
+    EXPECT_LT(ill.iterations, 100u);
+
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> wrong(n - 1, 1);
+    EXPECT_THROW(lao::linalg::mixed_precision_solve(A, x, wrong), std::invalid_argument);
+}
+
+/// @brief Test that invalid systems are rejected.
+TEST_F(SolverTest, IterativeErrors)
+{
+    lao::linalg::Matrix<double, 2, 2> A { { 0, 1 }, { 1, 2 } };
+    lao::linalg::ColVector<double, 2> b { { 1 }, { 1 } };
+    lao::linalg::ColVector<double, 2> x;
+    EXPECT_THROW(lao::linalg::jacobi(A, x, b), std::invalid_argument);
+    EXPECT_THROW(lao::linalg::gauss_seidel(A, x, b), std::invalid_argument);
+    EXPECT_THROW(lao::linalg::ILU0Preconditioner<double> ilu(A), std::invalid_argument);
+
+    lao::linalg::Matrix<double, 2, 2> indefinite { { 1, 2 }, { 2, 1 } };
+    lao::linalg::ColVector<double, 2> e { { 1 }, { -1 } };
+    EXPECT_THROW(lao::linalg::conjugate_gradient(indefinite, x, e), std::runtime_error);
+
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, lao::linalg::Dynamic> dyn(3, 3);
+    dyn.eye();
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> dx(3, 1);
+    lao::linalg::Matrix<double, lao::linalg::Dynamic, 1> db(2, 1);
+    EXPECT_THROW(lao::linalg::jacobi(dyn, dx, db), std::invalid_argument);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,482 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <lao/lao.hpp>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+class SparseMatrixTest : public ::testing::Test {
+};
+
+/// @brief Test assembling unordered entries with duplicates and cancellations.
+TEST_F(SparseMatrixTest, TripletBuilder)
+{
+    lao::linalg::TripletBuilder<double, 3, 4> builder(8);
+    builder.add(2, 3, 1.0);
+    builder.add(0, 2, 2.0);
+    builder.add(2, 0, 3.0);
+    builder.add(0, 1, 4.0);
+    builder.add(0, 2, 0.5);
+    builder.add(1, 1, 7.0);
+    builder.add(1, 1, -7.0);
+    EXPECT_EQ(builder.size(), 7u);
+    EXPECT_THROW(builder.add(3, 0, 1.0), std::out_of_range);
+
+    lao::linalg::SparseMatrix<double, 3, 4> mat(builder);
+    EXPECT_EQ(mat.nnz(), 4u);
+    EXPECT_DOUBLE_EQ(mat(0, 1), 4.0);
+    EXPECT_DOUBLE_EQ(mat(0, 2), 2.5);
+    EXPECT_DOUBLE_EQ(mat(1, 1), 0.0);
+    EXPECT_DOUBLE_EQ(mat(2, 0), 3.0);
+    EXPECT_DOUBLE_EQ(mat(2, 3), 1.0);
+    EXPECT_DOUBLE_EQ(mat(2, 2), 0.0);
+}
+
+/// @brief Test an assembly large enough to compress in parallel against a dense reference.
+TEST_F(SparseMatrixTest, ParallelTripletBuilder)
+{
+    constexpr size_t N = 500;
+    std::vector<int> dense(N * N, 0);
+    lao::linalg::TripletBuilder<int, N, N> builder;
+    size_t state = 12345;
+    for (size_t e = 0; e < 4 * LAO_SPARSE_PARALLEL_THRESHOLD / 3; ++e) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t row = (state >> 20) % N;
+        const size_t col = (state >> 40) % N;
+        const int val = static_cast<int>((state >> 10) % 5) - 2;
+        builder.add(row, col, val);
+        dense[row * N + col] += val;
+    }
+
+    lao::linalg::SparseMatrix<int, N, N> mat(builder);
+    size_t nnz = 0;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            EXPECT_EQ(mat(i, j), dense[i * N + j]);
+            nnz += dense[i * N + j] != 0;
+        }
+    }
+    EXPECT_EQ(mat.nnz(), nnz);
+}
+
+/// @brief Test that single element inserts land at the right position in their row.
+TEST_F(SparseMatrixTest, OutOfOrderInsertion)
+{
+    lao::linalg::SparseMatrix<int, 3, 3> mat;
+    mat.eye();
+    EXPECT_EQ(mat.nnz(), 3u);
+    EXPECT_EQ(mat(0, 0), 1);
+    EXPECT_EQ(mat(2, 2), 1);
+    EXPECT_EQ(mat(1, 2), 0);
+    EXPECT_THROW(mat(3, 0), std::out_of_range);
+
+    mat.set(1, 2, 5);
+    mat.set(1, 0, 4);
+    mat.set(1, 1, 6);
+    EXPECT_EQ(mat.nnz(), 5u);
+    EXPECT_EQ(mat(1, 0), 4);
+    EXPECT_EQ(mat(1, 1), 6);
+    EXPECT_EQ(mat(1, 2), 5);
+    EXPECT_EQ(mat(2, 2), 1);
+
+    mat.zeros();
+    EXPECT_TRUE(mat.is_empty());
+    EXPECT_EQ(mat(1, 1), 0);
+}
+
+/// @brief Test converting a dense expression to a sparse matrix.
+TEST_F(SparseMatrixTest, ExpressionConstructor)
+{
+    lao::linalg::Matrix<int, 2, 3> dense { { 0, 1, 0 }, { 2, 0, 3 } };
+    lao::linalg::SparseMatrix<int, 2, 3> mat(dense + dense);
+    EXPECT_EQ(mat.nnz(), 3u);
+    EXPECT_EQ(mat(0, 1), 2);
+    EXPECT_EQ(mat(1, 0), 4);
+    EXPECT_EQ(mat(1, 2), 6);
+    EXPECT_EQ(mat(0, 0), 0);
+}
+
+/// @brief Test reading a dense CSV file.
+TEST_F(SparseMatrixTest, FileConstructor)
+{
+    const std::string filename = "test_sparse_matrix.csv";
+    {
+        std::ofstream file(filename);
+        file << "0,1.5,0\n"
+             << "0,0,0\n"
+             << "2,0,-3\n";
+    }
+
+    lao::linalg::SparseMatrix<double, 3, 3> mat(filename);
+    std::remove(filename.c_str());
+
+    EXPECT_EQ(mat.nnz(), 3u);
+    EXPECT_DOUBLE_EQ(mat(0, 1), 1.5);
+    EXPECT_DOUBLE_EQ(mat(2, 0), 2.0);
+    EXPECT_DOUBLE_EQ(mat(2, 2), -3.0);
+    EXPECT_DOUBLE_EQ(mat(1, 1), 0.0);
+}
+
+/// @brief Test sparse-dense, dense-sparse and sparse-sparse products against dense products.
+TEST_F(SparseMatrixTest, SparseDenseProducts)
+{
+    lao::linalg::Matrix<double, 4, 5> dense_a { { 1, 0, 0, 2, 0 }, { 0, 0, 0, 0, 0 }, { 0, 3, 0, 0, 4 }, { 5, 0, 6, 0, 0 } };
+    lao::linalg::SparseMatrix<double, 4, 5> sparse_a(dense_a);
+    lao::linalg::Matrix<double, 5, 3> dense_b { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 1, 0, 1 }, { 0, 1, 0 } };
+    lao::linalg::ColMajorMatrix<double, 5, 3> colmajor_b = dense_b;
+    lao::linalg::ColVector<double, 5> x { { 1 }, { -1 }, { 2 }, { 0 }, { 3 } };
+    lao::linalg::Matrix<double, 3, 4> dense_c { { 1, 0, 2, 0 }, { 0, 1, 0, 3 }, { 4, 0, 0, 1 } };
+
+    lao::linalg::Matrix<double, 4, 3> ab = dense_a * dense_b;
+    lao::linalg::Matrix<double, 4, 1> ax = dense_a * x;
+    lao::linalg::Matrix<double, 3, 5> ca = dense_c * dense_a;
+
+    lao::linalg::Matrix<double, 4, 3> sparse_ab = sparse_a * dense_b;
+    lao::linalg::Matrix<double, 4, 3> sparse_ab_col = sparse_a * colmajor_b;
+    lao::linalg::Matrix<double, 4, 1> sparse_ax = sparse_a * x;
+    lao::linalg::Matrix<double, 3, 5> sparse_ca = dense_c * sparse_a;
+    lao::linalg::Matrix<double, 4, 1> nested = sparse_a * x + sparse_a * x;
+
+    for (size_t i = 1; i <= 4; ++i) {
+        for (size_t j = 1; j <= 3; ++j) {
+            EXPECT_DOUBLE_EQ(sparse_ab(i, j), ab(i, j));
+            EXPECT_DOUBLE_EQ(sparse_ab_col(i, j), ab(i, j));
+        }
+        EXPECT_DOUBLE_EQ(sparse_ax(i, 1), ax(i, 1));
+        EXPECT_DOUBLE_EQ(nested(i, 1), 2 * ax(i, 1));
+    }
+    for (size_t i = 1; i <= 3; ++i)
+        for (size_t j = 1; j <= 5; ++j)
+            EXPECT_DOUBLE_EQ(sparse_ca(i, j), ca(i, j));
+
+    lao::linalg::SparseMatrix<double, 3, 4> sparse_c(dense_c);
+    lao::linalg::Matrix<double, 3, 5> sparse_sparse = sparse_c * sparse_a;
+    for (size_t i = 1; i <= 3; ++i)
+        for (size_t j = 1; j <= 5; ++j)
+            EXPECT_DOUBLE_EQ(sparse_sparse(i, j), ca(i, j));
+}
+
+/// @brief Test a sparse matrix-vector product large enough to be split across threads.
+TEST_F(SparseMatrixTest, ParallelSpMV)
+{
+    // a banded matrix with a few dense rows, so the rows have very uneven non-zero counts.
+    constexpr size_t N = 20000;
+    lao::linalg::TripletBuilder<double, N, N> builder(6 * N);
+    for (size_t i = 0; i < N; ++i) {
+        builder.add(i, i, 4.0);
+        if (i > 0)
+            builder.add(i, i - 1, -1.0);
+        if (i + 1 < N)
+            builder.add(i, i + 1, -1.0);
+    }
+    for (size_t j = 0; j < N; ++j)
+        builder.add(7, j, 0.5);
+    lao::linalg::SparseMatrix<double, N, N> A(builder);
+    ASSERT_GE(A.nnz(), LAO_SPARSE_PARALLEL_THRESHOLD);
+
+    lao::linalg::Matrix<double, N, 1> x;
+    for (size_t i = 1; i <= N; ++i)
+        x(i, 1) = static_cast<double>(i % 13);
+    lao::linalg::Matrix<double, N, 1> y = A * x;
+
+    double dense_row = 0.0;
+    for (size_t j = 1; j <= N; ++j)
+        dense_row += 0.5 * x(j, 1);
+    for (size_t i = 1; i <= N; ++i) {
+        double expected = 4.0 * x(i, 1);
+        if (i > 1)
+            expected -= x(i - 1, 1);
+        if (i < N)
+            expected -= x(i + 1, 1);
+        if (i == 8)
+            expected += dense_row;
+        EXPECT_NEAR(y(i, 1), expected, 1e-9);
+    }
+}
+
+/// @brief Test reading general, symmetric and pattern Matrix Market files.
+TEST_F(SparseMatrixTest, MatrixMarket)
+{
+    const std::string filename = "test_sparse_matrix.mtx";
+    {
+        std::ofstream file(filename);
+        file << "%%MatrixMarket matrix coordinate real general\n"
+             << "% a comment\n"
+             << "%\n"
+             << "3 4 5\n"
+             << "1 2 1.5\n"
+             << "3 1 -2e-1\n"
+             << "  3 4 +4\r\n"
+             << "1 2 0.5\n"
+             << "2 3 7";
+    }
+    auto mat = lao::linalg::read_matrix_market<double, 3, 4>(filename);
+    EXPECT_EQ(mat.nnz(), 4u);
+    EXPECT_DOUBLE_EQ(mat(0, 1), 2.0);
+    EXPECT_DOUBLE_EQ(mat(2, 0), -0.2);
+    EXPECT_DOUBLE_EQ(mat(2, 3), 4.0);
+    EXPECT_DOUBLE_EQ(mat(1, 2), 7.0);
+    EXPECT_THROW((lao::linalg::read_matrix_market<double, 4, 3>(filename)), std::invalid_argument);
+    EXPECT_THROW((lao::linalg::read_matrix_market<int, 3, 4>(filename)), std::invalid_argument);
+
+    {
+        std::ofstream file(filename);
+        file << "%%MatrixMarket matrix coordinate integer symmetric\n"
+             << "3 3 3\n"
+             << "1 1 2\n"
+             << "3 1 5\n"
+             << "3 2 -1\n";
+    }
+    auto sym = lao::linalg::read_matrix_market<int, 3, 3>(filename);
+    EXPECT_EQ(sym.nnz(), 5u);
+    EXPECT_EQ(sym(0, 0), 2);
+    EXPECT_EQ(sym(2, 0), 5);
+    EXPECT_EQ(sym(0, 2), 5);
+    EXPECT_EQ(sym(2, 1), -1);
+    EXPECT_EQ(sym(1, 2), -1);
+
+    {
+        std::ofstream file(filename);
+        file << "%%MatrixMarket matrix coordinate pattern skew-symmetric\n"
+             << "2 2 1\n"
+             << "2 1\n";
+    }
+    auto skew = lao::linalg::read_matrix_market<float, 2, 2>(filename);
+    EXPECT_FLOAT_EQ(skew(1, 0), 1.0f);
+    EXPECT_FLOAT_EQ(skew(0, 1), -1.0f);
+
+    {
+        std::ofstream file(filename);
+        file << "%%MatrixMarket matrix coordinate real general\n"
+             << "2 2 2\n"
+             << "1 1 x\n"
+             << "2 2 1\n";
+    }
+    EXPECT_THROW((lao::linalg::read_matrix_market<double, 2, 2>(filename)), std::runtime_error);
+
+    {
+        std::ofstream file(filename);
+        file << "%%MatrixMarket matrix coordinate real general\n"
+             << "2 2 2\n"
+             << "1 1 1\n";
+    }
+    EXPECT_THROW((lao::linalg::read_matrix_market<double, 2, 2>(filename)), std::runtime_error);
+    std::remove(filename.c_str());
+    EXPECT_THROW((lao::linalg::read_matrix_market<double, 2, 2>(filename)), std::runtime_error);
+}
+
+/// @brief Test a Matrix Market file large enough to be parsed in parallel.
+TEST_F(SparseMatrixTest, ParallelMatrixMarket)
+{
+    constexpr size_t N = 30000;
+    const std::string filename = "test_sparse_matrix_large.mtx";
+    {
+        std::ofstream file(filename);
+        file << "%%MatrixMarket matrix coordinate real general\n"
+             << N << " " << N << " " << 3 * N - 2 << "\n";
+        for (size_t i = 1; i <= N; ++i) {
+            file << i << " " << i << " " << 0.25 * static_cast<double>(i) << "\n";
+            if (i > 1)
+                file << i << " " << i - 1 << " -1\n";
+            if (i < N)
+                file << i << " " << i + 1 << " 2\n";
+        }
+    }
+    auto mat = lao::linalg::read_matrix_market<double, N, N>(filename);
+    std::remove(filename.c_str());
+
+    ASSERT_EQ(mat.nnz(), 3 * N - 2);
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_DOUBLE_EQ(mat(i, i), 0.25 * static_cast<double>(i + 1));
+        if (i > 0) {
+            EXPECT_DOUBLE_EQ(mat(i, i - 1), -1.0);
+        }
+        if (i + 1 < N) {
+            EXPECT_DOUBLE_EQ(mat(i, i + 1), 2.0);
+        }
+    }
+}
+
+/// @brief Test writing and reading the binary CSR format, and using a mapped file directly.
+TEST_F(SparseMatrixTest, BinaryFormat)
+{
+    lao::linalg::Matrix<double, 4, 5> dense { { 1, 0, 0, 2, 0 }, { 0, 0, 0, 0, 0 }, { 0, 3, 0, 0, 4 }, { 5, 0, 6, 0, 0 } };
+    lao::linalg::SparseMatrix<double, 4, 5> mat(dense);
+    const std::string filename = "test_sparse_matrix.bin";
+    lao::linalg::write_binary(mat, filename);
+
+    auto loaded = lao::linalg::read_binary<double, 4, 5>(filename);
+    EXPECT_EQ(loaded.nnz(), mat.nnz());
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 5; ++j)
+            EXPECT_DOUBLE_EQ(loaded(i, j), mat(i, j));
+    EXPECT_THROW((lao::linalg::read_binary<double, 5, 4>(filename)), std::invalid_argument);
+    EXPECT_THROW((lao::linalg::read_binary<float, 4, 5>(filename)), std::invalid_argument);
+
+    {
+        lao::linalg::MappedCSR<double> mapped(filename);
+        EXPECT_EQ(mapped.rows(), 4u);
+        EXPECT_EQ(mapped.cols(), 5u);
+        EXPECT_EQ(mapped.nnz(), 6u);
+        const std::vector<double> x { 1, -1, 2, 0, 3 };
+        std::vector<double> y(4);
+        lao::linalg::spmv(mapped.rows(), mapped.row_offsets(), mapped.col_indices(), mapped.values(), x.data(), 1, y.data(), 1);
+        EXPECT_DOUBLE_EQ(y[0], 1.0);
+        EXPECT_DOUBLE_EQ(y[1], 0.0);
+        EXPECT_DOUBLE_EQ(y[2], 9.0);
+        EXPECT_DOUBLE_EQ(y[3], 17.0);
+
+        lao::linalg::MappedCSR<double> moved(std::move(mapped));
+        EXPECT_EQ(moved.nnz(), 6u);
+    }
+
+    // files with consistent sizes but corrupt row offsets or column indices: the offsets out of
+    // order, a column out of range, and the columns of a row out of order.
+    const size_t rowvec = 8;
+    const size_t colvec = rowvec + 5;
+    for (const auto& [word, value] : { std::pair<size_t, std::uint64_t> { rowvec + 1, 5 }, { colvec + 1, 5 }, { colvec, 4 } }) {
+        lao::linalg::write_binary(mat, filename);
+        {
+            std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(word * sizeof(std::uint64_t)));
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        EXPECT_NO_THROW(lao::linalg::MappedCSR<double> mapped(filename));
+        EXPECT_THROW(lao::linalg::MappedCSR<double> mapped(filename, lao::linalg::csrcheck::structure), std::runtime_error);
+        EXPECT_THROW((lao::linalg::read_binary<double, 4, 5>(filename)), std::runtime_error);
+    }
+
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file << "not a matrix";
+    }
+    EXPECT_THROW(lao::linalg::MappedCSR<double> mapped(filename), std::runtime_error);
+    std::remove(filename.c_str());
+
+    using CSR = lao::linalg::SparseMatrix<double, 2, 3>;
+    EXPECT_NO_THROW(CSR({ 1.0, 2.0 }, { 0, 2, 2 }, { 1, 2 }));
+    EXPECT_THROW(CSR({ 1.0, 2.0 }, { 0, 2, 2 }, { 2, 1 }), std::invalid_argument);
+    EXPECT_THROW(CSR({ 1.0, 2.0 }, { 0, 2, 2 }, { 1, 1 }), std::invalid_argument);
+    EXPECT_THROW(CSR({ 1.0, 2.0 }, { 0, 2, 2 }, { 1, 3 }), std::out_of_range);
+}
+
+/// @brief Test the sparse expressions against dense references, and their patterns.
+TEST_F(SparseMatrixTest, SparseExpressions)
+{
+    lao::linalg::TripletBuilder<double, 3, 4> a_builder;
+    a_builder.add(0, 0, 1.0);
+    a_builder.add(0, 3, 2.0);
+    a_builder.add(1, 1, 3.0);
+    a_builder.add(2, 2, 4.0);
+    lao::linalg::TripletBuilder<double, 3, 4> b_builder;
+    b_builder.add(0, 0, 5.0);
+    b_builder.add(0, 2, 6.0);
+    b_builder.add(2, 2, -4.0);
+    b_builder.add(2, 3, 7.0);
+    const lao::linalg::SparseMatrix<double, 3, 4> A(a_builder);
+    const lao::linalg::SparseMatrix<double, 3, 4> B(b_builder);
+    const lao::linalg::Matrix<double, 3, 4> a = A;
+    const lao::linalg::Matrix<double, 3, 4> b = B;
+    lao::linalg::Matrix<double, 3, 4> d { { 1, 2, 3, 4 }, { 5, 6, 7, 8 }, { 9, 10, 11, 12 } };
+    EXPECT_DOUBLE_EQ(a(1, 4), 2.0);
+    EXPECT_DOUBLE_EQ(a(2, 1), 0.0);
+
+    // the pattern of a sum is the union, with cancelled entries stored as zeros.
+    lao::linalg::SparseMatrix<double, 3, 4> sum = A + B;
+    EXPECT_EQ(sum.nnz(), 6u);
+    lao::linalg::SparseMatrix<double, 3, 4> scaled = 2.0 * A - B * 0.5;
+    lao::linalg::SparseMatrix<double, 3, 4> product = A % B;
+    EXPECT_EQ(product.nnz(), 2u);
+    lao::linalg::SparseMatrix<double, 3, 4> masked = A % (d + d);
+    EXPECT_TRUE(masked.same_pattern(A));
+    lao::linalg::SparseMatrix<double, 3, 4> masked_left = d % A;
+    lao::linalg::SparseMatrix<double, 4, 3> transposed = lao::linalg::transpose(A + B);
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            EXPECT_DOUBLE_EQ(sum(i, j), a(i + 1, j + 1) + b(i + 1, j + 1));
+            EXPECT_DOUBLE_EQ(scaled(i, j), 2.0 * a(i + 1, j + 1) - 0.5 * b(i + 1, j + 1));
+            EXPECT_DOUBLE_EQ(product(i, j), a(i + 1, j + 1) * b(i + 1, j + 1));
+            EXPECT_DOUBLE_EQ(masked(i, j), 2.0 * a(i + 1, j + 1) * d(i + 1, j + 1));
+            EXPECT_DOUBLE_EQ(masked_left(i, j), a(i + 1, j + 1) * d(i + 1, j + 1));
+            EXPECT_DOUBLE_EQ(transposed(j, i), sum(i, j));
+        }
+    }
+
+    // sparse expressions evaluate into dense matrices, and as operands of dense expressions.
+    const lao::linalg::Matrix<double, 3, 4> dense_sum = A + B;
+    const lao::linalg::Matrix<double, 3, 4> mixed = d + 2.0 * A;
+    const lao::linalg::Matrix<double, 4, 1> x { { 1 }, { -1 }, { 2 }, { 3 } };
+    const lao::linalg::Matrix<double, 3, 1> y = (A + B) * x;
+    const lao::linalg::Matrix<double, 3, 1> y_ref = (a + b) * x;
+    for (size_t i = 1; i < 4; ++i) {
+        for (size_t j = 1; j < 5; ++j) {
+            EXPECT_DOUBLE_EQ(dense_sum(i, j), a(i, j) + b(i, j));
+            EXPECT_DOUBLE_EQ(mixed(i, j), d(i, j) + 2.0 * a(i, j));
+        }
+        EXPECT_DOUBLE_EQ(y(i, 1), y_ref(i, 1));
+    }
+
+    // fillf only replaces non-zero values, fillfnz every stored value.
+    sum.fillf([]() { return 1.0; });
+    EXPECT_DOUBLE_EQ(sum(2, 2), 0.0);
+    EXPECT_DOUBLE_EQ(sum(0, 2), 1.0);
+    sum.fillfnz([]() { return 2.0; });
+    EXPECT_DOUBLE_EQ(sum(2, 2), 2.0);
+    EXPECT_EQ(sum.nnz(), 6u);
+}
+
+/// @brief Test that updates whose pattern is unchanged reuse the storage of the destination.
+TEST_F(SparseMatrixTest, PatternReuse)
+{
+    constexpr size_t N = 1000;
+    lao::linalg::TripletBuilder<double, N, N> j_builder;
+    lao::linalg::TripletBuilder<double, N, N> k_builder;
+    for (size_t i = 0; i < N; ++i) {
+        j_builder.add(i, i, 4.0);
+        if (i + 1 < N)
+            j_builder.add(i, i + 1, -1.0);
+        k_builder.add(i, (i * 7) % N, 1.0);
+    }
+    const lao::linalg::SparseMatrix<double, N, N> J(j_builder);
+    const lao::linalg::SparseMatrix<double, N, N> K(k_builder);
+
+    lao::linalg::SparseMatrix<double, N, N> A = J + 2.0 * K;
+    const size_t nnz = A.nnz();
+    const size_t* rowvec = A.row_offsets();
+    const size_t* colvec = A.col_indices();
+    const double* values = A.values();
+    for (int step = 0; step < 3; ++step)
+        A = A + 0.5 * K;
+    A = A % (J + K);
+    EXPECT_EQ(A.nnz(), nnz);
+    EXPECT_EQ(A.row_offsets(), rowvec);
+    EXPECT_EQ(A.col_indices(), colvec);
+    EXPECT_EQ(A.values(), values);
+    for (size_t i = 0; i < N; ++i) {
+        const size_t c = (i * 7) % N;
+        EXPECT_DOUBLE_EQ(A(i, c), (J(i, c) + 3.5) * (J(i, c) + 1.0));
+        if (c != i) {
+            EXPECT_DOUBLE_EQ(A(i, i), 16.0);
+        }
+    }
+
+    // a change of pattern builds new arrays, also into an operand.
+    A = A - transpose(K);
+    EXPECT_GE(A.nnz(), nnz);
+    const lao::linalg::SparseMatrix<double, N, N> T = transpose(transpose(K));
+    EXPECT_TRUE(T.same_pattern(K));
+    lao::linalg::SparseMatrix<double, N, N> S = K;
+    S = transpose(S);
+    for (size_t i = 0; i < N; ++i)
+        EXPECT_DOUBLE_EQ(S((i * 7) % N, i), 1.0);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}